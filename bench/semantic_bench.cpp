@@ -0,0 +1,228 @@
+/**
+ * @file semantic_bench.cpp
+ * @brief Scaling benchmark for semantic analysis on large generated programs.
+ *
+ * @details
+ * Generates programs of doubling size, runs lexer -> parser -> SemanticAnalyzer
+ * in memory, and prints the analysis time per expression node or per function.
+ * Linear analysis keeps the per-unit cost flat as size doubles; quadratic work
+ * (re-inferring subtrees, scanning sibling scopes) shows up as a per-unit cost
+ * that doubles with it.
+ *
+ * Six shapes are measured:
+ * - chain:     x = x + x + ... + x;           (left-deep, built iteratively by the parser)
+ * - nested:    x = (x + (x + (... + x)));     (right-deep, parenthesized)
+ * - functions: that many free functions, each with its own scope, plus main.
+ * - blocks:    that many nested while-blocks, each assigning main's local x.
+ * - hierarchy: that many classes, each inheriting from the previous one.
+ * - overloads: that many calls in main, spread over a few names that each
+ *              have several overloads (distinct arities and parameter types).
+ *
+ * Usage: semantic_bench [maxSize] [repetitions] [jobs]
+ *
+ * jobs is passed to SemanticAnalyzer::setPassTwoJobs (0 = all cores, default);
+ * the functions shape is the one that scales with it.
+ */
+
+#include "../include/AST.h"
+#include "../include/my_parser.h"
+#include "../include/semantic.h"
+#include "../include/token.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+/** @brief Build a chain expression with depth operators. */
+std::string chainExpression(int depth) {
+    std::string expr = "x";
+    for (int i = 0; i < depth; ++i) {
+        expr += " + x";
+    }
+    return expr;
+}
+
+/** @brief Build a right-nested, parenthesized expression with depth operators. */
+std::string nestedExpression(int depth) {
+    std::string expr;
+    for (int i = 0; i < depth; ++i) {
+        expr += "(x + ";
+    }
+    expr += "x";
+    expr.append(static_cast<std::size_t>(depth), ')');
+    return expr;
+}
+
+/** @brief Wrap an expression in a minimal program, one source line per element. */
+std::vector<std::string> makeProgram(const std::string& expression) {
+    return {
+        "main",
+        "    local",
+        "        integer x;",
+        "    do",
+        "        x = " + expression + ";",
+        "    end",
+    };
+}
+
+/** @brief Build main with depth nested while-blocks that each update a function local. */
+std::vector<std::string> makeBlocksProgram(int depth) {
+    std::vector<std::string> lines = {"main", "    local", "        integer x;", "    do"};
+    for (int i = 0; i < depth; ++i) {
+        lines.push_back("        while (x < 1) do");
+        lines.push_back("            x = x + 1;");
+    }
+    for (int i = 0; i < depth; ++i) {
+        lines.push_back("        end;");
+    }
+    lines.push_back("    end");
+    return lines;
+}
+
+/** @brief Build a program with count small free functions and an empty main. */
+std::vector<std::string> makeFunctionsProgram(int count) {
+    std::vector<std::string> lines;
+    for (int i = 0; i < count; ++i) {
+        const std::string name = "f" + std::to_string(i);
+        lines.push_back(name + "(integer a) : integer");
+        lines.push_back("    do");
+        lines.push_back("        return (a + 1);");
+        lines.push_back("    end");
+    }
+    lines.push_back("main");
+    lines.push_back("    do");
+    lines.push_back("    end");
+    return lines;
+}
+
+/** @brief Build a single inheritance chain of count classes and an empty main. */
+std::vector<std::string> makeHierarchyProgram(int count) {
+    std::vector<std::string> lines = {"class C0 {", "};"};
+    for (int i = 1; i < count; ++i) {
+        lines.push_back("class C" + std::to_string(i) + " inherits C" + std::to_string(i - 1) + " {");
+        lines.push_back("};");
+    }
+    lines.push_back("main");
+    lines.push_back("    do");
+    lines.push_back("    end");
+    return lines;
+}
+
+/**
+ * @brief Build an overload-heavy API and main with count calls into it.
+ * @details Every one of 64 names gets integer/float overloads of arity one and
+ * two, so each call is resolved among several same-name candidates.
+ */
+std::vector<std::string> makeOverloadsProgram(int count) {
+    constexpr int kNames = 64;
+    const char* const signatures[] = {"(integer a) : integer", "(float a) : float",
+                                       "(integer a, integer b) : integer", "(float a, integer b) : float"};
+    // Assignment target and argument list matching each signature above.
+    const char* const calls[][2] = {{"x = ", "(x);"}, {"y = ", "(y);"}, {"x = ", "(x, x);"}, {"y = ", "(y, x);"}};
+    std::vector<std::string> lines;
+    for (int i = 0; i < kNames; ++i) {
+        for (const char* signature : signatures) {
+            lines.push_back("g" + std::to_string(i) + signature);
+            lines.push_back("    do");
+            lines.push_back("        return (a);");
+            lines.push_back("    end");
+        }
+    }
+    lines.push_back("main");
+    lines.push_back("    local");
+    lines.push_back("        integer x;");
+    lines.push_back("        float y;");
+    lines.push_back("    do");
+    for (int i = 0; i < count; ++i) {
+        const std::string name = "g" + std::to_string(i % kNames);
+        lines.push_back(std::string("        ") + calls[i % 4][0] + name + calls[i % 4][1]);
+    }
+    lines.push_back("    end");
+    return lines;
+}
+
+/** @brief Tokenize source lines the same way the driver does. */
+std::vector<std::vector<Token>> tokenizeLines(const std::vector<std::string>& lines) {
+    std::vector<std::vector<Token>> tokens;
+    bool inBlockComment = false;
+    int lineNumber = 1;
+    for (const auto& line : lines) {
+        tokens.push_back(std::get<0>(Token::tokenize(line, lineNumber++, inBlockComment)));
+    }
+    return tokens;
+}
+
+/**
+ * @brief Parse once and time repeated semantic analysis of the same AST.
+ * @return Best analysis time in microseconds, or a negative value on failure.
+ */
+double measure(const std::vector<std::string>& program, int repetitions, int jobs) {
+    if (!Parser::parseTokens(tokenizeLines(program))) {
+        return -1.0;
+    }
+    std::shared_ptr<ProgNode> root = Parser::getASTRoot();
+
+    double best = -1.0;
+    for (int rep = 0; rep < repetitions; ++rep) {
+        SemanticAnalyzer analyzer;
+        analyzer.setPassTwoJobs(static_cast<std::size_t>(jobs));
+        auto start = Clock::now();
+        analyzer.analyze(root);
+        double micros = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        if (analyzer.getDiagnostics().errorCount() != 0) {
+            return -1.0;
+        }
+        best = best < 0.0 ? micros : std::min(best, micros);
+    }
+    return best;
+}
+
+/**
+ * @brief Print one timing table for a generated program shape.
+ * @param shape Table title.
+ * @param makeSource Program generator for a given size.
+ * @param unitsPerSize Timed units per size step (expression nodes or functions).
+ */
+void runShape(const char* shape, std::vector<std::string> (*makeSource)(int), int unitsPerSize, int maxSize, int repetitions, int jobs) {
+    std::cout << "\n" << shape << "\n";
+    std::cout << std::setw(10) << "size" << std::setw(14) << "analyze(us)" << std::setw(14) << "ns/unit" << "\n";
+    for (int size = 250; size <= maxSize; size *= 2) {
+        double micros = measure(makeSource(size), repetitions, jobs);
+        std::cout << std::setw(10) << size;
+        if (micros < 0.0) {
+            std::cout << "  failed (syntax or semantic errors)\n";
+            continue;
+        }
+        double perUnit = micros * 1000.0 / static_cast<double>(unitsPerSize * size + 1);
+        std::cout << std::setw(14) << std::fixed << std::setprecision(1) << micros
+                  << std::setw(14) << std::setprecision(1) << perUnit << "\n";
+    }
+}
+}
+
+int main(int argc, char* argv[]) {
+    int maxSize = argc > 1 ? std::atoi(argv[1]) : 4000;
+    int repetitions = argc > 2 ? std::atoi(argv[2]) : 5;
+    int jobs = argc > 3 ? std::atoi(argv[3]) : 0;
+    if (maxSize < 250 || repetitions < 1 || jobs < 0) {
+        std::cerr << "Usage: semantic_bench [maxSize>=250] [repetitions>=1] [jobs>=0]\n";
+        return 1;
+    }
+
+    // Expression shapes have 2 * depth + 1 nodes: depth operators, depth + 1 operands.
+    runShape("chain", [](int depth) { return makeProgram(chainExpression(depth)); }, 2, maxSize, repetitions, jobs);
+    runShape("nested", [](int depth) { return makeProgram(nestedExpression(depth)); }, 2, maxSize, repetitions, jobs);
+    runShape("functions", makeFunctionsProgram, 1, maxSize, repetitions, jobs);
+    runShape("blocks", makeBlocksProgram, 1, maxSize, repetitions, jobs);
+    runShape("hierarchy", makeHierarchyProgram, 1, maxSize, repetitions, jobs);
+    runShape("overloads", makeOverloadsProgram, 1, maxSize, repetitions, jobs);
+    return 0;
+}
@@ -20,7 +20,11 @@
  */
 #ifndef AST_H
 #define AST_H
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
 #include <string>
+#include <utility>
 #include <vector>
 #include <memory>
 
@@ -43,6 +47,69 @@ class VarDeclNode;
 class FuncDefNode;
 class ClassDeclNode;
 class ProgNode;
+class ASTNode;
+
+/**
+ * @struct ASTChildSlot
+ * @brief One named group of children, in traversal order.
+ *
+ * @details
+ * Nodes describe their children as ordered slots ("cond", "then", "params",
+ * "args", ...). Single-child slots hold one (possibly null) pointer; list slots
+ * hold every element. Optional slots whose child is absent are not reported at
+ * all, so traversal clients see the same structure the printers document.
+ * BlockNode reports its statements in one unlabeled, non-list slot.
+ */
+struct ASTChildSlot {
+    /** @brief Slot label ("" for a block's statement sequence). */
+    const char* label;
+    /** @brief True for element lists (params, args, members, ...). */
+    bool isList;
+    /** @brief Children in source order; single slots may contain one null entry. */
+    std::vector<std::shared_ptr<ASTNode>> nodes;
+};
+
+/**
+ * @enum ASTBinding
+ * @brief Declaration a resolved name or call refers to.
+ */
+enum class ASTBinding : std::uint8_t {
+    /** @brief Not a name (literal, operator) or not bound. */
+    None,
+    /** @brief Local variable of the enclosing function. */
+    Local,
+    /** @brief Parameter of the enclosing function. */
+    Param,
+    /** @brief Data member of ASTAnnotation::receiverClass. */
+    Field,
+    /** @brief Free function. */
+    Function,
+    /** @brief Member function of ASTAnnotation::receiverClass. */
+    Method
+};
+
+/**
+ * @struct ASTAnnotation
+ * @brief Semantic analysis result attached to one expression node.
+ *
+ * @details
+ * SemanticAnalyzer attaches an annotation to every expression whose type it
+ * resolved; later phases read it instead of re-resolving names and types. An
+ * expression without one (unresolved, or created after analysis) must be
+ * resolved by the reader itself.
+ */
+struct ASTAnnotation {
+    /** @brief Base type of the value ("integer", "float", "bool", "void", or a class name). */
+    std::string typeName;
+    /** @brief Dimensions left after the node's own indices (empty for scalars). */
+    std::vector<int> dimensions;
+    /** @brief What the node's name or callee is bound to. */
+    ASTBinding binding = ASTBinding::None;
+    /** @brief Class whose object holds the field or receives the method call ("" otherwise). */
+    std::string receiverClass;
+    /** @brief Parameter profile of the overload a call resolved to, e.g. "(integer,float[])" ("" otherwise). */
+    std::string overload;
+};
 
 /**
  * @class ASTVisitor
@@ -91,7 +158,9 @@ class ASTVisitor {
  *
  * @details
  * Provides source line metadata and optional left/right child slots used by
- * many unary/binary/shared structural nodes.
+ * many unary/binary/shared structural nodes. Each node can also cache a
+ * structural hash of its subtree (see ASTHasher) and, for expressions, carry
+ * the semantic annotation code generation consumes (see ASTAnnotation).
  */
 class ASTNode {
     public:
@@ -115,6 +184,26 @@ class ASTNode {
         /** @brief Set right child pointer. */
         void setRight(std::shared_ptr<ASTNode> rightNode) { right = rightNode; }
 
+        /**
+         * @brief Get cached structural hash of this subtree.
+         * @return 64-bit hash, meaningful only when hasStructuralHash() is true.
+         */
+        std::uint64_t getStructuralHash() const { return structuralHash; }
+        /** @brief True once ASTHasher::hashSubtree() has sealed this subtree. */
+        bool hasStructuralHash() const { return structuralHashValid; }
+        /** @brief Cache structural hash (set by ASTHasher, not by passes). */
+        void setStructuralHash(std::uint64_t hash) {
+            structuralHash = hash;
+            structuralHashValid = true;
+        }
+
+        /** @brief Semantic annotation of this expression, or null when it has none. */
+        const ASTAnnotation* getAnnotation() const { return annotation.get(); }
+        /** @brief Shared annotation, for passes that rebuild a node with the same meaning. */
+        const std::shared_ptr<const ASTAnnotation>& getSharedAnnotation() const { return annotation; }
+        /** @brief Attach or clear the annotation (set by SemanticAnalyzer, kept by rewriting passes). */
+        void setAnnotation(std::shared_ptr<const ASTAnnotation> value) { annotation = std::move(value); }
+
         /**
          * @brief Return compact textual label for diagnostics/printers.
          * @return Node-specific display string.
@@ -125,11 +214,23 @@ class ASTNode {
          * @param visitor Visitor implementation for current compiler phase.
          */
         virtual void accept(ASTVisitor& visitor) = 0;
+        /**
+         * @brief Append this node's child slots in traversal order.
+         * @param slots Output slot list (appended to).
+         *
+         * @details
+         * The default reports non-null left/right children as "left"/"right".
+         * Leaf nodes report no slots.
+         */
+        virtual void collectChildSlots(std::vector<ASTChildSlot>& slots) const;
 
     private:
         int lineNumber; 
         std::shared_ptr<ASTNode> left; 
         std::shared_ptr<ASTNode> right;
+        std::uint64_t structuralHash = 0;
+        bool structuralHashValid = false;
+        std::shared_ptr<const ASTAnnotation> annotation;
 };
 
 // =============================================================================
@@ -152,6 +253,7 @@ class IdNode : public ASTNode {
         const std::string& getName() const { return name; }
         std::string getValue() const override { return name; }
         void accept(ASTVisitor& visitor) override;
+        void collectChildSlots(std::vector<ASTChildSlot>&) const override {}
 };
 
 /**
@@ -166,6 +268,7 @@ class IntLitNode : public ASTNode {
         int getIntValue() const { return value; }
         std::string getValue() const override { return std::to_string(value); }
         void accept(ASTVisitor& visitor) override;
+        void collectChildSlots(std::vector<ASTChildSlot>&) const override {}
 };
 
 /**
@@ -184,6 +287,7 @@ class FloatLitNode : public ASTNode {
         float getFloatValue() const { return value; }
         std::string getValue() const override { return std::to_string(value); }
         void accept(ASTVisitor& visitor) override;
+        void collectChildSlots(std::vector<ASTChildSlot>&) const override {}
 };
 
 /**
@@ -198,6 +302,7 @@ class TypeNode : public ASTNode {
         const std::string& getTypeName() const { return typeName; }
         std::string getValue() const override { return typeName; }
         void accept(ASTVisitor& visitor) override;
+        void collectChildSlots(std::vector<ASTChildSlot>&) const override {}
 };
 
 // =============================================================================
@@ -263,6 +368,7 @@ class FuncCallNode : public ASTNode {
         
         std::string getValue() const override { return funcName + "()"; }
         void accept(ASTVisitor& visitor) override;
+        void collectChildSlots(std::vector<ASTChildSlot>& slots) const override;
 };
 
 /**
@@ -285,6 +391,7 @@ class DataMemberNode : public ASTNode {
         std::vector<std::shared_ptr<ASTNode>> getIndices() const { return indices; }
         std::string getValue() const override { return idName; }
         void accept(ASTVisitor& visitor) override;
+        void collectChildSlots(std::vector<ASTChildSlot>& slots) const override;
 };
 
 // =============================================================================
@@ -325,6 +432,7 @@ class IfStmtNode : public ASTNode {
         std::shared_ptr<ASTNode> getElseBlock() const { return elseBlock; }
         std::string getValue() const override { return "If"; }
         void accept(ASTVisitor& visitor) override;
+        void collectChildSlots(std::vector<ASTChildSlot>& slots) const override;
 };
 
 /**
@@ -340,6 +448,7 @@ class WhileStmtNode : public ASTNode {
         }
         std::string getValue() const override { return "While"; }
         void accept(ASTVisitor& visitor) override;
+        void collectChildSlots(std::vector<ASTChildSlot>& slots) const override;
 };
 
 /**
@@ -386,6 +495,7 @@ class BlockNode : public ASTNode {
         
         std::string getValue() const override { return "Block"; }
         void accept(ASTVisitor& visitor) override;
+        void collectChildSlots(std::vector<ASTChildSlot>& slots) const override;
 };
 
 // =============================================================================
@@ -416,6 +526,7 @@ class VarDeclNode : public ASTNode {
         std::vector<int> getDimensions() const { return arrayDimensions; }
         std::string getValue() const override { return visibility + " " + type + " " + name; }
         void accept(ASTVisitor& visitor) override;
+        void collectChildSlots(std::vector<ASTChildSlot>&) const override {}
 };
 
 /**
@@ -449,6 +560,7 @@ class FuncDefNode : public ASTNode {
             return (className.empty() ? "" : className + "::") + name + "() -> " + returnType; 
         }
         void accept(ASTVisitor& visitor) override;
+        void collectChildSlots(std::vector<ASTChildSlot>& slots) const override;
 };
 
 /**
@@ -474,6 +586,7 @@ class ClassDeclNode : public ASTNode {
 
         std::string getValue() const override { return "Class " + name; }
         void accept(ASTVisitor& visitor) override;
+        void collectChildSlots(std::vector<ASTChildSlot>& slots) const override;
 };
 
 /**
@@ -494,6 +607,7 @@ class ProgNode : public ASTNode {
 
         std::string getValue() const override { return "Program"; }
         void accept(ASTVisitor& visitor) override;
+        void collectChildSlots(std::vector<ASTChildSlot>& slots) const override;
 };
 
 /**
@@ -505,14 +619,108 @@ class ProgNode : public ASTNode {
  * to produce human-readable and visual artifacts.
  */
     namespace ASTPrinter {
+        /** @brief Stream structured text AST into an output stream. */
+        void write(const std::shared_ptr<ASTNode>& root, std::ostream& out);
         /** @brief Convert AST to structured text tree. */
         std::string toString(const std::shared_ptr<ASTNode>& root);
         /** @brief Write structured text AST to file. */
         bool writeToFile(const std::shared_ptr<ASTNode>& root, const std::string& filePath);
+        /**
+         * @brief Size/shape controls for DOT export of large ASTs.
+         *
+         * @details
+         * Defaults reproduce the full flat graph. Depth and node budgets replace
+         * the remaining subtrees with a single summary node each, which keeps the
+         * Graphviz layout time bounded regardless of program size.
+         */
+        struct DotExportOptions {
+            /** @brief Wrap each class and function definition in a subgraph cluster. */
+            bool clusterScopes = false;
+            /** @brief Collapse subtrees more than this many levels below the root (0 = unlimited). */
+            int maxDepth = 0;
+            /** @brief Collapse remaining subtrees once this many nodes were emitted (0 = unlimited). */
+            std::size_t maxNodes = 0;
+        };
+
+        /** @brief Stream Graphviz DOT AST into an output stream. */
+        void writeDot(const std::shared_ptr<ASTNode>& root, std::ostream& out, const DotExportOptions& options = DotExportOptions());
         /** @brief Convert AST to Graphviz DOT graph content. */
-        std::string toDot(const std::shared_ptr<ASTNode>& root);
+        std::string toDot(const std::shared_ptr<ASTNode>& root, const DotExportOptions& options = DotExportOptions());
         /** @brief Write Graphviz DOT AST to file. */
-        bool writeDotToFile(const std::shared_ptr<ASTNode>& root, const std::string& filePath);
+        bool writeDotToFile(const std::shared_ptr<ASTNode>& root, const std::string& filePath, const DotExportOptions& options = DotExportOptions());
+        /** @brief Write one DOT file per function definition; returns written paths. */
+        std::vector<std::string> writeDotPerFunction(const std::shared_ptr<ASTNode>& root, const std::string& pathPrefix, const DotExportOptions& options = DotExportOptions());
+    }
+
+/**
+ * @class ASTTraversalListener
+ * @brief Pre/post-order callbacks driven by ASTTraversal::walk().
+ *
+ * @details
+ * Callbacks arrive in document order: enterNode, then for each child slot
+ * enterSlot, the slot's children (nullChild for absent single children),
+ * exitSlot, and finally exitNode. Returning false from enterNode skips the
+ * node's children; exitNode is still delivered so clients can keep balanced
+ * stacks.
+ */
+class ASTTraversalListener {
+    public:
+        /** @brief Virtual destructor for interface-safe polymorphic deletion. */
+        virtual ~ASTTraversalListener() = default;
+        /**
+         * @brief Pre-order callback.
+         * @param node Node being entered.
+         * @param parent Parent node (nullptr for the walk root).
+         * @param slot Parent slot holding this node (nullptr for the walk root).
+         * @return False to skip this node's children.
+         */
+        virtual bool enterNode(ASTNode& /*node*/, const ASTNode* /*parent*/, const ASTChildSlot* /*slot*/) { return true; }
+        /** @brief Called before the first child of a slot (also for empty slots). */
+        virtual void enterSlot(ASTNode& /*owner*/, const ASTChildSlot& /*slot*/) {}
+        /** @brief Called for a null entry in a slot. */
+        virtual void nullChild(ASTNode& /*owner*/, const ASTChildSlot& /*slot*/) {}
+        /** @brief Called after the last child of a slot. */
+        virtual void exitSlot(ASTNode& /*owner*/, const ASTChildSlot& /*slot*/) {}
+        /** @brief Post-order callback. */
+        virtual void exitNode(ASTNode& /*node*/) {}
+        /** @brief Polled between steps; true abandons the walk immediately. */
+        virtual bool stopRequested() const { return false; }
+};
+
+/**
+ * @namespace ASTTraversal
+ * @brief Iterative AST traversal driver.
+ *
+ * @details
+ * walk() keeps its work stack on the heap, so tree depth is limited by memory
+ * rather than by the C++ call stack. Printers, the structural hasher, and the
+ * semantic declaration pre-pass are built on it.
+ */
+    namespace ASTTraversal {
+        /** @brief Walk a subtree depth-first, delivering listener callbacks. */
+        void walk(const std::shared_ptr<ASTNode>& root, ASTTraversalListener& listener);
+    }
+
+/**
+ * @namespace ASTHasher
+ * @brief Structural (Merkle-style) hashing of AST subtrees.
+ *
+ * @details
+ * A node's hash combines its kind, its own payload (names, operators, types,
+ * literal values, dimensions, visibility) and the hashes of its children in
+ * order. Line numbers are deliberately excluded and comments never reach the
+ * AST, so re-formatting a source file keeps every hash stable while any change
+ * to a function body or class declaration changes that subtree's hash.
+ *
+ * Hashes are cached on the nodes: the parser seals each statement, function,
+ * class, and the program root as soon as it is built, so every node is hashed
+ * exactly once, bottom-up. Later consumers read ASTNode::getStructuralHash().
+ */
+    namespace ASTHasher {
+        /** @brief Compute (or return cached) structural hash of a subtree; null hashes to a fixed constant. */
+        std::uint64_t hashSubtree(const std::shared_ptr<ASTNode>& node);
+        /** @brief Format hash as fixed-width lowercase hexadecimal. */
+        std::string toHex(std::uint64_t hash);
     }
 
-#endif // AST_H
\ No newline at end of file
+#endif // AST_H
@@ -0,0 +1,117 @@
+/**
+ * @file ast_optimizer.h
+ * @brief AST-level optimization pass run between semantic analysis and code generation.
+ *
+ * @details
+ * ASTOptimizer rewrites function bodies of a semantically valid program into a
+ * new tree that CodeGenVisitor lowers to fewer Moon instructions:
+ * - constant folding of integer and fixed-point float expressions,
+ * - propagation of locals assigned exactly once to a constant,
+ * - algebraic identities (x + 0, x * 1, x / 1, pure x * 0, unary plus).
+ *
+ * Folding evaluates with the backend's own arithmetic: floats are fixed-point
+ * words scaled by kMoonFloatScale, '*' and '/' rescale with truncating integer
+ * division, comparisons yield 0/1, and "and"/"or" combine the raw words. A
+ * result is only folded when it fits a 16-bit Moon immediate (every literal is
+ * lowered as one addi) and, for floats, when the literal it becomes lowers back
+ * to the same word. Operators the backend rejects are left untouched so their
+ * codegen diagnostics are unchanged.
+ *
+ * @par Why a separate tree?
+ * The analyzed AST stays as parsed for dumps, incremental snapshots, and class
+ * interfaces. Declarations and class nodes are shared; statements and
+ * expressions of function bodies are rebuilt. A rebuilt expression keeps the
+ * semantic annotation of the node it replaces (its type cannot change); literals
+ * produced by folding or propagation have none.
+ */
+#ifndef AST_OPTIMIZER_H
+#define AST_OPTIMIZER_H
+
+#include "AST.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @struct ASTOptimizerStats
+ * @brief Rewrite counts of the last ASTOptimizer::optimize() call.
+ */
+struct ASTOptimizerStats {
+    /** @brief Operator nodes replaced by a literal. */
+    std::size_t foldedExpressions = 0;
+    /** @brief Uses of single-assignment locals replaced by their constant. */
+    std::size_t propagatedConstants = 0;
+    /** @brief Operator nodes removed by an algebraic identity. */
+    std::size_t simplifiedIdentities = 0;
+};
+
+/**
+ * @class ASTOptimizer
+ * @brief Constant folding, constant propagation, and identity simplification.
+ *
+ * @details
+ * Only scalar integer/float locals of a function are propagated, and only from
+ * an assignment that is a top-level statement of the function body and the only
+ * write to the local (read statements count as writes). Uses in later top-level
+ * statements, nested or not, are dominated by that assignment; earlier uses keep
+ * loading the variable.
+ */
+class ASTOptimizer {
+    public:
+        /**
+         * @brief Build the optimized tree.
+         * @param root Analyzed program (not modified).
+         * @return New program root sharing class and declaration nodes with root.
+         */
+        std::shared_ptr<ProgNode> optimize(const std::shared_ptr<ProgNode>& root);
+        /** @brief Rewrite counts of the last optimize() call. */
+        const ASTOptimizerStats& stats() const { return _stats; }
+
+    private:
+        /**
+         * @struct Constant
+         * @brief Compile-time value in backend representation.
+         */
+        struct Constant {
+            /** @brief True for a fixed-point float word. */
+            bool isFloat = false;
+            /** @brief Integer value, or float value times kMoonFloatScale. */
+            long long word = 0;
+        };
+
+        ASTOptimizerStats _stats;
+        /** @brief Declared type of each scalar integer/float parameter and local of the current function. */
+        std::unordered_map<std::string, std::string> _scalarTypes;
+        /** @brief Constants of the current function's propagated locals. */
+        std::unordered_map<std::string, Constant> _constants;
+
+        /** @brief Rewrite one function definition (prototypes are shared). */
+        std::shared_ptr<FuncDefNode> optimizeFunction(const std::shared_ptr<FuncDefNode>& function);
+        /** @brief Rebuild a statement with rewritten expressions. */
+        std::shared_ptr<ASTNode> rewriteStatement(const std::shared_ptr<ASTNode>& statement);
+        /** @brief Rebuild an expression, folding and propagating bottom-up. */
+        std::shared_ptr<ASTNode> rewriteExpression(const std::shared_ptr<ASTNode>& expression);
+        /**
+         * @brief Rebuild an identifier or member access.
+         * @param access IdNode or DataMemberNode.
+         * @param substitute Replace a propagated plain name by its constant
+         *        (false for assignment/read targets and callee names).
+         */
+        std::shared_ptr<ASTNode> rewriteAccess(const std::shared_ptr<ASTNode>& access, bool substitute);
+        /** @brief Fold or simplify a binary node whose operands were already rewritten. */
+        std::shared_ptr<ASTNode> rewriteBinary(const BinaryOpNode& node, const std::shared_ptr<ASTNode>& left,
+                                               const std::shared_ptr<ASTNode>& right);
+        /** @brief Scalar type the backend infers for an expression ("" when unknown). */
+        std::string scalarTypeOf(const std::shared_ptr<ASTNode>& expression) const;
+
+        /** @brief Read a literal node as a constant. */
+        static bool constantOf(const std::shared_ptr<ASTNode>& node, Constant& value);
+        /** @brief Evaluate a binary operator as the backend would; false when not foldable. */
+        static bool evaluate(const std::string& op, Constant left, Constant right, Constant& result);
+        /** @brief Literal node for a constant, or nullptr when it has no exact literal form. */
+        static std::shared_ptr<ASTNode> makeLiteral(int line, const Constant& value);
+};
+
+#endif
@@ -0,0 +1,55 @@
+/**
+ * @file buffered_file_sink.h
+ * @brief Output file stream with a large private write buffer for streamed exports.
+ *
+ * @details
+ * AST exports, symbol-table dumps, and Moon assembly are written piece by piece
+ * while their structure is walked. The sink batches those small writes into 64 KiB chunks
+ * instead of relying on the default stream buffer size, so no exporter needs to
+ * materialize its whole output in memory first.
+ */
+#ifndef BUFFERED_FILE_SINK_H
+#define BUFFERED_FILE_SINK_H
+
+#include <cstddef>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @class BufferedFileSink
+ * @brief Output file stream backed by a large, privately owned write buffer.
+ */
+class BufferedFileSink {
+    public:
+        /** @brief Size of the write buffer attached to the file stream. */
+        static constexpr std::size_t kBufferSize = 1 << 16;
+
+        explicit BufferedFileSink(const std::string& filePath, std::ios::openmode mode = std::ios::out | std::ios::trunc)
+            : _buffer(kBufferSize) {
+            // The buffer must be installed before open() for libstdc++/MSVC to honor it.
+            _file.rdbuf()->pubsetbuf(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+            _file.open(filePath, mode);
+        }
+
+        BufferedFileSink(const BufferedFileSink&) = delete;
+        BufferedFileSink& operator=(const BufferedFileSink&) = delete;
+
+        bool isOpen() const { return _file.is_open(); }
+        std::ostream& stream() { return _file; }
+
+        /** @brief Flush pending bytes and report whether every write succeeded. */
+        bool close() {
+            _file.flush();
+            bool ok = static_cast<bool>(_file);
+            _file.close();
+            return ok;
+        }
+
+    private:
+        std::vector<char> _buffer;
+        std::ofstream _file;
+};
+
+#endif
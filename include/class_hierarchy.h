@@ -0,0 +1,80 @@
+/**
+ * @file class_hierarchy.h
+ * @brief Integer-indexed inheritance graph with cycle detection and topological order.
+ *
+ * @details
+ * ClassHierarchy numbers classes in declaration order and stores parent edges
+ * as indices, so graph passes touch vectors instead of hashing class names.
+ * analyze() runs an iterative Tarjan strongly-connected-components pass that:
+ * - reports every inheritance cycle once, with all of its classes (14.1), and
+ * - yields a parents-first order of all classes for phases that build per-class
+ *   tables from their parents' (member tables, layouts).
+ *
+ * @par Why iterative?
+ * A recursive DFS uses one native stack frame per inheritance level and
+ * overflows on generated programs with very long chains; the explicit stack
+ * here grows on the heap.
+ */
+#ifndef CLASS_HIERARCHY_H
+#define CLASS_HIERARCHY_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class ClassHierarchy
+ * @brief Inheritance graph of one program's classes.
+ */
+class ClassHierarchy {
+    public:
+        /**
+         * @brief Add a class and the names it inherits from.
+         * @param name Class name (a repeated name keeps its first declaration).
+         * @param parents Parent class names in declaration order; unknown names are ignored by analyze().
+         * @param line Declaration line, used to locate cycle diagnostics.
+         * @return False when name was already added.
+         */
+        bool addClass(const std::string& name, std::vector<std::string> parents, int line);
+        /** @brief Resolve parent names to indices and compute cycles and topological order. */
+        void analyze();
+
+        /** @brief Number of classes. */
+        std::size_t size() const { return _names.size(); }
+        /** @brief Name of a class index. */
+        const std::string& name(std::size_t index) const { return _names[index]; }
+        /** @brief Declaration line of a class index. */
+        int line(std::size_t index) const { return _lines[index]; }
+        /** @brief Index of a class name, or size() when unknown. */
+        std::size_t indexOf(const std::string& name) const;
+        /** @brief Known parents of a class, in declaration order (valid after analyze()). */
+        const std::vector<std::size_t>& parentsOf(std::size_t index) const { return _parents[index]; }
+
+        /**
+         * @brief Classes ordered parents-first (valid after analyze()).
+         * @details Every class appears once. Classes outside cycles follow all of
+         * their parents; the classes of one cycle are adjacent, in declaration
+         * order, after every parent outside the cycle.
+         */
+        const std::vector<std::size_t>& topologicalOrder() const { return _order; }
+        /**
+         * @brief Inheritance cycles (valid after analyze()).
+         * @details One entry per strongly connected component with more than one
+         * class or a self-inheritance; members are in declaration order and
+         * entries are ordered by their first member.
+         */
+        const std::vector<std::vector<std::size_t>>& cycles() const { return _cycles; }
+
+    private:
+        std::vector<std::string> _names;
+        std::vector<int> _lines;
+        /** @brief Parent names as declared, resolved into _parents by analyze(). */
+        std::vector<std::vector<std::string>> _parentNames;
+        std::vector<std::vector<std::size_t>> _parents;
+        std::unordered_map<std::string, std::size_t> _index;
+        std::vector<std::size_t> _order;
+        std::vector<std::vector<std::size_t>> _cycles;
+};
+
+#endif
@@ -0,0 +1,90 @@
+/**
+ * @file class_interface.h
+ * @brief Binary class interfaces for analyzing a program against pre-analyzed classes.
+ *
+ * @details
+ * A ClassInterface is the pass-1 view of a set of classes: each class symbol
+ * (name and inheritance), its own scope entries (fields with dimensions and
+ * member function signatures), and its declared member function identities.
+ * Types refer to the interface's own TypeTable, so an interface is independent
+ * of the analyzer that produced it.
+ * SemanticAnalyzer::exportClassInterface() builds one from an analyzed unit;
+ * SemanticAnalyzer::importClassInterface() pre-populates the global and class
+ * scopes of later analyses with it before pass 1.
+ *
+ * @par File layout ("SIF3")
+ * Integers are unsigned LEB128 varints; signed values (dimensions, lines) are
+ * zigzag-encoded first.
+ * - magic "SIF3";
+ * - string pool: count, then length and bytes of each string;
+ * - type section: count, then each descriptor past the pre-interned builtins in
+ *   id order (kind byte, then name, or element/dimensions/operands as earlier
+ *   interface ids);
+ * - classes: count, then per class its symbol entry, member count and entries,
+ *   declared-method count and (name, signature type) pairs, one per declared
+ *   overload. An entry is its name, kind/visibility/flag bytes, type, full
+ *   type, and line; dimensions and parameter types live in the type section.
+ * Every string is written as a string-pool index.
+ *
+ * @par Why?
+ * Shared class libraries were re-parsed and re-analyzed inside every program
+ * that included them. Loading an interface is a linear decode with no lexing,
+ * parsing, or pass-1 checks.
+ */
+#ifndef CLASS_INTERFACE_H
+#define CLASS_INTERFACE_H
+
+#include "semantic.h"
+#include "types.h"
+
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @struct ClassInterface
+ * @brief Exported declarations of a set of classes.
+ */
+struct ClassInterface {
+    /** @brief One exported class. */
+    struct Class {
+        /** @brief Global class symbol (type is the class descriptor with parents). */
+        SymbolEntry symbol;
+        /** @brief Own class-scope entries in declaration order. */
+        std::vector<SymbolEntry> members;
+        /** @brief Declared member function overloads: name and signature (return and array-typed parameter types). */
+        std::vector<std::pair<std::string, TypeId>> declaredMethods;
+    };
+
+    /** @brief Types referenced by the entries below. */
+    TypeTable types;
+    /** @brief Classes in declaration order. */
+    std::vector<Class> classes;
+};
+
+/**
+ * @brief Copy a symbol entry between type tables.
+ * @param entry Entry whose type ids belong to from.
+ * @param from Source type table.
+ * @param to Destination type table (types are interned as needed).
+ * @return Entry with type ids of to.
+ */
+SymbolEntry copySymbolEntry(const SymbolEntry& entry, const TypeTable& from, TypeTable& to);
+
+/** @brief Encode an interface in the "SIF3" layout. */
+void writeClassInterface(std::ostream& out, const ClassInterface& classInterface);
+/**
+ * @brief Decode an interface written by writeClassInterface().
+ * @param in Input positioned at the magic.
+ * @param classInterface Output (replaced on success).
+ * @param error Reason on failure.
+ * @return False for a truncated, foreign, or inconsistent input.
+ */
+bool readClassInterface(std::istream& in, ClassInterface& classInterface, std::string& error);
+/** @brief Write an interface file; false when it cannot be written. */
+bool writeClassInterfaceFile(const std::string& filePath, const ClassInterface& classInterface);
+/** @brief Read an interface file; false with a reason when it cannot be opened or decoded. */
+bool readClassInterfaceFile(const std::string& filePath, ClassInterface& classInterface, std::string& error);
+
+#endif
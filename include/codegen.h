@@ -4,8 +4,13 @@
  *
  * @details
  * This header defines the AST-driven backend that lowers typed AST nodes into
- * Moon assembly. The backend is layout-driven (class/object layouts, function
- * frames) and uses a register allocator plus stack-based addressing discipline.
+ * a MoonProgram listing, printed as Moon assembly once lowering is complete.
+ * Expression types and name bindings come from the semantic annotations on
+ * the nodes (see ASTAnnotation) when present. The backend is layout-driven
+ * (class/object layouts, function frames) and uses a register allocator plus
+ * stack-based addressing discipline. Operands are evaluated in Sethi-Ullman
+ * order, and values that must survive a call or a register shortage are
+ * spilled to temp slots of the function frame.
  *
  * @par Why this shape?
  * Keeping layout, type-resolution, and emission helpers in one visitor provides
@@ -15,14 +20,30 @@
 #define CODEGEN_H
 
 #include "AST.h"
+#include "diagnostics.h"
+#include "moon_ir.h"
+#include "moon_peephole.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <ostream>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
+/** @brief Fixed-point scale used to lower language floats onto integer-only Moon ops. */
+constexpr int kMoonFloatScale = 100;
+
+/**
+ * @brief Fixed-point word the backend emits for a float literal.
+ * @param value Literal value as parsed.
+ * @return value * kMoonFloatScale rounded to the nearest integer.
+ */
+long moonFixedPoint(float value);
+
 /**
  * @class CodeGenVisitor
  * @brief AST visitor that emits Moon assembly for the full program.
@@ -34,6 +55,11 @@
  * - object/member/array address lowering,
  * - runtime helper emission for integer/float I/O,
  * - trace-aware assembly comments and diagnostics.
+ *
+ * Comments are passed to emitComment()/emitSourceLineContext() as separate
+ * parts (strings, numbers, registers, dimensions, or callables producing
+ * text) and concatenated only in MoonEmitMode::Trace. The source line and tag
+ * they carry are tracked in both modes and feed the optional MoonLineMap.
  */
 class CodeGenVisitor : public ASTVisitor {
     public:
@@ -50,8 +76,24 @@ class CodeGenVisitor : public ASTVisitor {
          */
         bool generate(const std::shared_ptr<ProgNode>& root);
 
-        /** @brief Get accumulated code generation diagnostics. */
-        const std::vector<std::string>& getErrors() const;
+        /** @brief Get formatted code generation diagnostics. */
+        std::vector<std::string> getErrors() const;
+        /** @brief Listing built by the last generate(). */
+        const MoonProgram& program() const { return _program; }
+        /** @brief Moon instructions emitted by the last generate() (labels, directives, and comments excluded). */
+        std::size_t instructionCount() const { return _instructionCount; }
+        /** @brief Get code generation diagnostic records. */
+        const DiagnosticEngine& getDiagnostics() const { return _diagnostics; }
+        /** @brief Set error cap and deduplication policy for later generate() calls. */
+        void setDiagnosticOptions(const DiagnosticOptions& options) { _diagnostics.configure(options); }
+        /** @brief Select trace or lean output for later generate() calls (trace by default). */
+        void setEmitMode(MoonEmitMode mode) { _emitMode = mode; }
+        /** @brief Record the source context of each instruction of later generate() calls into lineMap (nullptr: none). */
+        void setLineMap(MoonLineMap* lineMap) { _lineMap = lineMap; }
+        /** @brief Configure the peephole pass run on the listing of later generate() calls (on by default). */
+        void setPeepholeOptions(const MoonPeepholeOptions& options) { _peepholeOptions = options; }
+        /** @brief Rule hits of the peephole pass in the last generate(). */
+        const MoonPeepholeStats& peepholeStats() const { return _peepholeStats; }
 
         /** @name AST Visitor Overrides */
         /** @{ */
@@ -78,26 +120,47 @@ class CodeGenVisitor : public ASTVisitor {
     private:
         /**
          * @class RegisterAllocator
-         * @brief Simple pool allocator for Moon general-purpose temporaries.
+         * @brief Bitmask pool allocator for Moon general-purpose temporaries.
          *
          * @details
-         * Current policy allocates from r1..r12 (excluding reserved frame/link usage
-         * in backend conventions). Exhaustion returns -1 and triggers codegen errors.
+         * Allocates the lowest free register of r1..r12 (excluding reserved frame/link
+         * usage in backend conventions). Expression lowering spills before the pool
+         * can run out, so exhaustion (-1) only signals an internal error.
          */
         class RegisterAllocator {
             public:
+                /** @brief Number of temporary registers (r1..r12). */
+                static constexpr int kPoolSize = 12;
+
                 /** @brief Initialize allocator with full temporary register pool. */
                 RegisterAllocator();
-                /** @brief Acquire a temporary register, or -1 if none available. */
+                /** @brief Acquire the lowest free temporary register, or -1 if none available. */
                 int acquire();
+                /** @brief Acquire a specific register; false when it is not a free temporary. */
+                bool claim(int reg);
                 /** @brief Return a previously acquired register to the pool. */
                 void release(int reg);
+                /** @brief Number of free temporary registers. */
+                int freeCount() const;
                 /** @brief Reset allocator to initial full-pool state. */
                 void reset();
 
             private:
-                /** @brief Free-register pool (LIFO policy). */
-                std::vector<int> _freeRegs;
+                /** @brief Bit r is set while register r is free. */
+                std::uint16_t _free = 0;
+        };
+
+        /**
+         * @struct RegisterNeed
+         * @brief Sethi-Ullman register needs of an expression subtree.
+         */
+        struct RegisterNeed {
+            /** @brief Registers live at once while evaluating the value. */
+            int value = 1;
+            /** @brief Registers live at once while computing its address (l-values and objects). */
+            int address = 1;
+            /** @brief True when the subtree contains a call, which clobbers every temporary. */
+            bool hasCall = false;
         };
 
         /**
@@ -139,6 +202,8 @@ class CodeGenVisitor : public ASTVisitor {
             long size = 0;
             /** @brief Field name -> layout metadata. */
             std::unordered_map<std::string, FieldLayoutInfo> fields;
+            /** @brief Direct parents in declaration order with their sub-object offsets. */
+            std::vector<std::pair<std::string, long>> parentOffsets;
         };
 
         /**
@@ -148,7 +213,9 @@ class CodeGenVisitor : public ASTVisitor {
         struct FunctionLayoutInfo {
             /** @brief Canonical key (for example class::name or free function name). */
             std::string key;
-            /** @brief Generated assembly label for function entry. */
+            /** @brief Parameter profile, e.g. "(integer,float[])"; tells overloads of key apart. */
+            std::string profile;
+            /** @brief Generated assembly label for function entry (overloads after the first carry their parameters). */
             std::string label;
             /** @brief Function identifier. */
             std::string name;
@@ -160,6 +227,10 @@ class CodeGenVisitor : public ASTVisitor {
             bool isMethod = false;
             /** @brief Total frame size in bytes. */
             long frameSize = 0;
+            /** @brief Stack offset of the first spill temp slot (further slots follow downward). */
+            long spillOffset = 0;
+            /** @brief Spill temp slots reserved for the deepest spill nesting of the body. */
+            int spillSlots = 0;
             /** @brief Stack offset for saved return link slot. */
             long returnLinkOffset = -4;
             /** @brief Stack offset for implicit receiver slot (methods). */
@@ -178,8 +249,8 @@ class CodeGenVisitor : public ASTVisitor {
         std::ostream& _out;
         /** @brief Temporary register allocator. */
         RegisterAllocator _regs;
-        /** @brief Collected codegen errors. */
-        std::vector<std::string> _errors;
+        /** @brief Collected codegen diagnostics. */
+        DiagnosticEngine _diagnostics{DiagnosticPhase::CodeGen};
 
         /** @brief Class declarations indexed by name from AST root. */
         std::unordered_map<std::string, std::shared_ptr<ClassDeclNode>> _classDecls;
@@ -187,8 +258,8 @@ class CodeGenVisitor : public ASTVisitor {
         std::unordered_map<std::string, ClassLayoutInfo> _classLayouts;
         /** @brief Cached class sizes. */
         std::unordered_map<std::string, long> _classSizes;
-        /** @brief Cached function frame layouts. */
-        std::unordered_map<std::string, FunctionLayoutInfo> _functionLayouts;
+        /** @brief Cached function frame layouts: key -> overloads in definition order. */
+        std::unordered_map<std::string, std::vector<FunctionLayoutInfo>> _functionLayouts;
         /** @brief Active frame variable metadata. */
         std::unordered_map<std::string, StackVarInfo> _stackVarInfo;
         /** @brief Active frame offsets. */
@@ -211,22 +282,51 @@ class CodeGenVisitor : public ASTVisitor {
         long _currentFrameSize = 0;
         /** @brief Current implicit receiver slot offset. */
         long _currentThisOffset = 0;
-        /** @brief Trace instruction counter. */
-        long _traceEmitCounter = 0;
+        /** @brief Offset of the current frame's first spill temp slot. */
+        long _currentSpillOffset = 0;
+        /** @brief Spill temp slots of the current frame. */
+        int _currentSpillSlots = 0;
+        /** @brief Spill temp slots in use (spills nest, so slots are taken and returned in stack order). */
+        int _spillDepth = 0;
+        /** @brief Memoized register needs of expression nodes of the program being generated. */
+        std::unordered_map<const ASTNode*, RegisterNeed> _registerNeeds;
+        /** @brief Trace or lean output. */
+        MoonEmitMode _emitMode = MoonEmitMode::Trace;
+        /** @brief Line map receiving instruction contexts, if any. */
+        MoonLineMap* _lineMap = nullptr;
+        /** @brief Peephole pass configuration. */
+        MoonPeepholeOptions _peepholeOptions;
+        /** @brief Peephole rule hits of the last generate(). */
+        MoonPeepholeStats _peepholeStats;
+        /** @brief Listing of the program being generated, printed at the end of generate(). */
+        MoonProgram _program;
+        /** @brief Symbol id of the function key of the body being emitted (0 outside function bodies). */
+        std::uint32_t _currentFunctionKey = 0;
+        /** @brief Emitted Moon instructions (see instructionCount()). */
+        std::size_t _instructionCount = 0;
         /** @brief Trace source line context. */
         int _traceSourceLine = 0;
-        /** @brief Trace context tag. */
-        std::string _traceContextTag;
+        /** @brief Symbol id of the trace context tag. */
+        std::uint32_t _traceContextTag = 0;
 
-        /** @brief Emit raw assembly line plus optional trace line. */
-        void emit(const std::string& line);
-        /** @brief Emit comment line with readability filtering policy. */
-        void emitComment(const std::string& message);
-        /** @brief Emit comment with source line context tag. */
-        void emitSourceLineContext(int line, const std::string& message);
+        /** @brief Append an instruction or directive carrying the current line, tag, and function. */
+        void emit(MoonOp op, MoonOperand first = {}, MoonOperand second = {}, MoonOperand third = {});
+        /** @brief Append a label definition. */
+        void emitLabel(const std::string& label);
+        /** @brief Symbol operand naming a label (interned in the program). */
+        MoonOperand labelOp(const std::string& label);
+        /** @brief Emit a comment line concatenated from parts (trace mode only). */
+        template <typename... Parts>
+        void emitComment(const Parts&... parts);
+        /**
+         * @brief Set the source line and context tag, then emit them as a comment (trace mode only).
+         * @param head First message part, starting with the bracketed tag ("[CALL] ...").
+         */
+        template <typename... Parts>
+        void emitSourceLineContext(int line, const char* head, const Parts&... parts);
         /** @brief Set active trace context fields. */
         void setTraceContext(int line, const std::string& contextTag);
-        /** @brief Record formatted codegen diagnostic. */
+        /** @brief Record codegen diagnostic (free-form message under CodeGenFailure). */
         void reportError(int line, const std::string& message);
 
         /** @brief Sanitize string for assembly-safe label token. */
@@ -248,12 +348,20 @@ class CodeGenVisitor : public ASTVisitor {
         bool lookupFieldLayout(const std::string& className, const std::string& fieldName, FieldLayoutInfo& out, int line);
         /** @brief Build frame layout for one function/method. */
         bool buildFunctionLayout(const std::shared_ptr<FuncDefNode>& functionNode);
-        /** @brief Lookup prebuilt function layout by owner/name. */
-        const FunctionLayoutInfo* findFunctionLayout(const std::string& className, const std::string& functionName) const;
+        /** @brief Lookup prebuilt function layout by owner/name and overload profile ("" = first definition). */
+        const FunctionLayoutInfo* findFunctionLayout(const std::string& className, const std::string& functionName,
+                                                     const std::string& profile = "") const;
+        /** @brief Lookup own or inherited method layout of an overload and the receiver adjustment it needs. */
+        const FunctionLayoutInfo* findMethodLayout(const std::string& className, const std::string& functionName,
+                                                   const std::string& profile, long& receiverOffset) const;
         /** @brief Assign stack offsets for variable declarations. */
         void assignOffsets(const std::vector<std::shared_ptr<VarDeclNode>>& vars);
         /** @brief Compute storage bytes for variable declaration. */
         long sizeOfVar(const std::shared_ptr<VarDeclNode>& decl);
+        /** @brief Copy type and dimensions from a node's semantic annotation, if it has one. */
+        static bool readAnnotatedType(const ASTNode& node, std::string& typeName, std::vector<int>& dimensions);
+        /** @brief True when an unqualified name is a frame slot; otherwise names the class holding the field. */
+        bool bindsFrameSlot(const ASTNode& node, const std::string& name, std::string& fieldClass) const;
         /** @brief Infer type and dimensions for any expression node. */
         bool resolveNodeType(const std::shared_ptr<ASTNode>& node, std::string& typeName, std::vector<int>& dimensions);
         /** @brief Infer type info specifically for data-member access node. */
@@ -272,6 +380,30 @@ class CodeGenVisitor : public ASTVisitor {
 
         /** @brief Evaluate expression and return result register. */
         int evalExpr(const std::shared_ptr<ASTNode>& node);
+        /** @brief Evaluate expression while the registers in held keep their values (spilling them when needed). */
+        int evalExprPreserving(const std::shared_ptr<ASTNode>& node, const std::vector<int>& held, int line);
+        /** @brief Compute an l-value address while the registers in held keep their values. */
+        int emitAddressPreserving(const std::shared_ptr<ASTNode>& node, const std::vector<int>& held, int line);
+        /** @brief Run evaluate() while held keeps its values, spilling held around it when needed. */
+        template <typename Evaluate>
+        int preserveAcross(const std::shared_ptr<ASTNode>& node, bool address, const std::vector<int>& held, int line, Evaluate&& evaluate);
+        /** @brief Take the next spill temp slot of the frame; its offset, or 0 when the layout reserved too few. */
+        long acquireSpillSlot(int line);
+        /** @brief Return the most recently taken spill temp slot. */
+        void releaseSpillSlot() { --_spillDepth; }
+
+        /** @brief Sethi-Ullman register needs of an expression (memoized). */
+        const RegisterNeed& registerNeed(const std::shared_ptr<ASTNode>& node);
+        /** @brief True when a binary operator evaluates its right operand first (heavier and free of calls). */
+        bool evaluatesRightFirst(const BinaryOpNode& node);
+        /** @brief True when computing node with freeRegisters available must spill the registers held around it. */
+        bool mustSpill(const std::shared_ptr<ASTNode>& node, bool address, int freeRegisters);
+        /** @brief True when a call stages its arguments in spill slots because a later argument or the receiver calls. */
+        bool stagesCallArguments(const FuncCallNode& node);
+        /** @brief Upper bound of spill temp slots a statement or expression takes (see buildFunctionLayout()). */
+        int spillSlotBound(const std::shared_ptr<ASTNode>& node, int held);
+        /** @brief spillSlotBound() of node computed while kept registers are held on top of held. */
+        int keptSpillSlotBound(const std::shared_ptr<ASTNode>& node, bool address, int held, int kept);
         /** @brief Load implicit receiver pointer into target register. */
         bool loadThisPointerInto(int targetReg, int line);
         /** @brief Emit address computation for assignable l-value. */
@@ -295,8 +427,24 @@ class CodeGenVisitor : public ASTVisitor {
  * @param root Program root node.
  * @param outputPath Destination assembly file path.
  * @param errors Optional output vector for codegen diagnostics.
+ * @param options Error cap and deduplication policy.
+ * @param instructionCount Optional output for the number of emitted Moon instructions.
+ * @param mode Trace or lean output.
+ * @param lineMap Optional output for the instruction-to-source line map.
+ * @param peephole Peephole pass configuration.
+ * @param peepholeStats Optional output for the peephole rule hits.
  * @return True on successful generation and file write.
  */
-bool generateMoonAssembly(const std::shared_ptr<ProgNode>& root, const std::string& outputPath, std::vector<std::string>* errors = nullptr);
+bool generateMoonAssembly(const std::shared_ptr<ProgNode>& root, const std::string& outputPath, std::vector<std::string>* errors = nullptr,
+                          const DiagnosticOptions& options = DiagnosticOptions(), std::size_t* instructionCount = nullptr,
+                          MoonEmitMode mode = MoonEmitMode::Trace, MoonLineMap* lineMap = nullptr,
+                          const MoonPeepholeOptions& peephole = MoonPeepholeOptions(), MoonPeepholeStats* peepholeStats = nullptr);
+
+/**
+ * @brief Generate Moon assembly for root and discard it.
+ * @return Number of Moon instructions generateMoonAssembly() would emit with the same peephole configuration.
+ */
+std::size_t countMoonInstructions(const std::shared_ptr<ProgNode>& root, const DiagnosticOptions& options = DiagnosticOptions(),
+                                  const MoonPeepholeOptions& peephole = MoonPeepholeOptions());
 
 #endif
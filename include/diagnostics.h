@@ -0,0 +1,244 @@
+/**
+ * @file diagnostics.h
+ * @brief Compact diagnostic records shared by the parser, semantic analyzer, and code generator.
+ *
+ * @details
+ * Phases report a DiagnosticCode, a source line, and a few plain arguments
+ * (names as strings, counts and indices as integers) instead of building the
+ * final message string. Each code's template is filled in, and given its
+ * "[ERROR][SEMANTIC] line N: " style prefix, only when an artifact is written.
+ *
+ * @par Why?
+ * Pathological inputs produce tens of thousands of diagnostics. A record
+ * holds only its code, line, and argument values, and message text is built
+ * once, on output, for the records that are written. The error cap bounds
+ * how many are kept, and --dedup can also drop exact repeats.
+ *
+ * @par What comes next?
+ * New messages are added as a DiagnosticCode plus one template row in
+ * diagnostics.cpp; tooling can consume records() directly instead of text.
+ */
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/** @brief Compiler phase that owns a diagnostic engine (selects the "[SYNTAX]"-style label). */
+enum class DiagnosticPhase : std::uint8_t {
+    Syntax,
+    Semantic,
+    CodeGen
+};
+
+/** @brief Diagnostic severity. */
+enum class DiagnosticSeverity : std::uint8_t {
+    Error,
+    Warning
+};
+
+/**
+ * @enum DiagnosticCode
+ * @brief Identity of a diagnostic message template.
+ *
+ * @details
+ * Numbered comments refer to the assignment's semantic rule ids, which are part
+ * of the rendered text.
+ */
+enum class DiagnosticCode : std::uint16_t {
+    // Syntax
+    EmptyTokenStream,
+    UnexpectedToken,
+
+    // Declarations and definitions
+    UndeclaredMemberFunctionDefinition,  ///< 6.1
+    UndefinedMemberFunctionDeclaration,  ///< 6.2
+    MultiplyDeclaredClass,               ///< 8.1
+    MultiplyDeclaredFreeFunction,        ///< 8.2
+    MultiplyDeclaredDataMember,          ///< 8.3
+    MultiplyDeclaredVariable,            ///< 8.4
+    ShadowedInheritedDataMember,         ///< 8.6 (warning)
+    LocalShadowsDataMember,              ///< 8.7 (warning)
+    OverloadedFreeFunction,              ///< 9.1 (warning)
+    OverloadedMemberFunction,            ///< 9.2 (warning)
+    OverriddenMemberFunction,            ///< 9.3 (warning)
+    RedefinedSymbol,
+    NonFunctionSymbolExists,
+    MultipleImplementations,
+    MethodOfUnknownClass,
+    MissingReturnStatement,
+
+    // Types and statements
+    LeftOperandNotNumeric,               ///< 10.1
+    RightOperandNotNumeric,              ///< 10.1
+    AssignmentTypeMismatch,              ///< 10.2
+    ReturnValueFromVoidFunction,         ///< 10.3
+    ReturnWithoutValue,                  ///< 10.3
+    ReturnTypeMismatch,                  ///< 10.3
+    ReturnOutsideFunction,
+    IfConditionType,
+    WhileConditionType,
+    ReadTargetNotAssignable,
+    ReadTargetNotScalar,
+    WriteVoidExpression,
+
+    // Names
+    UndeclaredLocalVariable,             ///< 11.1
+    UnresolvedIdentifier,                ///< 11.2
+    UndeclaredMemberVariable,            ///< 11.2
+    UndeclaredMemberFunction,            ///< 11.3
+    UndeclaredFreeFunction,              ///< 11.4
+    UndeclaredClass,                     ///< 11.5
+
+    // Calls
+    WrongArgumentCount,                  ///< 12.1
+    WrongArgumentType,                   ///< 12.2
+
+    // Arrays
+    ArrayDimensionMismatch,              ///< 13.1
+    ArrayIndexNotInteger,                ///< 13.2
+    NegativeArrayIndex,                  ///< 13.3
+    ArrayIndexOutOfBounds,               ///< 13.3
+    NegativeCallExtent,                  ///< 13.3
+    CallExtentExceedsArray,              ///< 13.3
+
+    // Classes
+    CircularClassDependency,             ///< 14.1
+    DotOnNonClassType,                   ///< 15.1
+
+    // Code generation (free-form message)
+    CodeGenFailure,
+
+    // Any phase: emitted once when the error cap is hit
+    ErrorLimitReached,
+
+    Count
+};
+
+/**
+ * @class DiagnosticArg
+ * @brief One template argument, stored as a plain value: a name or a number.
+ *
+ * @details
+ * Names are the strings the reporter already holds (identifiers, scope
+ * names); numbers (indices, sizes, counts) are kept as integers and turned
+ * into text only when the diagnostic is formatted.
+ */
+class DiagnosticArg {
+    public:
+        DiagnosticArg(std::string text) : _text(std::move(text)) {}
+        DiagnosticArg(const char* text) : _text(text) {}
+        template <typename Integer, typename = std::enable_if_t<std::is_integral<Integer>::value>>
+        DiagnosticArg(Integer value) : _number(static_cast<long long>(value)), _isNumber(true) {}
+
+        /** @brief Argument text. */
+        std::string text() const;
+        /** @brief Equality used by deduplication. */
+        bool sameAs(const DiagnosticArg& other) const;
+        /** @brief Hash consistent with sameAs(). */
+        std::size_t hash() const;
+
+    private:
+        std::string _text;
+        long long _number = 0;
+        bool _isNumber = false;
+};
+
+/**
+ * @struct DiagnosticRecord
+ * @brief Compact stored diagnostic; arguments live in the engine's argument pool.
+ */
+struct DiagnosticRecord {
+    DiagnosticCode code;
+    DiagnosticSeverity severity;
+    int line;
+    std::uint32_t firstArg;
+    std::uint32_t argCount;
+};
+
+/**
+ * @struct DiagnosticOptions
+ * @brief User-facing reporting policy shared by every phase.
+ */
+struct DiagnosticOptions {
+    /** @brief Keep at most this many errors per phase (0 = unlimited). */
+    std::size_t maxErrors = 0;
+    /** @brief Drop diagnostics identical to an earlier one (code, line, arguments); off by default. */
+    bool deduplicate = false;
+};
+
+/**
+ * @class DiagnosticEngine
+ * @brief Per-phase diagnostic store with lazy formatting, error cap, and optional deduplication.
+ *
+ * @details
+ * Once maxErrors errors are recorded, one ErrorLimitReached note is added and
+ * later errors are dropped; limitReached() lets the phase skip the remaining
+ * expensive checks. Warnings are never capped.
+ */
+class DiagnosticEngine {
+    public:
+        /** @brief Create an empty engine for a phase. */
+        explicit DiagnosticEngine(DiagnosticPhase phase);
+
+        /** @brief Replace the reporting policy (existing records are kept). */
+        void configure(const DiagnosticOptions& options) { _options = options; }
+        /** @brief Current reporting policy. */
+        const DiagnosticOptions& options() const { return _options; }
+
+        /**
+         * @brief Record a diagnostic.
+         * @param code Message template id (also selects severity).
+         * @param line Source line, or 0 when unknown.
+         * @param args Template arguments in placeholder order.
+         * @return True when stored; false when dropped by the cap or as a duplicate.
+         */
+        bool report(DiagnosticCode code, int line, std::initializer_list<DiagnosticArg> args = {});
+        /**
+         * @brief Re-report another engine's records in order (cap and dedup reapplied).
+         * @param other Source engine.
+         * @param lineDelta Added to every located record's line (used when reusing results of moved code).
+         * @details Its ErrorLimitReached note is not copied; this engine adds its own.
+         */
+        void append(const DiagnosticEngine& other, int lineDelta = 0);
+        /** @brief Move records out into a new engine with the same phase and policy; this engine is left empty. */
+        DiagnosticEngine extract();
+        /** @brief Drop all records (policy is kept). */
+        void clear();
+
+        /** @brief True once an error was dropped because of maxErrors. */
+        bool limitReached() const { return _limitReached; }
+        /** @brief Stored errors (the limit note is not counted). */
+        std::size_t errorCount() const { return _errorCount; }
+        /** @brief Stored warnings. */
+        std::size_t warningCount() const { return _warningCount; }
+        /** @brief Stored records in report order. */
+        const std::vector<DiagnosticRecord>& records() const { return _records; }
+
+        /** @brief Render one record with its severity/phase prefix. */
+        std::string format(const DiagnosticRecord& record) const;
+        /** @brief Render every record of a severity, in report order. */
+        std::vector<std::string> formatted(DiagnosticSeverity severity) const;
+
+    private:
+        DiagnosticPhase _phase;
+        DiagnosticOptions _options;
+        std::vector<DiagnosticRecord> _records;
+        std::vector<DiagnosticArg> _args;
+        /** @brief Record hash -> indices of records with that hash (dedup candidates). */
+        std::unordered_multimap<std::size_t, std::size_t> _seen;
+        std::size_t _errorCount = 0;
+        std::size_t _warningCount = 0;
+        bool _limitReached = false;
+
+        bool store(DiagnosticCode code, int line, const DiagnosticArg* args, std::size_t argCount);
+        std::size_t recordHash(DiagnosticCode code, int line, const DiagnosticArg* args, std::size_t argCount) const;
+        bool isDuplicate(std::size_t hash, DiagnosticCode code, int line, const DiagnosticArg* args, std::size_t argCount) const;
+};
+
+#endif
@@ -27,8 +27,10 @@ struct CompilerOutputPaths {
 	std::string astDotFile;
 	std::string astPngFile;
 	std::string symbolTablesFile;
+	std::string symbolTablesJsonFile;
 	std::string semanticDiagnosticsFile;
 	std::string moonOutputFile;
+	std::string moonLineMapFile;
 	std::string codegenDiagnosticsFile;
 	std::string moonRunLogFile;
 };
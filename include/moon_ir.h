@@ -0,0 +1,158 @@
+/**
+ * @file moon_ir.h
+ * @brief In-memory Moon instruction list built by code generation and printed once.
+ *
+ * @details
+ * CodeGenVisitor appends MoonInstruction records (opcode enum plus register,
+ * immediate, and symbol operands) to a MoonProgram instead of formatting
+ * assembly text while it lowers the AST. Each record carries the source line,
+ * context tag, and function key it was lowered from, so trace comments and the
+ * MoonLineMap are derived from the list when it is printed.
+ *
+ * @par Why?
+ * Formatting every instruction during lowering cost several string
+ * concatenations per instruction and left nothing an optimizer could inspect.
+ * The list is the substrate for passes over the generated code; it is printed
+ * in Moon syntax exactly once, after they ran.
+ */
+#ifndef MOON_IR_H
+#define MOON_IR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class MoonLineMap;
+
+/**
+ * @enum MoonEmitMode
+ * @brief How much commentary is printed around the instructions.
+ */
+enum class MoonEmitMode {
+    /** @brief Per-instruction trace lines plus layout, frame, and call comments. */
+    Trace,
+    /** @brief Instructions, labels, and directives only; comment text is never built. */
+    Lean
+};
+
+/**
+ * @enum MoonOp
+ * @brief Moon opcodes, then the directives and annotations of a program listing.
+ * @details Everything before Label is a Moon instruction and is counted by
+ * MoonProgram::instructionCount().
+ */
+enum class MoonOp : std::uint8_t {
+    // Register-register arithmetic and comparisons: "op ri, rj, rk".
+    Add, Sub, Mul, Div, Mod, And, Or, Ceq, Cne, Clt, Cle, Cgt, Cge,
+    // Register-immediate forms: "op ri, rj, K".
+    Addi, Subi, Muli, Divi, Modi, Andi, Ori, Ceqi, Cnei, Clti, Clei, Cgti, Cgei, Sl, Sr,
+    // "not ri, rj".
+    Not,
+    // Memory: "lw ri, K(rj)" and "sw K(rj), ri".
+    Lw, Lb, Sw, Sb,
+    // I/O, branches, and control.
+    Getc, Putc, Bz, Bnz, J, Jr, Jl, Jlr, Nop, Hlt,
+    // Listing entries that are not instructions.
+    Label, Entry, Align, Res, Comment
+};
+
+/** @brief True for opcodes that assemble to a Moon instruction. */
+inline bool isMoonInstruction(MoonOp op) { return op < MoonOp::Label; }
+/** @brief Assembly mnemonic of an opcode ("" for labels and comments). */
+const char* moonMnemonic(MoonOp op);
+
+/**
+ * @struct MoonOperand
+ * @brief Register number, immediate value, or MoonProgram symbol id.
+ */
+struct MoonOperand {
+    enum class Kind : std::uint8_t { None, Register, Immediate, Symbol };
+
+    Kind kind = Kind::None;
+    long value = 0;
+
+    bool operator==(const MoonOperand& other) const { return kind == other.kind && value == other.value; }
+    bool operator!=(const MoonOperand& other) const { return !(*this == other); }
+};
+
+/** @brief Register operand rN. */
+inline MoonOperand moonRegister(int reg) { return {MoonOperand::Kind::Register, reg}; }
+/** @brief Immediate operand (also the offset of a memory operand). */
+inline MoonOperand moonImmediate(long value) { return {MoonOperand::Kind::Immediate, value}; }
+
+/**
+ * @struct MoonInstruction
+ * @brief One listing entry with its operands in assembly order.
+ *
+ * @details
+ * A memory operand "K(rj)" is two operands: the immediate K, then the base
+ * register. So "lw ri, K(rj)" is (ri, K, rj) and "sw K(rj), ri" is (K, rj, ri).
+ * A Label's first operand is its symbol; Res is (symbol, byte count); a
+ * Comment's first operand is an immediate index into MoonProgram::comment().
+ */
+struct MoonInstruction {
+    MoonOp op = MoonOp::Nop;
+    MoonOperand operands[3];
+    /** @brief Source line (0 for bootstrap and runtime helper code). */
+    int line = 0;
+    /** @brief Symbol id of the codegen context tag ("" when none). */
+    std::uint32_t tag = 0;
+    /** @brief Symbol id of the enclosing function key ("" outside function bodies). */
+    std::uint32_t function = 0;
+};
+
+/**
+ * @class MoonProgram
+ * @brief Ordered listing of a generated program with its interned names.
+ */
+class MoonProgram {
+    public:
+        MoonProgram() { clear(); }
+
+        /** @brief Drop every entry, symbol, and comment. */
+        void clear();
+        /** @brief Symbol id of a label, tag, or function key, interning it when new (id 0 is ""). */
+        std::uint32_t symbol(const std::string& name);
+        /** @brief Name of a symbol id. */
+        const std::string& symbolName(std::uint32_t id) const { return _symbols[id]; }
+        /** @brief Symbol operand for a label. */
+        MoonOperand label(const std::string& name) { return {MoonOperand::Kind::Symbol, symbol(name)}; }
+
+        /** @brief Append an entry. */
+        void append(const MoonInstruction& instruction) { _code.push_back(instruction); }
+        /** @brief Append a comment entry holding text. */
+        void appendComment(std::string text, int line, std::uint32_t tag, std::uint32_t function);
+        /** @brief Text of a comment entry's index. */
+        const std::string& comment(long index) const { return _comments[static_cast<std::size_t>(index)]; }
+
+        /** @brief Entries in listing order (passes may rewrite or erase them). */
+        std::vector<MoonInstruction>& code() { return _code; }
+        const std::vector<MoonInstruction>& code() const { return _code; }
+        /** @brief Number of entries that are Moon instructions. */
+        std::size_t instructionCount() const;
+
+        /**
+         * @brief Print the listing in Moon syntax.
+         * @details In trace mode every entry other than a comment is preceded by
+         * a "% [E#][L#][tag] ..." line; lean mode prints no comments at all.
+         */
+        void print(std::ostream& out, MoonEmitMode mode) const;
+        /** @brief Record every instruction's line, function, and tag into lineMap. */
+        void recordLineMap(MoonLineMap& lineMap) const;
+
+    private:
+        std::vector<MoonInstruction> _code;
+        std::vector<std::string> _symbols;
+        std::unordered_map<std::string, std::uint32_t> _symbolIndex;
+        std::vector<std::string> _comments;
+
+        /** @brief Append the assembly text of a non-comment entry to text. */
+        void format(const MoonInstruction& instruction, std::string& text) const;
+        /** @brief Append one operand to text. */
+        void formatOperand(const MoonOperand& operand, std::string& text) const;
+};
+
+#endif
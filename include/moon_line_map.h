@@ -0,0 +1,107 @@
+/**
+ * @file moon_line_map.h
+ * @brief Instruction-to-source line table written next to generated Moon assembly.
+ *
+ * @details
+ * A MoonLineMap maps the index of every emitted Moon instruction (labels,
+ * directives, and comments excluded, as in CodeGenVisitor::instructionCount())
+ * to the source line, function, and codegen context tag it was lowered from.
+ * Like a DWARF line program it stores rows only where that state changes: a
+ * row covers its instruction and every following one up to the next row.
+ *
+ * @par File layout ("MLM1")
+ * Integers are unsigned LEB128 varints; signed values are zigzag-encoded first.
+ * - magic "MLM1";
+ * - instruction count (end of the last row);
+ * - name pool: count, then length and bytes of each function name and tag
+ *   (entry 0 is always the empty name);
+ * - rows: count, then per row a flags byte (bit 0: function follows, bit 1:
+ *   tag follows), the instruction advance and signed line advance from the
+ *   previous row, and the new function and tag pool indices when flagged.
+ * The state before the first row is instruction 0, line 0, and empty names.
+ *
+ * @par Why a sidecar?
+ * Trace comments tie instructions to lines only inside the assembly text and
+ * make it several times larger. The line map lets profilers, coverage tools, and
+ * error reports resolve an instruction index from lean output.
+ */
+#ifndef MOON_LINE_MAP_H
+#define MOON_LINE_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class MoonLineMap
+ * @brief Rows of (first instruction, line, function, tag) in instruction order.
+ */
+class MoonLineMap {
+    public:
+        /** @brief One run of instructions lowered from the same source context. */
+        struct Row {
+            /** @brief Index of the first instruction of the run. */
+            std::size_t instruction = 0;
+            /** @brief Source line (0 for runtime helpers and bootstrap code). */
+            int line = 0;
+            /** @brief Name pool index of the function key ("Class::method" or "function"). */
+            std::uint32_t function = 0;
+            /** @brief Name pool index of the context tag (for example "ASSIGN" or "CALL"). */
+            std::uint32_t tag = 0;
+        };
+
+        MoonLineMap() { clear(); }
+
+        /** @brief Drop every row and name. */
+        void clear();
+        /**
+         * @brief Record the context of an instruction.
+         * @details Instructions must be recorded in increasing order; a row is
+         * only added when line, function, or tag differs from the last row.
+         */
+        void record(std::size_t instruction, int line, const std::string& function, const std::string& tag);
+        /** @brief Set the number of instructions covered by the map (end of the last row). */
+        void setInstructionCount(std::size_t count) { _instructionCount = count; }
+
+        /** @brief Rows in instruction order. */
+        const std::vector<Row>& rows() const { return _rows; }
+        /** @brief Function name or tag of a pool index. */
+        const std::string& name(std::uint32_t index) const { return _names[index]; }
+        /** @brief Number of pooled names (the empty name included). */
+        std::size_t nameCount() const { return _names.size(); }
+        /** @brief Number of instructions covered by the map. */
+        std::size_t instructionCount() const { return _instructionCount; }
+        /** @brief Row covering an instruction, or nullptr when it is past the end. */
+        const Row* find(std::size_t instruction) const;
+
+        /** @brief Pool index of a name, adding it when new. */
+        std::uint32_t intern(const std::string& name);
+        /** @brief Append a row as decoded (no merging). */
+        void appendRow(const Row& row) { _rows.push_back(row); }
+
+    private:
+        std::vector<Row> _rows;
+        std::vector<std::string> _names;
+        std::unordered_map<std::string, std::uint32_t> _nameIndex;
+        std::size_t _instructionCount = 0;
+};
+
+/** @brief Encode a line map in the "MLM1" layout. */
+void writeMoonLineMap(std::ostream& out, const MoonLineMap& lineMap);
+/**
+ * @brief Decode a line map written by writeMoonLineMap().
+ * @param in Input positioned at the magic.
+ * @param lineMap Output (replaced on success).
+ * @param error Reason on failure.
+ * @return False on malformed or truncated input.
+ */
+bool readMoonLineMap(std::istream& in, MoonLineMap& lineMap, std::string& error);
+/** @brief Write a line map file; false when it cannot be written. */
+bool writeMoonLineMapFile(const std::string& filePath, const MoonLineMap& lineMap);
+/** @brief Read a line map file; false with error set on failure. */
+bool readMoonLineMapFile(const std::string& filePath, MoonLineMap& lineMap, std::string& error);
+
+#endif
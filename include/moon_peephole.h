@@ -0,0 +1,128 @@
+/**
+ * @file moon_peephole.h
+ * @brief Peephole pass over a MoonProgram listing before it is printed.
+ *
+ * @details
+ * MoonPeephole slides a window over the instructions of a MoonProgram and
+ * applies a table of local rewrite rules until a pass changes nothing:
+ * - identity: "addi r, r, 0", "subi r, r, 0", "muli r, r, 1", "divi r, r, 1",
+ *   "add r, r, r0", and "sub r, r, r0";
+ * - address-fold: a load or store through rb after "addi rb, rx, K" addresses
+ *   K(rx) directly (the backend computes variable addresses into a register
+ *   before storing, but loads scalars as "lw ri, K(r14)");
+ * - store-load: "sw K(rb), ra" then "lw rc, K(rb)" reads the stored value back,
+ *   so the load becomes "add rc, ra, r0" (or disappears when rc is ra);
+ * - constant-branch: "bz"/"bnz" on a register set by "addi rX, r0, K" becomes
+ *   "j" or disappears;
+ * - dead-write: a register write overwritten before it is read;
+ * - jump-to-next: "j L" directly followed by label L;
+ * - unreachable: instructions after "j", "jr", or "hlt" up to the next label.
+ *
+ * The window is counted in instructions and labels; trace comments are skipped
+ * and left in place. A pair rule only looks past an instruction that cannot
+ * change what the rule proved: no label (a jump could enter there), no branch
+ * or call, and no write to a register the rule depends on; store-load also
+ * stops at a store that may overlap the slot. A rewritten instruction keeps its
+ * source line and tag.
+ *
+ * @par Why after lowering?
+ * CodeGenVisitor lowers each node on its own, so these sequences appear at
+ * node boundaries (an assignment's store and the next statement's load, a
+ * folded if/while condition, a unit array stride) where no single visit can
+ * see them.
+ */
+#ifndef MOON_PEEPHOLE_H
+#define MOON_PEEPHOLE_H
+
+#include "moon_ir.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @enum MoonPeepholeRule
+ * @brief Rules of the peephole rule table, in the order they are tried.
+ */
+enum class MoonPeepholeRule : std::uint8_t {
+    Identity,
+    AddressFold,
+    StoreLoad,
+    ConstantBranch,
+    DeadWrite,
+    JumpToNext,
+    Unreachable,
+    Count
+};
+
+/** @brief Number of peephole rules. */
+constexpr std::size_t kMoonPeepholeRuleCount = static_cast<std::size_t>(MoonPeepholeRule::Count);
+
+/** @brief Short name of a rule ("store-load", ...), used in driver reports. */
+const char* moonPeepholeRuleName(MoonPeepholeRule rule);
+
+/**
+ * @struct MoonPeepholeOptions
+ * @brief Whether and how far the peephole pass looks.
+ */
+struct MoonPeepholeOptions {
+    /** @brief Run the pass at all. */
+    bool enabled = true;
+    /** @brief Instructions and labels a rule may inspect from its first instruction (at least 2). */
+    std::size_t window = 4;
+    /** @brief Upper bound on passes over the listing before the fixed point is reached. */
+    std::size_t maxPasses = 8;
+};
+
+/**
+ * @struct MoonPeepholeStats
+ * @brief Rule hits and instruction counts of the last MoonPeephole::run() call.
+ */
+struct MoonPeepholeStats {
+    /** @brief Hits per rule, indexed by MoonPeepholeRule. */
+    std::array<std::size_t, kMoonPeepholeRuleCount> hits{};
+    /** @brief Passes over the listing, including the final one that changed nothing. */
+    std::size_t passes = 0;
+    /** @brief Moon instructions before the pass. */
+    std::size_t instructionsBefore = 0;
+    /** @brief Moon instructions after the pass. */
+    std::size_t instructionsAfter = 0;
+
+    /** @brief Hits of one rule. */
+    std::size_t hitCount(MoonPeepholeRule rule) const { return hits[static_cast<std::size_t>(rule)]; }
+    /** @brief Hits of all rules. */
+    std::size_t totalHits() const;
+};
+
+/**
+ * @class MoonPeephole
+ * @brief Fixed-point application of the peephole rule table to a listing.
+ */
+class MoonPeephole {
+    public:
+        explicit MoonPeephole(const MoonPeepholeOptions& options = MoonPeepholeOptions());
+
+        /**
+         * @brief Rewrite program in place.
+         * @return Total rule hits (0 when nothing matched or the pass is disabled).
+         */
+        std::size_t run(MoonProgram& program);
+        /** @brief Rule hits and instruction counts of the last run(). */
+        const MoonPeepholeStats& stats() const { return _stats; }
+
+    private:
+        MoonPeepholeOptions _options;
+        MoonPeepholeStats _stats;
+        /** @brief Entries erased during the current pass (compacted at its end). */
+        std::vector<char> _erased;
+        /** @brief Listing indices of the current window. */
+        std::vector<std::size_t> _window;
+
+        /** @brief One pass over the listing; true when any rule matched. */
+        bool runPass(std::vector<MoonInstruction>& code);
+        /** @brief Fill _window with live non-comment entries from index start. */
+        void fillWindow(const std::vector<MoonInstruction>& code, std::size_t start);
+};
+
+#endif
@@ -23,6 +23,7 @@
 
 #include "Token.h"
 #include "AST.h"
+#include "diagnostics.h"
 #include <initializer_list>
 #include <stdexcept>
 #include <algorithm>
@@ -115,11 +116,11 @@ class Parser {
 
         static void _skipUntil(const std::vector<Token::Type>& followSet);
 
-        static std::string _formatError(const std::string& message, const Token& token, const std::vector<Token::Type>& expectedTokens);
+        static std::string _expectedTypesText(const std::vector<Token::Type>& expectedTokens);
 
         [[noreturn]] static void _reportError(const std::string& message, const std::vector<Token::Type>& expectedTokens);
 
-        static std::vector<std::string> _errorMessages;
+        static DiagnosticEngine _diagnostics;
 
         static std::vector<std::string> _derivationSteps;
 
@@ -364,9 +365,24 @@ class Parser {
 
         /**
          * @brief Retrieve accumulated syntax error messages.
-         * @return Read-only list of parser error messages.
+         * @return Formatted list of parser error messages.
          */
-        static const std::vector<std::string>& getErrorMessages();
+        static std::vector<std::string> getErrorMessages();
+
+        /**
+         * @brief Retrieve accumulated syntax diagnostic records.
+         * @return Read-only diagnostic engine of the latest parse.
+         */
+        static const DiagnosticEngine& getDiagnostics();
+
+        /**
+         * @brief Configure error cap and deduplication for later parses.
+         * @param options Reporting policy.
+         *
+         * @details
+         * Once the cap is hit, panic-mode recovery stops and the parse ends.
+         */
+        static void setDiagnosticOptions(const DiagnosticOptions& options);
 
         /**
          * @brief Retrieve grammar derivation trace.
@@ -21,7 +21,12 @@
 #define SEMANTIC_H
 
 #include "AST.h"
+#include "class_hierarchy.h"
+#include "diagnostics.h"
+#include "types.h"
 
+#include <cstdint>
+#include <iosfwd>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -32,7 +37,7 @@
  * @enum SymbolKind
  * @brief Kinds of semantic symbols tracked in scope tables.
  */
-enum class SymbolKind {
+enum class SymbolKind : std::uint8_t {
     Class,
     Function,
     Variable,
@@ -40,35 +45,74 @@ enum class SymbolKind {
     Field
 };
 
+/**
+ * @enum SymbolVisibility
+ * @brief Visibility or role of a symbol (rendered as "public", "local", ... in dumps).
+ */
+enum class SymbolVisibility : std::uint8_t {
+    None,
+    Local,
+    Param,
+    Public,
+    Private
+};
+
+/**
+ * @brief Bit flags of a SymbolEntry.
+ */
+enum SymbolFlag : std::uint8_t {
+    /** @brief A function prototype was seen (free function or class member declaration). */
+    SymbolDeclared = 1 << 0,
+    /** @brief A function body was seen. */
+    SymbolImplemented = 1 << 1,
+    /** @brief Member function (its owner is the class scope holding the entry). */
+    SymbolMethod = 1 << 2
+};
+
 /**
  * @struct SymbolEntry
  * @brief Canonical symbol metadata record stored in symbol tables.
  *
  * @details
  * A single structure is used for classes, functions, variables, parameters, and
- * fields. Unused members remain empty depending on symbol kind.
+ * fields. Types are ids into the analyzer's TypeTable, which doubles as the
+ * shared signature pool: array dimensions, return and parameter types are read
+ * from the descriptor of fullType instead of being stored per entry. The
+ * "Details" column of dumps is derived from kind, flags, and types.
  */
 struct SymbolEntry {
     /** @brief Symbol identifier. */
     std::string name;
-    /** @brief Primary type text or signature root. */
-    std::string type;
-    /** @brief Array dimensions for arrays/array parameters (if applicable). */
-    std::vector<int> dimensions;
-    /** @brief Function return type for function symbols. */
-    std::string returnType;
-    /** @brief Function parameter base types. */
-    std::vector<std::string> paramTypes;
-    /** @brief Function parameter dimension specs for array parameters. */
-    std::vector<std::vector<int>> paramDimensions;
-    /** @brief Symbol category. */
-    SymbolKind kind;
-    /** @brief Visibility/role marker (for example local, param, public). */
-    std::string visibility;
-    /** @brief Human-readable semantic details. */
-    std::string details;
+    /** @brief Base type (variables), signature (functions), or class descriptor (classes). */
+    TypeId type = TypeTable::Null;
+    /**
+     * @brief Declared array type (variables, parameters, fields; type itself when
+     * scalar), or signature with array-typed parameters (functions).
+     */
+    TypeId fullType = TypeTable::Null;
     /** @brief 1-based source declaration line. */
-    int line;
+    int line = 0;
+    /** @brief Symbol category. */
+    SymbolKind kind = SymbolKind::Variable;
+    /** @brief Visibility/role marker. */
+    SymbolVisibility visibility = SymbolVisibility::None;
+    /** @brief SymbolFlag bits. */
+    std::uint8_t flags = 0;
+};
+
+/**
+ * @struct FunctionOverload
+ * @brief One signature registered under a function name in a scope.
+ */
+struct FunctionOverload {
+    /** @brief Index of the name's entry (its first declaration) in the scope. */
+    size_t entry = 0;
+    /** @brief Parameter types, array-typed for array parameters. */
+    std::vector<TypeId> params;
+    /** @brief Signature with return type (as SymbolEntry::fullType). */
+    TypeId signature = TypeTable::Null;
+    /** @brief SymbolDeclared / SymbolImplemented bits of this signature. */
+    std::uint8_t flags = 0;
 };
 
 /**
@@ -78,6 +122,11 @@ struct SymbolEntry {
  * @details
  * Each scope stores local declarations and links to parent/children scopes.
  * Resolution first checks current scope then walks upward to parent scopes.
+ *
+ * A function name has one entry (its first declaration); every distinct
+ * parameter list declared under it is a FunctionOverload, indexed by (entry
+ * index, arity) so call resolution is one probe plus a type-id compare per
+ * argument of each candidate.
  */
 class SymbolTable : public std::enable_shared_from_this<SymbolTable> {
     public:
@@ -90,6 +139,8 @@ class SymbolTable : public std::enable_shared_from_this<SymbolTable> {
 
         /** @brief Create and register a child scope below this scope. */
         std::shared_ptr<SymbolTable> createChild(const std::string& scopeName);
+        /** @brief Find first child scope with the given name (null if none). */
+        std::shared_ptr<SymbolTable> findChild(const std::string& scopeName) const;
         /** @brief Define a symbol in current scope; fails on same-scope redeclaration. */
         bool define(const SymbolEntry& entry);
         /** @brief Find symbol only in current scope (const). */
@@ -107,13 +158,162 @@ class SymbolTable : public std::enable_shared_from_this<SymbolTable> {
         const std::vector<std::shared_ptr<SymbolTable>>& getChildren() const;
         /** @brief Get all entries defined in this scope. */
         const std::vector<SymbolEntry>& getEntries() const;
+        /** @brief Drop every entry, overload, and child scope (the scope itself stays in its parent). */
+        void clear();
+
+        /**
+         * @brief Register a parameter list under a function name defined in this scope.
+         * @param name Function name (must already have an entry).
+         * @param params Parameter types identifying the overload.
+         * @param signature Full signature stored with a new overload.
+         * @return The overload with these parameters (new ones have no flags), or null when name has no entry.
+         */
+        FunctionOverload* addOverload(const std::string& name, const std::vector<TypeId>& params, TypeId signature);
+        /** @brief Overload of a name with exactly these parameter types, or null. */
+        const FunctionOverload* findOverload(const std::string& name, const std::vector<TypeId>& params) const;
+        /** @brief Positions in getOverloads() of entry's overloads taking arity parameters, or null. */
+        const std::vector<size_t>* overloadsOf(size_t entry, size_t arity) const;
+        /** @brief Every overload of this scope in registration order. */
+        const std::vector<FunctionOverload>& getOverloads() const { return _overloads; }
 
     private:
         std::string _scopeName;
         std::weak_ptr<SymbolTable> _parent;
         std::vector<std::shared_ptr<SymbolTable>> _children;
+        std::unordered_map<std::string, size_t> _childIndex;
         std::vector<SymbolEntry> _entries;
         std::unordered_map<std::string, size_t> _entryIndex;
+        std::vector<FunctionOverload> _overloads;
+        /** @brief (entry index << 32 | arity) -> positions in _overloads. */
+        std::unordered_map<std::uint64_t, std::vector<size_t>> _overloadIndex;
+
+        static std::uint64_t overloadKey(size_t entry, size_t arity) {
+            return (static_cast<std::uint64_t>(entry) << 32) | static_cast<std::uint64_t>(arity);
+        }
+};
+
+/**
+ * @class ScopeBindings
+ * @brief Flat LeBlanc-Cook binding index over a stack of open scopes.
+ *
+ * @details
+ * One hash map sends each name to a stack of bindings (table, entry index). Opening
+ * a scope pushes a binding for each of its entries; closing it pops them. The
+ * innermost visible declaration is therefore the top of one stack, and lookup is
+ * a single probe at any nesting depth. The hierarchical SymbolTable objects remain
+ * the owners of entries (and the source of the symbol-table dump); this index only
+ * mirrors the chain of the scope currently being analyzed.
+ */
+class ScopeBindings {
+    public:
+        /** @brief Drop all open scopes and bindings. */
+        void clear();
+        /**
+         * @brief Make the open-scope stack equal the parent chain of a scope.
+         * @param scope Scope to make current (null closes everything).
+         *
+         * @details
+         * Entering a child or returning to the parent is one push/pop; arbitrary
+         * jumps (for example into a class scope for an out-of-class method body)
+         * close scopes down to the common ancestor and open the rest.
+         */
+        void moveTo(const SymbolTable* scope);
+        /** @brief Bind an entry just defined in the innermost open scope. */
+        void bindLast(const SymbolTable& scope);
+        /** @brief Innermost visible entry for a name, or null. */
+        const SymbolEntry* lookup(const std::string& name) const;
+        /** @brief Innermost visible entry with its scope and entry index, or null. */
+        const SymbolEntry* lookup(const std::string& name, const SymbolTable*& table, size_t& index) const;
+
+    private:
+        /** @brief One visible declaration. */
+        struct Binding {
+            const SymbolTable* table;
+            size_t index;
+        };
+        /** @brief One open scope and the binding stacks it pushed onto. */
+        struct Frame {
+            const SymbolTable* table;
+            std::vector<std::vector<Binding>*> pushed;
+        };
+
+        std::unordered_map<std::string, std::vector<Binding>> _bindings;
+        std::vector<Frame> _frames;
+
+        void open(const SymbolTable* table);
+        void close();
+        void bind(Frame& frame, const SymbolTable& table, size_t index);
+};
+
+/**
+ * @enum SymbolTableFormat
+ * @brief Layout of the symbol-table dump.
+ *
+ * @details
+ * Text is the aligned per-scope table written to ".outsymboltables". JsonLines
+ * writes one JSON object per line: a "scope" record (id, parent id, depth, name)
+ * followed by one "symbol" record per entry of that scope, in the same order as
+ * the text tables.
+ */
+enum class SymbolTableFormat {
+    Text,
+    JsonLines
+};
+
+struct ClassInterface;
+
+/**
+ * @class SemanticSnapshot
+ * @brief Results of one analysis kept for SemanticAnalyzer::analyzeIncremental().
+ *
+ * @details
+ * Besides the symbol-table tree and type table, it records for every function
+ * definition its structural and relative-line hashes, the pass-2 scope subtree
+ * and diagnostics it produced, and the declaration keys its check read:
+ * "n:<name>" for a name resolved from the body and "c:<class>" for a class
+ * whose existence or members were consulted. A fingerprint per key (hash of
+ * every global/class-scope declaration it stands for) lets the next analysis
+ * tell which of those keys changed.
+ */
+class SemanticSnapshot {
+    public:
+        /** @brief Top-level definition keys in source order ("class A", "function f(integer)", "function A::m()"). */
+        const std::vector<std::string>& definitionKeys() const { return _definitionKeys; }
+        /** @brief Number of function definitions recorded. */
+        size_t bodyCount() const { return _bodies.size(); }
+
+    private:
+        friend class SemanticAnalyzer;
+
+        /** @brief Pass-2 result of one function definition. */
+        struct BodyRecord {
+            /** @brief Function scope name (definition key). */
+            std::string key;
+            /** @brief ASTHasher hash of the definition. */
+            std::uint64_t hash = 0;
+            /** @brief Hash of every node's line relative to the definition line. */
+            std::uint64_t lineShape = 0;
+            /** @brief Definition line. */
+            int line = 0;
+            /** @brief Number of the block scope preceding the definition's first block. */
+            int blockBase = 0;
+            /** @brief Block scopes the definition created. */
+            int blockCount = 0;
+            /** @brief Function scope holding parameters, locals, and block scopes. */
+            std::shared_ptr<SymbolTable> scope;
+            /** @brief Diagnostics of this definition alone. */
+            DiagnosticEngine diagnostics{DiagnosticPhase::Semantic};
+            /** @brief Declaration keys read by the check, sorted. */
+            std::vector<std::string> dependencies;
+        };
+
+        TypeTable _types;
+        std::shared_ptr<SymbolTable> _globalScope;
+        std::unordered_map<std::string, std::size_t> _fingerprints;
+        std::vector<BodyRecord> _bodies;
+        /** @brief Definition key -> indices into _bodies, in source order. */
+        std::unordered_map<std::string, std::vector<size_t>> _bodiesByKey;
+        std::vector<std::string> _definitionKeys;
 };
 
 /**
@@ -138,12 +338,68 @@ class SemanticAnalyzer : public ASTVisitor {
          * @return True when no semantic errors were produced.
          */
         bool analyze(const std::shared_ptr<ProgNode>& root);
-        /** @brief Get accumulated semantic error diagnostics. */
-        const std::vector<std::string>& getErrors() const;
-        /** @brief Get accumulated semantic warning diagnostics. */
-        const std::vector<std::string>& getWarnings() const;
+        /**
+         * @brief Re-analyze a program, reusing a previous analysis where it is still valid.
+         * @param root Program root node (typically a re-parse of the edited source).
+         * @param previous Snapshot of an earlier analysis (see setRecordSnapshot()).
+         * @param changedDefinitions Definition keys (see SemanticSnapshot::definitionKeys()) to re-check.
+         * @return True when no semantic errors were produced.
+         *
+         * @details
+         * Pass 1 and the cross-pass checks run as usual. In pass 2 a function
+         * definition is re-checked when it is listed in changedDefinitions, its
+         * AST or relative line layout differs, or one of its recorded
+         * dependencies changed (a listed class dirties its own key and its
+         * members' names); otherwise its previous scope subtree and diagnostics
+         * are copied with lines and block numbers shifted. Diagnostics and symbol
+         * tables match analyze(root).
+         */
+        bool analyzeIncremental(const std::shared_ptr<ProgNode>& root, const SemanticSnapshot& previous,
+                                const std::unordered_set<std::string>& changedDefinitions = {});
+        /** @brief Record a SemanticSnapshot during the following analyses. */
+        void setRecordSnapshot(bool enabled) { _recordSnapshot = enabled; }
+        /** @brief Snapshot of the last analysis (null when not recording or when the error cap was hit). */
+        std::shared_ptr<const SemanticSnapshot> snapshot() const { return _snapshot; }
+        /**
+         * @brief Declare a pre-analyzed set of classes in every following analysis.
+         * @details Imported classes are defined in the global scope with their class
+         * scopes before pass 1, so the program's classes may inherit from them and
+         * its bodies may use them. Their methods are implemented elsewhere and are
+         * exempt from 6.2.
+         */
+        void importClassInterface(const ClassInterface& classInterface);
+        /** @brief Interface of the classes declared by the analyzed program (imported ones excluded). */
+        ClassInterface exportClassInterface() const;
+        /** @brief Function definitions whose pass-2 results were copied from the previous snapshot. */
+        size_t reusedBodyCount() const { return _reusedBodies; }
+        /** @brief Function definitions checked in pass 2 of the last analysis. */
+        size_t checkedBodyCount() const { return _checkedBodies; }
+        /** @brief Format accumulated semantic error diagnostics. */
+        std::vector<std::string> getErrors() const;
+        /** @brief Format accumulated semantic warning diagnostics. */
+        std::vector<std::string> getWarnings() const;
+        /** @brief Unformatted diagnostic records of the last analysis. */
+        const DiagnosticEngine& getDiagnostics() const { return _diagnostics; }
+        /** @brief Set error cap and deduplication policy for the next analysis. */
+        void setDiagnosticOptions(const DiagnosticOptions& options) { _diagnostics.configure(options); }
         /** @brief Dump formatted symbol-table hierarchy. */
         std::string dumpSymbolTables() const;
+        /** @brief Stream the symbol-table hierarchy scope by scope. */
+        void writeSymbolTables(std::ostream& out, SymbolTableFormat format = SymbolTableFormat::Text) const;
+        /**
+         * @brief Stream the symbol-table hierarchy into a buffered file.
+         * @return False when the file cannot be opened or written.
+         */
+        bool writeSymbolTablesToFile(const std::string& filePath, SymbolTableFormat format = SymbolTableFormat::Text) const;
+        /** @brief Type table backing every TypeId produced by the last analysis. */
+        const TypeTable& getTypeTable() const { return _types; }
+        /** @brief Inheritance graph of the last analysis: cycles and parents-first class order. */
+        const ClassHierarchy& getClassHierarchy() const { return _classHierarchy; }
+        /**
+         * @brief Set worker threads for pass-2 function bodies.
+         * @param jobs 0 = one per hardware thread (default), 1 = check bodies sequentially.
+         */
+        void setPassTwoJobs(size_t jobs) { _passTwoJobs = jobs; }
 
         /** @name AST Visitor Overrides */
         /** @{ */
@@ -172,49 +428,186 @@ class SemanticAnalyzer : public ASTVisitor {
         bool _isPassOne = false;
         /** @brief Global/root scope table. */
         std::shared_ptr<SymbolTable> _globalScope;
-        /** @brief Scope currently being visited. */
+        /** @brief Scope currently being visited (change through setCurrentScope). */
         std::shared_ptr<SymbolTable> _currentScope;
+        /** @brief Pass-2 flat name index mirroring _currentScope's parent chain. */
+        ScopeBindings _bindings;
         /** @brief Class name -> class scope map. */
         std::unordered_map<std::string, std::shared_ptr<SymbolTable>> _classScopes;
         /** @brief All class names declared in the program AST (order-independent lookup). */
         std::unordered_set<std::string> _declaredClassNames;
-        /** @brief Declared member function identities: Class::name(paramProfile). */
-        std::unordered_set<std::string> _declaredMemberFunctionKeys;
-        /** @brief Collected semantic errors. */
-        std::vector<std::string> _errors;
-        /** @brief Collected semantic warnings. */
-        std::vector<std::string> _warnings;
+        /** @brief Collected semantic errors and warnings. */
+        DiagnosticEngine _diagnostics{DiagnosticPhase::Semantic};
         /** @brief Return-type stack for nested function-body visits. */
-        std::vector<std::string> _functionReturnTypeStack;
+        std::vector<TypeId> _functionReturnTypeStack;
         /** @brief Counter for synthesized block scope naming. */
         int _blockCounter = 0;
+        /** @brief Class of the member function whose body pass 2 is checking ("" in free functions). */
+        std::string _receiverClass;
+        /** @brief Content hash of an annotation (see _annotations). */
+        struct AnnotationHash {
+            std::size_t operator()(const ASTAnnotation& annotation) const;
+        };
+        /** @brief Content equality of annotations (see _annotations). */
+        struct AnnotationEqual {
+            bool operator()(const ASTAnnotation& a, const ASTAnnotation& b) const;
+        };
+        /** @brief Distinct annotations attached by this analyzer; nodes with equal contents share one object. */
+        mutable std::unordered_map<ASTAnnotation, std::shared_ptr<const ASTAnnotation>, AnnotationHash, AnnotationEqual> _annotations;
+        /** @brief Pass-2 expression type side table (node -> inferred type), filled on first query. */
+        mutable std::unordered_map<const ASTNode*, TypeId> _exprTypes;
+        /** @brief Class/function-implementation node -> scope created in pass 1. */
+        std::unordered_map<const ASTNode*, std::shared_ptr<SymbolTable>> _nodeScopes;
+        /** @brief Interned types referenced by symbol entries and _exprTypes. */
+        TypeTable _types;
+
+        /** @brief Visible class member: defining scope slot and owning class type. */
+        struct ClassMember {
+            const SymbolTable* table;
+            size_t index;
+            TypeId owner;
+        };
+        /** @brief Global classes and their inheritance edges, analyzed after pass 1. */
+        ClassHierarchy _classHierarchy;
+        /** @brief Class type -> every visible member name (own and inherited), built after pass 1. */
+        std::unordered_map<TypeId, std::unordered_map<std::string, ClassMember>> _classMembers;
+        /** @brief Requested pass-2 worker count (see setPassTwoJobs). */
+        size_t _passTwoJobs = 0;
+
+        /** @brief Interfaces declared before pass 1 of every analysis. */
+        std::vector<std::shared_ptr<const ClassInterface>> _imports;
+        /** @brief Class scopes created from _imports in the current analysis. */
+        std::unordered_set<const SymbolTable*> _importedClassScopes;
+        /** @brief Whether analyses record a snapshot. */
+        bool _recordSnapshot = false;
+        /** @brief Snapshot being recorded by (or recorded by) the last analysis. */
+        std::shared_ptr<SemanticSnapshot> _snapshot;
+        /** @brief Snapshot reused by the running incremental analysis (null otherwise). */
+        const SemanticSnapshot* _previous = nullptr;
+        /** @brief Definition keys the caller marked as changed. */
+        std::unordered_set<std::string> _changedDefinitions;
+        /** @brief Declaration key -> fingerprint, computed after pass 1 when tracking. */
+        std::unordered_map<std::string, std::size_t> _fingerprints;
+        /** @brief Declaration keys whose fingerprint differs from the previous snapshot. */
+        std::unordered_set<std::string> _dirtyKeys;
+        /** @brief Receives declaration keys read by the body being checked (null when not tracking). */
+        std::unordered_set<std::string>* _dependencySink = nullptr;
+        /** @brief Definitions copied / checked by the last pass 2. */
+        size_t _reusedBodies = 0;
+        size_t _checkedBodies = 0;
+
+        /** @brief One pass-2 function definition check and the diagnostics it produced. */
+        struct FunctionBodyTask {
+            FuncDefNode* node = nullptr;
+            /** @brief _blockCounter value the sequential run would have on entry. */
+            int blockBase = 0;
+            /** @brief Block scopes the definition creates. */
+            int blockCount = 0;
+            DiagnosticEngine diagnostics{DiagnosticPhase::Semantic};
+            /** @brief Declaration keys read by the check (filled only when tracking). */
+            std::unordered_set<std::string> dependencies;
+        };
+
+        /** @brief Identity and reuse decision of one function definition in a tracked analysis. */
+        struct BodyPlan {
+            std::string key;
+            std::uint64_t hash = 0;
+            std::uint64_t lineShape = 0;
+            int line = 0;
+            std::shared_ptr<SymbolTable> scope;
+            /** @brief Previous result to copy, or null to check the definition. */
+            const SemanticSnapshot::BodyRecord* reuse = nullptr;
+        };
+
+        /** @brief Pass-1 listener declaring classes, fields, and signatures on ASTTraversal callbacks. */
+        class DeclarationCollector;
+        /** @brief Pass 1 on a class: define symbol and scope, register fields, enter the scope; returns the enclosing scope. */
+        std::shared_ptr<SymbolTable> beginClassDeclaration(ClassDeclNode& node);
+        /** @brief Define the fields of a class in the current (class) scope. */
+        void declareClassFields(ClassDeclNode& node);
+        /** @brief Pass 1: report a member function overriding a parent's function with the same signature. */
+        void checkOverriddenMemberFunction(const ClassDeclNode& owner, const FuncDefNode& method);
+        /** @brief Define imported classes in the fresh global scope. */
+        void declareImportedClasses();
+        /** @brief Shared body of analyze() and analyzeIncremental(). */
+        bool runAnalysis(const std::shared_ptr<ProgNode>& root, TypeTable types, const SemanticSnapshot* previous);
+        /** @brief Pass 2 over function definitions on worker analyzers, merged in source order. */
+        void checkFunctionBodies(const std::vector<std::shared_ptr<FuncDefNode>>& functions);
+        /** @brief Check one function definition into the task's own diagnostic buffers. */
+        void checkFunctionBody(FunctionBodyTask& task);
+        /** @brief Hash every definition and decide which previous results can be reused. */
+        std::vector<BodyPlan> planFunctionBodies(const std::vector<std::shared_ptr<FuncDefNode>>& functions) const;
+        /** @brief Copy a previous definition's scope subtree and diagnostics into the task, shifted. */
+        void reuseFunctionBody(const BodyPlan& plan, FunctionBodyTask& task);
+        /** @brief Store a finished definition in the snapshot being recorded. */
+        void recordFunctionBody(const BodyPlan& plan, FunctionBodyTask& task);
+        /** @brief Fingerprint every "n:" and "c:" declaration key after pass 1. */
+        std::unordered_map<std::string, std::size_t> declarationFingerprints() const;
+        /** @brief Compare fingerprints with the previous snapshot and apply changedDefinitions. */
+        void markDirtyKeys();
+        /** @brief Note that the body being checked read a declaration key. */
+        void recordDependency(const char* prefix, const std::string& name) const;
+        /** @brief Build _classMembers in _classHierarchy's topological order. */
+        void buildClassMemberTables();
+        /** @brief Resolve own or inherited member of a class type. */
+        const SymbolEntry* resolveClassMember(TypeId classType, const std::string& memberName) const;
+        /** @brief Resolve own or inherited member of a class type with its defining scope slot. */
+        const ClassMember* findClassMember(TypeId classType, const std::string& memberName) const;
+        /** @brief Callee symbol of a call and the overload its arguments select. */
+        struct CallTarget {
+            const SymbolEntry* symbol = nullptr;
+            /** @brief Selected overload; null when the callee is not a function or no overload has the call's arity. */
+            const FunctionOverload* overload = nullptr;
+        };
+        /** @brief Resolve a call's callee and select an overload by arity and argument types. */
+        CallTarget resolveCall(const FuncCallNode& node) const;
+        /** @brief Infer expression result type for semantic checks (memoized per node, annotates the node). */
+        TypeId inferExprType(const std::shared_ptr<ASTNode>& node) const;
+        /** @brief Compute expression type from children's memoized types and describe it in annotation. */
+        TypeId computeExprType(const std::shared_ptr<ASTNode>& node, ASTAnnotation& annotation) const;
+        /** @brief Fill binding, receiver, and dimensions of a name resolved to symbol. */
+        void annotateBinding(const SymbolEntry& symbol, ASTAnnotation& annotation) const;
+        /** @brief Parent class names of a class symbol, in declaration order. */
+        std::vector<std::string> classParents(const SymbolEntry& classEntry) const;
+        /** @brief Declared dimensions of a variable, parameter, or field (empty for scalars). */
+        const std::vector<int>& dimensionsOf(const SymbolEntry& entry) const { return _types.get(entry.fullType).dimensions; }
+        /** @brief Array-typed parameter types of a function symbol. */
+        const std::vector<TypeId>& paramTypesOf(const SymbolEntry& entry) const { return _types.get(entry.fullType).operands; }
 
-        /** @brief Strip signature/array suffixes from a type name. */
-        static std::string baseTypeName(const std::string& typeName);
-        /** @brief Resolve member inside a class type scope. */
-        const SymbolEntry* resolveClassMember(const std::string& classTypeName, const std::string& memberName) const;
-        /** @brief Infer expression result type for semantic checks. */
-        std::string inferExprType(const std::shared_ptr<ASTNode>& node) const;
-
-        /** @brief Record semantic error with line context. */
-        void reportError(int line, const std::string& message);
-        /** @brief Record semantic warning with line context. */
-        void reportWarning(int line, const std::string& message);
+        /** @brief Record a semantic diagnostic (severity comes from the code). */
+        void report(DiagnosticCode code, int line, std::initializer_list<DiagnosticArg> args = {});
         /** @brief Define symbol in current scope with redefinition policy checks. */
         bool defineSymbol(const SymbolEntry& entry);
         /** @brief Null-safe helper for visiting an optional node. */
         void visitNode(const std::shared_ptr<ASTNode>& node);
-        /** @brief Reuse existing child scope in pass 2 or create one in pass 1. */
-        std::shared_ptr<SymbolTable> getOrCreateChildScope(const std::shared_ptr<SymbolTable>& parent, const std::string& scopeName);
+        /** @brief Switch current scope, keeping pass-2 bindings in sync. */
+        void setCurrentScope(const std::shared_ptr<SymbolTable>& scope);
+        /** @brief Resolve a name from the current scope outward. */
+        const SymbolEntry* resolveName(const std::string& name) const;
+        /** @brief Scope created for a class/function node in pass 1. */
+        std::shared_ptr<SymbolTable> recordedScope(const ASTNode& node) const;
 
         /** @brief Convert SymbolKind enum to printable label. */
         static std::string kindToString(SymbolKind kind);
-        /** @brief Build canonical function signature string from AST function node. */
-        static std::string functionSignature(const FuncDefNode& node);
-        /** @brief Build class descriptor string including inheritance summary. */
-        static std::string classTypeName(const ClassDeclNode& node);
-        /** @brief Recursively dump scope tree in table format. */
-        void dumpScope(const std::shared_ptr<SymbolTable>& scope, int depth, std::string& out) const;
+        /** @brief Convert SymbolVisibility enum to printable label ("n/a" for None). */
+        static const char* visibilityToString(SymbolVisibility visibility);
+        /** @brief Map a declaration's visibility tag ("local", "public", "private") to the enum. */
+        static SymbolVisibility visibilityFromString(const std::string& visibility);
+        /** @brief Human-readable "Details" column of an entry defined in scope. */
+        std::string symbolDetails(const SymbolEntry& entry, const SymbolTable& scope) const;
+        /** @brief Intern function signature type (return and parameter base types). */
+        TypeId functionSignature(const FuncDefNode& node);
+        /** @brief Intern class descriptor type including inheritance list. */
+        TypeId classDescriptor(const ClassDeclNode& node);
+        /** @brief Output stream, format, and scope numbering of one dump. */
+        struct SymbolDumpState;
+        /** @brief Recursively dump scope tree (classes, then free functions, then remaining children). */
+        void dumpScope(const std::shared_ptr<SymbolTable>& scope, int depth, long parentId, SymbolDumpState& state) const;
+        /** @brief Write one scope as an aligned text table. */
+        void writeScopeTable(std::ostream& out, int depth, const SymbolTable& scope, const std::vector<const SymbolEntry*>& entries) const;
+        /** @brief Write one scope record and its symbol records as JSON lines. */
+        void writeScopeJsonLines(std::ostream& out, long id, long parentId, int depth, const SymbolTable& scope,
+                                 const std::vector<const SymbolEntry*>& entries) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,170 @@
+/**
+ * @file types.h
+ * @brief Interned semantic type descriptors referenced by compact type ids.
+ *
+ * @details
+ * The semantic layer describes every type it reasons about (builtin scalars,
+ * class names, array types, function signatures, and class descriptors) through
+ * a TypeTable. Each structurally distinct descriptor is stored once and named by
+ * a 32-bit TypeId, so type equality is an integer comparison and decomposition
+ * (return type, element type, inherited parents) is a table lookup instead of
+ * re-parsing decorated strings.
+ *
+ * @par Why hash-consing?
+ * Symbol entries, inferred expression types, and overload checks all compare
+ * types repeatedly. Interning once at declaration time makes those comparisons
+ * O(1) and leaves string rendering to diagnostics and symbol-table dumps.
+ *
+ * @par What comes next?
+ * New type forms (for example references or generics) should be added as new
+ * TypeKind values with their own constructor and rendering rule here.
+ */
+#ifndef TYPES_H
+#define TYPES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/** @brief Compact handle of an interned type descriptor. */
+using TypeId = std::uint32_t;
+
+/**
+ * @class TypeTableFrozenError
+ * @brief Thrown when a frozen TypeTable is asked for a descriptor it does not hold.
+ */
+class TypeTableFrozenError : public std::logic_error {
+    public:
+        using std::logic_error::logic_error;
+};
+
+/**
+ * @enum TypeKind
+ * @brief Structural category of an interned type descriptor.
+ */
+enum class TypeKind : std::uint8_t {
+    Null,            ///< Unresolved type, rendered "null".
+    Builtin,         ///< integer, float, void, bool.
+    Class,           ///< Named user type (declared or not).
+    Array,           ///< Element type plus dimensions (-1 for an open dimension).
+    Function,        ///< Return type plus parameter types.
+    ClassDescriptor  ///< Class symbol type: inherited parents list.
+};
+
+/**
+ * @struct TypeDescriptor
+ * @brief Structure of one interned type.
+ *
+ * @details
+ * Only the fields relevant to the kind are populated; text caches the rendered
+ * form used by diagnostics and dumps.
+ */
+struct TypeDescriptor {
+    /** @brief Structural category. */
+    TypeKind kind = TypeKind::Null;
+    /** @brief Builtin or class name. */
+    std::string name;
+    /** @brief Array element type or function return type. */
+    TypeId element = 0;
+    /** @brief Array dimensions. */
+    std::vector<int> dimensions;
+    /** @brief Function parameter types or class-descriptor parent classes. */
+    std::vector<TypeId> operands;
+    /** @brief Rendered form, e.g. "integer[3][]", "float(integer, float)", "class : A, B". */
+    std::string text;
+};
+
+/**
+ * @class TypeTable
+ * @brief Hash-consing store of type descriptors.
+ *
+ * @details
+ * Builtin scalar types and the null type are pre-interned at fixed ids, so the
+ * analyzer can compare against TypeTable::Integer and friends without lookups.
+ * Constructors return the existing id when an identical descriptor is present.
+ */
+class TypeTable {
+    public:
+        /** @name Pre-interned ids */
+        /** @{ */
+        static constexpr TypeId Null = 0;
+        static constexpr TypeId Integer = 1;
+        static constexpr TypeId Float = 2;
+        static constexpr TypeId Void = 3;
+        static constexpr TypeId Bool = 4;
+        /** @} */
+
+        /** @brief Create table containing the null and builtin types. */
+        TypeTable();
+
+        /** @brief Intern a builtin or class type by name ("null" maps to Null). */
+        TypeId named(const std::string& name);
+        /** @brief Find a builtin or class type by name without interning (Null if absent). */
+        TypeId lookupNamed(const std::string& name) const;
+        /** @brief Intern an array type; returns element unchanged when dimensions are empty. */
+        TypeId array(TypeId element, const std::vector<int>& dimensions);
+        /** @brief Intern a function signature type. */
+        TypeId function(TypeId returnType, const std::vector<TypeId>& params);
+        /** @brief Intern a class descriptor type from its parent class types. */
+        TypeId classDescriptor(const std::vector<TypeId>& parents);
+
+        /** @brief Access descriptor for an id. */
+        const TypeDescriptor& get(TypeId id) const;
+        /** @brief Category of an id. */
+        TypeKind kind(TypeId id) const;
+        /** @brief Rendered form of an id. */
+        const std::string& toString(TypeId id) const;
+        /**
+         * @brief Strip signature/array decoration.
+         * @return Function return type, array element type, or the id itself.
+         */
+        TypeId baseOf(TypeId id) const;
+        /** @brief Number of interned descriptors. */
+        std::size_t size() const;
+        /**
+         * @brief Intern the structure of another table's type here.
+         * @param other Source table.
+         * @param id Type id in other.
+         * @return Id of the structurally equal type in this table.
+         */
+        TypeId copyFrom(const TypeTable& other, TypeId id);
+        /**
+         * @brief Reject further interning of new descriptors.
+         * @details Copies of a frozen table keep agreeing on every id, which is what
+         * lets pass-2 workers use private copies; constructors then throw
+         * TypeTableFrozenError instead of adding a descriptor.
+         */
+        void freeze() { _frozen = true; }
+        /** @brief True once freeze() was called. */
+        bool frozen() const { return _frozen; }
+        /**
+         * @brief Allow interning again.
+         * @details Only for a private copy (for example one seeding an incremental
+         * analysis); ids already handed out stay valid.
+         */
+        void thaw() { _frozen = false; }
+
+    private:
+        /** @brief Hash functor over descriptor structure (text excluded). */
+        struct DescriptorHash {
+            std::size_t operator()(const TypeDescriptor& descriptor) const;
+        };
+        /** @brief Structural equality over descriptors (text excluded). */
+        struct DescriptorEqual {
+            bool operator()(const TypeDescriptor& a, const TypeDescriptor& b) const;
+        };
+
+        std::vector<TypeDescriptor> _types;
+        std::unordered_map<TypeDescriptor, TypeId, DescriptorHash, DescriptorEqual> _index;
+        bool _frozen = false;
+
+        /** @brief Return id of descriptor, rendering and storing it if new. */
+        TypeId intern(TypeDescriptor descriptor);
+        /** @brief Build text for a new descriptor from its (already interned) parts. */
+        std::string render(const TypeDescriptor& descriptor) const;
+};
+
+#endif
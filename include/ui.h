@@ -1,6 +1,7 @@
 #ifndef UI_H
 #define UI_H
 
+#include <future>
 #include <string>
 #include <utility>
 #include <vector>
@@ -17,6 +18,7 @@ namespace UI {
 struct PngRenderResult {
     bool dotAvailable;
     bool pngGenerated;
+    bool reusedPreviousRender;  // PNG already matched the DOT content; Graphviz was not run.
 };
 
 void printTitle(const std::string& title);
@@ -31,6 +33,8 @@ void printPngGenerationNotes(const PngRenderResult& result);
 void printDone();
 
 PngRenderResult renderAstPngFromDot(const std::string& inputDot, const std::string& outputPng);
+// Runs renderAstPngFromDot on a background thread; join with get() before reporting.
+std::future<PngRenderResult> renderAstPngFromDotAsync(const std::string& inputDot, const std::string& outputPng);
 
 }  // namespace UI
 
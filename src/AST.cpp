@@ -1,9 +1,12 @@
 #include "../include/AST.h"
+#include "../include/buffered_file_sink.h"
 
+#include <cstring>
 #include <fstream>
+#include <ostream>
 #include <sstream>
+#include <stdexcept>
 #include <unordered_map>
-#include <unordered_set>
 
 /**
  * @file AST.cpp
@@ -12,17 +15,21 @@
  * @details
  * Provides:
  * - concrete accept() forwarding for double-dispatch,
+ * - child-slot enumeration and the iterative traversal driver (ASTTraversal),
  * - text-based AST pretty printer,
  * - Graphviz DOT exporter with UML-inspired styling,
- * - file-writing wrappers used by the driver pipeline.
+ * - structural subtree hashing (ASTHasher),
+ * - file-writing wrappers used by the driver pipeline, which stream straight
+ *   into a buffered file sink instead of materializing the whole export.
  *
  * @par Why this organization?
  * Export/visualization logic is isolated from AST node definitions so traversal
  * policies can evolve independently from tree structure.
  *
  * @par What comes next?
- * Additional exporters (JSON, XML, IR dumps) should follow the same visitor
- * pattern and be added beside existing ASTPrinter functions.
+ * Additional exporters (JSON, XML, IR dumps) should be written as
+ * ASTTraversalListener implementations driven by ASTTraversal::walk() and be
+ * added beside existing ASTPrinter functions.
  */
 
 /**
@@ -53,434 +60,845 @@ void ProgNode::accept(ASTVisitor& visitor) { visitor.visit(*this); }
 
 namespace {
 /**
- * @brief Build indentation padding for text AST output.
- * @param depth Tree depth.
- * @return String containing two spaces per depth level.
+ * @brief Write indentation padding for text AST output.
+ * @param out Destination stream.
+ * @param depth Tree depth (two spaces per level).
  */
-std::string makeIndent(int depth) {
-    return std::string(depth * 2, ' ');
+void writeIndent(std::ostream& out, int depth) {
+    static const char kSpaces[] = "                                                                ";
+    constexpr int kChunk = static_cast<int>(sizeof(kSpaces) - 1);
+    int remaining = depth * 2;
+    while (remaining > 0) {
+        int count = remaining < kChunk ? remaining : kChunk;
+        out.write(kSpaces, count);
+        remaining -= count;
+    }
 }
 
 /**
- * @brief Escape DOT label-sensitive characters.
+ * @brief Write text with DOT label-sensitive characters escaped.
+ * @param out Destination stream.
  * @param text Raw label text.
- * @return Escaped label safe for Graphviz node/edge labels.
  */
-std::string escapeDotLabel(const std::string& text) {
-    std::string escaped;
-    escaped.reserve(text.size());
-    for (char c : text) {
+void writeEscapedDotLabel(std::ostream& out, const std::string& text) {
+    std::size_t runStart = 0;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
         if (c == '\\' || c == '"' || c == '<' || c == '>') {
-            escaped.push_back('\\');
+            out.write(text.data() + runStart, static_cast<std::streamsize>(i - runStart));
+            out.put('\\');
+            runStart = i;
         }
-        escaped.push_back(c);
     }
-    return escaped;
+    out.write(text.data() + runStart, static_cast<std::streamsize>(text.size() - runStart));
 }
 
 /**
- * @brief Build a concise node label including line metadata.
+ * @brief Write a concise node label including line metadata.
+ * @param out Destination stream.
  * @param node AST node.
- * @return Label in "value [line N]" form.
+ * @param escapeForDot Escape label characters for Graphviz output.
  */
-std::string nodeLabel(ASTNode& node) {
-    return node.getValue() + " [line " + std::to_string(node.getLineNumber()) + "]";
+void writeNodeLabel(std::ostream& out, ASTNode& node, bool escapeForDot) {
+    if (escapeForDot) {
+        writeEscapedDotLabel(out, node.getValue());
+    } else {
+        out << node.getValue();
+    }
+    out << " [line " << node.getLineNumber() << "]";
+}
+
+/**
+ * @brief Check whether a node is a local declaration inside a block.
+ * @param node Child node.
+ * @param parent Parent node.
+ * @return True for VarDecl statements in a BlockNode (they are shared with the
+ *         owning function's "locals" slot).
+ */
+bool isBlockLocal(const ASTNode& node, const ASTNode* parent) {
+    return parent != nullptr
+        && dynamic_cast<const BlockNode*>(parent) != nullptr
+        && dynamic_cast<const VarDeclNode*>(&node) != nullptr;
 }
 
 // ============================================================================
-// TEXT VISITOR
+// TEXT PRINTER
 // ============================================================================
 /**
- * @class TextASTVisitor
- * @brief Visitor that serializes AST into a readable indented text tree.
+ * @class TextASTPrinter
+ * @brief Traversal listener that serializes AST into a readable indented text tree.
  *
  * @details
  * This representation is optimized for diagnostics and grading output. Sections
  * like "params", "locals", and "body" make declaration/statement context explicit.
+ * Lines are written straight to the destination stream as nodes are entered.
+ * Labeled list slots indent their elements one level below the section header;
+ * single-child slots and block statements stay at the header's level.
  */
-class TextASTVisitor : public ASTVisitor {
+class TextASTPrinter : public ASTTraversalListener {
     public:
-        std::string str() const { return _out.str(); }
-
-        void visit(IdNode& node) override { visitLeaf(node); }
-        void visit(IntLitNode& node) override { visitLeaf(node); }
-        void visit(FloatLitNode& node) override { visitLeaf(node); }
-        void visit(TypeNode& node) override { visitLeaf(node); }
-        void visit(VarDeclNode& node) override { visitLeaf(node); }
+        explicit TextASTPrinter(std::ostream& out) : _out(out) {}
 
-        void visit(BinaryOpNode& node) override { visitBinaryLike(node); }
-        void visit(UnaryOpNode& node) override { visitBinaryLike(node); }
-        void visit(AssignStmtNode& node) override { visitBinaryLike(node); }
-        void visit(WhileStmtNode& node) override { visitBinaryLike(node, "cond", "body"); }
-        void visit(IOStmtNode& node) override { visitBinaryLike(node); }
-        void visit(ReturnStmtNode& node) override { visitBinaryLike(node); }
+        bool enterNode(ASTNode& node, const ASTNode*, const ASTChildSlot*) override {
+            writeIndent(_out, _depth);
+            writeNodeLabel(_out, node, false);
+            _out << '\n';
+            _depth++;
 
-        void visit(IfStmtNode& node) override {
-            writeNode(node);
-            section("cond");
-            visitChild(node.getLeft(), 0);
-            section("then");
-            visitChild(node.getRight(), 0);
-            if (node.getElseBlock() != nullptr) {
-                section("else");
-                visitChild(node.getElseBlock(), 0);
+            if (auto* cls = dynamic_cast<ClassDeclNode*>(&node)) {
+                const std::vector<std::string> parents = cls->getParents();
+                if (!parents.empty()) {
+                    section("inherits");
+                    for (const auto& parent : parents) {
+                        writeIndent(_out, _depth + 1);
+                        _out << parent << '\n';
+                    }
+                }
             }
-            _depth--;
+            return true;
         }
 
-        void visit(FuncCallNode& node) override {
-            writeNode(node);
-            if (node.getLeft() != nullptr) {
-                section("callee");
-                visitChild(node.getLeft(), 0);
-            }
-            section("args");
-            for (const auto& arg : node.getArgs()) {
-                visitChild(arg, 1);
-            }
-            _depth--;
-        }
+        void exitNode(ASTNode&) override { _depth--; }
 
-        void visit(DataMemberNode& node) override {
-            writeNode(node);
-            if (node.getLeft() != nullptr) {
-                section("owner");
-                visitChild(node.getLeft(), 0);
-            }
-            if (!node.getIndices().empty()) {
-                section("indices");
-                for (const auto& idx : node.getIndices()) {
-                    visitChild(idx, 1);
-                }
-            }
-            _depth--;
+        void enterSlot(ASTNode&, const ASTChildSlot& slot) override {
+            if (slot.label[0] == '\0') return;
+            section(slot.label);
+            if (slot.isList) _depth++;
         }
 
-        void visit(BlockNode& node) override {
-            writeNode(node);
-            for (const auto& stmt : node.getStatements()) {
-                visitChild(stmt, 0);
-            }
-            _depth--;
+        void exitSlot(ASTNode&, const ASTChildSlot& slot) override {
+            if (slot.label[0] != '\0' && slot.isList) _depth--;
         }
 
-        void visit(FuncDefNode& node) override {
-            writeNode(node);
-            section("params");
-            for (const auto& param : node.getParams()) {
-                visitChild(param, 1);
-            }
-            section("locals");
-            for (const auto& local : node.getLocalVars()) {
-                visitChild(local, 1);
-            }
-            section("body");
-            visitChild(node.getRight(), 0);
-            _depth--;
+        void nullChild(ASTNode&, const ASTChildSlot&) override {
+            writeIndent(_out, _depth);
+            _out << "<null>\n";
         }
 
-        void visit(ClassDeclNode& node) override {
-            writeNode(node);
-            if (!node.getParents().empty()) {
-                section("inherits");
-                for (const auto& parent : node.getParents()) {
-                    line(parent, _depth + 1);
-                }
-            }
-            section("members");
-            for (const auto& member : node.getMembers()) {
-                visitChild(member, 1);
-            }
-            _depth--;
+    private:
+        std::ostream& _out;
+        int _depth = 0;
+
+        void section(const char* label) {
+            writeIndent(_out, _depth);
+            _out << label << ":\n";
         }
+};
 
-        void visit(ProgNode& node) override {
-            writeNode(node);
-            section("classes");
-            for (const auto& cls : node.getClasses()) {
-                visitChild(cls, 1);
-            }
-            section("functions");
-            for (const auto& fn : node.getFunctions()) {
-                visitChild(fn, 1);
+// ============================================================================
+// SUBTREE SIZE
+// ============================================================================
+/**
+ * @class SubtreeSizeCounter
+ * @brief Traversal listener that counts DOT-visible nodes in a subtree.
+ *
+ * @details
+ * Block-level locals are skipped because the DOT graph draws them once, under
+ * the owning function; inherited class names count as their dummy nodes.
+ */
+class SubtreeSizeCounter : public ASTTraversalListener {
+    public:
+        std::size_t count = 0;
+
+        bool enterNode(ASTNode& node, const ASTNode* parent, const ASTChildSlot*) override {
+            if (isBlockLocal(node, parent)) return false;
+            count++;
+            if (auto* cls = dynamic_cast<ClassDeclNode*>(&node)) {
+                count += cls->getParents().size();
             }
-            _depth--;
+            return true;
         }
+};
+
+/**
+ * @brief Count nodes in a subtree, including its root.
+ * @param node Subtree root.
+ * @return Node count.
+ */
+std::size_t countSubtreeNodes(const std::shared_ptr<ASTNode>& node) {
+    SubtreeSizeCounter counter;
+    ASTTraversal::walk(node, counter);
+    return counter.count;
+}
+
+// ============================================================================
+// UML DOT PRINTER
+// ============================================================================
+/** @brief Shape/fill pair for one DOT node category. */
+struct DotNodeStyle {
+    const char* shape;
+    const char* fillcolor;
+};
+
+/** @brief Label/arrow/line style for one DOT edge relation. */
+struct DotEdgeStyle {
+    const char* label;
+    const char* arrowhead;
+    const char* style;
+};
+
+/**
+ * @class DotStyleVisitor
+ * @brief Visitor mapping concrete node kinds to DOT node categories.
+ */
+class DotStyleVisitor : public ASTVisitor {
+    public:
+        DotNodeStyle style{"ellipse", "#F3F3F3"};
+
+        // --- Leaves & Expressions ---
+        void visit(IdNode&) override { set("ellipse", "#F3F3F3"); }
+        void visit(IntLitNode&) override { set("ellipse", "#F3F3F3"); }
+        void visit(FloatLitNode&) override { set("ellipse", "#F3F3F3"); }
+        void visit(TypeNode&) override { set("ellipse", "#F3F3F3"); }
+        void visit(BinaryOpNode&) override { set("ellipse", "#F3F3F3"); }
+        void visit(UnaryOpNode&) override { set("ellipse", "#F3F3F3"); }
+        // --- Variables & Members ---
+        void visit(VarDeclNode&) override { set("note", "#FCE5CD"); }
+        void visit(DataMemberNode&) override { set("note", "#FCE5CD"); }
+        // --- Statements ---
+        void visit(AssignStmtNode&) override { set("box", "#EAD1DC"); }
+        void visit(IOStmtNode&) override { set("box", "#EAD1DC"); }
+        void visit(ReturnStmtNode&) override { set("box", "#EAD1DC"); }
+        void visit(BlockNode&) override { set("box", "#EAD1DC"); }
+        void visit(FuncCallNode&) override { set("box", "#EAD1DC"); }
+        // --- Control Flow ---
+        void visit(WhileStmtNode&) override { set("diamond", "#FFF2CC"); }
+        void visit(IfStmtNode&) override { set("diamond", "#FFF2CC"); }
+        // --- Core UML Structures ---
+        void visit(FuncDefNode&) override { set("Mrecord", "#CFE2F3"); } // Mrecord gives rounded corners to records
+        void visit(ClassDeclNode&) override { set("record", "#D9EAD3"); }
+        void visit(ProgNode&) override { set("folder", "#E8E8E8"); }
 
     private:
-        std::ostringstream _out;
-        int _depth = 0;
+        void set(const char* shape, const char* fillcolor) { style = DotNodeStyle{shape, fillcolor}; }
+};
 
-        void line(const std::string& text, int depth) {
-            _out << makeIndent(depth) << text << "\n";
-        }
+/**
+ * @brief Map a parent slot to the UML edge relation drawn for it.
+ * @param parent Parent node.
+ * @param slotLabel Slot label reported by the parent.
+ * @return Edge label and styling.
+ */
+DotEdgeStyle dotEdgeStyle(const ASTNode& parent, const char* slotLabel) {
+    const std::string label = slotLabel;
+    if (label == "left" || label == "right") {
+        if (dynamic_cast<const AssignStmtNode*>(&parent) != nullptr) {
+            return {label == "left" ? "target" : "value", "vee", "solid"};
+        }
+        if (dynamic_cast<const IOStmtNode*>(&parent) != nullptr && label == "left") return {"target", "vee", "solid"};
+        if (dynamic_cast<const ReturnStmtNode*>(&parent) != nullptr && label == "left") return {"value", "vee", "solid"};
+        return {label == "left" ? "left" : "right", "vee", "solid"};
+    }
+    if (label == "cond") {
+        // If conditions are dashed; while conditions keep the solid default.
+        bool isIf = dynamic_cast<const IfStmtNode*>(&parent) != nullptr;
+        return {"cond", "vee", isIf ? "dashed" : "solid"};
+    }
+    if (label == "then") return {"then", "vee", "solid"};
+    if (label == "else") return {"else", "vee", "solid"};
+    if (label == "body") return {"body", "vee", "solid"};
+    if (label == "owner") return {"owner", "dot", "solid"};
+    if (label == "indices") return {"index", "vee", "dashed"};
+    if (label == "callee") return {"callee", "dot", "solid"};
+    if (label == "args") return {"arg", "vee", "dashed"};
+    if (label == "params") return {"param", "dot", "solid"};
+    if (label == "locals") return {"local", "dot", "solid"};
+    if (label == "members") return {"member", "odiamond", "solid"}; // odiamond represents aggregation/composition
+    if (label == "classes") return {"class", "vee", "solid"};
+    if (label == "functions") return {"function", "vee", "solid"};
+    if (label.empty()) return {"stmt", "vee", "solid"};
+    return {"relation", "vee", "solid"};
+}
 
-        void writeNode(ASTNode& node) {
-            line(nodeLabel(node), _depth);
-            _depth++;
-        }
+/**
+ * @class DotASTPrinter
+ * @brief Traversal listener that serializes AST into UML-styled Graphviz DOT graph.
+ *
+ * @details
+ * Node shapes/colors are category-driven (program/class/function/statement/etc.)
+ * and edge labels encode semantic relations (member, inherits, cond, arg, ...).
+ * A legend subgraph is emitted to keep visualization self-describing.
+ *
+ * Statements are streamed in walk order: each edge is written just before the
+ * child it points to, and node ids live on a stack that mirrors the walk, so no
+ * whole-tree lookup table is kept. Only the current function's locals (shared
+ * between the "locals" list and the body block) are remembered.
+ *
+ * DotExportOptions keep large graphs renderable: classes and function
+ * definitions can be wrapped in subgraph clusters, and subtrees past a depth or
+ * node budget are replaced by one summary node carrying the hidden node count.
+ */
+class DotASTPrinter : public ASTTraversalListener {
+    public:
+        DotASTPrinter(std::ostream& out, const ASTPrinter::DotExportOptions& options) : _out(out), _options(options) {}
 
-        void section(const std::string& label) {
-            line(label + ":", _depth);
+        /** @brief Write graph header and default attributes. */
+        void begin() {
+            _out << "digraph AST {\n";
+            _out << "  rankdir=TB;\n";
+            _out << "  graph [fontname=\"Consolas\", splines=polyline];\n";
+            _out << "  node [fontname=\"Consolas\"];\n";
+            _out << "  edge [fontname=\"Consolas\", fontsize=10];\n\n";
         }
 
-        void visitChild(const std::shared_ptr<ASTNode>& node, int extraIndent) {
-            if (node == nullptr) {
-                line("<null>", _depth + extraIndent);
-                return;
-            }
-            if (extraIndent == 1) {
-                _depth++;
-                node->accept(*this);
-                _depth--;
+        /** @brief Write legend cluster and close the graph. */
+        void finish() {
+            // UML Legend: multi-column reference table
+            _out << "\n  subgraph cluster_legend {\n";
+            _out << "    label = \"AST Legend\";\n";
+            _out << "    fontsize = 12;\n";
+            _out << "    style = dashed;\n";
+            _out << "    node [shape=plaintext];\n";
+            _out << "    legend_table [label=<<TABLE BORDER=\"0\" CELLBORDER=\"1\" CELLSPACING=\"0\">\n";
+            _out << "      <TR><TD BGCOLOR=\"#DDEBF7\"><B>Node Categories</B></TD><TD BGCOLOR=\"#E2F0D9\"><B>Edge Labels</B></TD><TD BGCOLOR=\"#FCE4D6\"><B>Arrow/Style</B></TD></TR>\n";
+            _out << "      <TR><TD BGCOLOR=\"#E8E8E8\">Program: folder</TD><TD>class, function</TD><TD>vee / solid</TD></TR>\n";
+            _out << "      <TR><TD BGCOLOR=\"#D9EAD3\">Class: record</TD><TD>member, inherits</TD><TD>odiamond / empty</TD></TR>\n";
+            _out << "      <TR><TD BGCOLOR=\"#CFE2F3\">Function: Mrecord</TD><TD>param, local, body</TD><TD>dot / solid</TD></TR>\n";
+            _out << "      <TR><TD BGCOLOR=\"#FCE5CD\">Variable/Member: note</TD><TD>owner, index</TD><TD>dot / dashed</TD></TR>\n";
+            _out << "      <TR><TD BGCOLOR=\"#FFF2CC\">Control Flow: diamond</TD><TD>cond, then, else</TD><TD>vee / dashed</TD></TR>\n";
+            _out << "      <TR><TD BGCOLOR=\"#EAD1DC\">Statement/Call: box</TD><TD>target, value, callee, arg</TD><TD>vee / solid,dashed</TD></TR>\n";
+            _out << "      <TR><TD BGCOLOR=\"#F3F3F3\">Expression/Leaf: ellipse</TD><TD>left, right</TD><TD>vee / solid</TD></TR>\n";
+            _out << "    </TABLE>>];\n";
+            _out << "  }\n";
+
+            _out << "}\n";
+        }
+
+        bool enterNode(ASTNode& node, const ASTNode* parent, const ASTChildSlot* slot) override {
+            int id = 0;
+            if (parent == nullptr) {
+                id = _counter++;
             } else {
-                node->accept(*this);
+                auto shared = _localIds.find(&node);
+                bool alreadyDeclared = shared != _localIds.end();
+                id = alreadyDeclared ? shared->second : _counter++;
+                writeEdge(_frames.back().id, id, dotEdgeStyle(*parent, slot->label));
+                if (alreadyDeclared) {
+                    _frames.push_back(Frame{id, false, false});
+                    return false;
+                }
+                if (std::strcmp(slot->label, "locals") == 0) {
+                    // Locals are shared with the body block; remember their ids so the
+                    // block's "stmt" edges point at the same nodes.
+                    _localIds[&node] = id;
+                }
+                if (shouldCollapse()) {
+                    // Leaves are cheaper to draw than a summary of nothing.
+                    std::size_t hidden = countSubtreeNodes(std::shared_ptr<ASTNode>(std::shared_ptr<ASTNode>(), &node)) - 1;
+                    if (hidden > 0) {
+                        declareSummaryNode(id, node, hidden);
+                        _frames.push_back(Frame{id, false, false});
+                        return false;
+                    }
+                }
+            }
+
+            const bool isFunction = dynamic_cast<FuncDefNode*>(&node) != nullptr;
+            if (isFunction) _localIds.clear();
+            const bool clustered = openCluster(node);
+            declareNode(node, id);
+            _frames.push_back(Frame{id, clustered, isFunction});
+
+            if (auto* cls = dynamic_cast<ClassDeclNode*>(&node)) {
+                // UML Inheritance uses an empty arrowhead
+                for (const auto& parentName : cls->getParents()) {
+                    int parentDummyId = _counter++;
+                    _out << "  n" << parentDummyId << " [label=\"";
+                    writeEscapedDotLabel(_out, parentName);
+                    _out << "\", shape=record, style=dashed];\n";
+                    _out << "  n" << id << " -> n" << parentDummyId << " [label=\"inherits\", arrowhead=\"empty\", style=\"solid\"];\n";
+                }
             }
+            return true;
         }
 
-        void visitLeaf(ASTNode& node) {
-            line(nodeLabel(node), _depth);
+        void exitNode(ASTNode&) override {
+            Frame frame = _frames.back();
+            _frames.pop_back();
+            if (frame.ownsLocals) _localIds.clear();
+            if (frame.clustered) _out << "  }\n";
         }
 
-        void visitBinaryLike(ASTNode& node, const std::string& leftLabel = "left", const std::string& rightLabel = "right") {
-            writeNode(node);
-            if (node.getLeft() != nullptr) {
-                section(leftLabel);
-                visitChild(node.getLeft(), 0);
-            }
-            if (node.getRight() != nullptr) {
-                section(rightLabel);
-                visitChild(node.getRight(), 0);
+    private:
+        /** @brief Walk-stack entry for one entered node. */
+        struct Frame {
+            int id;
+            bool clustered;
+            bool ownsLocals;
+        };
+
+        std::ostream& _out;
+        ASTPrinter::DotExportOptions _options;
+        std::vector<Frame> _frames;
+        int _counter = 0;
+        int _clusterCounter = 0;
+        std::size_t _emittedNodes = 0;
+        std::unordered_map<const ASTNode*, int> _localIds; // Current function's locals only.
+
+        void declareNode(ASTNode& node, int id) {
+            DotStyleVisitor styler;
+            node.accept(styler);
+            _emittedNodes++;
+            _out << "  n" << id << " [label=\"";
+            writeNodeLabel(_out, node, true);
+            _out << "\", shape=" << styler.style.shape << ", style=filled, fillcolor=\"" << styler.style.fillcolor << "\"];\n";
+        }
+
+        void writeEdge(int from, int to, const DotEdgeStyle& edge) {
+            _out << "  n" << from << " -> n" << to << " [label=\"";
+            writeEscapedDotLabel(_out, edge.label);
+            _out << "\", arrowhead=\"" << edge.arrowhead << "\", style=\"" << edge.style << "\"];\n";
+        }
+
+        bool shouldCollapse() const {
+            // The parent of the node being entered sits at depth _frames.size() - 1.
+            if (_options.maxDepth > 0 && _frames.size() - 1 >= static_cast<std::size_t>(_options.maxDepth)) return true;
+            return _options.maxNodes > 0 && _emittedNodes >= _options.maxNodes;
+        }
+
+        void declareSummaryNode(int id, ASTNode& node, std::size_t hidden) {
+            _out << "  n" << id << " [label=\"";
+            writeNodeLabel(_out, node, true);
+            _out << "\\n+" << hidden << " collapsed node" << (hidden == 1 ? "" : "s")
+                 << "\", shape=box3d, style=\"filled,dashed\", fillcolor=\"#FFFFFF\"];\n";
+        }
+
+        bool openCluster(ASTNode& node) {
+            if (!_options.clusterScopes) return false;
+            const char* color = nullptr;
+            if (auto* fn = dynamic_cast<FuncDefNode*>(&node)) {
+                // Prototypes inside classes have no body and stay in the class cluster.
+                if (fn->getRight() != nullptr) color = "#CFE2F3";
+            } else if (dynamic_cast<ClassDeclNode*>(&node) != nullptr) {
+                color = "#D9EAD3";
             }
-            _depth--;
+            if (color == nullptr) return false;
+            _out << "  subgraph cluster_scope" << _clusterCounter++ << " {\n";
+            _out << "    label=\"";
+            writeEscapedDotLabel(_out, node.getValue());
+            _out << "\";\n    style=rounded;\n    color=\"" << color << "\";\n";
+            return true;
         }
 };
 
 // ============================================================================
-// UML DOT VISITOR
+// STRUCTURAL HASH
 // ============================================================================
+/** @brief Hash of an absent child slot (distinguishes "no else" from an empty block). */
+constexpr std::uint64_t kNullSubtreeHash = 0x6e756c6c5f617374ULL;
+
+/**
+ * @brief Finalize a 64-bit value with the splitmix64 avalanche step.
+ * @param x Value to mix.
+ * @return Well-distributed 64-bit value.
+ */
+std::uint64_t mix64(std::uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
 /**
- * @class DotASTVisitor
- * @brief Visitor that serializes AST into UML-styled Graphviz DOT graph.
+ * @class NodeHashVisitor
+ * @brief Visitor that seals one node from its payload and its children's hashes.
  *
  * @details
- * Node shapes/colors are category-driven (program/class/function/statement/etc.)
- * and edge labels encode semantic relations (member, inherits, cond, arg, ...).
- * A legend subgraph is emitted to keep visualization self-describing.
+ * Each visit starts from a per-kind tag, folds in the node payload, then folds
+ * in children hashes in order. Children must already be sealed; the hashing
+ * walk guarantees this by sealing nodes post-order.
  */
-class DotASTVisitor : public ASTVisitor {
+class NodeHashVisitor : public ASTVisitor {
     public:
-        std::string dot() const {
-            std::ostringstream out;
-            out << "digraph AST {\n";
-            out << "  rankdir=TB;\n";
-            out << "  graph [fontname=\"Consolas\", splines=polyline];\n";
-            out << "  node [fontname=\"Consolas\"];\n";
-            out << "  edge [fontname=\"Consolas\", fontsize=10];\n\n";
-            
-            for (const auto& n : _nodeLines) out << n << "\n";
-            out << "\n";
-            for (const auto& e : _edgeLines) out << e << "\n";
-            
-            // UML Legend: multi-column reference table
-            out << "\n  subgraph cluster_legend {\n";
-            out << "    label = \"AST Legend\";\n";
-            out << "    fontsize = 12;\n";
-            out << "    style = dashed;\n";
-            out << "    node [shape=plaintext];\n";
-            out << "    legend_table [label=<<TABLE BORDER=\"0\" CELLBORDER=\"1\" CELLSPACING=\"0\">\n";
-            out << "      <TR><TD BGCOLOR=\"#DDEBF7\"><B>Node Categories</B></TD><TD BGCOLOR=\"#E2F0D9\"><B>Edge Labels</B></TD><TD BGCOLOR=\"#FCE4D6\"><B>Arrow/Style</B></TD></TR>\n";
-            out << "      <TR><TD BGCOLOR=\"#E8E8E8\">Program: folder</TD><TD>class, function</TD><TD>vee / solid</TD></TR>\n";
-            out << "      <TR><TD BGCOLOR=\"#D9EAD3\">Class: record</TD><TD>member, inherits</TD><TD>odiamond / empty</TD></TR>\n";
-            out << "      <TR><TD BGCOLOR=\"#CFE2F3\">Function: Mrecord</TD><TD>param, local, body</TD><TD>dot / solid</TD></TR>\n";
-            out << "      <TR><TD BGCOLOR=\"#FCE5CD\">Variable/Member: note</TD><TD>owner, index</TD><TD>dot / dashed</TD></TR>\n";
-            out << "      <TR><TD BGCOLOR=\"#FFF2CC\">Control Flow: diamond</TD><TD>cond, then, else</TD><TD>vee / dashed</TD></TR>\n";
-            out << "      <TR><TD BGCOLOR=\"#EAD1DC\">Statement/Call: box</TD><TD>target, value, callee, arg</TD><TD>vee / solid,dashed</TD></TR>\n";
-            out << "      <TR><TD BGCOLOR=\"#F3F3F3\">Expression/Leaf: ellipse</TD><TD>left, right</TD><TD>vee / solid</TD></TR>\n";
-            out << "    </TABLE>>];\n";
-            out << "  }\n";
-
-            out << "}\n";
-            return out.str();
-        }
-
-        // --- Leaves & Expressions ---
-        void visit(IdNode& node) override { declareNode(node, "ellipse", "#F3F3F3"); }
-        void visit(IntLitNode& node) override { declareNode(node, "ellipse", "#F3F3F3"); }
-        void visit(FloatLitNode& node) override { declareNode(node, "ellipse", "#F3F3F3"); }
-        void visit(TypeNode& node) override { declareNode(node, "ellipse", "#F3F3F3"); }
-        void visit(BinaryOpNode& node) override { 
-            declareNode(node, "ellipse", "#F3F3F3");
-            visitBinaryLike(node); 
-        }
-        void visit(UnaryOpNode& node) override { 
-            declareNode(node, "ellipse", "#F3F3F3");
-            visitBinaryLike(node); 
+        void visit(IdNode& node) override { seal(node, begin(1).text(node.getName())); }
+        void visit(IntLitNode& node) override { seal(node, begin(2).number(static_cast<std::uint64_t>(static_cast<std::int64_t>(node.getIntValue())))); }
+        void visit(FloatLitNode& node) override {
+            float value = node.getFloatValue();
+            std::uint32_t bits = 0;
+            std::memcpy(&bits, &value, sizeof(bits));
+            seal(node, begin(3).number(bits));
+        }
+        void visit(TypeNode& node) override { seal(node, begin(4).text(node.getTypeName())); }
+        void visit(BinaryOpNode& node) override { seal(node, binaryLike(begin(5).text(node.getOperator()), node)); }
+        void visit(UnaryOpNode& node) override { seal(node, binaryLike(begin(6).text(node.getOperator()), node)); }
+        void visit(FuncCallNode& node) override {
+            Accumulator acc = binaryLike(begin(7).text(node.getFunctionName()), node);
+            seal(node, children(acc, node.getArgs()));
         }
-
-        // --- Variables & Members ---
-        void visit(VarDeclNode& node) override { declareNode(node, "note", "#FCE5CD"); }
         void visit(DataMemberNode& node) override {
-            declareNode(node, "note", "#FCE5CD");
-            visitChild(node, node.getLeft(), "owner", "dot", "solid");
-            for (const auto& idx : node.getIndices()) visitChild(node, idx, "index", "vee", "dashed");
+            Accumulator acc = binaryLike(begin(8).text(node.getName()), node);
+            seal(node, children(acc, node.getIndices()));
         }
-
-        // --- Statements ---
-        void visit(AssignStmtNode& node) override { 
-            declareNode(node, "box", "#EAD1DC");
-            visitBinaryLike(node, "target", "value"); 
-        }
-        void visit(IOStmtNode& node) override { 
-            declareNode(node, "box", "#EAD1DC");
-            visitChild(node, node.getLeft(), "target"); 
-        }
-        void visit(ReturnStmtNode& node) override { 
-            declareNode(node, "box", "#EAD1DC");
-            visitChild(node, node.getLeft(), "value"); 
-        }
-        void visit(BlockNode& node) override {
-            declareNode(node, "box", "#EAD1DC");
-            for (const auto& stmt : node.getStatements()) visitChild(node, stmt, "stmt");
+        void visit(AssignStmtNode& node) override { seal(node, binaryLike(begin(9), node)); }
+        void visit(IfStmtNode& node) override {
+            Accumulator acc = binaryLike(begin(10), node);
+            seal(node, acc.number(childHash(node.getElseBlock())));
+        }
+        void visit(WhileStmtNode& node) override { seal(node, binaryLike(begin(11), node)); }
+        void visit(IOStmtNode& node) override { seal(node, binaryLike(begin(12).text(node.getValue()), node)); }
+        void visit(ReturnStmtNode& node) override { seal(node, binaryLike(begin(13), node)); }
+        void visit(BlockNode& node) override { seal(node, children(begin(14), node.getStatements())); }
+        void visit(VarDeclNode& node) override {
+            Accumulator acc = begin(15).text(node.getTypeName()).text(node.getName()).text(node.getVisibility());
+            const std::vector<int> dims = node.getDimensions();
+            acc.number(dims.size());
+            for (int dim : dims) acc.number(static_cast<std::uint64_t>(static_cast<std::int64_t>(dim)));
+            seal(node, acc);
         }
-        void visit(FuncCallNode& node) override {
-            declareNode(node, "box", "#EAD1DC");
-            visitChild(node, node.getLeft(), "callee", "dot");
-            for (const auto& arg : node.getArgs()) visitChild(node, arg, "arg", "vee", "dashed");
+        void visit(FuncDefNode& node) override {
+            Accumulator acc = begin(16).text(node.getReturnType()).text(node.getName()).text(node.getClassName());
+            children(acc, node.getParams());
+            children(acc, node.getLocalVars());
+            seal(node, acc.number(childHash(node.getRight())));
         }
-
-        // --- Control Flow ---
-        void visit(WhileStmtNode& node) override { 
-            declareNode(node, "diamond", "#FFF2CC");
-            visitBinaryLike(node, "cond", "body"); 
+        void visit(ClassDeclNode& node) override {
+            Accumulator acc = begin(17).text(node.getName());
+            const std::vector<std::string> parents = node.getParents();
+            acc.number(parents.size());
+            for (const auto& parent : parents) acc.text(parent);
+            seal(node, children(acc, node.getMembers()));
         }
-        void visit(IfStmtNode& node) override {
-            declareNode(node, "diamond", "#FFF2CC");
-            visitChild(node, node.getLeft(), "cond", "vee", "dashed");
-            visitChild(node, node.getRight(), "then");
-            visitChild(node, node.getElseBlock(), "else");
+        void visit(ProgNode& node) override {
+            Accumulator acc = begin(18);
+            children(acc, node.getClasses());
+            seal(node, children(acc, node.getFunctions()));
         }
 
-        // --- Core UML Structures ---
-        void visit(FuncDefNode& node) override {
-            declareNode(node, "Mrecord", "#CFE2F3"); // Mrecord gives rounded corners to records
-            for (const auto& param : node.getParams()) visitChild(node, param, "param", "dot");
-            for (const auto& local : node.getLocalVars()) visitChild(node, local, "local", "dot");
-            visitChild(node, node.getRight(), "body");
-        }
+    private:
+        /** @brief Running hash state for one node. */
+        struct Accumulator {
+            std::uint64_t state;
 
-        void visit(ClassDeclNode& node) override {
-            declareNode(node, "record", "#D9EAD3"); 
-            
-            // UML Inheritance uses an empty arrowhead
-            for (const auto& parentName : node.getParents()) {
-                std::string parentDummyId = "n" + std::to_string(_counter++);
-                _nodeLines.push_back("  " + parentDummyId + " [label=\"" + escapeDotLabel(parentName) + "\", shape=record, style=dashed];");
-                
-                std::string myId = getNodeId(&node);
-                _edgeLines.push_back("  " + myId + " -> " + parentDummyId + " [label=\"inherits\", arrowhead=\"empty\", style=\"solid\"];");
+            Accumulator& number(std::uint64_t value) {
+                state = mix64(state ^ mix64(value));
+                return *this;
             }
 
-            for (const auto& member : node.getMembers()) {
-                visitChild(node, member, "member", "odiamond"); // odiamond represents aggregation/composition
+            Accumulator& text(const std::string& value) {
+                // FNV-1a over the bytes, length-prefixed so "ab"+"c" != "a"+"bc".
+                std::uint64_t h = 0xcbf29ce484222325ULL;
+                for (unsigned char c : value) {
+                    h ^= c;
+                    h *= 0x100000001b3ULL;
+                }
+                number(value.size());
+                return number(h);
             }
-        }
+        };
 
-        void visit(ProgNode& node) override {
-            declareNode(node, "folder", "#E8E8E8");
-            for (const auto& cls : node.getClasses()) visitChild(node, cls, "class");
-            for (const auto& fn : node.getFunctions()) visitChild(node, fn, "function");
+        static std::uint64_t childHash(const std::shared_ptr<ASTNode>& node) {
+            return node == nullptr ? kNullSubtreeHash : node->getStructuralHash();
         }
 
-    private:
-        std::unordered_map<const ASTNode*, std::string> _ids;
-        std::unordered_set<const ASTNode*> _declared;
-        std::vector<std::string> _nodeLines;
-        std::vector<std::string> _edgeLines;
-        int _counter = 0;
+        Accumulator begin(std::uint64_t kindTag) { return Accumulator{mix64(kindTag)}; }
 
-        std::string getNodeId(const ASTNode* ptr) {
-            auto it = _ids.find(ptr);
-            if (it != _ids.end()) return it->second;
-            std::string id = "n" + std::to_string(_counter++);
-            _ids[ptr] = id;
-            return id;
+        Accumulator& binaryLike(Accumulator& acc, ASTNode& node) {
+            acc.number(childHash(node.getLeft()));
+            return acc.number(childHash(node.getRight()));
         }
+        Accumulator binaryLike(Accumulator&& acc, ASTNode& node) { return binaryLike(acc, node); }
 
-        void declareNode(ASTNode& node, const std::string& shape, const std::string& fillcolor) {
-            const ASTNode* ptr = &node;
-            if (_declared.count(ptr)) return; // Already customized
-            _declared.insert(ptr);
-            
-            std::string id = getNodeId(ptr);
-            _nodeLines.push_back("  " + id + " [label=\"" + escapeDotLabel(nodeLabel(node)) + "\", shape=" + shape + ", style=filled, fillcolor=\"" + fillcolor + "\"];");
+        template <typename NodePtr>
+        Accumulator& children(Accumulator& acc, const std::vector<NodePtr>& nodes) {
+            acc.number(nodes.size());
+            for (const auto& child : nodes) acc.number(childHash(child));
+            return acc;
         }
+        template <typename NodePtr>
+        Accumulator children(Accumulator&& acc, const std::vector<NodePtr>& nodes) { return children(acc, nodes); }
 
-        void addEdge(ASTNode& parent, ASTNode& child, const std::string& label, const std::string& arrowhead, const std::string& style) {
-            std::string from = getNodeId(&parent);
-            std::string to = getNodeId(&child);
-            std::string safeLabel = label.empty() ? "relation" : label;
-            _edgeLines.push_back("  " + from + " -> " + to + " [label=\"" + escapeDotLabel(safeLabel) + "\", arrowhead=\"" + arrowhead + "\", style=\"" + style + "\"];");
-        }
+        static void seal(ASTNode& node, const Accumulator& acc) { node.setStructuralHash(acc.state); }
+};
 
-        void visitChild(ASTNode& parent, const std::shared_ptr<ASTNode>& child, const std::string& label, const std::string& arrowhead = "vee", const std::string& style = "solid") {
-            if (child == nullptr) return;
-            addEdge(parent, *child, label, arrowhead, style);
-            child->accept(*this);
+/**
+ * @class StructuralHashListener
+ * @brief Traversal listener sealing unsealed nodes post-order.
+ *
+ * @details
+ * Already sealed subtrees are skipped entirely, so sealing statements as they
+ * are parsed and then sealing the enclosing function touches every node once.
+ */
+class StructuralHashListener : public ASTTraversalListener {
+    public:
+        bool enterNode(ASTNode& node, const ASTNode*, const ASTChildSlot*) override {
+            return !node.hasStructuralHash();
         }
 
-        void visitBinaryLike(ASTNode& node, const std::string& leftLabel = "left", const std::string& rightLabel = "right") {
-            visitChild(node, node.getLeft(), leftLabel);
-            visitChild(node, node.getRight(), rightLabel);
+        void exitNode(ASTNode& node) override {
+            if (!node.hasStructuralHash()) node.accept(_hasher);
         }
+
+    private:
+        NodeHashVisitor _hasher;
 };
 }
 
+// ============================================================================
+// CHILD SLOTS
+// ============================================================================
+/** @brief Default slots: non-null left/right children. */
+void ASTNode::collectChildSlots(std::vector<ASTChildSlot>& slots) const {
+    if (left != nullptr) slots.push_back(ASTChildSlot{"left", false, {left}});
+    if (right != nullptr) slots.push_back(ASTChildSlot{"right", false, {right}});
+}
+
+/** @brief Call slots: optional callee/receiver, then argument list. */
+void FuncCallNode::collectChildSlots(std::vector<ASTChildSlot>& slots) const {
+    if (getLeft() != nullptr) slots.push_back(ASTChildSlot{"callee", false, {getLeft()}});
+    slots.push_back(ASTChildSlot{"args", true, arguments});
+}
+
+/** @brief Member-access slots: optional owner, then non-empty index list. */
+void DataMemberNode::collectChildSlots(std::vector<ASTChildSlot>& slots) const {
+    if (getLeft() != nullptr) slots.push_back(ASTChildSlot{"owner", false, {getLeft()}});
+    if (!indices.empty()) slots.push_back(ASTChildSlot{"indices", true, indices});
+}
+
+/** @brief If slots: condition and then-branch always, else-branch when present. */
+void IfStmtNode::collectChildSlots(std::vector<ASTChildSlot>& slots) const {
+    slots.push_back(ASTChildSlot{"cond", false, {getLeft()}});
+    slots.push_back(ASTChildSlot{"then", false, {getRight()}});
+    if (elseBlock != nullptr) slots.push_back(ASTChildSlot{"else", false, {elseBlock}});
+}
+
+/** @brief While slots: condition and body when present. */
+void WhileStmtNode::collectChildSlots(std::vector<ASTChildSlot>& slots) const {
+    if (getLeft() != nullptr) slots.push_back(ASTChildSlot{"cond", false, {getLeft()}});
+    if (getRight() != nullptr) slots.push_back(ASTChildSlot{"body", false, {getRight()}});
+}
+
+/** @brief Block slot: the statement sequence (unlabeled). */
+void BlockNode::collectChildSlots(std::vector<ASTChildSlot>& slots) const {
+    slots.push_back(ASTChildSlot{"", false, statements});
+}
+
+/** @brief Function slots: params, locals, then body (null for prototypes). */
+void FuncDefNode::collectChildSlots(std::vector<ASTChildSlot>& slots) const {
+    slots.push_back(ASTChildSlot{"params", true, {parameters.begin(), parameters.end()}});
+    slots.push_back(ASTChildSlot{"locals", true, {localVariables.begin(), localVariables.end()}});
+    slots.push_back(ASTChildSlot{"body", false, {getRight()}});
+}
+
+/** @brief Class slot: member declarations (inherited names are not nodes). */
+void ClassDeclNode::collectChildSlots(std::vector<ASTChildSlot>& slots) const {
+    slots.push_back(ASTChildSlot{"members", true, members});
+}
+
+/** @brief Program slots: classes then functions. */
+void ProgNode::collectChildSlots(std::vector<ASTChildSlot>& slots) const {
+    slots.push_back(ASTChildSlot{"classes", true, {classes.begin(), classes.end()}});
+    slots.push_back(ASTChildSlot{"functions", true, {functions.begin(), functions.end()}});
+}
+
+// ============================================================================
+// TRAVERSAL DRIVER
+// ============================================================================
+/**
+ * @brief Walk a subtree depth-first with an explicit, heap-allocated stack.
+ * @param root Subtree root (null walks nothing).
+ * @param listener Callback receiver.
+ *
+ * @details
+ * Each frame owns its node's slot list and a cursor (slot index, child index),
+ * so resuming a parent after a child finishes is a constant-time step.
+ */
+void ASTTraversal::walk(const std::shared_ptr<ASTNode>& root, ASTTraversalListener& listener) {
+    if (root == nullptr) return;
+
+    struct Frame {
+        std::shared_ptr<ASTNode> node;
+        std::vector<ASTChildSlot> slots;
+        std::size_t slotIndex = 0;
+        std::size_t childIndex = 0;
+        bool slotOpen = false;
+    };
+    std::vector<Frame> stack;
+
+    auto enter = [&](const std::shared_ptr<ASTNode>& node, const ASTNode* parent, const ASTChildSlot* slot) {
+        if (!listener.enterNode(*node, parent, slot)) {
+            listener.exitNode(*node);
+            return;
+        }
+        Frame frame;
+        frame.node = node;
+        node->collectChildSlots(frame.slots);
+        stack.push_back(std::move(frame));
+    };
+
+    enter(root, nullptr, nullptr);
+    while (!stack.empty()) {
+        if (listener.stopRequested()) return;
+
+        Frame& top = stack.back();
+        if (top.slotIndex == top.slots.size()) {
+            std::shared_ptr<ASTNode> node = std::move(top.node);
+            stack.pop_back();
+            listener.exitNode(*node);
+            continue;
+        }
+
+        const ASTChildSlot& slot = top.slots[top.slotIndex];
+        if (!top.slotOpen) {
+            listener.enterSlot(*top.node, slot);
+            top.slotOpen = true;
+        }
+        if (top.childIndex < slot.nodes.size()) {
+            std::shared_ptr<ASTNode> child = slot.nodes[top.childIndex++];
+            if (child == nullptr) {
+                listener.nullChild(*top.node, slot);
+            } else {
+                // enter() may grow the stack; the slot lives in the frame's own heap
+                // buffer, which moves with the frame without being reallocated.
+                enter(child, top.node.get(), &slot);
+            }
+            continue;
+        }
+
+        listener.exitSlot(*top.node, slot);
+        top.slotIndex++;
+        top.childIndex = 0;
+        top.slotOpen = false;
+    }
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+/**
+ * @brief Stream text AST representation into an output stream.
+ * @param root AST root node.
+ * @param out Destination stream.
+ */
+void ASTPrinter::write(const std::shared_ptr<ASTNode>& root, std::ostream& out) {
+    if (root == nullptr) {
+        out << "<null>\n";
+        return;
+    }
+    TextASTPrinter printer(out);
+    ASTTraversal::walk(root, printer);
+}
+
 /**
  * @brief Convert AST root to text format.
  * @param root AST root node.
  * @return Text tree representation ("<null>" for empty root).
  */
 std::string ASTPrinter::toString(const std::shared_ptr<ASTNode>& root) {
-    TextASTVisitor visitor;
-    if (root == nullptr) return "<null>\n";
-    root->accept(visitor);
-    return visitor.str();
+    std::ostringstream out;
+    ASTPrinter::write(root, out);
+    return out.str();
 }
 
 /**
  * @brief Write text AST representation to file.
  * @param root AST root node.
  * @param filePath Destination path.
- * @return True on success, false on file-open failure.
+ * @return True on success, false on file-open or write failure.
  */
 bool ASTPrinter::writeToFile(const std::shared_ptr<ASTNode>& root, const std::string& filePath) {
-    std::ofstream file(filePath, std::ios::out | std::ios::trunc);
-    if (!file.is_open()) return false;
-    file << ASTPrinter::toString(root);
-    return true;
+    BufferedFileSink sink(filePath);
+    if (!sink.isOpen()) return false;
+    ASTPrinter::write(root, sink.stream());
+    return sink.close();
+}
+
+/**
+ * @brief Stream Graphviz DOT representation into an output stream.
+ * @param root AST root node.
+ * @param out Destination stream.
+ * @param options Clustering/collapsing controls.
+ */
+void ASTPrinter::writeDot(const std::shared_ptr<ASTNode>& root, std::ostream& out, const DotExportOptions& options) {
+    DotASTPrinter printer(out, options);
+    printer.begin();
+    ASTTraversal::walk(root, printer);
+    printer.finish();
 }
 
 /**
  * @brief Convert AST root to Graphviz DOT format.
  * @param root AST root node.
+ * @param options Clustering/collapsing controls.
  * @return DOT graph text.
  */
-std::string ASTPrinter::toDot(const std::shared_ptr<ASTNode>& root) {
-    DotASTVisitor visitor;
-    if (root != nullptr) root->accept(visitor);
-    return visitor.dot();
+std::string ASTPrinter::toDot(const std::shared_ptr<ASTNode>& root, const DotExportOptions& options) {
+    std::ostringstream out;
+    ASTPrinter::writeDot(root, out, options);
+    return out.str();
 }
 
 /**
  * @brief Write DOT AST representation to file.
  * @param root AST root node.
  * @param filePath Destination path.
- * @return True on success, false on file-open failure.
+ * @param options Clustering/collapsing controls.
+ * @return True on success, false on file-open or write failure.
  */
-bool ASTPrinter::writeDotToFile(const std::shared_ptr<ASTNode>& root, const std::string& filePath) {
-    std::ofstream file(filePath, std::ios::out | std::ios::trunc);
-    if (!file.is_open()) return false;
-    file << ASTPrinter::toDot(root);
-    return true;
-}
\ No newline at end of file
+bool ASTPrinter::writeDotToFile(const std::shared_ptr<ASTNode>& root, const std::string& filePath, const DotExportOptions& options) {
+    BufferedFileSink sink(filePath);
+    if (!sink.isOpen()) return false;
+    ASTPrinter::writeDot(root, sink.stream(), options);
+    return sink.close();
+}
+
+/**
+ * @brief Write one DOT graph per function definition.
+ * @param root Program AST root.
+ * @param pathPrefix Destination prefix; files are named
+ *        "<prefix>.fnNNN_<Class__name>.outast.dot".
+ * @param options Clustering/collapsing controls applied to each graph.
+ * @return Paths of the files written (empty when root is not a program).
+ * @throws std::runtime_error When a destination file cannot be written.
+ */
+std::vector<std::string> ASTPrinter::writeDotPerFunction(const std::shared_ptr<ASTNode>& root, const std::string& pathPrefix, const DotExportOptions& options) {
+    std::vector<std::string> written;
+    std::shared_ptr<ProgNode> program = std::dynamic_pointer_cast<ProgNode>(root);
+    if (program == nullptr) return written;
+
+    std::size_t index = 0;
+    for (const auto& fn : program->getFunctions()) {
+        if (fn == nullptr) continue;
+        std::string name = fn->getClassName().empty() ? fn->getName() : fn->getClassName() + "__" + fn->getName();
+        std::string ordinal = std::to_string(index++);
+        ordinal.insert(0, ordinal.size() < 3 ? 3 - ordinal.size() : 0, '0');
+        std::string filePath = pathPrefix + ".fn" + ordinal + "_" + name + ".outast.dot";
+
+        BufferedFileSink sink(filePath);
+        if (!sink.isOpen()) {
+            throw std::runtime_error("Failed to open DOT output file: " + filePath);
+        }
+        ASTPrinter::writeDot(fn, sink.stream(), options);
+        if (!sink.close()) {
+            throw std::runtime_error("Failed to write DOT output file: " + filePath);
+        }
+        written.push_back(filePath);
+    }
+    return written;
+}
+
+/**
+ * @brief Compute structural hash of a subtree, sealing every unsealed node in it.
+ * @param node Subtree root (may be null).
+ * @return 64-bit structural hash.
+ */
+std::uint64_t ASTHasher::hashSubtree(const std::shared_ptr<ASTNode>& node) {
+    if (node == nullptr) return kNullSubtreeHash;
+    StructuralHashListener listener;
+    ASTTraversal::walk(node, listener);
+    return node->getStructuralHash();
+}
+
+/**
+ * @brief Format structural hash for logs and dashboards.
+ * @param hash Hash value.
+ * @return 16-digit lowercase hexadecimal string.
+ */
+std::string ASTHasher::toHex(std::uint64_t hash) {
+    static const char kDigits[] = "0123456789abcdef";
+    std::string text(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        text[static_cast<std::size_t>(i)] = kDigits[hash & 0xF];
+        hash >>= 4;
+    }
+    return text;
+}
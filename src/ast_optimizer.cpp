@@ -0,0 +1,509 @@
+#include "../include/ast_optimizer.h"
+#include "../include/codegen.h"
+
+#include <cstdint>
+#include <limits>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @file ast_optimizer.cpp
+ * @brief Constant folding, single-assignment constant propagation, and identity rewrites.
+ */
+
+namespace {
+/** @brief Range of a Moon addi immediate, which every literal is lowered to. */
+constexpr long long kImmediateMin = -32768;
+constexpr long long kImmediateMax = 32767;
+
+/** @brief True when a value fits a 32-bit Moon register word. */
+bool fitsWord(long long value) {
+    return value >= std::numeric_limits<std::int32_t>::min() && value <= std::numeric_limits<std::int32_t>::max();
+}
+
+bool isArithmeticOperator(const std::string& op) {
+    return op == "+" || op == "-" || op == "*" || op == "/" || op == "mod";
+}
+
+bool isComparisonOperator(const std::string& op) {
+    return op == "==" || op == "!=" || op == "<" || op == "<=" || op == ">" || op == ">=";
+}
+
+bool isLogicalOperator(const std::string& op) {
+    return op == "and" || op == "or" || op == "&&" || op == "||";
+}
+
+/**
+ * @brief Name of an identifier or member access without owner and indices.
+ * @return Empty for any other node.
+ */
+std::string plainName(const std::shared_ptr<ASTNode>& node) {
+    if (node == nullptr || node->getLeft() != nullptr) {
+        return "";
+    }
+    if (auto id = std::dynamic_pointer_cast<IdNode>(node)) {
+        return id->getName();
+    }
+    if (auto member = std::dynamic_pointer_cast<DataMemberNode>(node)) {
+        return member->getIndices().empty() ? member->getName() : "";
+    }
+    return "";
+}
+
+/**
+ * @class LocalWriteCounter
+ * @brief Traversal listener counting writes to plain names in a function body.
+ *
+ * @details
+ * Assignments count once; read statements count twice so their target is never
+ * treated as assigned exactly once.
+ */
+class LocalWriteCounter : public ASTTraversalListener {
+    public:
+        explicit LocalWriteCounter(std::unordered_map<std::string, int>& writes) : _writes(writes) {}
+
+        bool enterNode(ASTNode& node, const ASTNode*, const ASTChildSlot*) override {
+            if (auto* assign = dynamic_cast<AssignStmtNode*>(&node)) {
+                const std::string name = plainName(assign->getLeft());
+                if (!name.empty()) {
+                    ++_writes[name];
+                }
+            } else if (auto* io = dynamic_cast<IOStmtNode*>(&node)) {
+                const std::string name = plainName(io->getLeft());
+                if (io->getValue() == "read" && !name.empty()) {
+                    _writes[name] += 2;
+                }
+            }
+            return true;
+        }
+
+    private:
+        std::unordered_map<std::string, int>& _writes;
+};
+
+/**
+ * @brief Check that evaluating an expression has no side effects.
+ * @details Only calls have side effects in expressions. Owners are followed
+ * through left children directly because IdNode reports no child slots.
+ */
+bool isPure(const std::shared_ptr<ASTNode>& expression) {
+    if (expression == nullptr) {
+        return true;
+    }
+    if (std::dynamic_pointer_cast<FuncCallNode>(expression) != nullptr) {
+        return false;
+    }
+    if (auto member = std::dynamic_pointer_cast<DataMemberNode>(expression)) {
+        for (const auto& index : member->getIndices()) {
+            if (!isPure(index)) {
+                return false;
+            }
+        }
+    }
+    return isPure(expression->getLeft()) && isPure(expression->getRight());
+}
+}
+
+/**
+ * @brief Rebuild every function definition; classes are shared unchanged.
+ */
+std::shared_ptr<ProgNode> ASTOptimizer::optimize(const std::shared_ptr<ProgNode>& root) {
+    _stats = ASTOptimizerStats();
+    if (root == nullptr) {
+        return nullptr;
+    }
+
+    auto optimized = std::make_shared<ProgNode>(root->getLineNumber());
+    for (const auto& cls : root->getClasses()) {
+        optimized->addClass(cls);
+    }
+    for (const auto& function : root->getFunctions()) {
+        optimized->addFunction(optimizeFunction(function));
+    }
+    return optimized;
+}
+
+/**
+ * @brief Rewrite a function body, recording constants of single-assignment locals.
+ *
+ * @details
+ * Top-level statements are rewritten in order; after a qualifying assignment is
+ * rewritten (so its right-hand side is already folded), its constant applies to
+ * every following statement.
+ */
+std::shared_ptr<FuncDefNode> ASTOptimizer::optimizeFunction(const std::shared_ptr<FuncDefNode>& function) {
+    if (function == nullptr || function->getRight() == nullptr) {
+        return function;
+    }
+
+    _scalarTypes.clear();
+    _constants.clear();
+    auto copy = std::make_shared<FuncDefNode>(function->getLineNumber(), function->getReturnType(), function->getName(),
+                                              function->getClassName());
+    auto recordScalar = [&](const std::shared_ptr<VarDeclNode>& decl) {
+        const std::string& type = decl->getTypeName();
+        if (decl->getDimensions().empty() && (type == "integer" || type == "float")) {
+            _scalarTypes[decl->getName()] = type;
+            return true;
+        }
+        return false;
+    };
+
+    for (const auto& param : function->getParams()) {
+        copy->addParam(param);
+        recordScalar(param);
+    }
+    std::unordered_set<std::string> candidates;
+    for (const auto& local : function->getLocalVars()) {
+        copy->addLocalVar(local);
+        if (recordScalar(local)) {
+            candidates.insert(local->getName());
+        }
+    }
+
+    std::unordered_map<std::string, int> writes;
+    LocalWriteCounter counter(writes);
+    ASTTraversal::walk(function->getRight(), counter);
+
+    auto body = std::dynamic_pointer_cast<BlockNode>(function->getRight());
+    if (body == nullptr) {
+        copy->setRight(rewriteStatement(function->getRight()));
+        return copy;
+    }
+
+    auto block = std::make_shared<BlockNode>(body->getLineNumber());
+    for (const auto& statement : body->getStatements()) {
+        auto rewritten = rewriteStatement(statement);
+        block->addStatement(rewritten);
+
+        auto assign = std::dynamic_pointer_cast<AssignStmtNode>(rewritten);
+        const std::string name = assign != nullptr ? plainName(assign->getLeft()) : "";
+        Constant value;
+        if (name.empty() || candidates.count(name) == 0 || writes[name] != 1 || !constantOf(assign->getRight(), value)) {
+            continue;
+        }
+        if (_scalarTypes[name] == "float" && !value.isFloat) {
+            // The store promotes an integer right-hand side to fixed point.
+            value.isFloat = true;
+            value.word *= kMoonFloatScale;
+        }
+        if (value.isFloat == (_scalarTypes[name] == "float") && makeLiteral(0, value) != nullptr) {
+            _constants[name] = value;
+        }
+    }
+    copy->setRight(block);
+    return copy;
+}
+
+std::shared_ptr<ASTNode> ASTOptimizer::rewriteStatement(const std::shared_ptr<ASTNode>& statement) {
+    if (statement == nullptr) {
+        return nullptr;
+    }
+    const int line = statement->getLineNumber();
+
+    if (std::dynamic_pointer_cast<AssignStmtNode>(statement) != nullptr) {
+        return std::make_shared<AssignStmtNode>(line, rewriteAccess(statement->getLeft(), false),
+                                                rewriteExpression(statement->getRight()));
+    }
+    if (auto ifStmt = std::dynamic_pointer_cast<IfStmtNode>(statement)) {
+        return std::make_shared<IfStmtNode>(line, rewriteExpression(ifStmt->getLeft()), rewriteStatement(ifStmt->getRight()),
+                                            rewriteStatement(ifStmt->getElseBlock()));
+    }
+    if (std::dynamic_pointer_cast<WhileStmtNode>(statement) != nullptr) {
+        return std::make_shared<WhileStmtNode>(line, rewriteExpression(statement->getLeft()), rewriteStatement(statement->getRight()));
+    }
+    if (auto io = std::dynamic_pointer_cast<IOStmtNode>(statement)) {
+        const bool isRead = io->getValue() == "read";
+        return std::make_shared<IOStmtNode>(line, io->getValue(),
+                                            isRead ? rewriteAccess(io->getLeft(), false) : rewriteExpression(io->getLeft()));
+    }
+    if (std::dynamic_pointer_cast<ReturnStmtNode>(statement) != nullptr) {
+        return std::make_shared<ReturnStmtNode>(line, rewriteExpression(statement->getLeft()));
+    }
+    if (auto block = std::dynamic_pointer_cast<BlockNode>(statement)) {
+        auto copy = std::make_shared<BlockNode>(line);
+        for (const auto& nested : block->getStatements()) {
+            copy->addStatement(rewriteStatement(nested));
+        }
+        return copy;
+    }
+    return rewriteExpression(statement);
+}
+
+std::shared_ptr<ASTNode> ASTOptimizer::rewriteExpression(const std::shared_ptr<ASTNode>& expression) {
+    if (expression == nullptr) {
+        return nullptr;
+    }
+    const int line = expression->getLineNumber();
+
+    if (std::dynamic_pointer_cast<IdNode>(expression) != nullptr ||
+        std::dynamic_pointer_cast<DataMemberNode>(expression) != nullptr) {
+        return rewriteAccess(expression, true);
+    }
+    if (auto call = std::dynamic_pointer_cast<FuncCallNode>(expression)) {
+        auto copy = std::make_shared<FuncCallNode>(line, call->getFunctionName());
+        if (call->getLeft() != nullptr) {
+            copy->setLeft(rewriteAccess(call->getLeft(), false));
+        }
+        for (const auto& arg : call->getArgs()) {
+            copy->addArgument(rewriteExpression(arg));
+        }
+        copy->setAnnotation(call->getSharedAnnotation());
+        return copy;
+    }
+    if (auto unary = std::dynamic_pointer_cast<UnaryOpNode>(expression)) {
+        auto operand = rewriteExpression(unary->getLeft());
+        if (unary->getOperator() == "+") {
+            ++_stats.simplifiedIdentities;
+            return operand;
+        }
+        Constant value;
+        if (unary->getOperator() == "-" && constantOf(operand, value)) {
+            value.word = -value.word;
+            if (auto literal = makeLiteral(line, value)) {
+                ++_stats.foldedExpressions;
+                return literal;
+            }
+        }
+        auto copy = std::make_shared<UnaryOpNode>(line, unary->getOperator(), operand);
+        copy->setAnnotation(unary->getSharedAnnotation());
+        return copy;
+    }
+    if (auto binary = std::dynamic_pointer_cast<BinaryOpNode>(expression)) {
+        return rewriteBinary(*binary, rewriteExpression(binary->getLeft()), rewriteExpression(binary->getRight()));
+    }
+    return expression;
+}
+
+std::shared_ptr<ASTNode> ASTOptimizer::rewriteAccess(const std::shared_ptr<ASTNode>& access, bool substitute) {
+    if (access == nullptr) {
+        return nullptr;
+    }
+    const int line = access->getLineNumber();
+
+    if (substitute) {
+        auto it = _constants.find(plainName(access));
+        if (it != _constants.end()) {
+            ++_stats.propagatedConstants;
+            return makeLiteral(line, it->second);
+        }
+    }
+
+    if (auto id = std::dynamic_pointer_cast<IdNode>(access)) {
+        auto copy = std::make_shared<IdNode>(line, id->getName());
+        copy->setLeft(rewriteExpression(id->getLeft()));
+        copy->setAnnotation(id->getSharedAnnotation());
+        return copy;
+    }
+    if (auto member = std::dynamic_pointer_cast<DataMemberNode>(access)) {
+        auto copy = std::make_shared<DataMemberNode>(line, member->getName());
+        copy->setLeft(rewriteExpression(member->getLeft()));
+        for (const auto& index : member->getIndices()) {
+            copy->addIndex(rewriteExpression(index));
+        }
+        copy->setAnnotation(member->getSharedAnnotation());
+        return copy;
+    }
+    return rewriteExpression(access);
+}
+
+/**
+ * @brief Fold constant operands, otherwise apply identities.
+ *
+ * @details
+ * An identity only drops the literal operand when the remaining operand already
+ * has the result type: integer literals never change it, a float literal only
+ * next to a float operand. x * 0 additionally needs a pure x of known type.
+ */
+std::shared_ptr<ASTNode> ASTOptimizer::rewriteBinary(const BinaryOpNode& node, const std::shared_ptr<ASTNode>& left,
+                                                     const std::shared_ptr<ASTNode>& right) {
+    const std::string& op = node.getOperator();
+    const int line = node.getLineNumber();
+    Constant lhs;
+    Constant rhs;
+    const bool leftConstant = constantOf(left, lhs);
+    const bool rightConstant = constantOf(right, rhs);
+
+    Constant folded;
+    if (leftConstant && rightConstant && evaluate(op, lhs, rhs, folded)) {
+        if (auto literal = makeLiteral(line, folded)) {
+            ++_stats.foldedExpressions;
+            return literal;
+        }
+    }
+
+    auto keeps = [&](const std::shared_ptr<ASTNode>& operand, const Constant& literal) {
+        return !literal.isFloat || scalarTypeOf(operand) == "float";
+    };
+    auto isZero = [](const Constant& value) { return value.word == 0; };
+    auto isOne = [](const Constant& value) { return value.word == (value.isFloat ? kMoonFloatScale : 1); };
+
+    std::shared_ptr<ASTNode> simplified;
+    if (op == "+") {
+        if (rightConstant && isZero(rhs) && keeps(left, rhs)) {
+            simplified = left;
+        } else if (leftConstant && isZero(lhs) && keeps(right, lhs)) {
+            simplified = right;
+        }
+    } else if (op == "-") {
+        if (rightConstant && isZero(rhs) && keeps(left, rhs)) {
+            simplified = left;
+        }
+    } else if (op == "*") {
+        if (rightConstant && isOne(rhs) && keeps(left, rhs)) {
+            simplified = left;
+        } else if (leftConstant && isOne(lhs) && keeps(right, lhs)) {
+            simplified = right;
+        } else if ((rightConstant && isZero(rhs)) || (leftConstant && isZero(lhs))) {
+            const auto& operand = rightConstant && isZero(rhs) ? left : right;
+            const Constant& zero = rightConstant && isZero(rhs) ? rhs : lhs;
+            const std::string type = scalarTypeOf(operand);
+            if (!type.empty() && isPure(operand)) {
+                simplified = makeLiteral(line, Constant{zero.isFloat || type == "float", 0});
+            }
+        }
+    } else if (op == "/") {
+        if (rightConstant && isOne(rhs) && keeps(left, rhs)) {
+            simplified = left;
+        }
+    }
+
+    if (simplified != nullptr) {
+        ++_stats.simplifiedIdentities;
+        return simplified;
+    }
+    auto copy = std::make_shared<BinaryOpNode>(line, op, left, right);
+    copy->setAnnotation(node.getSharedAnnotation());
+    return copy;
+}
+
+/**
+ * @brief Mirror CodeGenVisitor::resolveNodeType for scalar expressions.
+ * @return "integer" (also for comparisons and logical results), "float", or ""
+ * when an operand's type is not known locally (fields, calls, arrays).
+ */
+std::string ASTOptimizer::scalarTypeOf(const std::shared_ptr<ASTNode>& expression) const {
+    if (std::dynamic_pointer_cast<IntLitNode>(expression) != nullptr) {
+        return "integer";
+    }
+    if (std::dynamic_pointer_cast<FloatLitNode>(expression) != nullptr) {
+        return "float";
+    }
+    if (auto unary = std::dynamic_pointer_cast<UnaryOpNode>(expression)) {
+        return scalarTypeOf(unary->getLeft());
+    }
+    if (auto binary = std::dynamic_pointer_cast<BinaryOpNode>(expression)) {
+        const std::string& op = binary->getOperator();
+        if (isComparisonOperator(op) || isLogicalOperator(op)) {
+            return "integer";
+        }
+        if (!isArithmeticOperator(op)) {
+            return "";
+        }
+        const std::string left = scalarTypeOf(binary->getLeft());
+        const std::string right = scalarTypeOf(binary->getRight());
+        if (left == "float" || right == "float") {
+            return "float";
+        }
+        return left.empty() || right.empty() ? "" : "integer";
+    }
+    auto it = _scalarTypes.find(plainName(expression));
+    return it != _scalarTypes.end() ? it->second : "";
+}
+
+bool ASTOptimizer::constantOf(const std::shared_ptr<ASTNode>& node, Constant& value) {
+    if (auto literal = std::dynamic_pointer_cast<IntLitNode>(node)) {
+        value = Constant{false, literal->getIntValue()};
+        return true;
+    }
+    if (auto literal = std::dynamic_pointer_cast<FloatLitNode>(node)) {
+        value = Constant{true, moonFixedPoint(literal->getFloatValue())};
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Evaluate like the emitted Moon code: promote integers next to floats,
+ * rescale fixed-point products and quotients, and stay within 32-bit words.
+ */
+bool ASTOptimizer::evaluate(const std::string& op, Constant left, Constant right, Constant& result) {
+    const bool arithmetic = isArithmeticOperator(op);
+    const bool comparison = isComparisonOperator(op);
+    if (isLogicalOperator(op)) {
+        const bool isAnd = op == "and" || op == "&&";
+        result = Constant{false, isAnd ? (left.word & right.word) : (left.word | right.word)};
+        return true;
+    }
+    if (!arithmetic && !comparison) {
+        return false;
+    }
+
+    const bool fixedPoint = left.isFloat || right.isFloat;
+    long long x = left.word;
+    long long y = right.word;
+    if (fixedPoint) {
+        x = left.isFloat ? x : x * kMoonFloatScale;
+        y = right.isFloat ? y : y * kMoonFloatScale;
+    }
+    if (!fitsWord(x) || !fitsWord(y)) {
+        return false;
+    }
+
+    long long value = 0;
+    if (op == "+") {
+        value = x + y;
+    } else if (op == "-") {
+        value = x - y;
+    } else if (op == "*") {
+        value = x * y;
+        if (!fitsWord(value)) {
+            return false;
+        }
+        value = fixedPoint ? value / kMoonFloatScale : value;
+    } else if (op == "/" || op == "mod") {
+        if (y == 0) {
+            return false;
+        }
+        if (op == "/" && fixedPoint) {
+            x *= kMoonFloatScale;
+            if (!fitsWord(x)) {
+                return false;
+            }
+        }
+        value = op == "/" ? x / y : x % y;
+    } else if (op == "==") {
+        value = x == y;
+    } else if (op == "!=") {
+        value = x != y;
+    } else if (op == "<") {
+        value = x < y;
+    } else if (op == "<=") {
+        value = x <= y;
+    } else if (op == ">") {
+        value = x > y;
+    } else {
+        value = x >= y;
+    }
+
+    result = Constant{fixedPoint && arithmetic, value};
+    return fitsWord(value);
+}
+
+/**
+ * @brief Literal for a constant within addi range; a float literal must lower
+ * back to exactly the same fixed-point word.
+ */
+std::shared_ptr<ASTNode> ASTOptimizer::makeLiteral(int line, const Constant& value) {
+    if (value.word < kImmediateMin || value.word > kImmediateMax) {
+        return nullptr;
+    }
+    if (!value.isFloat) {
+        return std::make_shared<IntLitNode>(line, static_cast<int>(value.word));
+    }
+    const float literal = static_cast<float>(value.word) / static_cast<float>(kMoonFloatScale);
+    if (moonFixedPoint(literal) != value.word) {
+        return nullptr;
+    }
+    return std::make_shared<FloatLitNode>(line, literal);
+}
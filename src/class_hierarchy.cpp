@@ -0,0 +1,112 @@
+#include "../include/class_hierarchy.h"
+
+#include <algorithm>
+#include <utility>
+
+/**
+ * @file class_hierarchy.cpp
+ * @brief Iterative Tarjan SCC pass over the inheritance graph.
+ */
+
+bool ClassHierarchy::addClass(const std::string& name, std::vector<std::string> parents, int line) {
+    if (!_index.emplace(name, _names.size()).second) {
+        return false;
+    }
+    _names.push_back(name);
+    _lines.push_back(line);
+    _parentNames.push_back(std::move(parents));
+    return true;
+}
+
+std::size_t ClassHierarchy::indexOf(const std::string& name) const {
+    auto it = _index.find(name);
+    return it != _index.end() ? it->second : _names.size();
+}
+
+/**
+ * @brief Tarjan's algorithm with an explicit DFS stack, roots in declaration order.
+ *
+ * @details
+ * Edges point from a class to its parents, so a component is completed only
+ * after every component it inherits from: completion order is parents-first.
+ */
+void ClassHierarchy::analyze() {
+    const std::size_t count = _names.size();
+    _parents.assign(count, {});
+    for (std::size_t i = 0; i < count; ++i) {
+        for (const auto& parentName : _parentNames[i]) {
+            const std::size_t parent = indexOf(parentName);
+            if (parent != count) {
+                _parents[i].push_back(parent);
+            }
+        }
+    }
+
+    _order.clear();
+    _order.reserve(count);
+    _cycles.clear();
+
+    constexpr std::size_t kUnvisited = static_cast<std::size_t>(-1);
+    std::vector<std::size_t> discovery(count, kUnvisited);
+    std::vector<std::size_t> low(count, 0);
+    std::vector<bool> onStack(count, false);
+    std::vector<std::size_t> componentStack;
+    // DFS frames: class index and next parent edge to follow.
+    std::vector<std::pair<std::size_t, std::size_t>> frames;
+    std::size_t nextDiscovery = 0;
+
+    for (std::size_t root = 0; root < count; ++root) {
+        if (discovery[root] != kUnvisited) {
+            continue;
+        }
+        frames.emplace_back(root, 0);
+        discovery[root] = low[root] = nextDiscovery++;
+        componentStack.push_back(root);
+        onStack[root] = true;
+
+        while (!frames.empty()) {
+            const std::size_t node = frames.back().first;
+            std::size_t& edge = frames.back().second;
+            if (edge < _parents[node].size()) {
+                const std::size_t parent = _parents[node][edge++];
+                if (discovery[parent] == kUnvisited) {
+                    discovery[parent] = low[parent] = nextDiscovery++;
+                    componentStack.push_back(parent);
+                    onStack[parent] = true;
+                    frames.emplace_back(parent, 0);
+                } else if (onStack[parent]) {
+                    low[node] = std::min(low[node], discovery[parent]);
+                }
+                continue;
+            }
+
+            frames.pop_back();
+            if (!frames.empty()) {
+                const std::size_t caller = frames.back().first;
+                low[caller] = std::min(low[caller], low[node]);
+            }
+            if (low[node] != discovery[node]) {
+                continue;
+            }
+
+            const std::size_t first = _order.size();
+            std::size_t member = 0;
+            do {
+                member = componentStack.back();
+                componentStack.pop_back();
+                onStack[member] = false;
+                _order.push_back(member);
+            } while (member != node);
+            std::sort(_order.begin() + static_cast<std::ptrdiff_t>(first), _order.end());
+
+            const bool selfInherits =
+                std::find(_parents[node].begin(), _parents[node].end(), node) != _parents[node].end();
+            if (_order.size() - first > 1 || selfInherits) {
+                _cycles.emplace_back(_order.begin() + static_cast<std::ptrdiff_t>(first), _order.end());
+            }
+        }
+    }
+
+    std::sort(_cycles.begin(), _cycles.end(),
+              [](const std::vector<std::size_t>& a, const std::vector<std::size_t>& b) { return a.front() < b.front(); });
+}
@@ -0,0 +1,361 @@
+#include "../include/class_interface.h"
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <unordered_map>
+
+/**
+ * @file class_interface.cpp
+ * @brief "SIF3" class interface encoding and decoding.
+ */
+
+namespace {
+/** @brief File magic, also the format version. */
+constexpr char kMagic[4] = {'S', 'I', 'F', '3'};
+/** @brief First type id not pre-interned by every TypeTable. */
+constexpr TypeId kFirstWrittenType = TypeTable::Bool + 1;
+
+/** @brief Map a signed value onto unsigned so small magnitudes stay short. */
+std::uint64_t zigzag(std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+/** @brief Inverse of zigzag(). */
+std::int64_t unzigzag(std::uint64_t value) {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+/**
+ * @class InterfaceEncoder
+ * @brief Builds the body of an interface file and its string pool.
+ *
+ * @details
+ * The pool is only known once every string was seen, so the body is encoded
+ * into its own buffer and written after the pool.
+ */
+class InterfaceEncoder {
+    public:
+        void writeVarint(std::uint64_t value) {
+            while (value >= 0x80) {
+                _body.push_back(static_cast<char>((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            _body.push_back(static_cast<char>(value));
+        }
+
+        void writeSigned(std::int64_t value) { writeVarint(zigzag(value)); }
+
+        void writeString(const std::string& text) {
+            auto it = _poolIndex.emplace(text, _pool.size()).first;
+            if (it->second == _pool.size()) {
+                _pool.push_back(text);
+            }
+            writeVarint(it->second);
+        }
+
+        void writeDimensions(const std::vector<int>& dimensions) {
+            writeVarint(dimensions.size());
+            for (int dim : dimensions) {
+                writeSigned(dim);
+            }
+        }
+
+        void writeEntry(const SymbolEntry& entry) {
+            writeString(entry.name);
+            _body.push_back(static_cast<char>(entry.kind));
+            _body.push_back(static_cast<char>(entry.visibility));
+            _body.push_back(static_cast<char>(entry.flags));
+            writeVarint(entry.type);
+            writeVarint(entry.fullType);
+            writeSigned(entry.line);
+        }
+
+        void writeKind(TypeKind kind) { _body.push_back(static_cast<char>(kind)); }
+
+        /** @brief Write magic, pool, and body. */
+        void finish(std::ostream& out) const {
+            std::string header(kMagic, sizeof(kMagic));
+            InterfaceEncoder pool;
+            pool.writeVarint(_pool.size());
+            for (const auto& text : _pool) {
+                pool.writeVarint(text.size());
+                pool._body += text;
+            }
+            out.write(header.data(), static_cast<std::streamsize>(header.size()));
+            out.write(pool._body.data(), static_cast<std::streamsize>(pool._body.size()));
+            out.write(_body.data(), static_cast<std::streamsize>(_body.size()));
+        }
+
+    private:
+        std::string _body;
+        std::vector<std::string> _pool;
+        std::unordered_map<std::string, std::size_t> _poolIndex;
+};
+
+/**
+ * @class InterfaceDecoder
+ * @brief Bounds-checked reader over an interface file held in memory.
+ *
+ * @details
+ * Every read validates against the remaining bytes and the sizes decoded so
+ * far; a violation throws std::runtime_error, turned into a false return by
+ * readClassInterface().
+ */
+class InterfaceDecoder {
+    public:
+        explicit InterfaceDecoder(const std::string& data) : _data(data) {}
+
+        void expectMagic() {
+            if (_data.size() < sizeof(kMagic) || _data.compare(0, sizeof(kMagic), kMagic, sizeof(kMagic)) != 0) {
+                throw std::runtime_error("not a class interface file (missing SIF3 magic)");
+            }
+            _pos = sizeof(kMagic);
+        }
+
+        std::uint64_t readVarint() {
+            std::uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                const std::uint8_t byte = readByte();
+                value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return value;
+                }
+            }
+            throw std::runtime_error("malformed varint");
+        }
+
+        std::int64_t readSigned() { return unzigzag(readVarint()); }
+
+        /** @brief Read a count that must fit in the remaining bytes (each item takes at least one). */
+        std::size_t readCount() {
+            const std::uint64_t count = readVarint();
+            if (count > _data.size() - _pos) {
+                throw std::runtime_error("count exceeds file size");
+            }
+            return static_cast<std::size_t>(count);
+        }
+
+        std::uint8_t readByte() {
+            if (_pos >= _data.size()) {
+                throw std::runtime_error("unexpected end of file");
+            }
+            return static_cast<std::uint8_t>(_data[_pos++]);
+        }
+
+        void readPool() {
+            const std::size_t count = readCount();
+            _pool.reserve(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                const std::size_t length = readCount();
+                _pool.push_back(_data.substr(_pos, length));
+                _pos += length;
+            }
+        }
+
+        const std::string& readString() {
+            const std::uint64_t index = readVarint();
+            if (index >= _pool.size()) {
+                throw std::runtime_error("string index out of range");
+            }
+            return _pool[static_cast<std::size_t>(index)];
+        }
+
+        /** @brief Read an interface type id and map it to the destination table. */
+        TypeId readType(const std::vector<TypeId>& types) {
+            const std::uint64_t id = readVarint();
+            if (id >= types.size()) {
+                throw std::runtime_error("type id out of range");
+            }
+            return types[static_cast<std::size_t>(id)];
+        }
+
+        std::vector<int> readDimensions() {
+            std::vector<int> dimensions(readCount());
+            for (int& dim : dimensions) {
+                dim = static_cast<int>(readSigned());
+            }
+            return dimensions;
+        }
+
+        SymbolEntry readEntry(const std::vector<TypeId>& types) {
+            SymbolEntry entry;
+            entry.name = readString();
+            const std::uint8_t kind = readByte();
+            if (kind > static_cast<std::uint8_t>(SymbolKind::Field)) {
+                throw std::runtime_error("unknown symbol kind");
+            }
+            entry.kind = static_cast<SymbolKind>(kind);
+            const std::uint8_t visibility = readByte();
+            if (visibility > static_cast<std::uint8_t>(SymbolVisibility::Private)) {
+                throw std::runtime_error("unknown symbol visibility");
+            }
+            entry.visibility = static_cast<SymbolVisibility>(visibility);
+            entry.flags = readByte();
+            if ((entry.flags & ~(SymbolDeclared | SymbolImplemented | SymbolMethod)) != 0) {
+                throw std::runtime_error("unknown symbol flags");
+            }
+            entry.type = readType(types);
+            entry.fullType = readType(types);
+            entry.line = static_cast<int>(readSigned());
+            return entry;
+        }
+
+        bool atEnd() const { return _pos == _data.size(); }
+
+    private:
+        const std::string& _data;
+        std::size_t _pos = 0;
+        std::vector<std::string> _pool;
+};
+}
+
+SymbolEntry copySymbolEntry(const SymbolEntry& entry, const TypeTable& from, TypeTable& to) {
+    SymbolEntry copy = entry;
+    copy.type = to.copyFrom(from, entry.type);
+    copy.fullType = to.copyFrom(from, entry.fullType);
+    return copy;
+}
+
+/**
+ * @brief Encode types, then classes; the string pool is emitted first.
+ * @param out Binary output stream.
+ * @param classInterface Interface to encode.
+ */
+void writeClassInterface(std::ostream& out, const ClassInterface& classInterface) {
+    InterfaceEncoder encoder;
+    const TypeTable& types = classInterface.types;
+    encoder.writeVarint(types.size() - kFirstWrittenType);
+    for (TypeId id = kFirstWrittenType; id < types.size(); ++id) {
+        const TypeDescriptor& descriptor = types.get(id);
+        encoder.writeKind(descriptor.kind);
+        switch (descriptor.kind) {
+            case TypeKind::Null:
+                break;
+            case TypeKind::Builtin:
+            case TypeKind::Class:
+                encoder.writeString(descriptor.name);
+                break;
+            case TypeKind::Array:
+                encoder.writeVarint(descriptor.element);
+                encoder.writeDimensions(descriptor.dimensions);
+                break;
+            case TypeKind::Function:
+            case TypeKind::ClassDescriptor:
+                encoder.writeVarint(descriptor.element);
+                encoder.writeVarint(descriptor.operands.size());
+                for (TypeId operand : descriptor.operands) {
+                    encoder.writeVarint(operand);
+                }
+                break;
+        }
+    }
+
+    encoder.writeVarint(classInterface.classes.size());
+    for (const auto& cls : classInterface.classes) {
+        encoder.writeEntry(cls.symbol);
+        encoder.writeVarint(cls.members.size());
+        for (const auto& member : cls.members) {
+            encoder.writeEntry(member);
+        }
+        encoder.writeVarint(cls.declaredMethods.size());
+        for (const auto& method : cls.declaredMethods) {
+            encoder.writeString(method.first);
+            encoder.writeVarint(method.second);
+        }
+    }
+    encoder.finish(out);
+}
+
+/**
+ * @brief Decode an interface, re-interning its types in a fresh table.
+ * @details Type operands may only refer to earlier descriptors, as they do in
+ * every table written by writeClassInterface().
+ */
+bool readClassInterface(std::istream& in, ClassInterface& classInterface, std::string& error) {
+    const std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    try {
+        InterfaceDecoder decoder(data);
+        decoder.expectMagic();
+        decoder.readPool();
+
+        ClassInterface decoded;
+        std::vector<TypeId> types;
+        for (TypeId id = 0; id < kFirstWrittenType; ++id) {
+            types.push_back(id);
+        }
+        const std::size_t typeCount = decoder.readCount();
+        for (std::size_t i = 0; i < typeCount; ++i) {
+            const std::uint8_t kind = decoder.readByte();
+            switch (static_cast<TypeKind>(kind)) {
+                case TypeKind::Builtin:
+                case TypeKind::Class:
+                    types.push_back(decoded.types.named(decoder.readString()));
+                    break;
+                case TypeKind::Array: {
+                    const TypeId element = decoder.readType(types);
+                    types.push_back(decoded.types.array(element, decoder.readDimensions()));
+                    break;
+                }
+                case TypeKind::Function:
+                case TypeKind::ClassDescriptor: {
+                    const TypeId element = decoder.readType(types);
+                    std::vector<TypeId> operands(decoder.readCount());
+                    for (TypeId& operand : operands) {
+                        operand = decoder.readType(types);
+                    }
+                    types.push_back(static_cast<TypeKind>(kind) == TypeKind::Function
+                                        ? decoded.types.function(element, operands)
+                                        : decoded.types.classDescriptor(operands));
+                    break;
+                }
+                default:
+                    throw std::runtime_error("unknown type kind");
+            }
+        }
+
+        const std::size_t classCount = decoder.readCount();
+        for (std::size_t i = 0; i < classCount; ++i) {
+            ClassInterface::Class cls;
+            cls.symbol = decoder.readEntry(types);
+            cls.members.resize(decoder.readCount());
+            for (SymbolEntry& member : cls.members) {
+                member = decoder.readEntry(types);
+            }
+            cls.declaredMethods.resize(decoder.readCount());
+            for (auto& method : cls.declaredMethods) {
+                method.first = decoder.readString();
+                method.second = decoder.readType(types);
+            }
+            decoded.classes.push_back(std::move(cls));
+        }
+        if (!decoder.atEnd()) {
+            throw std::runtime_error("trailing bytes after last class");
+        }
+        classInterface = std::move(decoded);
+        return true;
+    } catch (const std::exception& e) {
+        error = e.what();
+        return false;
+    }
+}
+
+bool writeClassInterfaceFile(const std::string& filePath, const ClassInterface& classInterface) {
+    std::ofstream file(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    writeClassInterface(file, classInterface);
+    file.flush();
+    return static_cast<bool>(file);
+}
+
+bool readClassInterfaceFile(const std::string& filePath, ClassInterface& classInterface, std::string& error) {
+    std::ifstream file(filePath, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        error = "cannot open " + filePath;
+        return false;
+    }
+    return readClassInterface(file, classInterface, error);
+}
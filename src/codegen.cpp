@@ -15,12 +15,17 @@
  * consistent diagnostics, and easier debugging against source-line context.
  */
 #include "../include/codegen.h"
+#include "../include/buffered_file_sink.h"
+#include "../include/moon_line_map.h"
 
 #include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <sstream>
 #include <cctype>
+#include <cstring>
+#include <type_traits>
+#include <utility>
 
 namespace {
     /** @brief Convert register index to Moon register token (for example r5). */
@@ -58,9 +63,26 @@ namespace {
         return false;
     }
 
-    /** @brief Check prefix match used by trace-comment suppression filters. */
-    bool startsWith(const std::string& text, const std::string& prefix) {
-        return text.size() >= prefix.size() && text.compare(0, prefix.size(), prefix) == 0;
+    /**
+     * @brief Parameter profile of a definition, e.g. "(integer,float[])".
+     * @details Same text as ASTAnnotation::overload of the calls that resolve to it.
+     */
+    std::string parameterProfile(const FuncDefNode& node) {
+        std::string profile = "(";
+        const auto params = node.getParams();
+        for (size_t i = 0; i < params.size(); ++i) {
+            profile += (i > 0 ? "," : "") + trimCopy(params[i]->getTypeName());
+            for (int dim : params[i]->getDimensions()) {
+                profile += dim < 0 ? "[]" : "[" + std::to_string(dim) + "]";
+            }
+        }
+        return profile + ")";
+    }
+
+    /** @brief Overload profile a call was resolved to ("" when unannotated: the first definition is used). */
+    std::string callProfile(const FuncCallNode& node) {
+        const ASTAnnotation* annotation = node.getAnnotation();
+        return annotation != nullptr ? annotation->overload : std::string();
     }
 
     /** @brief Render array dimensions into a compact trace-friendly string. */
@@ -80,6 +102,34 @@ namespace {
         return oss.str();
     }
 
+    /** @brief Register operand of a trace comment, rendered only when the comment is written. */
+    struct Reg {
+        int index;
+    };
+
+    /**
+     * @name Trace comment parts
+     * @brief Append one emitComment()/emitSourceLineContext() argument to a message.
+     * @details Numbers, registers, and dimensions are formatted here, and a
+     * callable part is invoked here, so lean emission never builds them.
+     */
+    /** @{ */
+    void appendTracePart(std::string& text, const std::string& part) { text += part; }
+    void appendTracePart(std::string& text, const char* part) { text += part; }
+    void appendTracePart(std::string& text, Reg reg) { text += regName(reg.index); }
+    void appendTracePart(std::string& text, const std::vector<int>& dimensions) { text += dimensionsToString(dimensions); }
+
+    template <typename Number, typename std::enable_if<std::is_arithmetic<Number>::value, int>::type = 0>
+    void appendTracePart(std::string& text, Number value) {
+        text += std::to_string(value);
+    }
+
+    template <typename Produce, typename = decltype(std::declval<const Produce&>()())>
+    void appendTracePart(std::string& text, const Produce& produce) {
+        appendTracePart(text, produce());
+    }
+    /** @} */
+
     /** @brief Build lightweight node summary strings for trace comments. */
     std::string summarizeNode(const std::shared_ptr<ASTNode>& node) {
         if (node == nullptr) {
@@ -146,6 +196,16 @@ namespace {
         return node->getValue();
     }
 
+    /** @brief Register operand rN of an emitted instruction. */
+    MoonOperand regOp(int reg) {
+        return moonRegister(reg);
+    }
+
+    /** @brief Immediate operand (or memory offset) of an emitted instruction. */
+    MoonOperand immOp(long value) {
+        return moonImmediate(value);
+    }
+
     /** @brief Utility constexpr used to validate fixed-point scale constant. */
     constexpr bool isPowerOfTen(int value) { // USED LATER IN CODEGEN FOR VALIDATING FLOAT SCALE CONSTANT
         if (value < 1) {
@@ -160,64 +220,140 @@ namespace {
     }
 
     /** @brief Fixed-point scale used to lower language floats onto integer-only Moon ops. */
-    constexpr int kFloatScale = 100; //must be a power of 10 to avoid precision issues in scaled integer representation. USE THIS CONSTANT ACCROSS ALL CODEGEN LOGIC FOR CONSISTENCY
+    constexpr int kFloatScale = kMoonFloatScale; //must be a power of 10 to avoid precision issues in scaled integer representation. USE THIS CONSTANT ACCROSS ALL CODEGEN LOGIC FOR CONSISTENCY
     /** @brief First fractional divisor (10 for scale 100) used by decimal emit loops. */
     constexpr int kFloatFirstFractionPlace = kFloatScale / 10;
     static_assert(kFloatScale >= 10 && isPowerOfTen(kFloatScale), "kFloatScale must be a power of ten >= 10");
 }
 
+/** @brief Scale and round a float literal exactly as visit(FloatLitNode&) lowers it. */
+long moonFixedPoint(float value) {
+    return static_cast<long>(std::llround(value * static_cast<float>(kFloatScale)));
+}
+
 /** @brief Initialize register allocator state. */
 CodeGenVisitor::RegisterAllocator::RegisterAllocator() {
     reset();
 }
 
-/** @brief Acquire one temporary register from allocator pool. */
+/** @brief Acquire the lowest free temporary register, so expressions reuse as few registers as possible. */
 int CodeGenVisitor::RegisterAllocator::acquire() {
-    if (_freeRegs.empty()) {
+    if (_free == 0) {
         return -1;
     }
 
-    const int reg = _freeRegs.back();
-    _freeRegs.pop_back();
+    int reg = 1;
+    while ((_free & (1u << reg)) == 0) {
+        ++reg;
+    }
+    _free = static_cast<std::uint16_t>(_free & ~(1u << reg));
     return reg;
 }
 
-/** @brief Return temporary register to allocator pool if valid. */
+/** @brief Take a specific register, used to reload spilled values into the registers their owners hold. */
+bool CodeGenVisitor::RegisterAllocator::claim(int reg) {
+    if (reg <= 0 || reg > kPoolSize || (_free & (1u << reg)) == 0) {
+        return false;
+    }
+
+    _free = static_cast<std::uint16_t>(_free & ~(1u << reg));
+    return true;
+}
+
+/** @brief Return temporary register to allocator pool if valid (releasing a free register is a no-op). */
 void CodeGenVisitor::RegisterAllocator::release(int reg) {
-    if (reg <= 0 || reg > 12) {
+    if (reg <= 0 || reg > kPoolSize) {
         return;
     }
 
-    if (std::find(_freeRegs.begin(), _freeRegs.end(), reg) == _freeRegs.end()) {
-        _freeRegs.push_back(reg);
+    _free = static_cast<std::uint16_t>(_free | (1u << reg));
+}
+
+/** @brief Count the set bits of the free mask. */
+int CodeGenVisitor::RegisterAllocator::freeCount() const {
+    int count = 0;
+    for (std::uint16_t bits = _free; bits != 0; bits = static_cast<std::uint16_t>(bits & (bits - 1))) {
+        ++count;
     }
+    return count;
 }
 
 /** @brief Restore allocator to full temporary register pool. */
 void CodeGenVisitor::RegisterAllocator::reset() {
-    _freeRegs.clear();
-    for (int reg = 12; reg >= 1; --reg) {
-        _freeRegs.push_back(reg);
-    }
+    _free = static_cast<std::uint16_t>(((1u << (kPoolSize + 1)) - 1) & ~1u);
 }
 
 /** @brief Construct backend with output stream sink. */
 CodeGenVisitor::CodeGenVisitor(std::ostream& out)
     : _out(out) {}
 
+/**
+ * @brief Emit a backend comment line concatenated from parts.
+ *
+ * @details
+ * Lean mode returns before any part is formatted, so comment text is only
+ * built when it is written.
+ */
+template <typename... Parts>
+void CodeGenVisitor::emitComment(const Parts&... parts) {
+    if (_emitMode == MoonEmitMode::Lean) {
+        return;
+    }
+
+    std::string text;
+    (appendTracePart(text, parts), ...);
+    _program.appendComment(std::move(text), _traceSourceLine, _traceContextTag, _currentFunctionKey);
+}
+
+/**
+ * @brief Attach source-line context tag and emit contextual trace comment.
+ * @details The context is kept in lean mode too, for the line map; only the
+ * tag is read from head then.
+ */
+template <typename... Parts>
+void CodeGenVisitor::emitSourceLineContext(int line, const char* head, const Parts&... parts) {
+    const char* close = head[0] == '[' ? std::strchr(head, ']') : nullptr;
+    if (close != nullptr && close > head + 1) {
+        setTraceContext(line, std::string(head + 1, close));
+    } else {
+        setTraceContext(line, head);
+    }
+
+    if (_emitMode == MoonEmitMode::Lean) {
+        return;
+    }
+
+    std::string message = head;
+    (appendTracePart(message, parts), ...);
+
+    if (line > 0) {
+        emitComment("[L", line, "] ", message);
+    } else {
+        emitComment("[RT] ", message);
+    }
+}
+
 /**
  * @brief Generate Moon assembly from program AST.
  *
  * @details
  * Initializes trace state, emits entry bootstrap, delegates full program
- * lowering to the AST visitor, then appends runtime I/O helpers.
+ * lowering to the AST visitor, then appends runtime I/O helpers. The finished
+ * listing goes through the peephole pass and is printed to the output stream
+ * once, after lowering.
  */
 bool CodeGenVisitor::generate(const std::shared_ptr<ProgNode>& root) {
-    _errors.clear();
+    _diagnostics.clear();
+    _program.clear();
     _labelCounter = 0;
-    _traceEmitCounter = 0;
+    _instructionCount = 0;
     _traceSourceLine = 0;
-    _traceContextTag.clear();
+    _traceContextTag = 0;
+    _currentFunctionKey = 0;
+    _peepholeStats = MoonPeepholeStats();
+    if (_lineMap != nullptr) {
+        _lineMap->clear();
+    }
 
     if (root == nullptr) {
         reportError(0, "cannot generate code from an empty AST");
@@ -227,107 +363,65 @@ bool CodeGenVisitor::generate(const std::shared_ptr<ProgNode>& root) {
     emitComment("Moon assembly generated by CodeGenVisitor");
     setTraceContext(0, "BOOT");
     emitComment("[BOOT] entry + stack base initialization");
-    emit("entry");
-    emit("addi r14, r0, topaddr");
+    emit(MoonOp::Entry);
+    emit(MoonOp::Addi, regOp(14), regOp(0), labelOp("topaddr"));
 
     root->accept(*this);
 
     emitComment("[BOOT] halt after program end label");
-    emit("hlt");
+    emit(MoonOp::Hlt);
     emitRuntimeIntegerIO();
 
-    return _errors.empty();
-}
-
-/** @brief Expose accumulated code generation diagnostics. */
-const std::vector<std::string>& CodeGenVisitor::getErrors() const {
-    return _errors;
-}
+    MoonPeephole peephole(_peepholeOptions);
+    peephole.run(_program);
+    _peepholeStats = peephole.stats();
 
-/**
- * @brief Emit assembly line and optional instruction trace comment.
- *
- * @details
- * Non-comment instructions receive an auto-incrementing trace marker to make
- * generated assembly easy to audit against source-line context.
- */
-void CodeGenVisitor::emit(const std::string& line) {
-    const bool isComment = !line.empty() && line[0] == '%';
-    if (!isComment && !line.empty()) {
-        ++_traceEmitCounter;
-
-        std::ostringstream trace;
-        trace << "[E" << _traceEmitCounter << "]";
-        if (_traceSourceLine > 0) {
-            trace << "[L" << _traceSourceLine << "]";
-        } else {
-            trace << "[RT]";
-        }
-
-        if (!_traceContextTag.empty()) {
-            trace << "[" << _traceContextTag << "]";
-        }
-
-        trace << " " << line;
-        _out << "% " << trace.str() << "\n";
+    _instructionCount = _program.instructionCount();
+    _program.print(_out, _emitMode);
+    if (_lineMap != nullptr) {
+        _program.recordLineMap(*_lineMap);
     }
 
-    _out << line << "\n";
+    return _diagnostics.errorCount() == 0;
 }
 
-/**
- * @brief Emit backend comment line with readability filtering.
- *
- * @details
- * Very high-frequency comment categories are suppressed to keep emitted assembly
- * reviewable in assignment-scale test outputs.
- */
-void CodeGenVisitor::emitComment(const std::string& message) {
-    // Keep Moon output readable by suppressing repetitive low-value traces.
-    if (startsWith(message, "semantic step:")) {
-        return;
-    }
-    if (startsWith(message, "  block stmt line=")) {
-        return;
-    }
-    if (startsWith(message, "  assignment mode:")) {
-        return;
-    }
-    if (startsWith(message, "  fixed-point promotion active")) {
-        return;
-    }
-
-    emit("% " + message);
+/** @brief Expose formatted code generation diagnostics. */
+std::vector<std::string> CodeGenVisitor::getErrors() const {
+    return _diagnostics.formatted(DiagnosticSeverity::Error);
 }
 
-/** @brief Attach source-line context tag and emit contextual trace comment. */
-void CodeGenVisitor::emitSourceLineContext(int line, const std::string& message) {
-    std::string tag = message;
-    if (!message.empty() && message[0] == '[') {
-        const size_t close = message.find(']');
-        if (close != std::string::npos && close > 1) {
-            tag = message.substr(1, close - 1);
-        }
-    }
+/** @brief Append an instruction or directive tagged with the active trace context. */
+void CodeGenVisitor::emit(MoonOp op, MoonOperand first, MoonOperand second, MoonOperand third) {
+    MoonInstruction instruction;
+    instruction.op = op;
+    instruction.operands[0] = first;
+    instruction.operands[1] = second;
+    instruction.operands[2] = third;
+    instruction.line = _traceSourceLine;
+    instruction.tag = _traceContextTag;
+    instruction.function = _currentFunctionKey;
+    _program.append(instruction);
+}
 
-    setTraceContext(line, tag);
+/** @brief Append a label definition. */
+void CodeGenVisitor::emitLabel(const std::string& label) {
+    emit(MoonOp::Label, labelOp(label));
+}
 
-    if (line > 0) {
-        emitComment("[L" + std::to_string(line) + "] " + message);
-    } else {
-        emitComment("[RT] " + message);
-    }
+/** @brief Symbol operand naming a label. */
+MoonOperand CodeGenVisitor::labelOp(const std::string& label) {
+    return _program.label(label);
 }
 
 /** @brief Update current trace context tuple (line + semantic tag). */
 void CodeGenVisitor::setTraceContext(int line, const std::string& contextTag) {
     _traceSourceLine = line;
-    _traceContextTag = contextTag;
+    _traceContextTag = _program.symbol(contextTag);
 }
 
-/** @brief Record formatted codegen error with source line. */
+/** @brief Record codegen error with source line. */
 void CodeGenVisitor::reportError(int line, const std::string& message) {
-    _errors.push_back("[ERROR][CODEGEN] line " + std::to_string(line) + ": " + message);
+    _diagnostics.report(DiagnosticCode::CodeGenFailure, line, {message});
 }
 
 /** @brief Sanitize arbitrary identifier text for use in Moon labels. */
@@ -369,6 +463,7 @@ void CodeGenVisitor::resetFunctionState() {
     _stackVarInfo.clear();
     _nextOffset = 0;
     _regs.reset();
+    _spillDepth = 0;
     _lastExprReg = -1;
 }
 
@@ -377,7 +472,8 @@ void CodeGenVisitor::resetFunctionState() {
  *
  * @details
  * Layout includes return link slot, optional receiver slot, parameter slots,
- * local storage slots, and metadata used by argument/assignment lowering.
+ * local storage slots, spill temp slots for the deepest spill nesting of the
+ * body, and metadata used by argument/assignment lowering.
  */
 bool CodeGenVisitor::buildFunctionLayout(const std::shared_ptr<FuncDefNode>& functionNode) {
     if (functionNode == nullptr || functionNode->getRight() == nullptr) {
@@ -390,7 +486,20 @@ bool CodeGenVisitor::buildFunctionLayout(const std::shared_ptr<FuncDefNode>& fun
     layout.returnType = trimCopy(functionNode->getReturnType());
     layout.isMethod = !layout.className.empty();
     layout.key = functionKey(layout.className, layout.name);
+    layout.profile = parameterProfile(*functionNode);
     layout.label = "fn_" + sanitizeName(layout.key);
+    // Further overloads of the name get the arity and parameter types appended.
+    std::vector<FunctionLayoutInfo>& overloads = _functionLayouts[layout.key];
+    auto sameProfile = std::find_if(overloads.begin(), overloads.end(), [&](const FunctionLayoutInfo& other) {
+        return other.profile == layout.profile;
+    });
+    if (!overloads.empty() && sameProfile != overloads.begin()) {
+        layout.label += "_" + std::to_string(functionNode->getParams().size());
+        for (const auto& param : functionNode->getParams()) {
+            const std::string dimensions = param->getDimensions().empty() ? "" : dimensionsToString(param->getDimensions());
+            layout.label += "_" + sanitizeName(trimCopy(param->getTypeName()) + dimensions);
+        }
+    }
 
     long cursor = -4; // saved return link
     layout.returnLinkOffset = -4;
@@ -461,23 +570,75 @@ bool CodeGenVisitor::buildFunctionLayout(const std::shared_ptr<FuncDefNode>& fun
         };
     }
 
+    layout.spillSlots = spillSlotBound(functionNode->getRight(), 0);
+    if (layout.spillSlots > 0) {
+        layout.spillOffset = cursor - 4;
+        cursor -= 4L * layout.spillSlots;
+    }
+
     layout.frameSize = -cursor;
     if (layout.frameSize < 4) {
         layout.frameSize = 4;
     }
 
-    _functionLayouts[layout.key] = layout;
+    if (sameProfile != overloads.end()) {
+        *sameProfile = layout;
+    } else {
+        overloads.push_back(layout);
+    }
     return true;
 }
 
-/** @brief Lookup cached function layout by owner class and function name. */
-const CodeGenVisitor::FunctionLayoutInfo* CodeGenVisitor::findFunctionLayout(const std::string& className, const std::string& functionName) const {
+/**
+ * @brief Lookup cached function layout by owner class, function name, and overload.
+ * @param profile Parameter profile of the overload, or "" for the name's first definition.
+ */
+const CodeGenVisitor::FunctionLayoutInfo* CodeGenVisitor::findFunctionLayout(const std::string& className, const std::string& functionName,
+                                                                             const std::string& profile) const {
     const std::string key = functionKey(trimCopy(className), functionName);
     auto it = _functionLayouts.find(key);
-    if (it == _functionLayouts.end()) {
+    if (it == _functionLayouts.end() || it->second.empty()) {
         return nullptr;
     }
-    return &it->second;
+    if (profile.empty()) {
+        return &it->second.front();
+    }
+    for (const auto& overload : it->second) {
+        if (overload.profile == profile) {
+            return &overload;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Lookup method layout in a class, then depth-first through its parents.
+ *
+ * @details
+ * Search order matches field inheritance (own class, then parents in
+ * declaration order). receiverOffset is the byte offset of the defining
+ * class's sub-object inside className, to be added to the receiver address.
+ */
+const CodeGenVisitor::FunctionLayoutInfo* CodeGenVisitor::findMethodLayout(const std::string& className, const std::string& functionName,
+                                                                           const std::string& profile, long& receiverOffset) const {
+    receiverOffset = 0;
+    if (const FunctionLayoutInfo* own = findFunctionLayout(className, functionName, profile)) {
+        return own;
+    }
+
+    auto classIt = _classLayouts.find(trimCopy(className));
+    if (classIt == _classLayouts.end()) {
+        return nullptr;
+    }
+
+    for (const auto& parent : classIt->second.parentOffsets) {
+        long parentOffset = 0;
+        if (const FunctionLayoutInfo* inherited = findMethodLayout(parent.first, functionName, profile, parentOffset)) {
+            receiverOffset = parent.second + parentOffset;
+            return inherited;
+        }
+    }
+    return nullptr;
 }
 
 /** @brief Compute storage size for scalar or class type. */
@@ -533,6 +694,7 @@ bool CodeGenVisitor::buildClassLayout(const std::string& className, std::unorder
         }
 
         const ClassLayoutInfo& parentLayout = _classLayouts[parentName];
+        layout.parentOffsets.emplace_back(parentName, runningOffset);
         for (const auto& kv : parentLayout.fields) {
             FieldLayoutInfo inherited = kv.second;
             inherited.offset += runningOffset;
@@ -708,9 +870,9 @@ void CodeGenVisitor::assignOffsets(const std::vector<std::shared_ptr<VarDeclNode
         };
 
         emitComment(
-            "alloc " + name + " @ " + std::to_string(_nextOffset) + "(r14), size=" + std::to_string(varSize) +
-            ", type=" + trimCopy(var->getTypeName()) + ", dims=" + dimensionsToString(var->getDimensions()) +
-            ", elem=" + std::to_string(elementSize) + ", ref=" + (_stackVarInfo[name].isReferenceParam ? "yes" : "no")
+            "alloc ", name, " @ ", _nextOffset, "(r14), size=", varSize, ", type=",
+            [&] { return trimCopy(var->getTypeName()); }, ", dims=", var->getDimensions(), ", elem=", elementSize,
+            ", ref=", (_stackVarInfo[name].isReferenceParam ? "yes" : "no")
         );
     }
 }
@@ -743,6 +905,267 @@ int CodeGenVisitor::evalExpr(const std::shared_ptr<ASTNode>& node) {
     return _lastExprReg;
 }
 
+/**
+ * @brief Spill held registers around evaluate() when it calls or needs more registers than are free.
+ *
+ * @details
+ * Held registers are stored to spill temp slots and returned to the pool, so
+ * evaluate() sees them as free; afterwards they are claimed back and reloaded.
+ * When the result landed in a held register number it is moved to a fresh one
+ * first. Without a spill evaluate() runs as is.
+ */
+template <typename Evaluate>
+int CodeGenVisitor::preserveAcross(const std::shared_ptr<ASTNode>& node,
+                                   bool address,
+                                   const std::vector<int>& held,
+                                   int line,
+                                   Evaluate&& evaluate) {
+    if (held.empty() || !mustSpill(node, address, _regs.freeCount())) {
+        return evaluate();
+    }
+
+    if (_spillDepth + static_cast<int>(held.size()) > _currentSpillSlots) {
+        reportError(line, "spill temp slots exhausted in code generation (frame reserves " + std::to_string(_currentSpillSlots) + ")");
+        return -1;
+    }
+
+    std::vector<long> slots;
+    slots.reserve(held.size());
+    for (int reg : held) {
+        const long slot = acquireSpillSlot(line);
+        emitSourceLineContext(line, "[SPILL] mem[", slot, "(r14)] <- ", Reg{reg});
+        emit(MoonOp::Sw, immOp(slot), regOp(14), regOp(reg));
+        _regs.release(reg);
+        slots.push_back(slot);
+    }
+
+    int result = evaluate();
+    for (int reg : held) {
+        if (reg != result) {
+            _regs.claim(reg);
+        }
+    }
+
+    if (result >= 0 && std::find(held.begin(), held.end(), result) != held.end()) {
+        const int moved = _regs.acquire();
+        if (moved < 0) {
+            reportError(line, "register exhaustion while reloading spilled registers");
+            result = -1;
+        } else {
+            emit(MoonOp::Add, regOp(moved), regOp(result), regOp(0));
+            result = moved;
+        }
+    }
+
+    for (size_t i = held.size(); i-- > 0;) {
+        emitSourceLineContext(line, "[SPILL] ", Reg{held[i]}, " <- mem[", slots[i], "(r14)]");
+        emit(MoonOp::Lw, regOp(held[i]), immOp(slots[i]), regOp(14));
+        releaseSpillSlot();
+    }
+    return result;
+}
+
+/** @brief Evaluate node with held registers preserved across it. */
+int CodeGenVisitor::evalExprPreserving(const std::shared_ptr<ASTNode>& node, const std::vector<int>& held, int line) {
+    return preserveAcross(node, false, held, line, [&] { return evalExpr(node); });
+}
+
+/** @brief Compute the l-value address of node with held registers preserved across it. */
+int CodeGenVisitor::emitAddressPreserving(const std::shared_ptr<ASTNode>& node, const std::vector<int>& held, int line) {
+    return preserveAcross(node, true, held, line, [&] { return emitAddressForLValue(node, line); });
+}
+
+/** @brief Take the next spill temp slot below the ones in use. */
+long CodeGenVisitor::acquireSpillSlot(int line) {
+    if (_spillDepth >= _currentSpillSlots) {
+        reportError(line, "spill temp slots exhausted in code generation (frame reserves " + std::to_string(_currentSpillSlots) + ")");
+        return 0;
+    }
+
+    return _currentSpillOffset - 4 * _spillDepth++;
+}
+
+/**
+ * @brief Compute and memoize the Sethi-Ullman register needs of an expression.
+ *
+ * @details
+ * A need counts the registers lowering keeps live at once: a binary operator
+ * keeps its first operand while evaluating the second (max(first, 1 + second)),
+ * an indexed access keeps its base and linear offset while evaluating each
+ * index, and a member or field read keeps the address next to the loaded
+ * value. A call evaluates its arguments one at a time but clobbers every
+ * temporary, so whoever holds a register across one spills it.
+ */
+const CodeGenVisitor::RegisterNeed& CodeGenVisitor::registerNeed(const std::shared_ptr<ASTNode>& node) {
+    static const RegisterNeed kLeaf;
+    if (node == nullptr) {
+        return kLeaf;
+    }
+
+    auto cached = _registerNeeds.find(node.get());
+    if (cached != _registerNeeds.end()) {
+        return cached->second;
+    }
+
+    RegisterNeed need;
+    if (auto idNode = std::dynamic_pointer_cast<IdNode>(node)) {
+        const ASTAnnotation* annotation = idNode->getAnnotation();
+        const bool frameSlot = annotation != nullptr &&
+                               (annotation->binding == ASTBinding::Local || annotation->binding == ASTBinding::Param);
+        need.value = frameSlot ? 1 : 2;
+    } else if (auto binaryNode = std::dynamic_pointer_cast<BinaryOpNode>(node)) {
+        const RegisterNeed left = registerNeed(binaryNode->getLeft());
+        const RegisterNeed right = registerNeed(binaryNode->getRight());
+        const bool rightFirst = evaluatesRightFirst(*binaryNode);
+        const int first = rightFirst ? right.value : left.value;
+        const int second = rightFirst ? left.value : right.value;
+        need.value = std::max(first, second + 1);
+        need.hasCall = left.hasCall || right.hasCall;
+    } else if (auto unaryNode = std::dynamic_pointer_cast<UnaryOpNode>(node)) {
+        need = registerNeed(unaryNode->getLeft());
+    } else if (auto memberNode = std::dynamic_pointer_cast<DataMemberNode>(node)) {
+        if (memberNode->getLeft() != nullptr) {
+            const RegisterNeed owner = registerNeed(memberNode->getLeft());
+            need.address = owner.address;
+            need.hasCall = owner.hasCall;
+        }
+        for (const auto& index : memberNode->getIndices()) {
+            const RegisterNeed indexNeed = registerNeed(index);
+            need.address = std::max(need.address, 2 + indexNeed.value);
+            need.hasCall = need.hasCall || indexNeed.hasCall;
+        }
+        need.value = std::max(need.address, 2);
+    } else if (auto callNode = std::dynamic_pointer_cast<FuncCallNode>(node)) {
+        // An object argument is copied through source, destination, and word registers.
+        need.value = 3;
+        for (const auto& arg : callNode->getArgs()) {
+            const RegisterNeed argNeed = registerNeed(arg);
+            need.value = std::max({need.value, argNeed.value, argNeed.address});
+        }
+        auto calleeMember = std::dynamic_pointer_cast<DataMemberNode>(callNode->getLeft());
+        if (calleeMember != nullptr && calleeMember->getLeft() != nullptr) {
+            need.value = std::max(need.value, registerNeed(calleeMember->getLeft()).address);
+        }
+        need.address = need.value;
+        need.hasCall = true;
+    }
+
+    return _registerNeeds[node.get()] = need;
+}
+
+/** @brief Reorder only call-free operands, so calls keep their left-to-right side effects. */
+bool CodeGenVisitor::evaluatesRightFirst(const BinaryOpNode& node) {
+    const RegisterNeed left = registerNeed(node.getLeft());
+    const RegisterNeed right = registerNeed(node.getRight());
+    return !left.hasCall && !right.hasCall && right.value > left.value;
+}
+
+/** @brief Calls clobber every temporary; otherwise spill only when the need exceeds the free registers. */
+bool CodeGenVisitor::mustSpill(const std::shared_ptr<ASTNode>& node, bool address, int freeRegisters) {
+    const RegisterNeed& need = registerNeed(node);
+    return need.hasCall || (address ? need.address : need.value) > freeRegisters;
+}
+
+/** @brief A call stages its arguments when a later argument or its receiver would overwrite the stored ones. */
+bool CodeGenVisitor::stagesCallArguments(const FuncCallNode& node) {
+    const auto args = node.getArgs();
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (registerNeed(args[i]).hasCall) {
+            return true;
+        }
+    }
+
+    auto calleeMember = std::dynamic_pointer_cast<DataMemberNode>(node.getLeft());
+    return !args.empty() && calleeMember != nullptr && calleeMember->getLeft() != nullptr &&
+           registerNeed(calleeMember->getLeft()).hasCall;
+}
+
+/**
+ * @brief Bound the spill temp slots lowering of node takes, with held registers live around it.
+ *
+ * @details
+ * Mirrors the holders of expression lowering statically: each spot that keeps
+ * registers while computing a later operand spills them when mustSpill() holds
+ * for the registers left, and a staging call keeps one slot per argument
+ * already evaluated. Statements start with no register held. Value and
+ * address lowering of a node keep the same holders, so one bound covers both.
+ */
+int CodeGenVisitor::spillSlotBound(const std::shared_ptr<ASTNode>& node, int held) {
+    if (node == nullptr) {
+        return 0;
+    }
+
+    if (auto blockNode = std::dynamic_pointer_cast<BlockNode>(node)) {
+        int bound = 0;
+        for (const auto& stmt : blockNode->getStatements()) {
+            bound = std::max(bound, spillSlotBound(stmt, 0));
+        }
+        return bound;
+    }
+    if (auto assignNode = std::dynamic_pointer_cast<AssignStmtNode>(node)) {
+        return std::max(spillSlotBound(assignNode->getRight(), 0),
+                        keptSpillSlotBound(assignNode->getLeft(), true, 0, 1));
+    }
+    if (auto ifNode = std::dynamic_pointer_cast<IfStmtNode>(node)) {
+        return std::max({spillSlotBound(ifNode->getLeft(), 0),
+                         spillSlotBound(ifNode->getRight(), 0),
+                         spillSlotBound(ifNode->getElseBlock(), 0)});
+    }
+    if (auto whileNode = std::dynamic_pointer_cast<WhileStmtNode>(node)) {
+        return std::max(spillSlotBound(whileNode->getLeft(), 0), spillSlotBound(whileNode->getRight(), 0));
+    }
+    if (auto ioNode = std::dynamic_pointer_cast<IOStmtNode>(node)) {
+        if (ioNode->getValue() == "read") {
+            return keptSpillSlotBound(ioNode->getLeft(), true, 0, 1);
+        }
+        return spillSlotBound(ioNode->getLeft(), 0);
+    }
+    if (auto returnNode = std::dynamic_pointer_cast<ReturnStmtNode>(node)) {
+        return spillSlotBound(returnNode->getLeft(), 0);
+    }
+
+    if (auto binaryNode = std::dynamic_pointer_cast<BinaryOpNode>(node)) {
+        const bool rightFirst = evaluatesRightFirst(*binaryNode);
+        const auto& first = rightFirst ? binaryNode->getRight() : binaryNode->getLeft();
+        const auto& second = rightFirst ? binaryNode->getLeft() : binaryNode->getRight();
+        return std::max(spillSlotBound(first, held), keptSpillSlotBound(second, false, held, 1));
+    }
+    if (auto unaryNode = std::dynamic_pointer_cast<UnaryOpNode>(node)) {
+        return spillSlotBound(unaryNode->getLeft(), held);
+    }
+    if (auto memberNode = std::dynamic_pointer_cast<DataMemberNode>(node)) {
+        int bound = spillSlotBound(memberNode->getLeft(), held);
+        for (const auto& index : memberNode->getIndices()) {
+            bound = std::max(bound, keptSpillSlotBound(index, false, held, 2));
+        }
+        return bound;
+    }
+    if (auto callNode = std::dynamic_pointer_cast<FuncCallNode>(node)) {
+        const auto args = callNode->getArgs();
+        const int staged = stagesCallArguments(*callNode) ? static_cast<int>(args.size()) + 1 : 0;
+        int bound = staged;
+        for (size_t i = 0; i < args.size(); ++i) {
+            const int argBound = spillSlotBound(args[i], held);
+            bound = std::max(bound, (staged > 0 ? static_cast<int>(i) : 0) + argBound);
+        }
+        auto calleeMember = std::dynamic_pointer_cast<DataMemberNode>(callNode->getLeft());
+        if (calleeMember != nullptr && calleeMember->getLeft() != nullptr) {
+            const int ownerBound = spillSlotBound(calleeMember->getLeft(), held);
+            bound = std::max(bound, (staged > 0 ? static_cast<int>(args.size()) : 0) + ownerBound);
+        }
+        return bound;
+    }
+    return 0;
+}
+
+/** @brief Kept registers spill to slots when node does not fit next to them, else they stay held. */
+int CodeGenVisitor::keptSpillSlotBound(const std::shared_ptr<ASTNode>& node, bool address, int held, int kept) {
+    if (mustSpill(node, address, RegisterAllocator::kPoolSize - held - kept)) {
+        return kept + spillSlotBound(node, held);
+    }
+    return spillSlotBound(node, held + kept);
+}
+
 /** @brief Load implicit receiver pointer into target register for method context. */
 bool CodeGenVisitor::loadThisPointerInto(int targetReg, int line) {
     if (targetReg < 0) {
@@ -754,16 +1177,58 @@ bool CodeGenVisitor::loadThisPointerInto(int targetReg, int line) {
         return false;
     }
 
-    emitSourceLineContext(line, "[MEM] " + regName(targetReg) + " <- mem[" + std::to_string(_currentThisOffset) + "(r14)]  ; this");
-    emit("lw " + regName(targetReg) + ", " + std::to_string(_currentThisOffset) + "(r14)");
+    emitSourceLineContext(line, "[MEM] ", Reg{targetReg}, " <- mem[", _currentThisOffset, "(r14)]  ; this");
+    emit(MoonOp::Lw, regOp(targetReg), immOp(_currentThisOffset), regOp(14));
+    return true;
+}
+
+/** @brief Copy the semantic type of an annotated node; false when the node has no annotation. */
+bool CodeGenVisitor::readAnnotatedType(const ASTNode& node, std::string& typeName, std::vector<int>& dimensions) {
+    const ASTAnnotation* annotation = node.getAnnotation();
+    if (annotation == nullptr) {
+        return false;
+    }
+    typeName = annotation->typeName;
+    dimensions = annotation->dimensions;
     return true;
 }
 
+/**
+ * @brief Decide how an unqualified variable name is lowered.
+ * @param node Identifier or owner-less member node.
+ * @param fieldClass Receives the class whose layout holds the field when the
+ *        name is not a frame slot ("" outside member functions).
+ * @return True when the name is a local or parameter slot of the frame.
+ *
+ * @details
+ * The semantic binding decides when present; otherwise frame slots shadow
+ * fields of the current class, as in semantic analysis.
+ */
+bool CodeGenVisitor::bindsFrameSlot(const ASTNode& node, const std::string& name, std::string& fieldClass) const {
+    if (const ASTAnnotation* annotation = node.getAnnotation()) {
+        if (annotation->binding == ASTBinding::Local || annotation->binding == ASTBinding::Param) {
+            return true;
+        }
+        if (annotation->binding == ASTBinding::Field) {
+            fieldClass = annotation->receiverClass;
+            return false;
+        }
+    }
+    if (hasOffset(name)) {
+        return true;
+    }
+    fieldClass = _currentClassName;
+    return false;
+}
+
 /** @brief Resolve effective type and remaining dimensions for data-member access. */
 bool CodeGenVisitor::resolveDataMemberType(const std::shared_ptr<DataMemberNode>& node, std::string& typeName, std::vector<int>& dimensions) {
     if (node == nullptr) {
         return false;
     }
+    if (readAnnotatedType(*node, typeName, dimensions)) {
+        return true;
+    }
 
     if (node->getLeft() == nullptr) {
         auto infoIt = _stackVarInfo.find(node->getName());
@@ -817,12 +1282,16 @@ bool CodeGenVisitor::resolveDataMemberType(const std::shared_ptr<DataMemberNode>
  *
  * @details
  * This helper enables mixed numeric operations, object-copy detection, call
- * return handling, and argument conversions without re-running semantic analysis.
+ * return handling, and argument conversions. Nodes annotated by semantic
+ * analysis answer directly; the rest are resolved from frame and class layouts.
  */
 bool CodeGenVisitor::resolveNodeType(const std::shared_ptr<ASTNode>& node, std::string& typeName, std::vector<int>& dimensions) {
     if (node == nullptr) {
         return false;
     }
+    if (readAnnotatedType(*node, typeName, dimensions)) {
+        return true;
+    }
 
     if (auto idNode = std::dynamic_pointer_cast<IdNode>(node)) {
         auto infoIt = _stackVarInfo.find(idNode->getName());
@@ -903,11 +1372,13 @@ bool CodeGenVisitor::resolveNodeType(const std::shared_ptr<ASTNode>& node, std::
                 return false;
             }
 
-            targetLayout = findFunctionLayout(ownerType, callNode->getFunctionName());
+            long receiverOffset = 0;
+            targetLayout = findMethodLayout(ownerType, callNode->getFunctionName(), callProfile(*callNode), receiverOffset);
         } else {
-            targetLayout = findFunctionLayout("", callNode->getFunctionName());
+            targetLayout = findFunctionLayout("", callNode->getFunctionName(), callProfile(*callNode));
             if (targetLayout == nullptr && !_currentClassName.empty()) {
-                targetLayout = findFunctionLayout(_currentClassName, callNode->getFunctionName());
+                long receiverOffset = 0;
+                targetLayout = findMethodLayout(_currentClassName, callNode->getFunctionName(), callProfile(*callNode), receiverOffset);
             }
         }
 
@@ -943,12 +1414,7 @@ bool CodeGenVisitor::emitIndexOffsetIntoAddress(int addrReg,
         return true;
     }
 
-    emitSourceLineContext(
-        line,
-        "[ADDR] " + regName(addrReg) + " += indexExpr(" + std::to_string(indices.size()) +
-        ") * " + std::to_string(elementSize) +
-        "  dims=" + dimensionsToString(declaredDimensions)
-    );
+    emitSourceLineContext(line, "[ADDR] ", Reg{addrReg}, " += indexExpr(", indices.size(), ") * ", elementSize, "  dims=", declaredDimensions);
 
     if (indices.size() > declaredDimensions.size()) {
         reportError(line, "too many array indices in code generation");
@@ -961,10 +1427,10 @@ bool CodeGenVisitor::emitIndexOffsetIntoAddress(int addrReg,
         return false;
     }
 
-    emit("addi " + regName(linearReg) + ", r0, 0");
+    emit(MoonOp::Addi, regOp(linearReg), regOp(0), immOp(0));
 
     for (size_t i = 0; i < indices.size(); ++i) {
-        const int idxReg = evalExpr(indices[i]);
+        const int idxReg = evalExprPreserving(indices[i], {addrReg, linearReg}, line);
         if (idxReg < 0) {
             _regs.release(linearReg);
             return false;
@@ -980,18 +1446,18 @@ bool CodeGenVisitor::emitIndexOffsetIntoAddress(int addrReg,
         }
 
         if (stride != 1) {
-            emit("muli " + regName(idxReg) + ", " + regName(idxReg) + ", " + std::to_string(stride));
+            emit(MoonOp::Muli, regOp(idxReg), regOp(idxReg), immOp(stride));
         }
 
-        emit("add " + regName(linearReg) + ", " + regName(linearReg) + ", " + regName(idxReg));
+        emit(MoonOp::Add, regOp(linearReg), regOp(linearReg), regOp(idxReg));
         _regs.release(idxReg);
     }
 
     if (elementSize != 1) {
-        emit("muli " + regName(linearReg) + ", " + regName(linearReg) + ", " + std::to_string(elementSize));
+        emit(MoonOp::Muli, regOp(linearReg), regOp(linearReg), immOp(elementSize));
     }
 
-    emit("add " + regName(addrReg) + ", " + regName(addrReg) + ", " + regName(linearReg));
+    emit(MoonOp::Add, regOp(addrReg), regOp(addrReg), regOp(linearReg));
     _regs.release(linearReg);
     return true;
 }
@@ -1004,7 +1470,8 @@ int CodeGenVisitor::emitAddressForLValue(const std::shared_ptr<ASTNode>& node, i
     }
 
     if (auto idNode = std::dynamic_pointer_cast<IdNode>(node)) {
-        if (hasOffset(idNode->getName())) {
+        std::string fieldClass;
+        if (bindsFrameSlot(*idNode, idNode->getName(), fieldClass)) {
             const int addrReg = _regs.acquire();
             if (addrReg < 0) {
                 reportError(idNode->getLineNumber(), "register exhaustion while generating l-value address");
@@ -1016,18 +1483,24 @@ int CodeGenVisitor::emitAddressForLValue(const std::shared_ptr<ASTNode>& node, i
                 infoIt != _stackVarInfo.end() && infoIt->second.isReferenceParam;
 
             if (isReferenceParam) {
-                emitSourceLineContext(idNode->getLineNumber(), "[ADDR] " + regName(addrReg) + " <- mem[" + std::to_string(lookupOffset(idNode->getName())) + "(r14)]  ; ref param '" + idNode->getName() + "'");
-                emit("lw " + regName(addrReg) + ", " + std::to_string(lookupOffset(idNode->getName())) + "(r14)");
+                emitSourceLineContext(
+                    idNode->getLineNumber(), "[ADDR] ", Reg{addrReg}, " <- mem[", lookupOffset(idNode->getName()),
+                    "(r14)]  ; ref param '", idNode->getName(), "'"
+                );
+                emit(MoonOp::Lw, regOp(addrReg), immOp(lookupOffset(idNode->getName())), regOp(14));
             } else {
-                emitSourceLineContext(idNode->getLineNumber(), "[ADDR] " + regName(addrReg) + " <- &" + idNode->getName() + " @ " + std::to_string(lookupOffset(idNode->getName())) + "(r14)");
-                emit("addi " + regName(addrReg) + ", r14, " + std::to_string(lookupOffset(idNode->getName())));
+                emitSourceLineContext(
+                    idNode->getLineNumber(), "[ADDR] ", Reg{addrReg}, " <- &", idNode->getName(), " @ ",
+                    lookupOffset(idNode->getName()), "(r14)"
+                );
+                emit(MoonOp::Addi, regOp(addrReg), regOp(14), immOp(lookupOffset(idNode->getName())));
             }
             return addrReg;
         }
 
-        if (!_currentClassName.empty()) {
+        if (!fieldClass.empty()) {
             FieldLayoutInfo fieldLayout;
-            if (lookupFieldLayout(_currentClassName, idNode->getName(), fieldLayout, idNode->getLineNumber())) {
+            if (lookupFieldLayout(fieldClass, idNode->getName(), fieldLayout, idNode->getLineNumber())) {
                 const int addrReg = _regs.acquire();
                 if (addrReg < 0) {
                     reportError(idNode->getLineNumber(), "register exhaustion while generating field address");
@@ -1040,10 +1513,13 @@ int CodeGenVisitor::emitAddressForLValue(const std::shared_ptr<ASTNode>& node, i
                 }
 
                 if (fieldLayout.offset != 0) {
-                    emit("addi " + regName(addrReg) + ", " + regName(addrReg) + ", " + std::to_string(fieldLayout.offset));
+                    emit(MoonOp::Addi, regOp(addrReg), regOp(addrReg), immOp(fieldLayout.offset));
                 }
 
-                emitSourceLineContext(idNode->getLineNumber(), "[ADDR] " + regName(addrReg) + " -> field '" + idNode->getName() + "' offset=" + std::to_string(fieldLayout.offset));
+                emitSourceLineContext(
+                    idNode->getLineNumber(), "[ADDR] ", Reg{addrReg}, " -> field '", idNode->getName(), "' offset=",
+                    fieldLayout.offset
+                );
                 return addrReg;
             }
         }
@@ -1069,7 +1545,8 @@ int CodeGenVisitor::emitAddressForLValue(const std::shared_ptr<ASTNode>& node, i
  */
 int CodeGenVisitor::emitAddressForDataMember(DataMemberNode& node) {
     if (node.getLeft() == nullptr) {
-        const bool isLocalOrParam = hasOffset(node.getName());
+        std::string fieldClass;
+        const bool isLocalOrParam = bindsFrameSlot(node, node.getName(), fieldClass);
         if (isLocalOrParam) {
             const int addrReg = _regs.acquire();
             if (addrReg < 0) {
@@ -1088,11 +1565,17 @@ int CodeGenVisitor::emitAddressForDataMember(DataMemberNode& node) {
             }
 
             if (isReferenceParam) {
-                emitSourceLineContext(node.getLineNumber(), "[ADDR] " + regName(addrReg) + " <- mem[" + std::to_string(lookupOffset(node.getName())) + "(r14)]  ; ref '" + node.getName() + "'");
-                emit("lw " + regName(addrReg) + ", " + std::to_string(lookupOffset(node.getName())) + "(r14)");
+                emitSourceLineContext(
+                    node.getLineNumber(), "[ADDR] ", Reg{addrReg}, " <- mem[", lookupOffset(node.getName()),
+                    "(r14)]  ; ref '", node.getName(), "'"
+                );
+                emit(MoonOp::Lw, regOp(addrReg), immOp(lookupOffset(node.getName())), regOp(14));
             } else {
-                emitSourceLineContext(node.getLineNumber(), "[ADDR] " + regName(addrReg) + " <- &" + node.getName() + " @ " + std::to_string(lookupOffset(node.getName())) + "(r14)");
-                emit("addi " + regName(addrReg) + ", r14, " + std::to_string(lookupOffset(node.getName())));
+                emitSourceLineContext(
+                    node.getLineNumber(), "[ADDR] ", Reg{addrReg}, " <- &", node.getName(), " @ ",
+                    lookupOffset(node.getName()), "(r14)"
+                );
+                emit(MoonOp::Addi, regOp(addrReg), regOp(14), immOp(lookupOffset(node.getName())));
             }
 
             if (!emitIndexOffsetIntoAddress(addrReg, node.getIndices(), declaredDimensions, elementSize, node.getLineNumber())) {
@@ -1103,9 +1586,9 @@ int CodeGenVisitor::emitAddressForDataMember(DataMemberNode& node) {
             return addrReg;
         }
 
-        if (!_currentClassName.empty()) {
+        if (!fieldClass.empty()) {
             FieldLayoutInfo fieldLayout;
-            if (!lookupFieldLayout(_currentClassName, node.getName(), fieldLayout, node.getLineNumber())) {
+            if (!lookupFieldLayout(fieldClass, node.getName(), fieldLayout, node.getLineNumber())) {
                 return -1;
             }
 
@@ -1121,10 +1604,13 @@ int CodeGenVisitor::emitAddressForDataMember(DataMemberNode& node) {
             }
 
             if (fieldLayout.offset != 0) {
-                emit("addi " + regName(addrReg) + ", " + regName(addrReg) + ", " + std::to_string(fieldLayout.offset));
+                emit(MoonOp::Addi, regOp(addrReg), regOp(addrReg), immOp(fieldLayout.offset));
             }
 
-            emitSourceLineContext(node.getLineNumber(), "[ADDR] " + regName(addrReg) + " -> implicit field '" + node.getName() + "' offset=" + std::to_string(fieldLayout.offset));
+            emitSourceLineContext(
+                node.getLineNumber(), "[ADDR] ", Reg{addrReg}, " -> implicit field '", node.getName(), "' offset=",
+                fieldLayout.offset
+            );
 
             long fieldElementSize = sizeOfType(fieldLayout.typeName, node.getLineNumber());
             if (fieldElementSize <= 0) {
@@ -1160,7 +1646,7 @@ int CodeGenVisitor::emitAddressForDataMember(DataMemberNode& node) {
     if (ownerAddrReg < 0) {
         return -1;
     }
-    emitSourceLineContext(node.getLineNumber(), "[ADDR] explicit owner for member '" + node.getName() + "' in " + regName(ownerAddrReg));
+    emitSourceLineContext(node.getLineNumber(), "[ADDR] explicit owner for member '", node.getName(), "' in ", Reg{ownerAddrReg});
 
     std::string ownerType;
     std::vector<int> ownerDimensions;
@@ -1182,7 +1668,7 @@ int CodeGenVisitor::emitAddressForDataMember(DataMemberNode& node) {
     }
 
     if (fieldLayout.offset != 0) {
-        emit("addi " + regName(ownerAddrReg) + ", " + regName(ownerAddrReg) + ", " + std::to_string(fieldLayout.offset));
+        emit(MoonOp::Addi, regOp(ownerAddrReg), regOp(ownerAddrReg), immOp(fieldLayout.offset));
     }
 
     long fieldElementSize = sizeOfType(fieldLayout.typeName, node.getLineNumber());
@@ -1253,14 +1739,11 @@ bool CodeGenVisitor::emitCopyWords(int dstAddrReg, int srcAddrReg, long byteCoun
         return false;
     }
 
-    emitSourceLineContext(
-        line,
-        "[MEM] memcpy " + std::to_string(byteCount) + "B : " + regName(dstAddrReg) + " <- " + regName(srcAddrReg)
-    );
+    emitSourceLineContext(line, "[MEM] memcpy ", byteCount, "B : ", Reg{dstAddrReg}, " <- ", Reg{srcAddrReg});
 
     for (long offset = 0; offset < byteCount; offset += 4) {
-        emit("lw " + regName(tmpReg) + ", " + std::to_string(offset) + "(" + regName(srcAddrReg) + ")");
-        emit("sw " + std::to_string(offset) + "(" + regName(dstAddrReg) + "), " + regName(tmpReg));
+        emit(MoonOp::Lw, regOp(tmpReg), immOp(offset), regOp(srcAddrReg));
+        emit(MoonOp::Sw, immOp(offset), regOp(dstAddrReg), regOp(tmpReg));
     }
 
     _regs.release(tmpReg);
@@ -1279,17 +1762,16 @@ bool CodeGenVisitor::emitStoreTarget(const std::shared_ptr<ASTNode>& target, int
         return false;
     }
 
-    const int addrReg = emitAddressForLValue(target, target->getLineNumber());
+    const int addrReg = emitAddressPreserving(target, {valueReg}, target->getLineNumber());
     if (addrReg < 0) {
         return false;
     }
 
     emitSourceLineContext(
-        target->getLineNumber(),
-        "[MEM] mem[0(" + regName(addrReg) + ")] <- " + regName(valueReg) +
-        "  target=" + summarizeNode(target)
+        target->getLineNumber(), "[MEM] mem[0(", Reg{addrReg}, ")] <- ", Reg{valueReg}, "  target=",
+        [&] { return summarizeNode(target); }
     );
-    emit("sw 0(" + regName(addrReg) + "), " + regName(valueReg));
+    emit(MoonOp::Sw, immOp(0), regOp(addrReg), regOp(valueReg));
     _regs.release(addrReg);
     return true;
 }
@@ -1311,9 +1793,12 @@ void CodeGenVisitor::emitFunctionBody(const std::shared_ptr<FuncDefNode>& functi
     resetFunctionState();
 
     _currentFunction = functionNode->getName();
+    _currentFunctionKey = _program.symbol(layout.key);
     _currentClassName = layout.className;
     _currentFrameSize = layout.frameSize;
     _currentThisOffset = layout.thisOffset;
+    _currentSpillOffset = layout.spillOffset;
+    _currentSpillSlots = layout.spillSlots;
     _currentReturnLabel = layout.label + "_ret";
     _currentReturnType = trimCopy(functionNode->getReturnType());
 
@@ -1322,19 +1807,20 @@ void CodeGenVisitor::emitFunctionBody(const std::shared_ptr<FuncDefNode>& functi
 
     emitSourceLineContext(functionNode->getLineNumber(), "[FUNC] begin body emission");
     emitComment("============================================================");
-    emitComment("BEGIN FUNCTION: " + layout.key + " label=" + layout.label);
-    emitComment("[FRAME] size=" + std::to_string(layout.frameSize) +
-                "B, retLink=" + std::to_string(layout.returnLinkOffset) +
-                ", method=" + std::string(layout.isMethod ? "yes" : "no"));
+    emitComment("BEGIN FUNCTION: ", layout.key, " label=", layout.label);
+    emitComment("[FRAME] size=", layout.frameSize, "B, retLink=", layout.returnLinkOffset, ", method=", (layout.isMethod ? "yes" : "no"));
 
     if (!isMainBody) {
-        emitComment("[FRAME] save caller return address to mem[" + std::to_string(layout.returnLinkOffset) + "(r14)]");
-        emit(layout.label);
-        emit("sw " + std::to_string(layout.returnLinkOffset) + "(r14), r15");
+        emitComment("[FRAME] save caller return address to mem[", layout.returnLinkOffset, "(r14)]");
+        emitLabel(layout.label);
+        emit(MoonOp::Sw, immOp(layout.returnLinkOffset), regOp(14), regOp(15));
     }
 
     if (layout.isMethod) {
-        emitComment("[FRAME] method receiver slot: mem[" + std::to_string(layout.thisOffset) + "(r14)]");
+        emitComment("[FRAME] method receiver slot: mem[", layout.thisOffset, "(r14)]");
+    }
+    if (layout.spillSlots > 0) {
+        emitComment("[FRAME] spill temp slots: ", layout.spillSlots, " from mem[", layout.spillOffset, "(r14)] down");
     }
 
     for (size_t i = 0; i < layout.paramNames.size(); ++i) {
@@ -1342,13 +1828,13 @@ void CodeGenVisitor::emitFunctionBody(const std::shared_ptr<FuncDefNode>& functi
         const long paramOffset = layout.paramOffsets[i];
         auto infoIt = layout.varInfo.find(paramName);
         if (infoIt != layout.varInfo.end()) {
-            emitComment("param " + paramName + " @ " + std::to_string(paramOffset) +
-                        "(r14), type=" + infoIt->second.typeName +
-                        ", dims=" + dimensionsToString(infoIt->second.dimensions) +
-                        ", elem=" + std::to_string(infoIt->second.elementSize) +
-                        ", ref=" + std::string(infoIt->second.isReferenceParam ? "yes" : "no"));
+            emitComment(
+                "param ", paramName, " @ ", paramOffset, "(r14), type=", infoIt->second.typeName, ", dims=",
+                infoIt->second.dimensions, ", elem=", infoIt->second.elementSize, ", ref=",
+                (infoIt->second.isReferenceParam ? "yes" : "no")
+            );
         } else {
-            emitComment("param " + paramName + " @ " + std::to_string(paramOffset) + "(r14)");
+            emitComment("param ", paramName, " @ ", paramOffset, "(r14)");
         }
     }
 
@@ -1359,12 +1845,12 @@ void CodeGenVisitor::emitFunctionBody(const std::shared_ptr<FuncDefNode>& functi
 
         auto infoIt = layout.varInfo.find(kv.first);
         if (infoIt != layout.varInfo.end()) {
-            emitComment("local " + kv.first + " @ " + std::to_string(kv.second) +
-                        "(r14), type=" + infoIt->second.typeName +
-                        ", dims=" + dimensionsToString(infoIt->second.dimensions) +
-                        ", elem=" + std::to_string(infoIt->second.elementSize));
+            emitComment(
+                "local ", kv.first, " @ ", kv.second, "(r14), type=", infoIt->second.typeName, ", dims=",
+                infoIt->second.dimensions, ", elem=", infoIt->second.elementSize
+            );
         } else {
-            emitComment("local " + kv.first + " @ " + std::to_string(kv.second) + "(r14)");
+            emitComment("local ", kv.first, " @ ", kv.second, "(r14)");
         }
     }
 
@@ -1374,13 +1860,14 @@ void CodeGenVisitor::emitFunctionBody(const std::shared_ptr<FuncDefNode>& functi
 
     if (!isMainBody) {
         emitComment("[FRAME] epilogue: restore r15 and return");
-        emit(_currentReturnLabel);
-        emit("lw r15, " + std::to_string(layout.returnLinkOffset) + "(r14)");
-        emit("jr r15");
+        emitLabel(_currentReturnLabel);
+        emit(MoonOp::Lw, regOp(15), immOp(layout.returnLinkOffset), regOp(14));
+        emit(MoonOp::Jr, regOp(15));
     }
 
-    emitComment("END FUNCTION: " + layout.key);
+    emitComment("END FUNCTION: ", layout.key);
     emitComment("============================================================");
+    _currentFunctionKey = 0;
 }
 
 /**
@@ -1394,235 +1881,236 @@ void CodeGenVisitor::emitRuntimeIntegerIO() {
     emitSourceLineContext(0, "[RT_READINT] helper begin");
     emitComment("runtime helper: rt_readInt (returns parsed integer in r1)");
     emitComment("upgrade from PROVIDED_DOCS/A5/moon/samples/newlib.m: alias + align conventions");
-    emit("align");
-    emit("getint");
-    emit("j rt_readInt");
-    emit("align");
-    emit("rt_readInt");
-    emit("addi r1, r0, 0");
-    emit("addi r2, r0, 1");
-    emit("rt_readInt_skip_ws");
-    emit("getc r3");
-    emit("andi r3, r3, 255");
-    emit("ceqi r4, r3, 32");
-    emit("bz r4, rt_readInt_check_tab");
-    emit("j rt_readInt_skip_ws");
-    emit("rt_readInt_check_tab");
-    emit("ceqi r4, r3, 9");
-    emit("bz r4, rt_readInt_check_lf");
-    emit("j rt_readInt_skip_ws");
-    emit("rt_readInt_check_lf");
-    emit("ceqi r4, r3, 10");
-    emit("bz r4, rt_readInt_check_cr");
-    emit("j rt_readInt_skip_ws");
-    emit("rt_readInt_check_cr");
-    emit("ceqi r4, r3, 13");
-    emit("bz r4, rt_readInt_check_sign");
-    emit("j rt_readInt_skip_ws");
-    emit("rt_readInt_check_sign");
-    emit("ceqi r4, r3, 45");
-    emit("bz r4, rt_readInt_check_plus");
-    emit("addi r2, r0, -1");
-    emit("getc r3");
-    emit("andi r3, r3, 255");
-    emit("j rt_readInt_digit_loop");
-    emit("rt_readInt_check_plus");
-    emit("ceqi r4, r3, 43");
-    emit("bz r4, rt_readInt_digit_loop");
-    emit("getc r3");
-    emit("andi r3, r3, 255");
-    emit("rt_readInt_digit_loop");
-    emit("addi r6, r0, 48");
-    emit("addi r7, r0, 57");
-    emit("clt r4, r3, r6");
-    emit("bz r4, rt_readInt_check_upper");
-    emit("j rt_readInt_apply_sign");
-    emit("rt_readInt_check_upper");
-    emit("cgt r4, r3, r7");
-    emit("bz r4, rt_readInt_consume_digit");
-    emit("j rt_readInt_apply_sign");
-    emit("rt_readInt_consume_digit");
-    emit("muli r1, r1, 10");
-    emit("sub r8, r3, r6");
-    emit("add r1, r1, r8");
-    emit("getc r3");
-    emit("andi r3, r3, 255");
-    emit("j rt_readInt_digit_loop");
-    emit("rt_readInt_apply_sign");
-    emit("clt r4, r2, r0");
-    emit("bz r4, rt_readInt_ret");
-    emit("sub r1, r0, r1");
-    emit("rt_readInt_ret");
-    emit("jr r15");
+    emit(MoonOp::Align);
+    emitLabel("getint");
+    emit(MoonOp::J, labelOp("rt_readInt"));
+    emit(MoonOp::Align);
+    emitLabel("rt_readInt");
+    emit(MoonOp::Addi, regOp(1), regOp(0), immOp(0));
+    emit(MoonOp::Addi, regOp(2), regOp(0), immOp(1));
+    emitLabel("rt_readInt_skip_ws");
+    emit(MoonOp::Getc, regOp(3));
+    emit(MoonOp::Andi, regOp(3), regOp(3), immOp(255));
+    emit(MoonOp::Ceqi, regOp(4), regOp(3), immOp(32));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readInt_check_tab"));
+    emit(MoonOp::J, labelOp("rt_readInt_skip_ws"));
+    emitLabel("rt_readInt_check_tab");
+    emit(MoonOp::Ceqi, regOp(4), regOp(3), immOp(9));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readInt_check_lf"));
+    emit(MoonOp::J, labelOp("rt_readInt_skip_ws"));
+    emitLabel("rt_readInt_check_lf");
+    emit(MoonOp::Ceqi, regOp(4), regOp(3), immOp(10));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readInt_check_cr"));
+    emit(MoonOp::J, labelOp("rt_readInt_skip_ws"));
+    emitLabel("rt_readInt_check_cr");
+    emit(MoonOp::Ceqi, regOp(4), regOp(3), immOp(13));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readInt_check_sign"));
+    emit(MoonOp::J, labelOp("rt_readInt_skip_ws"));
+    emitLabel("rt_readInt_check_sign");
+    emit(MoonOp::Ceqi, regOp(4), regOp(3), immOp(45));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readInt_check_plus"));
+    emit(MoonOp::Addi, regOp(2), regOp(0), immOp(-1));
+    emit(MoonOp::Getc, regOp(3));
+    emit(MoonOp::Andi, regOp(3), regOp(3), immOp(255));
+    emit(MoonOp::J, labelOp("rt_readInt_digit_loop"));
+    emitLabel("rt_readInt_check_plus");
+    emit(MoonOp::Ceqi, regOp(4), regOp(3), immOp(43));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readInt_digit_loop"));
+    emit(MoonOp::Getc, regOp(3));
+    emit(MoonOp::Andi, regOp(3), regOp(3), immOp(255));
+    emitLabel("rt_readInt_digit_loop");
+    emit(MoonOp::Addi, regOp(6), regOp(0), immOp(48));
+    emit(MoonOp::Addi, regOp(7), regOp(0), immOp(57));
+    emit(MoonOp::Clt, regOp(4), regOp(3), regOp(6));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readInt_check_upper"));
+    emit(MoonOp::J, labelOp("rt_readInt_apply_sign"));
+    emitLabel("rt_readInt_check_upper");
+    emit(MoonOp::Cgt, regOp(4), regOp(3), regOp(7));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readInt_consume_digit"));
+    emit(MoonOp::J, labelOp("rt_readInt_apply_sign"));
+    emitLabel("rt_readInt_consume_digit");
+    emit(MoonOp::Muli, regOp(1), regOp(1), immOp(10));
+    emit(MoonOp::Sub, regOp(8), regOp(3), regOp(6));
+    emit(MoonOp::Add, regOp(1), regOp(1), regOp(8));
+    emit(MoonOp::Getc, regOp(3));
+    emit(MoonOp::Andi, regOp(3), regOp(3), immOp(255));
+    emit(MoonOp::J, labelOp("rt_readInt_digit_loop"));
+    emitLabel("rt_readInt_apply_sign");
+    emit(MoonOp::Clt, regOp(4), regOp(2), regOp(0));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readInt_ret"));
+    emit(MoonOp::Sub, regOp(1), regOp(0), regOp(1));
+    emitLabel("rt_readInt_ret");
+    emit(MoonOp::Jr, regOp(15));
 
     emitSourceLineContext(0, "[RT_READFLOAT] helper begin");
-    emitComment("runtime helper: rt_readFloat (returns fixed-point float in r1, scale=" + std::to_string(kFloatScale) + ")");
-    emit("rt_readFloat");
-    emit("addi r1, r0, 0");
-    emit("addi r2, r0, 1");
-    emit("rt_readFloat_skip_ws");
-    emit("getc r3");
-    emit("andi r3, r3, 255");
-    emit("ceqi r4, r3, 32");
-    emit("bz r4, rt_readFloat_check_tab");
-    emit("j rt_readFloat_skip_ws");
-    emit("rt_readFloat_check_tab");
-    emit("ceqi r4, r3, 9");
-    emit("bz r4, rt_readFloat_check_lf");
-    emit("j rt_readFloat_skip_ws");
-    emit("rt_readFloat_check_lf");
-    emit("ceqi r4, r3, 10");
-    emit("bz r4, rt_readFloat_check_cr");
-    emit("j rt_readFloat_skip_ws");
-    emit("rt_readFloat_check_cr");
-    emit("ceqi r4, r3, 13");
-    emit("bz r4, rt_readFloat_check_sign");
-    emit("j rt_readFloat_skip_ws");
-    emit("rt_readFloat_check_sign");
-    emit("ceqi r4, r3, 45");
-    emit("bz r4, rt_readFloat_check_plus");
-    emit("addi r2, r0, -1");
-    emit("getc r3");
-    emit("andi r3, r3, 255");
-    emit("j rt_readFloat_int_loop");
-    emit("rt_readFloat_check_plus");
-    emit("ceqi r4, r3, 43");
-    emit("bz r4, rt_readFloat_int_loop");
-    emit("getc r3");
-    emit("andi r3, r3, 255");
-    emit("rt_readFloat_int_loop");
-    emit("addi r6, r0, 48");
-    emit("addi r7, r0, 57");
-    emit("clt r4, r3, r6");
-    emit("bz r4, rt_readFloat_int_check_upper");
-    emit("j rt_readFloat_maybe_frac");
-    emit("rt_readFloat_int_check_upper");
-    emit("cgt r4, r3, r7");
-    emit("bz r4, rt_readFloat_int_consume");
-    emit("j rt_readFloat_maybe_frac");
-    emit("rt_readFloat_int_consume");
-    emit("muli r1, r1, 10");
-    emit("sub r8, r3, r6");
-    emit("add r1, r1, r8");
-    emit("getc r3");
-    emit("andi r3, r3, 255");
-    emit("j rt_readFloat_int_loop");
-    emit("rt_readFloat_maybe_frac");
-    emit("addi r11, r0, 0");
-    emit("addi r10, r0, 0");
-    emit("muli r1, r1, " + std::to_string(kFloatScale));
-    emit("ceqi r4, r3, 46");
-    emit("bz r4, rt_readFloat_apply_sign");
-    emit("getc r3");
-    emit("andi r3, r3, 255");
-    emit("addi r11, r0, " + std::to_string(kFloatFirstFractionPlace));
-    emit("addi r10, r0, 0");
-    emit("rt_readFloat_frac_loop");
-    emit("clt r4, r3, r6");
-    emit("bz r4, rt_readFloat_frac_check_upper");
-    emit("j rt_readFloat_apply_sign");
-    emit("rt_readFloat_frac_check_upper");
-    emit("cgt r4, r3, r7");
-    emit("bz r4, rt_readFloat_frac_consume");
-    emit("j rt_readFloat_apply_sign");
-    emit("rt_readFloat_frac_consume");
-    emit("ceqi r4, r11, 0");
-    emit("bz r4, rt_readFloat_frac_store");
-    emit("getc r3");
-    emit("andi r3, r3, 255");
-    emit("j rt_readFloat_frac_loop");
-    emit("rt_readFloat_frac_store");
-    emit("sub r8, r3, r6");
-    emit("mul r8, r8, r11");
-    emit("add r10, r10, r8");
-    emit("ceqi r4, r11, 1");
-    emit("bz r4, rt_readFloat_frac_scale_down");
-    emit("addi r11, r0, 0");
-    emit("j rt_readFloat_frac_next");
-    emit("rt_readFloat_frac_scale_down");
-    emit("divi r11, r11, 10");
-    emit("rt_readFloat_frac_next");
-    emit("getc r3");
-    emit("andi r3, r3, 255");
-    emit("j rt_readFloat_frac_loop");
-    emit("rt_readFloat_apply_sign");
-    emit("add r1, r1, r10");
-    emit("clt r4, r2, r0");
-    emit("bz r4, rt_readFloat_ret");
-    emit("sub r1, r0, r1");
-    emit("rt_readFloat_ret");
-    emit("jr r15");
+    emitComment("runtime helper: rt_readFloat (returns fixed-point float in r1, scale=", kFloatScale, ")");
+    emitLabel("rt_readFloat");
+    emit(MoonOp::Addi, regOp(1), regOp(0), immOp(0));
+    emit(MoonOp::Addi, regOp(2), regOp(0), immOp(1));
+    emitLabel("rt_readFloat_skip_ws");
+    emit(MoonOp::Getc, regOp(3));
+    emit(MoonOp::Andi, regOp(3), regOp(3), immOp(255));
+    emit(MoonOp::Ceqi, regOp(4), regOp(3), immOp(32));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readFloat_check_tab"));
+    emit(MoonOp::J, labelOp("rt_readFloat_skip_ws"));
+    emitLabel("rt_readFloat_check_tab");
+    emit(MoonOp::Ceqi, regOp(4), regOp(3), immOp(9));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readFloat_check_lf"));
+    emit(MoonOp::J, labelOp("rt_readFloat_skip_ws"));
+    emitLabel("rt_readFloat_check_lf");
+    emit(MoonOp::Ceqi, regOp(4), regOp(3), immOp(10));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readFloat_check_cr"));
+    emit(MoonOp::J, labelOp("rt_readFloat_skip_ws"));
+    emitLabel("rt_readFloat_check_cr");
+    emit(MoonOp::Ceqi, regOp(4), regOp(3), immOp(13));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readFloat_check_sign"));
+    emit(MoonOp::J, labelOp("rt_readFloat_skip_ws"));
+    emitLabel("rt_readFloat_check_sign");
+    emit(MoonOp::Ceqi, regOp(4), regOp(3), immOp(45));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readFloat_check_plus"));
+    emit(MoonOp::Addi, regOp(2), regOp(0), immOp(-1));
+    emit(MoonOp::Getc, regOp(3));
+    emit(MoonOp::Andi, regOp(3), regOp(3), immOp(255));
+    emit(MoonOp::J, labelOp("rt_readFloat_int_loop"));
+    emitLabel("rt_readFloat_check_plus");
+    emit(MoonOp::Ceqi, regOp(4), regOp(3), immOp(43));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readFloat_int_loop"));
+    emit(MoonOp::Getc, regOp(3));
+    emit(MoonOp::Andi, regOp(3), regOp(3), immOp(255));
+    emitLabel("rt_readFloat_int_loop");
+    emit(MoonOp::Addi, regOp(6), regOp(0), immOp(48));
+    emit(MoonOp::Addi, regOp(7), regOp(0), immOp(57));
+    emit(MoonOp::Clt, regOp(4), regOp(3), regOp(6));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readFloat_int_check_upper"));
+    emit(MoonOp::J, labelOp("rt_readFloat_maybe_frac"));
+    emitLabel("rt_readFloat_int_check_upper");
+    emit(MoonOp::Cgt, regOp(4), regOp(3), regOp(7));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readFloat_int_consume"));
+    emit(MoonOp::J, labelOp("rt_readFloat_maybe_frac"));
+    emitLabel("rt_readFloat_int_consume");
+    emit(MoonOp::Muli, regOp(1), regOp(1), immOp(10));
+    emit(MoonOp::Sub, regOp(8), regOp(3), regOp(6));
+    emit(MoonOp::Add, regOp(1), regOp(1), regOp(8));
+    emit(MoonOp::Getc, regOp(3));
+    emit(MoonOp::Andi, regOp(3), regOp(3), immOp(255));
+    emit(MoonOp::J, labelOp("rt_readFloat_int_loop"));
+    emitLabel("rt_readFloat_maybe_frac");
+    emit(MoonOp::Addi, regOp(11), regOp(0), immOp(0));
+    emit(MoonOp::Addi, regOp(10), regOp(0), immOp(0));
+    emit(MoonOp::Muli, regOp(1), regOp(1), immOp(kFloatScale));
+    emit(MoonOp::Ceqi, regOp(4), regOp(3), immOp(46));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readFloat_apply_sign"));
+    emit(MoonOp::Getc, regOp(3));
+    emit(MoonOp::Andi, regOp(3), regOp(3), immOp(255));
+    emit(MoonOp::Addi, regOp(11), regOp(0), immOp(kFloatFirstFractionPlace));
+    emit(MoonOp::Addi, regOp(10), regOp(0), immOp(0));
+    emitLabel("rt_readFloat_frac_loop");
+    emit(MoonOp::Clt, regOp(4), regOp(3), regOp(6));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readFloat_frac_check_upper"));
+    emit(MoonOp::J, labelOp("rt_readFloat_apply_sign"));
+    emitLabel("rt_readFloat_frac_check_upper");
+    emit(MoonOp::Cgt, regOp(4), regOp(3), regOp(7));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readFloat_frac_consume"));
+    emit(MoonOp::J, labelOp("rt_readFloat_apply_sign"));
+    emitLabel("rt_readFloat_frac_consume");
+    emit(MoonOp::Ceqi, regOp(4), regOp(11), immOp(0));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readFloat_frac_store"));
+    emit(MoonOp::Getc, regOp(3));
+    emit(MoonOp::Andi, regOp(3), regOp(3), immOp(255));
+    emit(MoonOp::J, labelOp("rt_readFloat_frac_loop"));
+    emitLabel("rt_readFloat_frac_store");
+    emit(MoonOp::Sub, regOp(8), regOp(3), regOp(6));
+    emit(MoonOp::Mul, regOp(8), regOp(8), regOp(11));
+    emit(MoonOp::Add, regOp(10), regOp(10), regOp(8));
+    emit(MoonOp::Ceqi, regOp(4), regOp(11), immOp(1));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readFloat_frac_scale_down"));
+    emit(MoonOp::Addi, regOp(11), regOp(0), immOp(0));
+    emit(MoonOp::J, labelOp("rt_readFloat_frac_next"));
+    emitLabel("rt_readFloat_frac_scale_down");
+    emit(MoonOp::Divi, regOp(11), regOp(11), immOp(10));
+    emitLabel("rt_readFloat_frac_next");
+    emit(MoonOp::Getc, regOp(3));
+    emit(MoonOp::Andi, regOp(3), regOp(3), immOp(255));
+    emit(MoonOp::J, labelOp("rt_readFloat_frac_loop"));
+    emitLabel("rt_readFloat_apply_sign");
+    emit(MoonOp::Add, regOp(1), regOp(1), regOp(10));
+    emit(MoonOp::Clt, regOp(4), regOp(2), regOp(0));
+    emit(MoonOp::Bz, regOp(4), labelOp("rt_readFloat_ret"));
+    emit(MoonOp::Sub, regOp(1), regOp(0), regOp(1));
+    emitLabel("rt_readFloat_ret");
+    emit(MoonOp::Jr, regOp(15));
 
     emitSourceLineContext(0, "[RT_WRITEINT] helper begin");
     emitComment("runtime helper: rt_writeInt (prints integer from r1)");
     emitComment("upgrade from PROVIDED_DOCS/A5/moon/samples/newlib.m: buffer-based decimal emission");
-    emit("align");
-    emit("putint");
-    emit("j rt_writeInt");
-    emit("align");
-    emit("rt_writeInt");
-    emit("add r2, r0, r0");
-    emit("add r3, r0, r0");
-    emit("addi r4, r0, rt_writeInt_endbuf");
-    emit("cge r5, r1, r0");
-    emit("bnz r5, rt_writeInt_digits");
-    emit("addi r3, r0, 1");
-    emit("sub r1, r0, r1");
-    emit("rt_writeInt_digits");
-    emit("modi r2, r1, 10");
-    emit("addi r2, r2, 48");
-    emit("subi r4, r4, 1");
-    emit("sb 0(r4), r2");
-    emit("divi r1, r1, 10");
-    emit("bnz r1, rt_writeInt_digits");
-    emit("bz r3, rt_writeInt_emit");
-    emit("addi r2, r0, 45");
-    emit("subi r4, r4, 1");
-    emit("sb 0(r4), r2");
-    emit("rt_writeInt_emit");
-    emit("lb r2, 0(r4)");
-    emit("putc r2");
-    emit("addi r4, r4, 1");
-    emit("cgei r5, r4, rt_writeInt_endbuf");
-    emit("bz r5, rt_writeInt_emit");
-    emit("jr r15");
-    emit("rt_writeInt_buf res 20");
-    emit("rt_writeInt_endbuf");
+    emit(MoonOp::Align);
+    emitLabel("putint");
+    emit(MoonOp::J, labelOp("rt_writeInt"));
+    emit(MoonOp::Align);
+    emitLabel("rt_writeInt");
+    emit(MoonOp::Add, regOp(2), regOp(0), regOp(0));
+    emit(MoonOp::Add, regOp(3), regOp(0), regOp(0));
+    emit(MoonOp::Addi, regOp(4), regOp(0), labelOp("rt_writeInt_endbuf"));
+    emit(MoonOp::Cge, regOp(5), regOp(1), regOp(0));
+    emit(MoonOp::Bnz, regOp(5), labelOp("rt_writeInt_digits"));
+    emit(MoonOp::Addi, regOp(3), regOp(0), immOp(1));
+    emit(MoonOp::Sub, regOp(1), regOp(0), regOp(1));
+    emitLabel("rt_writeInt_digits");
+    emit(MoonOp::Modi, regOp(2), regOp(1), immOp(10));
+    emit(MoonOp::Addi, regOp(2), regOp(2), immOp(48));
+    emit(MoonOp::Subi, regOp(4), regOp(4), immOp(1));
+    emit(MoonOp::Sb, immOp(0), regOp(4), regOp(2));
+    emit(MoonOp::Divi, regOp(1), regOp(1), immOp(10));
+    emit(MoonOp::Bnz, regOp(1), labelOp("rt_writeInt_digits"));
+    emit(MoonOp::Bz, regOp(3), labelOp("rt_writeInt_emit"));
+    emit(MoonOp::Addi, regOp(2), regOp(0), immOp(45));
+    emit(MoonOp::Subi, regOp(4), regOp(4), immOp(1));
+    emit(MoonOp::Sb, immOp(0), regOp(4), regOp(2));
+    emitLabel("rt_writeInt_emit");
+    emit(MoonOp::Lb, regOp(2), immOp(0), regOp(4));
+    emit(MoonOp::Putc, regOp(2));
+    emit(MoonOp::Addi, regOp(4), regOp(4), immOp(1));
+    emit(MoonOp::Cgei, regOp(5), regOp(4), labelOp("rt_writeInt_endbuf"));
+    emit(MoonOp::Bz, regOp(5), labelOp("rt_writeInt_emit"));
+    emit(MoonOp::Jr, regOp(15));
+    emit(MoonOp::Res, labelOp("rt_writeInt_buf"), immOp(20));
+    emitLabel("rt_writeInt_endbuf");
 
     emitSourceLineContext(0, "[RT_WRITEFLOAT] helper begin");
-    emitComment("runtime helper: rt_writeFloat (prints fixed-point float from r1, scale=" + std::to_string(kFloatScale) + ")");
-    emit("rt_writeFloat");
-    emit("add r2, r1, r0");
-    emit("clt r3, r2, r0");
-    emit("bz r3, rt_writeFloat_abs_ready");
-    emit("addi r4, r0, 45");
-    emit("putc r4");
-    emit("sub r2, r0, r2");
-    emit("rt_writeFloat_abs_ready");
-    emit("divi r5, r2, " + std::to_string(kFloatScale));
-    emit("modi r6, r2, " + std::to_string(kFloatScale));
-    emit("add r11, r6, r0");
-    emit("add r10, r15, r0");
-    emit("add r1, r5, r0");
-    emit("jl r15, rt_writeInt");
-    emit("add r15, r10, r0");
-    emit("add r6, r11, r0");
-    emit("addi r4, r0, 46");
-    emit("putc r4");
+    emitComment("runtime helper: rt_writeFloat (prints fixed-point float from r1, scale=", kFloatScale, ")");
+    emitLabel("rt_writeFloat");
+    emit(MoonOp::Add, regOp(2), regOp(1), regOp(0));
+    emit(MoonOp::Clt, regOp(3), regOp(2), regOp(0));
+    emit(MoonOp::Bz, regOp(3), labelOp("rt_writeFloat_abs_ready"));
+    emit(MoonOp::Addi, regOp(4), regOp(0), immOp(45));
+    emit(MoonOp::Putc, regOp(4));
+    emit(MoonOp::Sub, regOp(2), regOp(0), regOp(2));
+    emitLabel("rt_writeFloat_abs_ready");
+    emit(MoonOp::Divi, regOp(5), regOp(2), immOp(kFloatScale));
+    emit(MoonOp::Modi, regOp(6), regOp(2), immOp(kFloatScale));
+    emit(MoonOp::Add, regOp(11), regOp(6), regOp(0));
+    emit(MoonOp::Add, regOp(10), regOp(15), regOp(0));
+    emit(MoonOp::Add, regOp(1), regOp(5), regOp(0));
+    emit(MoonOp::Jl, regOp(15), labelOp("rt_writeInt"));
+    emit(MoonOp::Add, regOp(15), regOp(10), regOp(0));
+    emit(MoonOp::Add, regOp(6), regOp(11), regOp(0));
+    emit(MoonOp::Addi, regOp(4), regOp(0), immOp(46));
+    emit(MoonOp::Putc, regOp(4));
     for (int divisor = kFloatFirstFractionPlace; divisor > 0; divisor /= 10) {
-        emit("divi r7, r6, " + std::to_string(divisor));
-        emit("addi r7, r7, 48");
-        emit("putc r7");
+        emit(MoonOp::Divi, regOp(7), regOp(6), immOp(divisor));
+        emit(MoonOp::Addi, regOp(7), regOp(7), immOp(48));
+        emit(MoonOp::Putc, regOp(7));
         if (divisor > 1) {
-            emit("modi r6, r6, " + std::to_string(divisor));
+            emit(MoonOp::Modi, regOp(6), regOp(6), immOp(divisor));
         }
     }
-    emit("jr r15");
+    emit(MoonOp::Jr, regOp(15));
 }
 
 /** @brief Lower identifier expression into register value load. */
 void CodeGenVisitor::visit(IdNode& node) {
-    if (hasOffset(node.getName())) {
+    std::string fieldClass;
+    if (bindsFrameSlot(node, node.getName(), fieldClass)) {
         int reg = _regs.acquire();
         if (reg < 0) {
             reportError(node.getLineNumber(), "register exhaustion while loading identifier");
@@ -1630,18 +2118,15 @@ void CodeGenVisitor::visit(IdNode& node) {
             return;
         }
 
-        emitSourceLineContext(
-            node.getLineNumber(),
-            "[REG] " + regName(reg) + " <- mem[" + std::to_string(lookupOffset(node.getName())) + "(r14)]  ; id=" + node.getName()
-        );
-        emit("lw " + regName(reg) + ", " + std::to_string(lookupOffset(node.getName())) + "(r14)");
+        emitSourceLineContext(node.getLineNumber(), "[REG] ", Reg{reg}, " <- mem[", lookupOffset(node.getName()), "(r14)]  ; id=", node.getName());
+        emit(MoonOp::Lw, regOp(reg), immOp(lookupOffset(node.getName())), regOp(14));
         _lastExprReg = reg;
         return;
     }
 
-    if (!_currentClassName.empty()) {
+    if (!fieldClass.empty()) {
         FieldLayoutInfo fieldLayout;
-        if (lookupFieldLayout(_currentClassName, node.getName(), fieldLayout, node.getLineNumber())) {
+        if (lookupFieldLayout(fieldClass, node.getName(), fieldLayout, node.getLineNumber())) {
             const int addrReg = _regs.acquire();
             const int valueReg = _regs.acquire();
             if (addrReg < 0 || valueReg < 0) {
@@ -1664,14 +2149,11 @@ void CodeGenVisitor::visit(IdNode& node) {
             }
 
             if (fieldLayout.offset != 0) {
-                emit("addi " + regName(addrReg) + ", " + regName(addrReg) + ", " + std::to_string(fieldLayout.offset));
+                emit(MoonOp::Addi, regOp(addrReg), regOp(addrReg), immOp(fieldLayout.offset));
             }
 
-            emitSourceLineContext(
-                node.getLineNumber(),
-                "[REG] " + regName(valueReg) + " <- mem[0(" + regName(addrReg) + ")]  ; field=" + node.getName()
-            );
-            emit("lw " + regName(valueReg) + ", 0(" + regName(addrReg) + ")");
+            emitSourceLineContext(node.getLineNumber(), "[REG] ", Reg{valueReg}, " <- mem[0(", Reg{addrReg}, ")]  ; field=", node.getName());
+            emit(MoonOp::Lw, regOp(valueReg), immOp(0), regOp(addrReg));
             _regs.release(addrReg);
             _lastExprReg = valueReg;
             return;
@@ -1691,8 +2173,8 @@ void CodeGenVisitor::visit(IntLitNode& node) {
         return;
     }
 
-    emitSourceLineContext(node.getLineNumber(), "[REG] " + regName(reg) + " <- imm " + std::to_string(node.getIntValue()));
-    emit("addi " + regName(reg) + ", r0, " + std::to_string(node.getIntValue()));
+    emitSourceLineContext(node.getLineNumber(), "[REG] ", Reg{reg}, " <- imm ", node.getIntValue());
+    emit(MoonOp::Addi, regOp(reg), regOp(0), immOp(node.getIntValue()));
     _lastExprReg = reg;
 }
 
@@ -1705,13 +2187,9 @@ void CodeGenVisitor::visit(FloatLitNode& node) {
         return;
     }
 
-    const long lowered = static_cast<long>(std::llround(node.getFloatValue() * static_cast<float>(kFloatScale)));
-    emitSourceLineContext(
-        node.getLineNumber(),
-        "[REG] " + regName(reg) + " <- float(" + std::to_string(node.getFloatValue()) + ") * " + std::to_string(kFloatScale) +
-        " = " + std::to_string(lowered)
-    );
-    emit("addi " + regName(reg) + ", r0, " + std::to_string(lowered));
+    const long lowered = moonFixedPoint(node.getFloatValue());
+    emitSourceLineContext(node.getLineNumber(), "[REG] ", Reg{reg}, " <- float(", node.getFloatValue(), ") * ", kFloatScale, " = ", lowered);
+    emit(MoonOp::Addi, regOp(reg), regOp(0), immOp(lowered));
     _lastExprReg = reg;
 }
 
@@ -1724,13 +2202,22 @@ void CodeGenVisitor::visit(TypeNode&) {
  * @brief Lower binary expression with scalar/fixed-point operator selection.
  *
  * @details
- * Mixed integer-float arithmetic is handled by fixed-point promotion using the
- * module-wide scale constant before operation emission.
+ * The operand with the larger register need is evaluated first (Sethi-Ullman
+ * order) unless either side calls; the other is evaluated while the first
+ * result is held. Mixed integer-float arithmetic is handled by fixed-point
+ * promotion using the module-wide scale constant before operation emission.
  */
 void CodeGenVisitor::visit(BinaryOpNode& node) {
-    emitSourceLineContext(node.getLineNumber(), "[EXPR] binary op='" + node.getOperator() + "'");
-    int leftReg = evalExpr(node.getLeft());
-    int rightReg = evalExpr(node.getRight());
+    emitSourceLineContext(node.getLineNumber(), "[EXPR] binary op='", node.getOperator(), "'");
+    int leftReg = -1;
+    int rightReg = -1;
+    if (evaluatesRightFirst(node)) {
+        rightReg = evalExpr(node.getRight());
+        leftReg = rightReg >= 0 ? evalExprPreserving(node.getLeft(), {rightReg}, node.getLineNumber()) : evalExpr(node.getLeft());
+    } else {
+        leftReg = evalExpr(node.getLeft());
+        rightReg = leftReg >= 0 ? evalExprPreserving(node.getRight(), {leftReg}, node.getLineNumber()) : evalExpr(node.getRight());
+    }
 
     if (leftReg < 0 || rightReg < 0) {
         if (leftReg > 0) {
@@ -1759,59 +2246,58 @@ void CodeGenVisitor::visit(BinaryOpNode& node) {
     const bool useFloatFixedPoint = (isArithmetic || isComparison) && (leftIsFloat || rightIsFloat);
 
     if (useFloatFixedPoint) {
-        emitComment("  fixed-point promotion active for binary op (scale=" + std::to_string(kFloatScale) + ")");
         if (!leftIsFloat) {
-            emit("muli " + regName(leftReg) + ", " + regName(leftReg) + ", " + std::to_string(kFloatScale));
+            emit(MoonOp::Muli, regOp(leftReg), regOp(leftReg), immOp(kFloatScale));
         }
         if (!rightIsFloat) {
-            emit("muli " + regName(rightReg) + ", " + regName(rightReg) + ", " + std::to_string(kFloatScale));
+            emit(MoonOp::Muli, regOp(rightReg), regOp(rightReg), immOp(kFloatScale));
         }
     }
 
     if (op == "+") {
-        emit("add " + regName(leftReg) + ", " + regName(leftReg) + ", " + regName(rightReg));
+        emit(MoonOp::Add, regOp(leftReg), regOp(leftReg), regOp(rightReg));
     } else if (op == "-") {
-        emit("sub " + regName(leftReg) + ", " + regName(leftReg) + ", " + regName(rightReg));
+        emit(MoonOp::Sub, regOp(leftReg), regOp(leftReg), regOp(rightReg));
     } else if (op == "*") {
-        emit("mul " + regName(leftReg) + ", " + regName(leftReg) + ", " + regName(rightReg));
+        emit(MoonOp::Mul, regOp(leftReg), regOp(leftReg), regOp(rightReg));
         if (useFloatFixedPoint) {
-            emit("divi " + regName(leftReg) + ", " + regName(leftReg) + ", " + std::to_string(kFloatScale));
+            emit(MoonOp::Divi, regOp(leftReg), regOp(leftReg), immOp(kFloatScale));
         }
     } else if (op == "/") {
         if (useFloatFixedPoint) {
-            emit("muli " + regName(leftReg) + ", " + regName(leftReg) + ", " + std::to_string(kFloatScale));
+            emit(MoonOp::Muli, regOp(leftReg), regOp(leftReg), immOp(kFloatScale));
         }
-        emit("div " + regName(leftReg) + ", " + regName(leftReg) + ", " + regName(rightReg));
+        emit(MoonOp::Div, regOp(leftReg), regOp(leftReg), regOp(rightReg));
     } else if (op == "mod") {
-        emit("mod " + regName(leftReg) + ", " + regName(leftReg) + ", " + regName(rightReg));
+        emit(MoonOp::Mod, regOp(leftReg), regOp(leftReg), regOp(rightReg));
     } else if (op == "and" || op == "&&") {
-        emit("and " + regName(leftReg) + ", " + regName(leftReg) + ", " + regName(rightReg));
+        emit(MoonOp::And, regOp(leftReg), regOp(leftReg), regOp(rightReg));
     } else if (op == "or" || op == "||") {
-        emit("or " + regName(leftReg) + ", " + regName(leftReg) + ", " + regName(rightReg));
+        emit(MoonOp::Or, regOp(leftReg), regOp(leftReg), regOp(rightReg));
     } else if (op == "==") {
-        emit("ceq " + regName(leftReg) + ", " + regName(leftReg) + ", " + regName(rightReg));
+        emit(MoonOp::Ceq, regOp(leftReg), regOp(leftReg), regOp(rightReg));
     } else if (op == "!=") {
-        emit("cne " + regName(leftReg) + ", " + regName(leftReg) + ", " + regName(rightReg));
+        emit(MoonOp::Cne, regOp(leftReg), regOp(leftReg), regOp(rightReg));
     } else if (op == "<") {
-        emit("clt " + regName(leftReg) + ", " + regName(leftReg) + ", " + regName(rightReg));
+        emit(MoonOp::Clt, regOp(leftReg), regOp(leftReg), regOp(rightReg));
     } else if (op == "<=") {
-        emit("cle " + regName(leftReg) + ", " + regName(leftReg) + ", " + regName(rightReg));
+        emit(MoonOp::Cle, regOp(leftReg), regOp(leftReg), regOp(rightReg));
     } else if (op == ">") {
-        emit("cgt " + regName(leftReg) + ", " + regName(leftReg) + ", " + regName(rightReg));
+        emit(MoonOp::Cgt, regOp(leftReg), regOp(leftReg), regOp(rightReg));
     } else if (op == ">=") {
-        emit("cge " + regName(leftReg) + ", " + regName(leftReg) + ", " + regName(rightReg));
+        emit(MoonOp::Cge, regOp(leftReg), regOp(leftReg), regOp(rightReg));
     } else {
         reportError(node.getLineNumber(), "unsupported binary operator in code generation: '" + op + "'");
     }
 
     _regs.release(rightReg);
-    emitSourceLineContext(node.getLineNumber(), "[REG] result " + regName(leftReg) + " after op '" + op + "'");
+    emitSourceLineContext(node.getLineNumber(), "[REG] result ", Reg{leftReg}, " after op '", op, "'");
     _lastExprReg = leftReg;
 }
 
 /** @brief Lower unary operators (negation, logical not, unary plus passthrough). */
 void CodeGenVisitor::visit(UnaryOpNode& node) {
-    emitSourceLineContext(node.getLineNumber(), "[EXPR] unary op='" + node.getOperator() + "'");
+    emitSourceLineContext(node.getLineNumber(), "[EXPR] unary op='", node.getOperator(), "'");
     int operandReg = evalExpr(node.getLeft());
     if (operandReg < 0) {
         _lastExprReg = -1;
@@ -1820,9 +2306,9 @@ void CodeGenVisitor::visit(UnaryOpNode& node) {
 
     const std::string op = node.getOperator();
     if (op == "-") {
-        emit("sub " + regName(operandReg) + ", r0, " + regName(operandReg));
+        emit(MoonOp::Sub, regOp(operandReg), regOp(0), regOp(operandReg));
     } else if (op == "not") {
-        emit("ceqi " + regName(operandReg) + ", " + regName(operandReg) + ", 0");
+        emit(MoonOp::Ceqi, regOp(operandReg), regOp(operandReg), immOp(0));
     } else if (op != "+") {
         reportError(node.getLineNumber(), "unsupported unary operator in code generation: '" + op + "'");
     }
@@ -1835,14 +2321,17 @@ void CodeGenVisitor::visit(UnaryOpNode& node) {
  *
  * @details
  * Emits argument marshalling, optional receiver handling, frame movement around
- * call, jump-link transfer, and return-value capture.
+ * call, jump-link transfer, and return-value capture. When a later argument or
+ * the receiver calls, argument values are staged in spill temp slots and stored
+ * to the parameter slots only after every argument has been evaluated.
  */
 void CodeGenVisitor::visit(FuncCallNode& node) {
-    emitSourceLineContext(node.getLineNumber(), "[CALL] begin '" + node.getFunctionName() + "'");
+    emitSourceLineContext(node.getLineNumber(), "[CALL] begin '", node.getFunctionName(), "'");
     const FunctionLayoutInfo* targetLayout = nullptr;
     std::shared_ptr<ASTNode> ownerExpr = nullptr;
     bool explicitMethodCall = false;
     bool implicitMethodCall = false;
+    long receiverOffset = 0;
 
     auto calleeMember = std::dynamic_pointer_cast<DataMemberNode>(node.getLeft());
     if (calleeMember != nullptr && calleeMember->getLeft() != nullptr) {
@@ -1861,11 +2350,16 @@ void CodeGenVisitor::visit(FuncCallNode& node) {
             return;
         }
 
-        targetLayout = findFunctionLayout(ownerType, node.getFunctionName());
+        targetLayout = findMethodLayout(ownerType, node.getFunctionName(), callProfile(node), receiverOffset);
     } else {
-        targetLayout = findFunctionLayout("", node.getFunctionName());
-        if (targetLayout == nullptr && !_currentClassName.empty()) {
-            targetLayout = findFunctionLayout(_currentClassName, node.getFunctionName());
+        const ASTAnnotation* annotation = node.getAnnotation();
+        const ASTBinding binding = annotation != nullptr ? annotation->binding : ASTBinding::None;
+        if (binding != ASTBinding::Method) {
+            targetLayout = findFunctionLayout("", node.getFunctionName(), callProfile(node));
+        }
+        if (targetLayout == nullptr && binding != ASTBinding::Function && !_currentClassName.empty()) {
+            const std::string& receiverClass = binding == ASTBinding::Method ? annotation->receiverClass : _currentClassName;
+            targetLayout = findMethodLayout(receiverClass, node.getFunctionName(), callProfile(node), receiverOffset);
             if (targetLayout != nullptr && targetLayout->isMethod) {
                 implicitMethodCall = true;
             }
@@ -1878,8 +2372,7 @@ void CodeGenVisitor::visit(FuncCallNode& node) {
         return;
     }
 
-    emitComment("[CALL] target=" + targetLayout->key + " label=" + targetLayout->label +
-                " return=" + trimCopy(targetLayout->returnType));
+    emitComment("[CALL] target=", targetLayout->key, " label=", targetLayout->label, " return=", [&] { return trimCopy(targetLayout->returnType); });
 
     const std::string callReturnType = trimCopy(targetLayout->returnType);
     const bool callReturnsObject = !callReturnType.empty() && !isBasicScalarType(callReturnType);
@@ -1892,6 +2385,32 @@ void CodeGenVisitor::visit(FuncCallNode& node) {
 
     const long callerFrameSize = _currentFrameSize;
 
+    // A call in a later argument (or the receiver) reuses this call's parameter area for its own
+    // frame, so argument values wait in spill temp slots until every argument has been evaluated.
+    struct StagedValue {
+        long slot;
+        long storeOffset;
+        long objectSize;
+    };
+    const bool staged = stagesCallArguments(node);
+    std::vector<StagedValue> stagedValues;
+    auto abandonCall = [&] {
+        for (size_t k = 0; k < stagedValues.size(); ++k) {
+            releaseSpillSlot();
+        }
+        _lastExprReg = -1;
+    };
+    auto stageValue = [&](int reg, long storeOffset, long objectSize) {
+        const long slot = acquireSpillSlot(node.getLineNumber());
+        if (slot == 0) {
+            return false;
+        }
+        emit(MoonOp::Sw, immOp(slot), regOp(14), regOp(reg));
+        emitComment("[CALL] stage ", Reg{reg}, " in mem[", slot, "(r14)] for mem[", storeOffset, "(r14)]");
+        stagedValues.push_back({slot, storeOffset, objectSize});
+        return true;
+    };
+
     for (size_t i = 0; i < node.getArgs().size(); ++i) {
         std::string expectedType;
         std::vector<int> expectedDims;
@@ -1907,38 +2426,49 @@ void CodeGenVisitor::visit(FuncCallNode& node) {
         const bool expectedIsObject = !expectedIsArray && !expectedType.empty() && !isBasicScalarType(expectedType);
         const long storeOffset = targetLayout->paramOffsets[i] - callerFrameSize;
 
-        emitComment("[CALL] arg[" + std::to_string(i) + "] -> mem[" + std::to_string(storeOffset) + "(r14)], expectedType=" +
-            (expectedType.empty() ? std::string("<unknown>") : expectedType) +
-                ", expectedDims=" + dimensionsToString(expectedDims));
+        emitComment(
+            "[CALL] arg[", i, "] -> mem[", storeOffset, "(r14)], expectedType=",
+            [&] { return expectedType.empty() ? std::string("<unknown>") : expectedType; }, ", expectedDims=",
+            expectedDims
+        );
 
         if (expectedIsObject) {
             const int srcAddrReg = emitAddressForObjectExpression(node.getArgs()[i], node.getLineNumber());
             if (srcAddrReg < 0) {
-                _lastExprReg = -1;
+                abandonCall();
                 return;
             }
 
-            const int dstAddrReg = _regs.acquire();
-            if (dstAddrReg < 0) {
+            const long objectSize = sizeOfType(expectedType, node.getLineNumber());
+            if (objectSize <= 0) {
                 _regs.release(srcAddrReg);
-                reportError(node.getLineNumber(), "register exhaustion while preparing aggregate argument slot");
-                _lastExprReg = -1;
+                abandonCall();
                 return;
             }
 
-            const long objectSize = sizeOfType(expectedType, node.getLineNumber());
-            if (objectSize <= 0) {
-                _regs.release(dstAddrReg);
+            if (staged) {
+                const bool stagedOk = stageValue(srcAddrReg, storeOffset, objectSize);
                 _regs.release(srcAddrReg);
-                _lastExprReg = -1;
+                if (!stagedOk) {
+                    abandonCall();
+                    return;
+                }
+                continue;
+            }
+
+            const int dstAddrReg = _regs.acquire();
+            if (dstAddrReg < 0) {
+                _regs.release(srcAddrReg);
+                reportError(node.getLineNumber(), "register exhaustion while preparing aggregate argument slot");
+                abandonCall();
                 return;
             }
 
-            emit("addi " + regName(dstAddrReg) + ", r14, " + std::to_string(storeOffset));
+            emit(MoonOp::Addi, regOp(dstAddrReg), regOp(14), immOp(storeOffset));
             if (!emitCopyWords(dstAddrReg, srcAddrReg, objectSize, node.getLineNumber())) {
                 _regs.release(dstAddrReg);
                 _regs.release(srcAddrReg);
-                _lastExprReg = -1;
+                abandonCall();
                 return;
             }
 
@@ -1955,7 +2485,7 @@ void CodeGenVisitor::visit(FuncCallNode& node) {
         }
 
         if (argReg < 0) {
-            _lastExprReg = -1;
+            abandonCall();
             return;
         }
 
@@ -1966,61 +2496,116 @@ void CodeGenVisitor::visit(FuncCallNode& node) {
         const bool expectedIsFloat = !expectedIsArray && expectedType == "float";
 
         if (expectedIsFloat && !actualIsFloat) {
-            emit("muli " + regName(argReg) + ", " + regName(argReg) + ", " + std::to_string(kFloatScale));
+            emit(MoonOp::Muli, regOp(argReg), regOp(argReg), immOp(kFloatScale));
+        }
+
+        if (staged) {
+            const bool stagedOk = stageValue(argReg, storeOffset, 0);
+            _regs.release(argReg);
+            if (!stagedOk) {
+                abandonCall();
+                return;
+            }
+            continue;
         }
 
-        emit("sw " + std::to_string(storeOffset) + "(r14), " + regName(argReg));
-        emitComment("[CALL] store arg from " + regName(argReg));
+        emit(MoonOp::Sw, immOp(storeOffset), regOp(14), regOp(argReg));
+        emitComment("[CALL] store arg from ", Reg{argReg});
         _regs.release(argReg);
     }
 
     if (targetLayout->isMethod) {
         emitComment("[CALL] prepare receiver (this)");
-        const int thisReg = _regs.acquire();
-        if (thisReg < 0) {
-            reportError(node.getLineNumber(), "register exhaustion while preparing method receiver");
-            _lastExprReg = -1;
-            return;
-        }
-
+        int thisReg = -1;
         if (explicitMethodCall) {
-            const int ownerAddrReg = emitAddressForLValue(ownerExpr, node.getLineNumber());
-            if (ownerAddrReg < 0) {
-                _regs.release(thisReg);
-                _lastExprReg = -1;
+            thisReg = emitAddressForLValue(ownerExpr, node.getLineNumber());
+            if (thisReg < 0) {
+                abandonCall();
                 return;
             }
-
-            emit("add " + regName(thisReg) + ", " + regName(ownerAddrReg) + ", r0");
-            _regs.release(ownerAddrReg);
         } else if (implicitMethodCall) {
+            thisReg = _regs.acquire();
+            if (thisReg < 0) {
+                reportError(node.getLineNumber(), "register exhaustion while preparing method receiver");
+                abandonCall();
+                return;
+            }
             if (!loadThisPointerInto(thisReg, node.getLineNumber())) {
                 _regs.release(thisReg);
-                _lastExprReg = -1;
+                abandonCall();
                 return;
             }
         } else {
             reportError(node.getLineNumber(), "method call requires an object receiver");
-            _regs.release(thisReg);
-            _lastExprReg = -1;
+            abandonCall();
             return;
         }
 
+        if (receiverOffset != 0) {
+            emit(MoonOp::Addi, regOp(thisReg), regOp(thisReg), immOp(receiverOffset));
+            emitComment("[CALL] receiver adjusted to inherited sub-object at +", receiverOffset);
+        }
+
         const long thisStoreOffset = targetLayout->thisOffset - callerFrameSize;
-        emit("sw " + std::to_string(thisStoreOffset) + "(r14), " + regName(thisReg));
-        emitComment("[CALL] receiver -> mem[" + std::to_string(thisStoreOffset) + "(r14)]");
-        _regs.release(thisReg);
+        if (staged) {
+            const bool stagedOk = stageValue(thisReg, thisStoreOffset, 0);
+            _regs.release(thisReg);
+            if (!stagedOk) {
+                abandonCall();
+                return;
+            }
+        } else {
+            emit(MoonOp::Sw, immOp(thisStoreOffset), regOp(14), regOp(thisReg));
+            emitComment("[CALL] receiver -> mem[", thisStoreOffset, "(r14)]");
+            _regs.release(thisReg);
+        }
+    }
+
+    for (const StagedValue& value : stagedValues) {
+        const int valueReg = _regs.acquire();
+        if (valueReg < 0) {
+            reportError(node.getLineNumber(), "register exhaustion while storing staged arguments");
+            abandonCall();
+            return;
+        }
+
+        emit(MoonOp::Lw, regOp(valueReg), immOp(value.slot), regOp(14));
+        if (value.objectSize > 0) {
+            const int dstAddrReg = _regs.acquire();
+            if (dstAddrReg < 0) {
+                _regs.release(valueReg);
+                reportError(node.getLineNumber(), "register exhaustion while preparing aggregate argument slot");
+                abandonCall();
+                return;
+            }
+
+            emit(MoonOp::Addi, regOp(dstAddrReg), regOp(14), immOp(value.storeOffset));
+            const bool copied = emitCopyWords(dstAddrReg, valueReg, value.objectSize, node.getLineNumber());
+            _regs.release(dstAddrReg);
+            if (!copied) {
+                _regs.release(valueReg);
+                abandonCall();
+                return;
+            }
+        } else {
+            emit(MoonOp::Sw, immOp(value.storeOffset), regOp(14), regOp(valueReg));
+            emitComment("[CALL] store staged value -> mem[", value.storeOffset, "(r14)]");
+        }
+        _regs.release(valueReg);
+    }
+    for (size_t k = 0; k < stagedValues.size(); ++k) {
+        releaseSpillSlot();
     }
 
     if (callerFrameSize > 0) {
-        emitComment("[FRAME] reserve " + std::to_string(callerFrameSize) + "B before call");
-        emit("subi r14, r14, " + std::to_string(callerFrameSize));
+        emitComment("[FRAME] reserve ", callerFrameSize, "B before call");
+        emit(MoonOp::Subi, regOp(14), regOp(14), immOp(callerFrameSize));
     }
-    emitComment("[CALL] jl r15 -> " + targetLayout->label);
-    emit("jl r15, " + targetLayout->label);
+    emitComment("[CALL] jl r15 -> ", targetLayout->label);
+    emit(MoonOp::Jl, regOp(15), labelOp(targetLayout->label));
     if (callerFrameSize > 0) {
         emitComment("[FRAME] restore r14 after call");
-        emit("addi r14, r14, " + std::to_string(callerFrameSize));
+        emit(MoonOp::Addi, regOp(14), regOp(14), immOp(callerFrameSize));
     }
 
     const int resultReg = _regs.acquire();
@@ -2030,17 +2615,17 @@ void CodeGenVisitor::visit(FuncCallNode& node) {
         return;
     }
 
-    emit("add " + regName(resultReg) + ", r1, r0");
+    emit(MoonOp::Add, regOp(resultReg), regOp(1), regOp(0));
     if (callReturnsObject) {
         emitComment("object-returning call result propagated as object-address handle in register");
     }
-    emitSourceLineContext(node.getLineNumber(), "[REG] " + regName(resultReg) + " <- r1  ; call result");
+    emitSourceLineContext(node.getLineNumber(), "[REG] ", Reg{resultReg}, " <- r1  ; call result");
     _lastExprReg = resultReg;
 }
 
 /** @brief Lower member access expression by address resolution then load. */
 void CodeGenVisitor::visit(DataMemberNode& node) {
-    emitSourceLineContext(node.getLineNumber(), "[EXPR] data member '" + node.getName() + "' idx=" + std::to_string(node.getIndices().size()));
+    emitSourceLineContext(node.getLineNumber(), "[EXPR] data member '", node.getName(), "' idx=", node.getIndices().size());
     const int addrReg = emitAddressForDataMember(node);
     if (addrReg < 0) {
         _lastExprReg = -1;
@@ -2055,11 +2640,8 @@ void CodeGenVisitor::visit(DataMemberNode& node) {
         return;
     }
 
-    emitSourceLineContext(
-        node.getLineNumber(),
-        "[REG] " + regName(valueReg) + " <- mem[0(" + regName(addrReg) + ")]  ; member=" + node.getName()
-    );
-    emit("lw " + regName(valueReg) + ", 0(" + regName(addrReg) + ")");
+    emitSourceLineContext(node.getLineNumber(), "[REG] ", Reg{valueReg}, " <- mem[0(", Reg{addrReg}, ")]  ; member=", node.getName());
+    emit(MoonOp::Lw, regOp(valueReg), immOp(0), regOp(addrReg));
     _regs.release(addrReg);
     _lastExprReg = valueReg;
 }
@@ -2090,7 +2672,7 @@ void CodeGenVisitor::visit(AssignStmtNode& node) {
         cleanLeftType == cleanRightType;
 
     if (isObjectCopy) {
-        emitSourceLineContext(node.getLineNumber(), "[ASSIGN] object copy type=" + cleanLeftType);
+        emitSourceLineContext(node.getLineNumber(), "[ASSIGN] object copy type=", cleanLeftType);
         const long objectSize = sizeOfType(cleanLeftType, node.getLineNumber());
         if (objectSize <= 0) {
             return;
@@ -2102,16 +2684,13 @@ void CodeGenVisitor::visit(AssignStmtNode& node) {
             return;
         }
 
-        const int dstAddrReg = emitAddressForLValue(node.getLeft(), node.getLineNumber());
+        const int dstAddrReg = emitAddressPreserving(node.getLeft(), {srcAddrReg}, node.getLineNumber());
         if (dstAddrReg < 0) {
             _regs.release(srcAddrReg);
             return;
         }
 
-        emitSourceLineContext(
-            node.getLineNumber(),
-            "[MEM] object copy " + std::to_string(objectSize) + "B via dst=" + regName(dstAddrReg) + " src=" + regName(srcAddrReg)
-        );
+        emitSourceLineContext(node.getLineNumber(), "[MEM] object copy ", objectSize, "B via dst=", Reg{dstAddrReg}, " src=", Reg{srcAddrReg});
 
         if (!emitCopyWords(dstAddrReg, srcAddrReg, objectSize, node.getLineNumber())) {
             _regs.release(srcAddrReg);
@@ -2130,15 +2709,15 @@ void CodeGenVisitor::visit(AssignStmtNode& node) {
     }
 
     emitSourceLineContext(
-        node.getLineNumber(),
-        "[ASSIGN] scalar leftType=" + cleanLeftType + ", rightType=" + cleanRightType + ", valueReg=" + regName(valueReg)
+        node.getLineNumber(), "[ASSIGN] scalar leftType=", cleanLeftType, ", rightType=", cleanRightType, ", valueReg=",
+        Reg{valueReg}
     );
 
     const bool leftIsFloat = leftResolved && leftDims.empty() && trimCopy(leftType) == "float";
     const bool rightIsFloat = rightResolved && rightDims.empty() && trimCopy(rightType) == "float";
 
     if (leftIsFloat && !rightIsFloat) {
-        emit("muli " + regName(valueReg) + ", " + regName(valueReg) + ", " + std::to_string(kFloatScale));
+        emit(MoonOp::Muli, regOp(valueReg), regOp(valueReg), immOp(kFloatScale));
     }
 
     if (!emitStoreTarget(node.getLeft(), valueReg)) {
@@ -2159,26 +2738,23 @@ void CodeGenVisitor::visit(IfStmtNode& node) {
 
     const std::string elseLabel = makeLabel("else");
     const std::string endLabel = makeLabel("endif");
-    emitSourceLineContext(
-        node.getLineNumber(),
-        "[CTRL] if condReg=" + regName(condReg) + " false->" + elseLabel + " end->" + endLabel
-    );
+    emitSourceLineContext(node.getLineNumber(), "[CTRL] if condReg=", Reg{condReg}, " false->", elseLabel, " end->", endLabel);
 
-    emit("bz " + regName(condReg) + ", " + elseLabel);
+    emit(MoonOp::Bz, regOp(condReg), labelOp(elseLabel));
     _regs.release(condReg);
 
     if (node.getRight() != nullptr) {
         node.getRight()->accept(*this);
     }
 
-    emit("j " + endLabel);
-    emit(elseLabel);
+    emit(MoonOp::J, labelOp(endLabel));
+    emitLabel(elseLabel);
 
     if (node.getElseBlock() != nullptr) {
         node.getElseBlock()->accept(*this);
     }
 
-    emit(endLabel);
+    emitLabel(endLabel);
 }
 
 /** @brief Lower while loop with explicit start/end labels and conditional branch. */
@@ -2186,26 +2762,26 @@ void CodeGenVisitor::visit(WhileStmtNode& node) {
     emitSourceLineContext(node.getLineNumber(), "[CTRL] while begin");
     const std::string startLabel = makeLabel("while_start");
     const std::string endLabel = makeLabel("while_end");
-    emitComment("[CTRL] while labels start=" + startLabel + " end=" + endLabel);
+    emitComment("[CTRL] while labels start=", startLabel, " end=", endLabel);
 
-    emit(startLabel);
+    emitLabel(startLabel);
 
     int condReg = evalExpr(node.getLeft());
     if (condReg < 0) {
         return;
     }
 
-    emitSourceLineContext(node.getLineNumber(), "[CTRL] while condReg=" + regName(condReg) + " false->" + endLabel);
+    emitSourceLineContext(node.getLineNumber(), "[CTRL] while condReg=", Reg{condReg}, " false->", endLabel);
 
-    emit("bz " + regName(condReg) + ", " + endLabel);
+    emit(MoonOp::Bz, regOp(condReg), labelOp(endLabel));
     _regs.release(condReg);
 
     if (node.getRight() != nullptr) {
         node.getRight()->accept(*this);
     }
 
-    emit("j " + startLabel);
-    emit(endLabel);
+    emit(MoonOp::J, labelOp(startLabel));
+    emitLabel(endLabel);
 }
 
 /**
@@ -2217,7 +2793,7 @@ void CodeGenVisitor::visit(WhileStmtNode& node) {
  */
 void CodeGenVisitor::visit(IOStmtNode& node) {
     const std::string ioType = node.getValue();
-    emitSourceLineContext(node.getLineNumber(), "[IO] begin kind='" + ioType + "'");
+    emitSourceLineContext(node.getLineNumber(), "[IO] begin kind='", ioType, "'");
 
     if (ioType == "read") {
         std::string targetType;
@@ -2238,10 +2814,10 @@ void CodeGenVisitor::visit(IOStmtNode& node) {
 
         if (targetType == "float") {
             emitComment("read lowered to decimal float parser (rt_readFloat)");
-            emit("jl r15, rt_readFloat");
+            emit(MoonOp::Jl, regOp(15), labelOp("rt_readFloat"));
         } else {
             emitComment("read lowered to decimal integer parser (rt_readInt)");
-            emit("jl r15, rt_readInt");
+            emit(MoonOp::Jl, regOp(15), labelOp("rt_readInt"));
         }
 
         int inputReg = _regs.acquire();
@@ -2250,8 +2826,8 @@ void CodeGenVisitor::visit(IOStmtNode& node) {
             return;
         }
 
-        emit("add " + regName(inputReg) + ", r1, r0");
-        emitSourceLineContext(node.getLineNumber(), "[REG] " + regName(inputReg) + " <- r1  ; read result");
+        emit(MoonOp::Add, regOp(inputReg), regOp(1), regOp(0));
+        emitSourceLineContext(node.getLineNumber(), "[REG] ", Reg{inputReg}, " <- r1  ; read result");
         emitStoreTarget(node.getLeft(), inputReg);
         _regs.release(inputReg);
         return;
@@ -2268,14 +2844,14 @@ void CodeGenVisitor::visit(IOStmtNode& node) {
         const bool valueResolved = resolveNodeType(node.getLeft(), valueType, valueDims);
         const bool valueIsFloat = valueResolved && valueDims.empty() && trimCopy(valueType) == "float";
 
-        emit("add r1, " + regName(valueReg) + ", r0");
-        emitSourceLineContext(node.getLineNumber(), "[REG] r1 <- " + regName(valueReg) + "  ; write argument");
+        emit(MoonOp::Add, regOp(1), regOp(valueReg), regOp(0));
+        emitSourceLineContext(node.getLineNumber(), "[REG] r1 <- ", Reg{valueReg}, "  ; write argument");
         if (valueIsFloat) {
             emitComment("write lowered to fixed-point float printer (rt_writeFloat)");
-            emit("jl r15, rt_writeFloat");
+            emit(MoonOp::Jl, regOp(15), labelOp("rt_writeFloat"));
         } else {
             emitComment("write lowered to decimal integer printer (rt_writeInt)");
-            emit("jl r15, rt_writeInt");
+            emit(MoonOp::Jl, regOp(15), labelOp("rt_writeInt"));
         }
         _regs.release(valueReg);
         return;
@@ -2295,8 +2871,8 @@ void CodeGenVisitor::visit(ReturnStmtNode& node) {
             int retAddrReg = emitAddressForObjectExpression(node.getLeft(), node.getLineNumber());
             if (retAddrReg >= 0) {
                 emitComment("object return lowered as object-address handle in r1");
-                emit("add r1, " + regName(retAddrReg) + ", r0");
-                emitSourceLineContext(node.getLineNumber(), "[REG] r1 <- " + regName(retAddrReg) + "  ; object return handle");
+                emit(MoonOp::Add, regOp(1), regOp(retAddrReg), regOp(0));
+                emitSourceLineContext(node.getLineNumber(), "[REG] r1 <- ", Reg{retAddrReg}, "  ; object return handle");
                 _regs.release(retAddrReg);
             }
         } else {
@@ -2307,28 +2883,28 @@ void CodeGenVisitor::visit(ReturnStmtNode& node) {
                 const bool actualResolved = resolveNodeType(node.getLeft(), actualType, actualDims);
                 const bool actualIsFloat = actualResolved && actualDims.empty() && trimCopy(actualType) == "float";
                 if (cleanReturnType == "float" && !actualIsFloat) {
-                    emit("muli " + regName(retReg) + ", " + regName(retReg) + ", " + std::to_string(kFloatScale));
+                    emit(MoonOp::Muli, regOp(retReg), regOp(retReg), immOp(kFloatScale));
                 }
 
                 emitComment("return value currently lowered into r1");
-                emit("add r1, " + regName(retReg) + ", r0");
-                emitSourceLineContext(node.getLineNumber(), "[REG] r1 <- " + regName(retReg) + "  ; scalar return");
+                emit(MoonOp::Add, regOp(1), regOp(retReg), regOp(0));
+                emitSourceLineContext(node.getLineNumber(), "[REG] r1 <- ", Reg{retReg}, "  ; scalar return");
                 _regs.release(retReg);
             }
         }
     }
 
     if (_currentFunction != "main") {
-        emit("j " + _currentReturnLabel);
+        emit(MoonOp::J, labelOp(_currentReturnLabel));
     }
 }
 
 /** @brief Lower statement block by visiting statements in source order. */
 void CodeGenVisitor::visit(BlockNode& node) {
-    emitSourceLineContext(node.getLineNumber(), "[BLOCK] statements=" + std::to_string(node.getStatements().size()));
+    emitSourceLineContext(node.getLineNumber(), "[BLOCK] statements=", node.getStatements().size());
     for (const auto& stmt : node.getStatements()) {
         if (stmt != nullptr) {
-            emitSourceLineContext(stmt->getLineNumber(), "[STMT] " + summarizeNode(stmt));
+            emitSourceLineContext(stmt->getLineNumber(), "[STMT] ", [&] { return summarizeNode(stmt); });
             stmt->accept(*this);
             if (std::dynamic_pointer_cast<FuncCallNode>(stmt) != nullptr && _lastExprReg > 0) {
                 _regs.release(_lastExprReg);
@@ -2351,7 +2927,7 @@ void CodeGenVisitor::visit(FuncDefNode& node) {
 
 /** @brief Class declaration node currently contributes layout metadata only. */
 void CodeGenVisitor::visit(ClassDeclNode& node) {
-    emitComment("class code generation not implemented for: " + node.getName());
+    emitComment("class code generation not implemented for: ", node.getName());
 }
 
 /**
@@ -2366,6 +2942,7 @@ void CodeGenVisitor::visit(ProgNode& node) {
     _classLayouts.clear();
     _classSizes.clear();
     _functionLayouts.clear();
+    _registerNeeds.clear();
 
     for (const auto& cls : node.getClasses()) {
         if (cls != nullptr) {
@@ -2373,8 +2950,6 @@ void CodeGenVisitor::visit(ProgNode& node) {
         }
     }
 
-    emitComment("semantic step: collect class declarations count=" + std::to_string(_classDecls.size()));
-
     for (const auto& cls : node.getClasses()) {
         if (cls == nullptr) {
             continue;
@@ -2390,13 +2965,12 @@ void CodeGenVisitor::visit(ProgNode& node) {
             continue;
         }
 
-        emitComment("class layout '" + cls->getName() + "' totalSize=" + std::to_string(layoutIt->second.size));
+        emitComment("class layout '", cls->getName(), "' totalSize=", layoutIt->second.size);
         for (const auto& field : layoutIt->second.fields) {
-            emitComment("  field " + field.first +
-                        " offset=" + std::to_string(field.second.offset) +
-                        " size=" + std::to_string(field.second.size) +
-                        " type=" + field.second.typeName +
-                        " dims=" + dimensionsToString(field.second.dimensions));
+            emitComment(
+                "  field ", field.first, " offset=", field.second.offset, " size=", field.second.size, " type=",
+                field.second.typeName, " dims=", field.second.dimensions
+            );
         }
     }
 
@@ -2412,12 +2986,12 @@ void CodeGenVisitor::visit(ProgNode& node) {
             continue;
         }
 
-        const FunctionLayoutInfo* built = findFunctionLayout(fn->getClassName(), fn->getName());
+        const FunctionLayoutInfo* built = findFunctionLayout(fn->getClassName(), fn->getName(), parameterProfile(*fn));
         if (built != nullptr) {
-            emitComment("function layout built: " + built->key +
-                        " frame=" + std::to_string(built->frameSize) +
-                        " params=" + std::to_string(built->paramNames.size()) +
-                        " locals+temps=" + std::to_string(built->varOffsets.size()));
+            emitComment(
+                "function layout built: ", built->key, " frame=", built->frameSize, " params=",
+                built->paramNames.size(), " locals+temps=", built->varOffsets.size()
+            );
         }
 
         if (fn->getClassName().empty() && fn->getName() == "main") {
@@ -2441,10 +3015,10 @@ void CodeGenVisitor::visit(ProgNode& node) {
     const std::string programEndLabel = makeLabel("program_end");
 
     emitFunctionBody(mainFunction, *mainLayout, true);
-    emit("j " + programEndLabel);
+    emit(MoonOp::J, labelOp(programEndLabel));
 
     for (const auto& fn : nonMainFunctions) {
-        const FunctionLayoutInfo* layout = findFunctionLayout(fn->getClassName(), fn->getName());
+        const FunctionLayoutInfo* layout = findFunctionLayout(fn->getClassName(), fn->getName(), parameterProfile(*fn));
         if (layout == nullptr) {
             reportError(fn->getLineNumber(), "missing function layout for '" + functionKey(fn->getClassName(), fn->getName()) + "'");
             continue;
@@ -2453,28 +3027,53 @@ void CodeGenVisitor::visit(ProgNode& node) {
         emitFunctionBody(fn, *layout, false);
     }
 
-    emit(programEndLabel);
+    emitLabel(programEndLabel);
 }
 
 /**
  * @brief Convenience front-end for writing generated Moon assembly to file.
  * @return True when generation succeeded and output file was writable.
  */
-bool generateMoonAssembly(const std::shared_ptr<ProgNode>& root, const std::string& outputPath, std::vector<std::string>* errors) {
-    std::ofstream out(outputPath, std::ios::out | std::ios::trunc | std::ios::binary);
-    if (!out.is_open()) {
+bool generateMoonAssembly(const std::shared_ptr<ProgNode>& root, const std::string& outputPath, std::vector<std::string>* errors,
+                          const DiagnosticOptions& options, std::size_t* instructionCount, MoonEmitMode mode,
+                          MoonLineMap* lineMap, const MoonPeepholeOptions& peephole, MoonPeepholeStats* peepholeStats) {
+    BufferedFileSink out(outputPath, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!out.isOpen()) {
         if (errors != nullptr) {
             errors->push_back("[ERROR][CODEGEN] Failed to open output file: " + outputPath);
         }
         return false;
     }
 
-    CodeGenVisitor generator(out);
+    CodeGenVisitor generator(out.stream());
+    generator.setDiagnosticOptions(options);
+    generator.setEmitMode(mode);
+    generator.setLineMap(lineMap);
+    generator.setPeepholeOptions(peephole);
     const bool success = generator.generate(root);
+    const bool written = out.close();
 
     if (errors != nullptr) {
         *errors = generator.getErrors();
     }
+    if (instructionCount != nullptr) {
+        *instructionCount = generator.instructionCount();
+    }
+    if (peepholeStats != nullptr) {
+        *peepholeStats = generator.peepholeStats();
+    }
+
+    return success && written;
+}
 
-    return success;
+/** @brief Run a lean generator against a stream without a buffer, which drops every line. */
+std::size_t countMoonInstructions(const std::shared_ptr<ProgNode>& root, const DiagnosticOptions& options,
+                                  const MoonPeepholeOptions& peephole) {
+    std::ostream discard(nullptr);
+    CodeGenVisitor generator(discard);
+    generator.setDiagnosticOptions(options);
+    generator.setEmitMode(MoonEmitMode::Lean);
+    generator.setPeepholeOptions(peephole);
+    generator.generate(root);
+    return generator.instructionCount();
 }
@@ -0,0 +1,283 @@
+#include "../include/diagnostics.h"
+
+#include <functional>
+#include <stdexcept>
+
+/**
+ * @file diagnostics.cpp
+ * @brief Diagnostic templates, argument handling, and DiagnosticEngine storage/formatting.
+ */
+
+namespace {
+/**
+ * @struct DiagnosticTemplate
+ * @brief Severity and message text of one DiagnosticCode.
+ *
+ * @details
+ * Text uses {0}..{9} for arguments and {line} for the source line. Located
+ * templates get the "line N: " prefix used by semantic and codegen output;
+ * syntax templates place the line themselves.
+ */
+struct DiagnosticTemplate {
+    DiagnosticSeverity severity;
+    bool located;
+    const char* text;
+};
+
+constexpr DiagnosticSeverity E = DiagnosticSeverity::Error;
+constexpr DiagnosticSeverity W = DiagnosticSeverity::Warning;
+
+/** @brief Templates indexed by DiagnosticCode (order must match the enum). */
+const DiagnosticTemplate kTemplates[] = {
+    // Syntax
+    {E, false, "Empty token stream"},
+    {E, false, "{0} at line {line}. Found token: {1}. Expected one of type: {2}"},
+
+    // Declarations and definitions
+    {E, true, "6.1 undeclared member function definition: '{0}::{1}'"},
+    {E, true, "6.2 undefined member function declaration: '{0}::{1}'"},
+    {E, true, "8.1 multiply declared class: '{0}'"},
+    {E, true, "8.2 multiply declared free function: '{0}'"},
+    {E, true, "8.3 multiply declared data member in class: '{0}'"},
+    {E, true, "8.4 multiply declared variable '{0}' in scope '{1}'"},
+    {W, true, "8.6 shadowed inherited data member: '{0}'"},
+    {W, true, "8.7 local variable in member function shadows data member: '{0}'"},
+    {W, true, "9.1 overloaded free function: '{0}'"},
+    {W, true, "9.2 overloaded member function: '{0}::{1}'"},
+    {W, true, "9.3 overridden member function: '{0}::{1}'"},
+    {E, true, "redefinition of symbol '{0}' in scope '{1}'"},
+    {E, true, "symbol '{0}' already exists with non-function kind in scope '{1}'"},
+    {E, true, "multiple implementations for function '{0}' in scope '{1}'"},
+    {E, true, "definition for method '{0}::{1}' has unknown class"},
+    {E, true, "non-void function '{0}' must contain a return statement"},
+
+    // Types and statements
+    {E, true, "10.1 type error in expression: left operand must be numeric"},
+    {E, true, "10.1 type error in expression: right operand must be numeric"},
+    {E, true, "10.2 type error in assignment statement: cannot assign '{0}' to '{1}'"},
+    {E, true, "10.3 type error in return statement: function expects 'void' but return has expression of type '{0}'"},
+    {E, true, "10.3 type error in return statement: function expects '{0}' but return has no expression"},
+    {E, true, "10.3 type error in return statement: expected '{0}', got '{1}'"},
+    {E, true, "return statement used outside of function body"},
+    {E, true, "condition in 'if' must evaluate to numeric/boolean-compatible type, found '{0}'"},
+    {E, true, "condition in 'while' must evaluate to numeric/boolean-compatible type, found '{0}'"},
+    {E, true, "read statement requires an assignable variable/member target"},
+    {E, true, "read statement target must be scalar integer/float/bool, found '{0}'"},
+    {E, true, "write statement cannot output expression of type 'void'"},
+
+    // Names
+    {E, true, "11.1 undeclared local variable: '{0}'"},
+    {E, true, "11.2 undeclared member variable or unresolved identifier: '{0}'"},
+    {E, true, "11.2 undeclared member variable: type '{0}' has no member named '{1}'"},
+    {E, true, "11.3 undeclared member function: '{0}::{1}'"},
+    {E, true, "11.4 undeclared/undefined free function: '{0}'"},
+    {E, true, "11.5 undeclared class: '{0}'"},
+
+    // Calls
+    {E, true, "12.1 function call with wrong number of parameters: '{0}': expected {1}, got {2}"},
+    {E, true, "12.2 function call with wrong type of parameters in call to '{0}': expected '{1}', got '{2}'"},
+
+    // Arrays
+    {E, true, "13.1 array '{0}' has {1} dimension(s) but is accessed with {2} index/indices"},
+    {E, true, "13.2 array index is not an integer"},
+    {E, true, "13.3 array index out of bounds: index {0} for array '{1}'"},
+    {E, true, "13.3 array index out of bounds: index {0} exceeds upper bound {1} for array '{2}'"},
+    {E, true, "13.3 potential out-of-bounds access in call to '{0}': size argument {1} is negative for array '{2}'"},
+    {E, true, "13.3 potential out-of-bounds access in call to '{0}': size argument {1} exceeds declared size {2} for array '{3}'"},
+
+    // Classes
+    {E, true, "14.1 circular class dependency among classes {0}"},
+    {E, true, "15.1 '.' operator used on non-class type '{0}'"},
+
+    // Code generation
+    {E, true, "{0}"},
+
+    // Any phase
+    {E, false, "error limit of {0} reached; remaining checks skipped"},
+};
+
+static_assert(sizeof(kTemplates) / sizeof(kTemplates[0]) == static_cast<std::size_t>(DiagnosticCode::Count),
+              "every DiagnosticCode needs exactly one template");
+
+const DiagnosticTemplate& templateFor(DiagnosticCode code) {
+    return kTemplates[static_cast<std::size_t>(code)];
+}
+
+const char* phaseLabel(DiagnosticPhase phase) {
+    switch (phase) {
+        case DiagnosticPhase::Syntax:
+            return "SYNTAX";
+        case DiagnosticPhase::Semantic:
+            return "SEMANTIC";
+        case DiagnosticPhase::CodeGen:
+            return "CODEGEN";
+    }
+    return "UNKNOWN";
+}
+
+/** @brief Fold a value into a running hash (boost-style combine). */
+void hashCombine(std::size_t& seed, std::size_t value) {
+    seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+}
+}
+
+std::string DiagnosticArg::text() const {
+    return _isNumber ? std::to_string(_number) : _text;
+}
+
+bool DiagnosticArg::sameAs(const DiagnosticArg& other) const {
+    if (_isNumber != other._isNumber) {
+        return false;
+    }
+    return _isNumber ? _number == other._number : _text == other._text;
+}
+
+std::size_t DiagnosticArg::hash() const {
+    return _isNumber ? std::hash<long long>()(_number) : std::hash<std::string>()(_text);
+}
+
+DiagnosticEngine::DiagnosticEngine(DiagnosticPhase phase)
+    : _phase(phase) {}
+
+bool DiagnosticEngine::report(DiagnosticCode code, int line, std::initializer_list<DiagnosticArg> args) {
+    return store(code, line, args.begin(), args.size());
+}
+
+void DiagnosticEngine::append(const DiagnosticEngine& other, int lineDelta) {
+    for (const auto& record : other._records) {
+        if (record.code == DiagnosticCode::ErrorLimitReached) {
+            continue;
+        }
+        store(record.code, record.line + lineDelta, other._args.data() + record.firstArg, record.argCount);
+    }
+}
+
+DiagnosticEngine DiagnosticEngine::extract() {
+    DiagnosticEngine taken(_phase);
+    taken._options = _options;
+    std::swap(taken._records, _records);
+    std::swap(taken._args, _args);
+    std::swap(taken._seen, _seen);
+    std::swap(taken._errorCount, _errorCount);
+    std::swap(taken._warningCount, _warningCount);
+    std::swap(taken._limitReached, _limitReached);
+    return taken;
+}
+
+void DiagnosticEngine::clear() {
+    _records.clear();
+    _args.clear();
+    _seen.clear();
+    _errorCount = 0;
+    _warningCount = 0;
+    _limitReached = false;
+}
+
+/**
+ * @brief Apply cap and dedup, then store record and arguments.
+ * @return True when stored.
+ */
+bool DiagnosticEngine::store(DiagnosticCode code, int line, const DiagnosticArg* args, std::size_t argCount) {
+    const DiagnosticSeverity severity = templateFor(code).severity;
+    if (severity == DiagnosticSeverity::Error && _options.maxErrors != 0 && _errorCount >= _options.maxErrors) {
+        if (!_limitReached) {
+            _limitReached = true;
+            const DiagnosticArg limit(_options.maxErrors);
+            _records.push_back({DiagnosticCode::ErrorLimitReached, DiagnosticSeverity::Error, 0,
+                                static_cast<std::uint32_t>(_args.size()), 1});
+            _args.push_back(limit);
+        }
+        return false;
+    }
+
+    std::size_t hash = 0;
+    if (_options.deduplicate) {
+        hash = recordHash(code, line, args, argCount);
+        if (isDuplicate(hash, code, line, args, argCount)) {
+            return false;
+        }
+        _seen.emplace(hash, _records.size());
+    }
+
+    _records.push_back({code, severity, line, static_cast<std::uint32_t>(_args.size()), static_cast<std::uint32_t>(argCount)});
+    _args.insert(_args.end(), args, args + argCount);
+    if (severity == DiagnosticSeverity::Error) {
+        ++_errorCount;
+    } else {
+        ++_warningCount;
+    }
+    return true;
+}
+
+std::size_t DiagnosticEngine::recordHash(DiagnosticCode code, int line, const DiagnosticArg* args, std::size_t argCount) const {
+    std::size_t seed = static_cast<std::size_t>(code);
+    hashCombine(seed, static_cast<std::size_t>(line));
+    for (std::size_t i = 0; i < argCount; ++i) {
+        hashCombine(seed, args[i].hash());
+    }
+    return seed;
+}
+
+bool DiagnosticEngine::isDuplicate(std::size_t hash, DiagnosticCode code, int line, const DiagnosticArg* args, std::size_t argCount) const {
+    auto range = _seen.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        const DiagnosticRecord& record = _records[it->second];
+        if (record.code != code || record.line != line || record.argCount != argCount) {
+            continue;
+        }
+        bool same = true;
+        for (std::size_t i = 0; i < argCount && same; ++i) {
+            same = _args[record.firstArg + i].sameAs(args[i]);
+        }
+        if (same) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Render one record: "[SEVERITY][PHASE] " + optional "line N: " + filled template.
+ */
+std::string DiagnosticEngine::format(const DiagnosticRecord& record) const {
+    const DiagnosticTemplate& tmpl = templateFor(record.code);
+    std::string out = record.severity == DiagnosticSeverity::Error ? "[ERROR][" : "[WARNING][";
+    out += phaseLabel(_phase);
+    out += "] ";
+    if (tmpl.located) {
+        out += "line " + std::to_string(record.line) + ": ";
+    }
+
+    for (const char* p = tmpl.text; *p != '\0'; ++p) {
+        if (*p != '{') {
+            out += *p;
+            continue;
+        }
+        const char* close = p + 1;
+        while (*close != '\0' && *close != '}') {
+            ++close;
+        }
+        const std::string name(p + 1, close);
+        if (name == "line") {
+            out += std::to_string(record.line);
+        } else {
+            const std::size_t index = static_cast<std::size_t>(std::stoul(name));
+            if (index >= record.argCount) {
+                throw std::logic_error("diagnostic template argument {" + name + "} missing");
+            }
+            out += _args[record.firstArg + index].text();
+        }
+        p = *close == '\0' ? close - 1 : close;
+    }
+    return out;
+}
+
+std::vector<std::string> DiagnosticEngine::formatted(DiagnosticSeverity severity) const {
+    std::vector<std::string> lines;
+    for (const auto& record : _records) {
+        if (record.severity == severity) {
+            lines.push_back(format(record));
+        }
+    }
+    return lines;
+}
@@ -1,17 +1,295 @@
 #include <chrono>
+#include <fstream>
+#include <future>
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
+#include "../include/class_interface.h"
 #include "../include/io.h"
 #include "../include/token.h"
 #include "../include/my_parser.h"
 #include "../include/semantic.h"
+#include "../include/ast_optimizer.h"
 #include "../include/codegen.h"
+#include "../include/moon_ir.h"
+#include "../include/moon_line_map.h"
+#include "../include/moon_peephole.h"
 #include "../include/ui.h"
 
 namespace {
+/** @brief DOT node budget applied by default so Graphviz layout time stays bounded. */
+constexpr std::size_t kDefaultDotNodeBudget = 2000;
+
+/**
+ * @brief Command-line configuration for one driver run.
+ */
+struct DriverOptions {
+    std::string sourceFile;
+    ASTPrinter::DotExportOptions dot;
+    bool splitDotPerFunction = false;
+    std::size_t semanticJobs = 0;
+    DiagnosticOptions diagnostics;
+    SymbolTableFormat symbolTableFormat = SymbolTableFormat::Text;
+    bool incrementalCheck = false;
+    std::vector<std::string> importInterfaces;
+    std::string exportInterface;
+    bool optimizeAst = true;
+    /** @brief Also lower the unoptimized AST to report the optimizer's instruction savings. */
+    bool optimizerStats = false;
+    MoonEmitMode moonEmitMode = MoonEmitMode::Trace;
+    bool writeLineMap = false;
+    bool lineMapCheck = false;
+    MoonPeepholeOptions peephole;
+};
+
+/**
+ * @brief Print command-line usage.
+ * @param program Driver executable name.
+ */
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " <source_file> [options]\n"
+              << "  --dot-clusters        group class/function nodes in DOT subgraph clusters\n"
+              << "  --dot-depth=N         collapse AST subtrees deeper than N levels in DOT output\n"
+              << "  --dot-max-nodes=N     collapse DOT subtrees after N nodes (0 = unlimited, default "
+              << kDefaultDotNodeBudget << ")\n"
+              << "  --dot-split           also write one DOT file per function\n"
+              << "  --semantic-jobs=N     check function bodies on N threads (0 = all cores, default; 1 = sequential)\n"
+              << "  --max-errors=N        stop each phase after N errors (0 = unlimited, default)\n"
+              << "  --dedup               drop repeated identical diagnostics\n"
+              << "  --symtab-format=F     symbol-table dump format: text (default) or jsonl\n"
+              << "  --incremental-check   verify incremental re-analysis against the full semantic analysis\n"
+              << "  --import-interface=F  declare the classes of class interface file F before analysis (repeatable)\n"
+              << "  --export-interface=F  write the program's classes to class interface file F\n"
+              << "  --no-ast-opt          generate code without folding, constant propagation, or identity rewrites\n"
+              << "  --opt-stats           also count the instructions generated without the AST optimizer\n"
+              << "  --lean-moon           write Moon assembly without trace and explanatory comments\n"
+              << "  --line-map            also write the instruction-to-source line map (<name>.moon.linemap)\n"
+              << "  --line-map-check      write the line map, decode it, and compare it with the Moon trace comments\n"
+              << "  --no-peephole         print the Moon listing without peephole rewrites\n"
+              << "  --peephole-window=N   instructions and labels a peephole rule may inspect (at least 2, default 4)" << std::endl;
+}
+
+/**
+ * @brief Parse a non-negative integer option value.
+ * @param text Option value text.
+ * @param value Output value.
+ * @return True when text is a valid non-negative integer.
+ */
+bool parseCount(const std::string& text, std::size_t& value) {
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    try {
+        value = static_cast<std::size_t>(std::stoull(text));
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Compare incremental re-analysis of the program with a full analysis.
+ * @param root Program root.
+ * @param options Driver options (pass-2 jobs and diagnostic policy).
+ * @param imports Class interfaces declared before every analysis.
+ *
+ * @details
+ * Records a snapshot from a full analysis, then re-analyzes incrementally once
+ * with no changed definitions and once per definition key marked as changed.
+ * Every run must reproduce the full run's diagnostics and symbol tables.
+ */
+void runIncrementalCheck(const std::shared_ptr<ProgNode>& root, const DriverOptions& options,
+                         const std::vector<ClassInterface>& imports) {
+    auto configure = [&](SemanticAnalyzer& analyzer) {
+        analyzer.setPassTwoJobs(options.semanticJobs);
+        analyzer.setDiagnosticOptions(options.diagnostics);
+        for (const auto& classInterface : imports) {
+            analyzer.importClassInterface(classInterface);
+        }
+    };
+
+    SemanticAnalyzer full;
+    configure(full);
+    full.setRecordSnapshot(true);
+    full.analyze(root);
+    const auto snapshot = full.snapshot();
+    if (snapshot == nullptr) {
+        UI::printWarning("Incremental check skipped (error limit reached)");
+        return;
+    }
+
+    const std::vector<std::string> errors = full.getErrors();
+    const std::vector<std::string> warnings = full.getWarnings();
+    const std::string tables = full.dumpSymbolTables();
+
+    std::vector<std::unordered_set<std::string>> edits(1);
+    for (const auto& key : snapshot->definitionKeys()) {
+        edits.push_back({key});
+    }
+
+    std::size_t mismatches = 0;
+    std::size_t reused = 0;
+    std::size_t checked = 0;
+    for (const auto& changed : edits) {
+        SemanticAnalyzer incremental;
+        configure(incremental);
+        incremental.analyzeIncremental(root, *snapshot, changed);
+        reused += incremental.reusedBodyCount();
+        checked += incremental.checkedBodyCount();
+        if (incremental.getErrors() != errors || incremental.getWarnings() != warnings ||
+            incremental.dumpSymbolTables() != tables) {
+            ++mismatches;
+            UI::printWarning("Incremental re-analysis differs from full analysis" +
+                             (changed.empty() ? std::string() : " (changed: " + *changed.begin() + ")"));
+        }
+    }
+
+    UI::printKV("Incremental", std::to_string(edits.size()) + " re-analyses, " + std::to_string(mismatches) + " mismatch(es)");
+    UI::printKV("Reused Bodies", std::to_string(reused) + " (re-checked " + std::to_string(checked) + ")");
+}
+
+/**
+ * @brief Decode a written line map and compare it with the recorded map and the Moon listing.
+ * @param moonFile Moon listing the map was written for.
+ * @param mapFile Line map file written by writeMoonLineMapFile().
+ * @param recorded Map the code generator recorded.
+ *
+ * @details
+ * Every decoded row must equal its recorded row. When the listing carries trace
+ * comments, the "% [E n][L line][TAG]" comment printed before each instruction
+ * must also name the line and tag that MoonLineMap::find() returns for that
+ * instruction's index; lean listings are checked against the recorded map only.
+ */
+void runLineMapCheck(const std::string& moonFile, const std::string& mapFile, const MoonLineMap& recorded) {
+    MoonLineMap decoded;
+    std::string error;
+    if (!readMoonLineMapFile(mapFile, decoded, error)) {
+        UI::printWarning("Line map check failed to decode " + mapFile + ": " + error);
+        return;
+    }
+
+    std::size_t mismatches = 0;
+    if (decoded.instructionCount() != recorded.instructionCount() || decoded.rows().size() != recorded.rows().size()) {
+        ++mismatches;
+    } else {
+        for (std::size_t i = 0; i < recorded.rows().size(); ++i) {
+            const MoonLineMap::Row& want = recorded.rows()[i];
+            const MoonLineMap::Row& got = decoded.rows()[i];
+            if (got.instruction != want.instruction || got.line != want.line ||
+                decoded.name(got.function) != recorded.name(want.function) || decoded.name(got.tag) != recorded.name(want.tag)) {
+                ++mismatches;
+            }
+        }
+    }
+
+    std::unordered_set<std::string> mnemonics;
+    for (int op = 0; isMoonInstruction(static_cast<MoonOp>(op)); ++op) {
+        mnemonics.insert(moonMnemonic(static_cast<MoonOp>(op)));
+    }
+
+    std::ifstream listing(moonFile);
+    std::string text;
+    std::string trace;
+    std::size_t instruction = 0;
+    while (std::getline(listing, text)) {
+        if (text.rfind("% [E", 0) == 0) {
+            trace = text;
+            continue;
+        }
+        if (text.empty() || text[0] == '%' || mnemonics.count(text.substr(0, text.find(' '))) == 0) {
+            continue;
+        }
+        if (!trace.empty()) {
+            // "% [E12][L7][ASSIGN] text" or "% [E3][RT] text": line, then an optional tag.
+            const std::size_t close = trace.find(']');
+            int line = 0;
+            if (trace.compare(close + 1, 2, "[L") == 0) {
+                line = std::stoi(trace.substr(close + 3));
+            }
+            const std::size_t second = trace.find(']', close + 1);
+            std::string tag;
+            if (second + 1 < trace.size() && trace[second + 1] == '[') {
+                tag = trace.substr(second + 2, trace.find(']', second + 1) - second - 2);
+            }
+            const MoonLineMap::Row* row = decoded.find(instruction);
+            if (row == nullptr || row->line != line || decoded.name(row->tag) != tag) {
+                ++mismatches;
+            }
+            trace.clear();
+        }
+        ++instruction;
+    }
+    if (instruction != decoded.instructionCount() || decoded.find(instruction) != nullptr) {
+        ++mismatches;
+    }
+
+    UI::printKV("Line Map Check", std::to_string(instruction) + " instruction(s), " + std::to_string(mismatches) + " mismatch(es)");
+}
+
+/**
+ * @brief Parse driver arguments.
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @param options Output configuration.
+ * @return True when arguments are valid.
+ */
+bool parseDriverOptions(int argc, char* argv[], DriverOptions& options) {
+    options.dot.maxNodes = kDefaultDotNodeBudget;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::size_t count = 0;
+        if (arg == "--dot-clusters") {
+            options.dot.clusterScopes = true;
+        } else if (arg.rfind("--dot-depth=", 0) == 0 && parseCount(arg.substr(12), count)) {
+            options.dot.maxDepth = static_cast<int>(count);
+        } else if (arg.rfind("--dot-max-nodes=", 0) == 0 && parseCount(arg.substr(16), count)) {
+            options.dot.maxNodes = count;
+        } else if (arg == "--dot-split") {
+            options.splitDotPerFunction = true;
+        } else if (arg.rfind("--semantic-jobs=", 0) == 0 && parseCount(arg.substr(16), count)) {
+            options.semanticJobs = count;
+        } else if (arg.rfind("--max-errors=", 0) == 0 && parseCount(arg.substr(13), count)) {
+            options.diagnostics.maxErrors = count;
+        } else if (arg == "--dedup") {
+            options.diagnostics.deduplicate = true;
+        } else if (arg == "--symtab-format=text") {
+            options.symbolTableFormat = SymbolTableFormat::Text;
+        } else if (arg == "--symtab-format=jsonl") {
+            options.symbolTableFormat = SymbolTableFormat::JsonLines;
+        } else if (arg == "--incremental-check") {
+            options.incrementalCheck = true;
+        } else if (arg.rfind("--import-interface=", 0) == 0 && arg.size() > 19) {
+            options.importInterfaces.push_back(arg.substr(19));
+        } else if (arg.rfind("--export-interface=", 0) == 0 && arg.size() > 19) {
+            options.exportInterface = arg.substr(19);
+        } else if (arg == "--no-ast-opt") {
+            options.optimizeAst = false;
+        } else if (arg == "--opt-stats") {
+            options.optimizerStats = true;
+        } else if (arg == "--lean-moon") {
+            options.moonEmitMode = MoonEmitMode::Lean;
+        } else if (arg == "--line-map") {
+            options.writeLineMap = true;
+        } else if (arg == "--line-map-check") {
+            options.writeLineMap = true;
+            options.lineMapCheck = true;
+        } else if (arg == "--no-peephole") {
+            options.peephole.enabled = false;
+        } else if (arg.rfind("--peephole-window=", 0) == 0 && parseCount(arg.substr(18), count) && count >= 2) {
+            options.peephole.window = count;
+        } else if (arg.rfind("--", 0) != 0 && options.sourceFile.empty()) {
+            options.sourceFile = arg;
+        } else {
+            std::cerr << "Unknown or malformed argument: " << arg << std::endl;
+            return false;
+        }
+    }
+    return !options.sourceFile.empty();
+}
+
 std::string buildBackEndSkipReason(bool parseSuccess, bool semanticHasErrors, const std::shared_ptr<ProgNode>& root) {
     if (!parseSuccess) {
         return "parser errors";
@@ -28,12 +306,13 @@ std::string buildBackEndSkipReason(bool parseSuccess, bool semanticHasErrors, co
 
 int main(int argc, char* argv[]) {
     // Check if the user provided a file argument
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <source_file>" << std::endl;
+    DriverOptions options;
+    if (!parseDriverOptions(argc, argv, options)) {
+        printUsage(argv[0]);
         return 1;
     }
 
-    std::string sourceFile = argv[1];
+    const std::string& sourceFile = options.sourceFile;
     std::vector<PhaseSummary> phases;
 
     // SETUP PHASE
@@ -42,6 +321,9 @@ int main(int argc, char* argv[]) {
 
     CompilerOutputPaths outputs = prepareCompilerOutputPaths(sourceFile, argv[0]);
     UI::printKV("Output", makeDisplayPath(outputs.outputDir));
+    const std::string& symbolTablesFile = options.symbolTableFormat == SymbolTableFormat::JsonLines
+        ? outputs.symbolTablesJsonFile
+        : outputs.symbolTablesFile;
 
     std::vector<std::vector<Token>> valid_tokens;
     bool parseSuccess = false;
@@ -50,6 +332,8 @@ int main(int argc, char* argv[]) {
     bool semanticHasErrors = false;
     bool semanticHasWarnings = false;
     bool codegenHasRunnableMoon = false;
+    std::future<UI::PngRenderResult> pngRender;
+    size_t astPhaseIndex = 0;
 
     // LEXER PHASE
     UI::printSection("[1/6] LEXICAL ANALYSIS");
@@ -80,6 +364,7 @@ int main(int argc, char* argv[]) {
     UI::printSection("[2/6] SYNTACTIC ANALYSIS");
     try {
         auto start = std::chrono::steady_clock::now();
+        Parser::setDiagnosticOptions(options.diagnostics);
         parseSuccess = Parser::parseTokens(valid_tokens);
 
         writeSyntaxErrorsToFile(outputs.syntaxErrorsFile, Parser::getErrorMessages());
@@ -106,29 +391,28 @@ int main(int argc, char* argv[]) {
     UI::printSection("[3/6] AST EXPORT");
     try {
         auto start = std::chrono::steady_clock::now();
+        if (Parser::getASTRoot() != nullptr) {
+            UI::printKV("AST Hash", ASTHasher::toHex(Parser::getASTRoot()->getStructuralHash()));
+        }
         ASTPrinter::writeToFile(Parser::getASTRoot(), outputs.astFile);
-        ASTPrinter::writeDotToFile(Parser::getASTRoot(), outputs.astDotFile);
+        if (!ASTPrinter::writeDotToFile(Parser::getASTRoot(), outputs.astDotFile, options.dot)) {
+            throw std::runtime_error("Failed to open DOT output file: " + outputs.astDotFile);
+        }
+        if (options.splitDotPerFunction) {
+            std::string prefix = buildOutputPath(outputs.astDir, outputs.baseName, "");
+            size_t splitCount = ASTPrinter::writeDotPerFunction(Parser::getASTRoot(), prefix, options.dot).size();
+            UI::printKV("DOT Split", std::to_string(splitCount) + " per-function file(s)");
+        }
 
-        UI::PngRenderResult pngResult = UI::renderAstPngFromDot(outputs.astDotFile, outputs.astPngFile);
-        dotAvailable = pngResult.dotAvailable;
-        pngGenerated = pngResult.pngGenerated;
+        // Graphviz runs beside the remaining phases; the result is joined before the summary.
+        pngRender = UI::renderAstPngFromDotAsync(outputs.astDotFile, outputs.astPngFile);
 
         auto end = std::chrono::steady_clock::now();
         long long durationMs = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
 
-        bool astSuccess = !dotAvailable || (pngGenerated);
-        std::string details = dotAvailable
-            ? (astSuccess ? "AST/DOT/PNG generated" : "AST/DOT generated, image render incomplete")
-            : "AST/DOT generated, Graphviz unavailable";
-        phases.push_back({"AST", astSuccess, durationMs, details});
-
-        if (astSuccess) {
-            UI::printStatusLine(true, "AST export completed");
-        } else {
-            UI::printWarning("AST export completed with warnings");
-        }
-
-        UI::printPngGenerationNotes(pngResult);
+        astPhaseIndex = phases.size();
+        phases.push_back({"AST", true, durationMs, "AST/DOT generated, PNG rendering in background"});
+        UI::printStatusLine(true, "AST export completed (PNG rendering in background)");
 
     } catch (const std::exception& e) {
         UI::printCrash("AST export", e.what());
@@ -143,12 +427,24 @@ int main(int argc, char* argv[]) {
         auto start = std::chrono::steady_clock::now();
 
         SemanticAnalyzer semanticAnalyzer;
+        semanticAnalyzer.setPassTwoJobs(options.semanticJobs);
+        semanticAnalyzer.setDiagnosticOptions(options.diagnostics);
+        std::vector<ClassInterface> imports(options.importInterfaces.size());
+        for (std::size_t i = 0; i < imports.size(); ++i) {
+            const std::string& path = options.importInterfaces[i];
+            std::string error;
+            if (!readClassInterfaceFile(path, imports[i], error)) {
+                throw std::runtime_error("Failed to read class interface " + path + ": " + error);
+            }
+            semanticAnalyzer.importClassInterface(imports[i]);
+            UI::printKV("Imported", path + " (" + std::to_string(imports[i].classes.size()) + " class(es))");
+        }
         bool semanticSuccess = semanticAnalyzer.analyze(Parser::getASTRoot());
 
         (void)semanticSuccess;
 
-        if (!writeTextToFile(outputs.symbolTablesFile, semanticAnalyzer.dumpSymbolTables())) {
-            throw std::runtime_error("Failed to open symbol table output file: " + outputs.symbolTablesFile);
+        if (!semanticAnalyzer.writeSymbolTablesToFile(symbolTablesFile, options.symbolTableFormat)) {
+            throw std::runtime_error("Failed to open symbol table output file: " + symbolTablesFile);
         }
 
         const auto& errors = semanticAnalyzer.getErrors();
@@ -187,6 +483,22 @@ int main(int argc, char* argv[]) {
             UI::printStatusLine(true, "Semantic analysis completed (no semantic diagnostics)");
         }
 
+        if (!options.exportInterface.empty()) {
+            if (hasErrors) {
+                UI::printWarning("Class interface not exported (semantic errors)");
+            } else {
+                const ClassInterface classInterface = semanticAnalyzer.exportClassInterface();
+                if (!writeClassInterfaceFile(options.exportInterface, classInterface)) {
+                    throw std::runtime_error("Failed to write class interface: " + options.exportInterface);
+                }
+                UI::printKV("Interface", options.exportInterface + " (" + std::to_string(classInterface.classes.size()) + " class(es))");
+            }
+        }
+
+        if (options.incrementalCheck) {
+            runIncrementalCheck(Parser::getASTRoot(), options, imports);
+        }
+
     } catch (const std::exception& e) {
         UI::printCrash("Semantic analysis", e.what());
         phases.push_back({"Semantic", false, 0, e.what()});
@@ -216,7 +528,55 @@ int main(int argc, char* argv[]) {
             bool codegenSuccess = false;
             std::string details;
 
-            codegenSuccess = generateMoonAssembly(Parser::getASTRoot(), outputs.moonOutputFile, &codegenErrors);
+            std::shared_ptr<ProgNode> codegenRoot = Parser::getASTRoot();
+            std::size_t unoptimizedInstructions = 0;
+            ASTOptimizer optimizer;
+            if (options.optimizeAst) {
+                if (options.optimizerStats) {
+                    unoptimizedInstructions = countMoonInstructions(codegenRoot, options.diagnostics, options.peephole);
+                }
+                codegenRoot = optimizer.optimize(codegenRoot);
+            }
+
+            std::size_t instructions = 0;
+            MoonLineMap lineMap;
+            MoonPeepholeStats peepholeStats;
+            codegenSuccess = generateMoonAssembly(codegenRoot, outputs.moonOutputFile, &codegenErrors, options.diagnostics, &instructions,
+                                                  options.moonEmitMode, options.writeLineMap ? &lineMap : nullptr, options.peephole,
+                                                  &peepholeStats);
+            if (options.writeLineMap) {
+                if (!writeMoonLineMapFile(outputs.moonLineMapFile, lineMap)) {
+                    throw std::runtime_error("Failed to write Moon line map: " + outputs.moonLineMapFile);
+                }
+                UI::printKV("Line Map", std::to_string(lineMap.rows().size()) + " row(s) for " +
+                                            std::to_string(lineMap.instructionCount()) + " instruction(s)");
+                if (options.lineMapCheck) {
+                    runLineMapCheck(outputs.moonOutputFile, outputs.moonLineMapFile, lineMap);
+                }
+            }
+
+            if (options.optimizeAst) {
+                const ASTOptimizerStats& stats = optimizer.stats();
+                const std::string before = options.optimizerStats ? std::to_string(unoptimizedInstructions) + " -> " : "";
+                UI::printKV("Instructions", before + std::to_string(instructions) +
+                                                " (" + std::to_string(stats.foldedExpressions) + " folded, " +
+                                                std::to_string(stats.propagatedConstants) + " propagated, " +
+                                                std::to_string(stats.simplifiedIdentities) + " simplified)");
+            } else {
+                UI::printKV("Instructions", std::to_string(instructions) + " (AST optimizer off)");
+            }
+            if (options.peephole.enabled) {
+                std::string hits;
+                for (std::size_t rule = 0; rule < kMoonPeepholeRuleCount; ++rule) {
+                    hits += (rule == 0 ? "" : ", ") + std::string(moonPeepholeRuleName(static_cast<MoonPeepholeRule>(rule))) + " " +
+                            std::to_string(peepholeStats.hits[rule]);
+                }
+                UI::printKV("Peephole", std::to_string(peepholeStats.instructionsBefore) + " -> " +
+                                            std::to_string(peepholeStats.instructionsAfter) + " in " +
+                                            std::to_string(peepholeStats.passes) + " pass(es) (" + hits + ")");
+            } else {
+                UI::printKV("Peephole", "off");
+            }
 
             if (!writeLinesToFile(outputs.codegenDiagnosticsFile, codegenErrors)) {
                 throw std::runtime_error("Failed to open codegen diagnostics output file: " + outputs.codegenDiagnosticsFile);
@@ -295,6 +655,22 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (pngRender.valid()) {
+        UI::PngRenderResult pngResult = pngRender.get();
+        dotAvailable = pngResult.dotAvailable;
+        pngGenerated = pngResult.pngGenerated;
+
+        bool astSuccess = !dotAvailable || (pngGenerated);
+        PhaseSummary& astPhase = phases[astPhaseIndex];
+        astPhase.success = astSuccess;
+        astPhase.details = dotAvailable
+            ? (astSuccess ? "AST/DOT/PNG generated" : "AST/DOT generated, image render incomplete")
+            : "AST/DOT generated, Graphviz unavailable";
+
+        std::cout << "\n";
+        UI::printPngGenerationNotes(pngResult);
+    }
+
     UI::printSummaryTable(phases);
 
     UI::printArtifactList("Lexer Outputs", makeDisplayArtifacts({
@@ -317,15 +693,19 @@ int main(int argc, char* argv[]) {
     UI::printArtifactList("AST Outputs", makeDisplayArtifacts(astArtifacts));
 
     UI::printArtifactList("Semantic Outputs", makeDisplayArtifacts({
-        {"Symbol Tables", outputs.symbolTablesFile},
+        {"Symbol Tables", symbolTablesFile},
         {"Sem Diagnostics ", outputs.semanticDiagnosticsFile},
     }));
 
-    UI::printArtifactList("CodeGen Outputs", makeDisplayArtifacts({
+    std::vector<std::pair<std::string, std::string>> codegenArtifacts = {
         {"Moon", outputs.moonOutputFile},
         {"CodeGen Diags", outputs.codegenDiagnosticsFile},
         {"Moon Run Log", outputs.moonRunLogFile},
-    }));
+    };
+    if (options.writeLineMap && canAttemptBackEnd) {
+        codegenArtifacts.push_back({"Line Map", outputs.moonLineMapFile});
+    }
+    UI::printArtifactList("CodeGen Outputs", makeDisplayArtifacts(codegenArtifacts));
 
     UI::printDone();
 
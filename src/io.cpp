@@ -143,8 +143,10 @@ CompilerOutputPaths prepareCompilerOutputPaths(const std::string& sourceFile, co
     paths.astDotFile = buildOutputPath(paths.astDir, paths.baseName, ".outast.dot");
     paths.astPngFile = buildOutputPath(paths.astDir, paths.baseName, ".outast.png");
     paths.symbolTablesFile = buildOutputPath(paths.semanticDir, paths.baseName, ".outsymboltables");
+    paths.symbolTablesJsonFile = buildOutputPath(paths.semanticDir, paths.baseName, ".outsymboltables.jsonl");
     paths.semanticDiagnosticsFile = buildOutputPath(paths.semanticDir, paths.baseName, ".outsemanticerrors");
     paths.moonOutputFile = buildOutputPath(paths.codegenDir, paths.baseName, ".moon");
+    paths.moonLineMapFile = buildOutputPath(paths.codegenDir, paths.baseName, ".moon.linemap");
     paths.codegenDiagnosticsFile = buildOutputPath(paths.codegenDir, paths.baseName, ".outcodegenerrors");
     paths.moonRunLogFile = buildOutputPath(paths.codegenDir, paths.baseName, ".outmoonrun");
 
@@ -0,0 +1,167 @@
+#include "../include/moon_ir.h"
+#include "../include/moon_line_map.h"
+
+#include <ostream>
+#include <utility>
+
+/**
+ * @file moon_ir.cpp
+ * @brief Moon listing storage, printing, and line map derivation.
+ */
+
+namespace {
+/** @brief Mnemonics in MoonOp order. */
+constexpr const char* kMnemonics[] = {
+    "add", "sub", "mul", "div", "mod", "and", "or", "ceq", "cne", "clt", "cle", "cgt", "cge",
+    "addi", "subi", "muli", "divi", "modi", "andi", "ori", "ceqi", "cnei", "clti", "clei", "cgti", "cgei", "sl", "sr",
+    "not",
+    "lw", "lb", "sw", "sb",
+    "getc", "putc", "bz", "bnz", "j", "jr", "jl", "jlr", "nop", "hlt",
+    "", "entry", "align", "res", ""};
+
+static_assert(sizeof(kMnemonics) / sizeof(kMnemonics[0]) == static_cast<std::size_t>(MoonOp::Comment) + 1,
+              "kMnemonics must list every MoonOp");
+}
+
+const char* moonMnemonic(MoonOp op) {
+    return kMnemonics[static_cast<std::size_t>(op)];
+}
+
+void MoonProgram::clear() {
+    _code.clear();
+    _symbols.assign(1, std::string());
+    _symbolIndex.clear();
+    _symbolIndex.emplace(std::string(), 0);
+    _comments.clear();
+}
+
+std::uint32_t MoonProgram::symbol(const std::string& name) {
+    auto it = _symbolIndex.emplace(name, static_cast<std::uint32_t>(_symbols.size())).first;
+    if (it->second == _symbols.size()) {
+        _symbols.push_back(name);
+    }
+    return it->second;
+}
+
+void MoonProgram::appendComment(std::string text, int line, std::uint32_t tag, std::uint32_t function) {
+    MoonInstruction entry;
+    entry.op = MoonOp::Comment;
+    entry.operands[0] = moonImmediate(static_cast<long>(_comments.size()));
+    entry.line = line;
+    entry.tag = tag;
+    entry.function = function;
+    _comments.push_back(std::move(text));
+    _code.push_back(entry);
+}
+
+std::size_t MoonProgram::instructionCount() const {
+    std::size_t count = 0;
+    for (const MoonInstruction& instruction : _code) {
+        if (isMoonInstruction(instruction.op)) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void MoonProgram::formatOperand(const MoonOperand& operand, std::string& text) const {
+    switch (operand.kind) {
+        case MoonOperand::Kind::None:
+            break;
+        case MoonOperand::Kind::Register:
+            text += 'r';
+            text += std::to_string(operand.value);
+            break;
+        case MoonOperand::Kind::Immediate:
+            text += std::to_string(operand.value);
+            break;
+        case MoonOperand::Kind::Symbol:
+            text += _symbols[static_cast<std::size_t>(operand.value)];
+            break;
+    }
+}
+
+void MoonProgram::format(const MoonInstruction& instruction, std::string& text) const {
+    const MoonOperand* operands = instruction.operands;
+    switch (instruction.op) {
+        case MoonOp::Label:
+            formatOperand(operands[0], text);
+            return;
+        case MoonOp::Res:
+            formatOperand(operands[0], text);
+            text += " res ";
+            formatOperand(operands[1], text);
+            return;
+        case MoonOp::Lw:
+        case MoonOp::Lb:
+            text += moonMnemonic(instruction.op);
+            text += ' ';
+            formatOperand(operands[0], text);
+            text += ", ";
+            formatOperand(operands[1], text);
+            text += '(';
+            formatOperand(operands[2], text);
+            text += ')';
+            return;
+        case MoonOp::Sw:
+        case MoonOp::Sb:
+            text += moonMnemonic(instruction.op);
+            text += ' ';
+            formatOperand(operands[0], text);
+            text += '(';
+            formatOperand(operands[1], text);
+            text += "), ";
+            formatOperand(operands[2], text);
+            return;
+        default:
+            break;
+    }
+
+    text += moonMnemonic(instruction.op);
+    for (int i = 0; i < 3 && operands[i].kind != MoonOperand::Kind::None; ++i) {
+        text += i == 0 ? " " : ", ";
+        formatOperand(operands[i], text);
+    }
+}
+
+/** @brief Format each entry once into a reused buffer; trace lines repeat it. */
+void MoonProgram::print(std::ostream& out, MoonEmitMode mode) const {
+    const bool trace = mode == MoonEmitMode::Trace;
+    long traceCounter = 0;
+    std::string text;
+    for (const MoonInstruction& instruction : _code) {
+        if (instruction.op == MoonOp::Comment) {
+            if (trace) {
+                out << "% " << comment(instruction.operands[0].value) << '\n';
+            }
+            continue;
+        }
+
+        text.clear();
+        format(instruction, text);
+        if (trace) {
+            out << "% [E" << ++traceCounter << "]";
+            if (instruction.line > 0) {
+                out << "[L" << instruction.line << "]";
+            } else {
+                out << "[RT]";
+            }
+            if (instruction.tag != 0) {
+                out << "[" << _symbols[instruction.tag] << "]";
+            }
+            out << " " << text << '\n';
+        }
+        out << text << '\n';
+    }
+}
+
+void MoonProgram::recordLineMap(MoonLineMap& lineMap) const {
+    lineMap.clear();
+    std::size_t index = 0;
+    for (const MoonInstruction& instruction : _code) {
+        if (isMoonInstruction(instruction.op)) {
+            lineMap.record(index++, instruction.line, _symbols[instruction.function], _symbols[instruction.tag]);
+        }
+    }
+    lineMap.setInstructionCount(index);
+}
@@ -0,0 +1,258 @@
+#include "../include/moon_line_map.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+/**
+ * @file moon_line_map.cpp
+ * @brief "MLM1" line map recording, encoding, and decoding.
+ */
+
+namespace {
+/** @brief File magic, also the format version. */
+constexpr char kMagic[4] = {'M', 'L', 'M', '1'};
+/** @brief Row flag: a function pool index follows. */
+constexpr std::uint8_t kFunctionChanged = 1;
+/** @brief Row flag: a tag pool index follows. */
+constexpr std::uint8_t kTagChanged = 2;
+
+/** @brief Map a signed value onto unsigned so small magnitudes stay short. */
+std::uint64_t zigzag(std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+/** @brief Inverse of zigzag(). */
+std::int64_t unzigzag(std::uint64_t value) {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+/** @brief Append an unsigned LEB128 varint. */
+void writeVarint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+/**
+ * @class LineMapDecoder
+ * @brief Bounds-checked reader over a line map held in memory.
+ * @details A violation throws std::runtime_error, turned into a false return by
+ * readMoonLineMap().
+ */
+class LineMapDecoder {
+    public:
+        explicit LineMapDecoder(const std::string& data) : _data(data) {}
+
+        void expectMagic() {
+            if (_data.size() < sizeof(kMagic) || _data.compare(0, sizeof(kMagic), kMagic, sizeof(kMagic)) != 0) {
+                throw std::runtime_error("not a Moon line map (missing MLM1 magic)");
+            }
+            _pos = sizeof(kMagic);
+        }
+
+        std::uint8_t readByte() {
+            if (_pos >= _data.size()) {
+                throw std::runtime_error("unexpected end of file");
+            }
+            return static_cast<std::uint8_t>(_data[_pos++]);
+        }
+
+        std::uint64_t readVarint() {
+            std::uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                const std::uint8_t byte = readByte();
+                value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return value;
+                }
+            }
+            throw std::runtime_error("malformed varint");
+        }
+
+        std::int64_t readSigned() { return unzigzag(readVarint()); }
+
+        /** @brief Read a count that must fit in the remaining bytes (each item takes at least one). */
+        std::size_t readCount() {
+            const std::uint64_t count = readVarint();
+            if (count > _data.size() - _pos) {
+                throw std::runtime_error("count exceeds file size");
+            }
+            return static_cast<std::size_t>(count);
+        }
+
+        std::string readBytes(std::size_t length) {
+            std::string bytes = _data.substr(_pos, length);
+            _pos += length;
+            return bytes;
+        }
+
+        bool atEnd() const { return _pos == _data.size(); }
+
+    private:
+        const std::string& _data;
+        std::size_t _pos = 0;
+};
+}
+
+void MoonLineMap::clear() {
+    _rows.clear();
+    _names.assign(1, std::string());
+    _nameIndex.clear();
+    _nameIndex.emplace(std::string(), 0);
+    _instructionCount = 0;
+}
+
+std::uint32_t MoonLineMap::intern(const std::string& name) {
+    auto it = _nameIndex.emplace(name, static_cast<std::uint32_t>(_names.size())).first;
+    if (it->second == _names.size()) {
+        _names.push_back(name);
+    }
+    return it->second;
+}
+
+void MoonLineMap::record(std::size_t instruction, int line, const std::string& function, const std::string& tag) {
+    if (!_rows.empty()) {
+        const Row& last = _rows.back();
+        if (last.line == line && _names[last.function] == function && _names[last.tag] == tag) {
+            return;
+        }
+    }
+    Row row;
+    row.instruction = instruction;
+    row.line = line;
+    row.function = intern(function);
+    row.tag = intern(tag);
+    _rows.push_back(row);
+}
+
+/** @brief Binary search for the last row starting at or before the instruction. */
+const MoonLineMap::Row* MoonLineMap::find(std::size_t instruction) const {
+    if (instruction >= _instructionCount) {
+        return nullptr;
+    }
+    auto it = std::upper_bound(_rows.begin(), _rows.end(), instruction,
+                               [](std::size_t index, const Row& row) { return index < row.instruction; });
+    return it == _rows.begin() ? nullptr : &*(it - 1);
+}
+
+/**
+ * @brief Encode the pool and the rows as deltas from the previous row.
+ * @param out Binary output stream.
+ * @param lineMap Map to encode.
+ */
+void writeMoonLineMap(std::ostream& out, const MoonLineMap& lineMap) {
+    std::string data(kMagic, sizeof(kMagic));
+    writeVarint(data, lineMap.instructionCount());
+    writeVarint(data, lineMap.nameCount());
+    for (std::uint32_t i = 0; i < lineMap.nameCount(); ++i) {
+        writeVarint(data, lineMap.name(i).size());
+        data += lineMap.name(i);
+    }
+
+    writeVarint(data, lineMap.rows().size());
+    MoonLineMap::Row previous;
+    for (const MoonLineMap::Row& row : lineMap.rows()) {
+        std::uint8_t flags = 0;
+        if (row.function != previous.function) {
+            flags |= kFunctionChanged;
+        }
+        if (row.tag != previous.tag) {
+            flags |= kTagChanged;
+        }
+        data.push_back(static_cast<char>(flags));
+        writeVarint(data, row.instruction - previous.instruction);
+        writeVarint(data, zigzag(static_cast<std::int64_t>(row.line) - previous.line));
+        if ((flags & kFunctionChanged) != 0) {
+            writeVarint(data, row.function);
+        }
+        if ((flags & kTagChanged) != 0) {
+            writeVarint(data, row.tag);
+        }
+        previous = row;
+    }
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+/**
+ * @brief Decode a line map, replaying the row deltas.
+ * @details Names must be unique and start with the empty name, as written by
+ * writeMoonLineMap(); rows must lie within the instruction count.
+ */
+bool readMoonLineMap(std::istream& in, MoonLineMap& lineMap, std::string& error) {
+    const std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    try {
+        LineMapDecoder decoder(data);
+        decoder.expectMagic();
+
+        MoonLineMap decoded;
+        const std::uint64_t instructionCount = decoder.readVarint();
+        const std::size_t nameCount = decoder.readCount();
+        for (std::size_t i = 0; i < nameCount; ++i) {
+            const std::string name = decoder.readBytes(decoder.readCount());
+            if (decoded.intern(name) != i) {
+                throw std::runtime_error("duplicate or misplaced name in pool");
+            }
+        }
+        if (nameCount == 0) {
+            throw std::runtime_error("empty name pool");
+        }
+
+        const std::size_t rowCount = decoder.readCount();
+        MoonLineMap::Row row;
+        for (std::size_t i = 0; i < rowCount; ++i) {
+            const std::uint8_t flags = decoder.readByte();
+            if ((flags & ~(kFunctionChanged | kTagChanged)) != 0) {
+                throw std::runtime_error("unknown row flags");
+            }
+            const std::uint64_t advance = decoder.readVarint();
+            if (advance >= instructionCount - row.instruction || (i > 0 && advance == 0)) {
+                throw std::runtime_error("row instruction out of range");
+            }
+            row.instruction += static_cast<std::size_t>(advance);
+            row.line = static_cast<int>(row.line + decoder.readSigned());
+            if ((flags & kFunctionChanged) != 0) {
+                row.function = static_cast<std::uint32_t>(decoder.readVarint());
+            }
+            if ((flags & kTagChanged) != 0) {
+                row.tag = static_cast<std::uint32_t>(decoder.readVarint());
+            }
+            if (row.function >= nameCount || row.tag >= nameCount) {
+                throw std::runtime_error("name index out of range");
+            }
+            decoded.appendRow(row);
+        }
+        if (!decoder.atEnd()) {
+            throw std::runtime_error("trailing bytes after last row");
+        }
+        decoded.setInstructionCount(static_cast<std::size_t>(instructionCount));
+        lineMap = std::move(decoded);
+        return true;
+    } catch (const std::exception& e) {
+        error = e.what();
+        return false;
+    }
+}
+
+bool writeMoonLineMapFile(const std::string& filePath, const MoonLineMap& lineMap) {
+    std::ofstream file(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    writeMoonLineMap(file, lineMap);
+    file.flush();
+    return static_cast<bool>(file);
+}
+
+bool readMoonLineMapFile(const std::string& filePath, MoonLineMap& lineMap, std::string& error) {
+    std::ifstream file(filePath, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        error = "cannot open " + filePath;
+        return false;
+    }
+    return readMoonLineMap(file, lineMap, error);
+}
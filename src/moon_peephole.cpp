@@ -0,0 +1,377 @@
+#include "../include/moon_peephole.h"
+
+#include <algorithm>
+
+/**
+ * @file moon_peephole.cpp
+ * @brief Peephole rule table and its fixed-point driver.
+ */
+
+namespace {
+/**
+ * @class Window
+ * @brief Entries a rule inspects; slot 0 is the instruction the rule starts at.
+ */
+class Window {
+    public:
+        Window(std::vector<MoonInstruction>& code, const std::vector<std::size_t>& slots, std::vector<char>& erased)
+            : _code(code), _slots(slots), _erased(erased) {}
+
+        std::size_t size() const { return _slots.size(); }
+        MoonInstruction& at(std::size_t slot) { return _code[_slots[slot]]; }
+        /** @brief Drop a slot's entry when the pass ends. */
+        void erase(std::size_t slot) { _erased[_slots[slot]] = 1; }
+
+    private:
+        std::vector<MoonInstruction>& _code;
+        const std::vector<std::size_t>& _slots;
+        std::vector<char>& _erased;
+};
+
+/** @brief Branches, calls, returns, and halt. */
+bool isControl(MoonOp op) {
+    switch (op) {
+        case MoonOp::Bz:
+        case MoonOp::Bnz:
+        case MoonOp::J:
+        case MoonOp::Jr:
+        case MoonOp::Jl:
+        case MoonOp::Jlr:
+        case MoonOp::Hlt:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/** @brief True when instruction assigns the register operand reg. */
+bool writes(const MoonInstruction& instruction, const MoonOperand& reg) {
+    switch (instruction.op) {
+        case MoonOp::Sw:
+        case MoonOp::Sb:
+        case MoonOp::Putc:
+        case MoonOp::Bz:
+        case MoonOp::Bnz:
+        case MoonOp::J:
+        case MoonOp::Jr:
+        case MoonOp::Nop:
+        case MoonOp::Hlt:
+            return false;
+        default:
+            return isMoonInstruction(instruction.op) && instruction.operands[0] == reg;
+    }
+}
+
+/** @brief True when instruction uses the value of the register operand reg. */
+bool reads(const MoonInstruction& instruction, const MoonOperand& reg) {
+    if (!isMoonInstruction(instruction.op)) {
+        return false;
+    }
+    for (int i = writes(instruction, instruction.operands[0]) ? 1 : 0; i < 3; ++i) {
+        if (instruction.operands[i] == reg) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief Memory operand of a load or store: offset and base register slots. */
+bool memoryOperand(MoonInstruction& instruction, MoonOperand*& offset, MoonOperand*& base) {
+    switch (instruction.op) {
+        case MoonOp::Lw:
+        case MoonOp::Lb:
+            offset = &instruction.operands[1];
+            base = &instruction.operands[2];
+            return true;
+        case MoonOp::Sw:
+        case MoonOp::Sb:
+            offset = &instruction.operands[0];
+            base = &instruction.operands[1];
+            return true;
+        default:
+            return false;
+    }
+}
+
+/** @brief True when value fits the signed 16-bit immediate field of a Moon instruction. */
+bool fitsImmediate(long value) {
+    return value >= -32768 && value <= 32767;
+}
+
+/** @brief True when a pair rule must not look past instruction (see moon_peephole.h). */
+bool blocks(const MoonInstruction& instruction, const MoonOperand& reg, const MoonOperand& other) {
+    return !isMoonInstruction(instruction.op) || isControl(instruction.op) || writes(instruction, reg) || writes(instruction, other);
+}
+
+/** @brief "addi r, r, 0", "muli r, r, 1", "add r, r, r0" and their subi, divi, and sub forms do nothing. */
+bool applyIdentity(Window& window) {
+    const MoonInstruction& instruction = window.at(0);
+    const MoonOperand* operands = instruction.operands;
+    if (operands[0].kind != MoonOperand::Kind::Register || operands[0] != operands[1]) {
+        return false;
+    }
+    const bool zero = operands[2] == moonImmediate(0);
+    const bool one = operands[2] == moonImmediate(1);
+    bool identity = false;
+    switch (instruction.op) {
+        case MoonOp::Addi:
+        case MoonOp::Subi:
+            identity = zero;
+            break;
+        case MoonOp::Muli:
+        case MoonOp::Divi:
+            identity = one;
+            break;
+        case MoonOp::Add:
+        case MoonOp::Sub:
+            identity = operands[2] == moonRegister(0);
+            break;
+        default:
+            break;
+    }
+    if (!identity) {
+        return false;
+    }
+    window.erase(0);
+    return true;
+}
+
+/** @brief A load or store through "addi rb, rx, K" addresses K(rx) directly, so rb may become dead. */
+bool applyAddressFold(Window& window) {
+    const MoonInstruction& address = window.at(0);
+    const MoonOperand& reg = address.operands[0];
+    const MoonOperand& base = address.operands[1];
+    if (address.op != MoonOp::Addi || reg.kind != MoonOperand::Kind::Register || base.kind != MoonOperand::Kind::Register ||
+        reg == base || address.operands[2].kind != MoonOperand::Kind::Immediate) {
+        return false;
+    }
+    for (std::size_t slot = 1; slot < window.size(); ++slot) {
+        MoonInstruction& next = window.at(slot);
+        MoonOperand* offset = nullptr;
+        MoonOperand* memoryBase = nullptr;
+        if (memoryOperand(next, offset, memoryBase) && *memoryBase == reg && offset->kind == MoonOperand::Kind::Immediate &&
+            fitsImmediate(offset->value + address.operands[2].value)) {
+            *offset = moonImmediate(offset->value + address.operands[2].value);
+            *memoryBase = base;
+            return true;
+        }
+        if (blocks(next, reg, base)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+/** @brief A load of the slot just stored reads the stored register instead. */
+bool applyStoreLoad(Window& window) {
+    const MoonInstruction& store = window.at(0);
+    if (store.op != MoonOp::Sw) {
+        return false;
+    }
+    const MoonOperand& offset = store.operands[0];
+    const MoonOperand& base = store.operands[1];
+    const MoonOperand& value = store.operands[2];
+    for (std::size_t slot = 1; slot < window.size(); ++slot) {
+        MoonInstruction& next = window.at(slot);
+        if (next.op == MoonOp::Lw && next.operands[1] == offset && next.operands[2] == base) {
+            if (next.operands[0] == value) {
+                window.erase(slot);
+            } else {
+                next.op = MoonOp::Add;
+                next.operands[1] = value;
+                next.operands[2] = moonRegister(0);
+            }
+            return true;
+        }
+        // Another word store through the same base cannot overlap the slot when 4 or more bytes apart.
+        const bool disjointStore = next.op == MoonOp::Sw && next.operands[1] == base && offset.kind == MoonOperand::Kind::Immediate &&
+                                   next.operands[0].kind == MoonOperand::Kind::Immediate &&
+                                   (next.operands[0].value - offset.value >= 4 || offset.value - next.operands[0].value >= 4);
+        if ((next.op == MoonOp::Sw && !disjointStore) || next.op == MoonOp::Sb || blocks(next, base, value)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+/** @brief A branch on a register holding a known constant is always or never taken. */
+bool applyConstantBranch(Window& window) {
+    const MoonInstruction& load = window.at(0);
+    const MoonOperand& reg = load.operands[0];
+    if (load.op != MoonOp::Addi || reg.kind != MoonOperand::Kind::Register || reg == moonRegister(0) ||
+        load.operands[1] != moonRegister(0) || load.operands[2].kind != MoonOperand::Kind::Immediate) {
+        return false;
+    }
+    const bool zero = load.operands[2].value == 0;
+    for (std::size_t slot = 1; slot < window.size(); ++slot) {
+        MoonInstruction& next = window.at(slot);
+        if ((next.op == MoonOp::Bz || next.op == MoonOp::Bnz) && next.operands[0] == reg) {
+            if ((next.op == MoonOp::Bz) == zero) {
+                next.op = MoonOp::J;
+                next.operands[0] = next.operands[1];
+                next.operands[1] = MoonOperand();
+            } else {
+                window.erase(slot);
+            }
+            return true;
+        }
+        if (blocks(next, reg, reg)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+/** @brief A register write overwritten before any read (and before any label or branch) is dead. */
+bool applyDeadWrite(Window& window) {
+    const MoonInstruction& write = window.at(0);
+    const MoonOperand& reg = write.operands[0];
+    if (write.op > MoonOp::Lb || reg.kind != MoonOperand::Kind::Register) {
+        return false;
+    }
+    for (std::size_t slot = 1; slot < window.size(); ++slot) {
+        const MoonInstruction& next = window.at(slot);
+        if (!isMoonInstruction(next.op) || isControl(next.op) || reads(next, reg)) {
+            return false;
+        }
+        if (writes(next, reg)) {
+            window.erase(0);
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief A jump to one of the labels right after it falls through anyway. */
+bool applyJumpToNext(Window& window) {
+    const MoonInstruction& jump = window.at(0);
+    if (jump.op != MoonOp::J) {
+        return false;
+    }
+    for (std::size_t slot = 1; slot < window.size() && window.at(slot).op == MoonOp::Label; ++slot) {
+        if (window.at(slot).operands[0] == jump.operands[0]) {
+            window.erase(0);
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief Only a label makes the code after a jump, return, or halt reachable. */
+bool applyUnreachable(Window& window) {
+    const MoonOp op = window.at(0).op;
+    if ((op != MoonOp::J && op != MoonOp::Jr && op != MoonOp::Hlt) || window.size() < 2 ||
+        !isMoonInstruction(window.at(1).op)) {
+        return false;
+    }
+    window.erase(1);
+    return true;
+}
+
+/** @brief Rule table entry. */
+struct Rule {
+    MoonPeepholeRule id;
+    const char* name;
+    bool (*apply)(Window&);
+};
+
+/** @brief Rules in MoonPeepholeRule order; the first that matches is applied. */
+constexpr Rule kRules[] = {
+    {MoonPeepholeRule::Identity, "identity", applyIdentity},
+    {MoonPeepholeRule::AddressFold, "address-fold", applyAddressFold},
+    {MoonPeepholeRule::StoreLoad, "store-load", applyStoreLoad},
+    {MoonPeepholeRule::ConstantBranch, "constant-branch", applyConstantBranch},
+    {MoonPeepholeRule::DeadWrite, "dead-write", applyDeadWrite},
+    {MoonPeepholeRule::JumpToNext, "jump-to-next", applyJumpToNext},
+    {MoonPeepholeRule::Unreachable, "unreachable", applyUnreachable},
+};
+
+constexpr bool rulesInOrder() {
+    for (std::size_t i = 0; i < kMoonPeepholeRuleCount; ++i) {
+        if (static_cast<std::size_t>(kRules[i].id) != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(sizeof(kRules) / sizeof(kRules[0]) == kMoonPeepholeRuleCount, "kRules must list every MoonPeepholeRule");
+static_assert(rulesInOrder(), "kRules must be in MoonPeepholeRule order");
+}
+
+const char* moonPeepholeRuleName(MoonPeepholeRule rule) {
+    return kRules[static_cast<std::size_t>(rule)].name;
+}
+
+std::size_t MoonPeepholeStats::totalHits() const {
+    std::size_t total = 0;
+    for (std::size_t count : hits) {
+        total += count;
+    }
+    return total;
+}
+
+MoonPeephole::MoonPeephole(const MoonPeepholeOptions& options) : _options(options) {
+    _options.window = std::max<std::size_t>(_options.window, 2);
+}
+
+/** @brief Repeat passes until one matches nothing, since a rewrite can expose another (a branch made a jump exposes dead code). */
+std::size_t MoonPeephole::run(MoonProgram& program) {
+    _stats = MoonPeepholeStats();
+    _stats.instructionsBefore = program.instructionCount();
+    if (_options.enabled) {
+        std::vector<MoonInstruction>& code = program.code();
+        while (_stats.passes < _options.maxPasses) {
+            ++_stats.passes;
+            if (!runPass(code)) {
+                break;
+            }
+        }
+    }
+    _stats.instructionsAfter = program.instructionCount();
+    return _stats.totalHits();
+}
+
+/** @brief Apply rules at each instruction until none matches there, then drop erased entries. */
+bool MoonPeephole::runPass(std::vector<MoonInstruction>& code) {
+    _erased.assign(code.size(), 0);
+    bool changed = false;
+    for (std::size_t i = 0; i < code.size(); ++i) {
+        while (_erased[i] == 0 && isMoonInstruction(code[i].op)) {
+            fillWindow(code, i);
+            Window window(code, _window, _erased);
+            const Rule* matched = nullptr;
+            for (const Rule& rule : kRules) {
+                if (rule.apply(window)) {
+                    matched = &rule;
+                    break;
+                }
+            }
+            if (matched == nullptr) {
+                break;
+            }
+            ++_stats.hits[static_cast<std::size_t>(matched->id)];
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < code.size(); ++i) {
+            if (_erased[i] == 0) {
+                code[kept++] = code[i];
+            }
+        }
+        code.resize(kept);
+    }
+    return changed;
+}
+
+void MoonPeephole::fillWindow(const std::vector<MoonInstruction>& code, std::size_t start) {
+    _window.clear();
+    for (std::size_t i = start; i < code.size() && _window.size() < _options.window; ++i) {
+        if (_erased[i] == 0 && code[i].op != MoonOp::Comment) {
+            _window.push_back(i);
+        }
+    }
+}
@@ -33,8 +33,8 @@ bool Parser::_inErrorRecoveryMode = false;
 std::vector<std::vector<Token>> Parser::_tokens;
 /** @brief Flattened token stream consumed by recursive-descent routines. */
 std::vector<Token> Parser::_flatTokens;
-/** @brief Collected parser error messages. */
-std::vector<std::string> Parser::_errorMessages;
+/** @brief Collected parser diagnostics. */
+DiagnosticEngine Parser::_diagnostics(DiagnosticPhase::Syntax);
 /** @brief Derivation trace used for parser debugging/output artifacts. */
 std::vector<std::string> Parser::_derivationSteps;
 /** @brief AST root produced by latest parse run. */
@@ -108,14 +108,14 @@ bool Parser::parseTokens(const std::vector<std::vector<Token>>& tokens) {
         }
     }
     _currentTokenIndex = 0;
-    _errorMessages.clear();
+    _diagnostics.clear();
     _derivationSteps.clear();
     _inErrorRecoveryMode = false;
     _astRoot = nullptr;
 
     // Prime the lookahead token
     if (!_nextToken()) {
-        _errorMessages.push_back("[ERROR][SYNTAX] Empty token stream");
+        _diagnostics.report(DiagnosticCode::EmptyTokenStream, 0);
         return false;
     }
 
@@ -125,7 +125,7 @@ bool Parser::parseTokens(const std::vector<std::vector<Token>>& tokens) {
         // Error already logged in _reportError
     }
 
-    return _errorMessages.empty();
+    return _diagnostics.errorCount() == 0;
 }
 
 /**
@@ -138,10 +138,26 @@ std::shared_ptr<ProgNode> Parser::getASTRoot() {
 
 /**
  * @brief Return collected syntax diagnostics.
- * @return Read-only syntax error message list.
+ * @return Formatted syntax error message list.
  */
-const std::vector<std::string>& Parser::getErrorMessages() {
-    return _errorMessages;
+std::vector<std::string> Parser::getErrorMessages() {
+    return _diagnostics.formatted(DiagnosticSeverity::Error);
+}
+
+/**
+ * @brief Return collected syntax diagnostic records.
+ * @return Read-only syntax diagnostic engine.
+ */
+const DiagnosticEngine& Parser::getDiagnostics() {
+    return _diagnostics;
+}
+
+/**
+ * @brief Set error cap and deduplication policy for later parses.
+ * @param options Reporting policy.
+ */
+void Parser::setDiagnosticOptions(const DiagnosticOptions& options) {
+    _diagnostics.configure(options);
 }
 
 /**
@@ -153,25 +169,16 @@ const std::vector<std::string>& Parser::getDerivationSteps() {
 }
 
 /**
- * @brief Format parser error message with lookahead and expected set.
- * @param message High-level error description.
- * @param token Current lookahead token.
+ * @brief Render expected token classes as the space-terminated type list used in syntax diagnostics.
  * @param expectedTokens Expected token classes.
- * @return Fully formatted diagnostic string.
+ * @return Text such as "ID_ SEMICOLON_ ".
  */
-std::string Parser::_formatError(const std::string& message, const Token& token, const std::vector<Token::Type>& expectedTokens) {
-    std::string errorMsg = "[ERROR][SYNTAX] " 
-                            + message 
-                            + " at line " 
-                            + std::to_string(token.getLineNumber()) 
-                            + ". Found token: " 
-                            + token.toString() 
-                            + ". Expected one of type: ";
-
+std::string Parser::_expectedTypesText(const std::vector<Token::Type>& expectedTokens) {
+    std::string text;
     for (const auto& expected : expectedTokens) {
-        errorMsg += Token(expected, "", 0).getTypeString() + " ";
+        text += Token(expected, "", 0).getTypeString() + " ";
     }
-    return errorMsg;
+    return text;
 }
 
 /**
@@ -181,9 +188,12 @@ std::string Parser::_formatError(const std::string& message, const Token& token,
  * @throws SyntaxError Always thrown after message registration.
  */
 void Parser::_reportError(const std::string& message, const std::vector<Token::Type>& expectedTokens) {
-    std::string msg = _formatError(message, _lookaheadToken, expectedTokens);
-    _errorMessages.push_back(msg);
-    throw SyntaxError(msg);
+    _diagnostics.report(
+        DiagnosticCode::UnexpectedToken,
+        _lookaheadToken.getLineNumber(),
+        {message, _lookaheadToken.toString(), _expectedTypesText(expectedTokens)}
+    );
+    throw SyntaxError(message);
 }
 
 /**
@@ -960,11 +970,13 @@ std::shared_ptr<ASTNode> Parser::_parseStatBlock(){
                 block->addStatement(stmt);
             }
         }
+        ASTHasher::hashSubtree(block);
         return block;
     }
     else {
         std::shared_ptr<ASTNode> stmt = _parseStatement();
         if (stmt != nullptr) {
+            ASTHasher::hashSubtree(stmt);
             return stmt;
         }
         _derivationSteps.push_back("StatBlock -> EPSILON");
@@ -1073,12 +1085,17 @@ std::vector<std::shared_ptr<ASTNode>> Parser::_parseStatementList() {
             std::shared_ptr<ASTNode> stmt = _parseStatement();
             if (stmt != nullptr) {
                 _derivationSteps.push_back("StatementList -> Statement StatementList");
+                // Seal each finished statement so enclosing nodes reuse its hash.
+                ASTHasher::hashSubtree(stmt);
                 statements.push_back(stmt);
             } else {
                 _derivationSteps.push_back("StatementList -> EPSILON");
                 return statements;
             }
         } catch (const SyntaxError& e) {
+            if (_diagnostics.limitReached()) {
+                throw;
+            }
             // Error already logged. Skip to next statement start or list end.
             _skipUntil({TTYPE::IF_KEYWORD_, TTYPE::WHILE_KEYWORD_, TTYPE::READ_KEYWORD_,
                        TTYPE::WRITE_KEYWORD_, TTYPE::RETURN_KEYWORD_, TTYPE::ID_,
@@ -1130,6 +1147,9 @@ std::vector<std::shared_ptr<VarDeclNode>> Parser::_parseVarDeclList() {
                 return decls;
             }
         } catch (const SyntaxError& e) {
+            if (_diagnostics.limitReached()) {
+                throw;
+            }
             _skipUntil({TTYPE::INTEGER_TYPE_, TTYPE::FLOAT_TYPE_, TTYPE::ID_,
                        TTYPE::DO_KEYWORD_, TTYPE::END_OF_FILE_});
             _inErrorRecoveryMode = false;
@@ -1330,6 +1350,7 @@ std::shared_ptr<FuncDefNode> Parser::_parseFuncDef() {
             func->addLocalVar(local);
         }
         func->setRight(body);
+        ASTHasher::hashSubtree(func);
         return func;
     }
     else{
@@ -1518,6 +1539,9 @@ std::vector<std::shared_ptr<ASTNode>> Parser::_parseClassBody(){
                 members.push_back(member);
             }
         } catch (const SyntaxError& e) {
+            if (_diagnostics.limitReached()) {
+                throw;
+            }
             _skipUntil({TTYPE::PUBLIC_KEYWORD_, TTYPE::PRIVATE_KEYWORD_,
                        TTYPE::CLOSE_BRACE_, TTYPE::END_OF_FILE_});
             _inErrorRecoveryMode = false;
@@ -1596,6 +1620,7 @@ std::shared_ptr<ClassDeclNode> Parser::_parseClassDecl() {
     for (const auto& member : members) {
         classNode->addMember(member);
     }
+    ASTHasher::hashSubtree(classNode);
     return classNode;
 }
 
@@ -1691,11 +1716,13 @@ std::shared_ptr<ProgNode> Parser::_parseProgram() {
             mainFunc->addLocalVar(local);
         }
         mainFunc->setRight(mainBody);
+        ASTHasher::hashSubtree(mainFunc);
         program->addFunction(mainFunc);
     } catch (const SyntaxError& e) {
         _skipUntil({TTYPE::END_OF_FILE_});
         _inErrorRecoveryMode = false;
     }
 
+    ASTHasher::hashSubtree(program);
     return program;
 }
@@ -1,10 +1,15 @@
 #include "../include/semantic.h"
+#include "../include/buffered_file_sink.h"
+#include "../include/class_interface.h"
 
 #include <algorithm>
-#include <cctype>
+#include <atomic>
+#include <exception>
 #include <functional>
 #include <iomanip>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
 #include <unordered_set>
 
 /**
@@ -30,54 +35,43 @@
  */
 
 namespace {
-/** @brief Check if a type name is a language builtin scalar/void type. */
-bool isBuiltinType(const std::string& typeName) {
-    return typeName == "integer" || typeName == "float" || typeName == "void" || typeName == "bool";
-}
-
-/** @brief Return trimmed copy of input string. */
-std::string trimCopy(std::string s) {
-    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) {
-        s.erase(s.begin());
-    }
-    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) {
-        s.pop_back();
-    }
-    return s;
+/** @brief Fold a value into a running hash (boost-style combine). */
+void hashCombine(std::size_t& seed, std::size_t value) {
+    seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
 }
 
 /**
- * @brief Parse inherited parent class names from encoded class type descriptor.
- * @param classType Class descriptor text (for example "class : A, B").
- * @return Parent class names in declaration order.
+ * @brief Write text as a quoted JSON string.
+ * @param out Destination stream.
+ * @param text Raw text (escaped for quotes, backslashes, and control characters).
  */
-std::vector<std::string> parseParentsFromClassType(const std::string& classType) {
-    std::vector<std::string> parents;
-    size_t colon = classType.find(':');
-    if (colon == std::string::npos) {
-        return parents;
-    }
-
-    std::string suffix = classType.substr(colon + 1);
-    size_t start = 0;
-    while (start <= suffix.size()) {
-        size_t comma = suffix.find(',', start);
-        if (comma == std::string::npos) {
-            std::string token = trimCopy(suffix.substr(start));
-            if (!token.empty()) {
-                parents.push_back(token);
-            }
-            break;
-        }
-
-        std::string token = trimCopy(suffix.substr(start, comma - start));
-        if (!token.empty()) {
-            parents.push_back(token);
+void writeJsonString(std::ostream& out, const std::string& text) {
+    static const char kHex[] = "0123456789abcdef";
+    out << '"';
+    for (char ch : text) {
+        const unsigned char c = static_cast<unsigned char>(ch);
+        switch (ch) {
+            case '"':
+                out << "\\\"";
+                break;
+            case '\\':
+                out << "\\\\";
+                break;
+            case '\n':
+                out << "\\n";
+                break;
+            case '\t':
+                out << "\\t";
+                break;
+            default:
+                if (c < 0x20) {
+                    out << "\\u00" << kHex[c >> 4] << kHex[c & 0xF];
+                } else {
+                    out << ch;
+                }
         }
-        start = comma + 1;
     }
-
-    return parents;
+    out << '"';
 }
 
 /** @brief Extract class name from scope label "class X". */
@@ -111,80 +105,166 @@ std::string enclosingClassFromFunctionScope(const std::shared_ptr<SymbolTable>&
 }
 
 /**
- * @brief Convert internal scope name into user-facing diagnostic scope label.
+ * @brief Scope whose name labels a diagnostic reported in a scope.
  * @param scope Scope pointer.
- * @return Friendly scope name.
+ * @return Enclosing function or class scope for blocks, otherwise the scope itself.
  */
-std::string getUserFriendlyScopeName(const std::shared_ptr<SymbolTable>& scope) {
+std::shared_ptr<SymbolTable> getUserFriendlyScope(const std::shared_ptr<SymbolTable>& scope) {
     if (scope == nullptr) {
-        return "";
+        return nullptr;
     }
 
-    const std::string scopeName = scope->getScopeName();
-
     // If it's a block, find the enclosing function or class
-    if (scopeName.rfind("block#", 0) == 0) {
+    if (scope->getScopeName().rfind("block#", 0) == 0) {
         std::shared_ptr<SymbolTable> currentScope = scope->getParent();
         while (currentScope != nullptr) {
-            const std::string name = currentScope->getScopeName();
-            if (name.rfind("function ", 0) == 0) {
-                return name;
-            }
-            if (name.rfind("class ", 0) == 0) {
-                return name;
+            const std::string& name = currentScope->getScopeName();
+            if (name.rfind("function ", 0) == 0 || name.rfind("class ", 0) == 0) {
+                return currentScope;
             }
             currentScope = currentScope->getParent();
         }
     }
 
-    return scopeName;
+    return scope;
 }
 
+/**
+ * @class ReturnFinder
+ * @brief Traversal listener that stops at the first return statement.
+ */
+class ReturnFinder : public ASTTraversalListener {
+    public:
+        bool found = false;
+
+        bool enterNode(ASTNode& node, const ASTNode*, const ASTChildSlot*) override {
+            if (dynamic_cast<ReturnStmtNode*>(&node) != nullptr) {
+                found = true;
+                return false;
+            }
+            return true;
+        }
+
+        bool stopRequested() const override { return found; }
+};
+
 /**
  * @brief Detect whether subtree contains any return statement.
  * @param node Subtree root.
  * @return True if at least one ReturnStmtNode exists in subtree.
  */
 bool containsReturnStatement(const std::shared_ptr<ASTNode>& node) {
-    if (node == nullptr) {
-        return false;
-    }
+    ReturnFinder finder;
+    ASTTraversal::walk(node, finder);
+    return finder.found;
+}
 
-    if (std::dynamic_pointer_cast<ReturnStmtNode>(node) != nullptr) {
-        return true;
-    }
+/**
+ * @class ClassNameCollector
+ * @brief Traversal listener recording every top-level class name (forward-reference pre-pass).
+ */
+class ClassNameCollector : public ASTTraversalListener {
+    public:
+        explicit ClassNameCollector(std::unordered_set<std::string>& classNames) : _classNames(classNames) {}
 
-    if (auto block = std::dynamic_pointer_cast<BlockNode>(node)) {
-        for (const auto& stmt : block->getStatements()) {
-            if (containsReturnStatement(stmt)) {
-                return true;
+        bool enterNode(ASTNode& node, const ASTNode* parent, const ASTChildSlot*) override {
+            if (auto* cls = dynamic_cast<ClassDeclNode*>(&node)) {
+                _classNames.insert(cls->getName());
             }
+            return parent == nullptr && dynamic_cast<ProgNode*>(&node) != nullptr;
         }
-    }
 
-    if (auto call = std::dynamic_pointer_cast<FuncCallNode>(node)) {
-        for (const auto& arg : call->getArgs()) {
-            if (containsReturnStatement(arg)) {
-                return true;
-            }
-        }
-    }
+    private:
+        std::unordered_set<std::string>& _classNames;
+};
 
-    if (auto member = std::dynamic_pointer_cast<DataMemberNode>(node)) {
-        for (const auto& idx : member->getIndices()) {
-            if (containsReturnStatement(idx)) {
-                return true;
+/**
+ * @class FunctionBodyPrepass
+ * @brief Traversal listener measuring what a function definition's pass-2 check will create.
+ *
+ * @details
+ * Counts block nodes (each opens one numbered block scope in pass 2) and
+ * collects declared variable types with their dimensions, so parallel pass 2
+ * can number block scopes and intern types before any worker starts.
+ */
+class FunctionBodyPrepass : public ASTTraversalListener {
+    public:
+        bool enterNode(ASTNode& node, const ASTNode*, const ASTChildSlot*) override {
+            if (dynamic_cast<BlockNode*>(&node) != nullptr) {
+                ++_blockCount;
+            } else if (auto* decl = dynamic_cast<VarDeclNode*>(&node)) {
+                _declaredTypes.push_back(decl);
             }
+            return true;
         }
-    }
 
-    if (auto ifStmt = std::dynamic_pointer_cast<IfStmtNode>(node)) {
-        if (containsReturnStatement(ifStmt->getElseBlock())) {
+        int blockCount() const { return _blockCount; }
+        const std::vector<const VarDeclNode*>& declaredTypes() const { return _declaredTypes; }
+
+    private:
+        int _blockCount = 0;
+        std::vector<const VarDeclNode*> _declaredTypes;
+};
+
+/**
+ * @class LineShapeHasher
+ * @brief Traversal listener hashing each node's line relative to a base line.
+ *
+ * @details
+ * Together with the structural hash (which ignores lines) this identifies a
+ * definition that only moved: its diagnostics and symbol lines all shift by the
+ * same amount.
+ */
+class LineShapeHasher : public ASTTraversalListener {
+    public:
+        explicit LineShapeHasher(int baseLine) : _baseLine(baseLine) {}
+
+        bool enterNode(ASTNode& node, const ASTNode*, const ASTChildSlot*) override {
+            hashCombine(_hash, static_cast<std::size_t>(node.getLineNumber() - _baseLine));
             return true;
         }
-    }
 
-    return containsReturnStatement(node->getLeft()) || containsReturnStatement(node->getRight());
+        std::size_t hash() const { return _hash; }
+
+    private:
+        int _baseLine;
+        std::size_t _hash = 0;
+};
+
+/**
+ * @brief Hash the declaration-relevant fields of a symbol entry.
+ * @details The line is left out: no body diagnostic mentions another declaration's line.
+ */
+std::size_t entryHash(const SymbolEntry& entry, const TypeTable& types) {
+    std::size_t seed = std::hash<std::string>()(entry.name);
+    hashCombine(seed, static_cast<std::size_t>(entry.kind));
+    hashCombine(seed, std::hash<std::string>()(types.toString(entry.type)));
+    hashCombine(seed, std::hash<std::string>()(types.toString(entry.fullType)));
+    hashCombine(seed, static_cast<std::size_t>(entry.visibility));
+    hashCombine(seed, entry.flags);
+    return seed;
+}
+
+/**
+ * @brief Copy a previous run's scope subtree below a freshly created scope.
+ * @param from Previous scope.
+ * @param to Empty scope receiving the entries and child scopes.
+ * @param lineDelta Added to every entry line.
+ * @param blockShift Added to every "block#N" child number.
+ */
+void graftScope(const SymbolTable& from, const std::shared_ptr<SymbolTable>& to, int lineDelta, int blockShift) {
+    for (const auto& entry : from.getEntries()) {
+        SymbolEntry copy = entry;
+        copy.line += lineDelta;
+        to->define(copy);
+    }
+    for (const auto& child : from.getChildren()) {
+        std::string name = child->getScopeName();
+        if (name.rfind("block#", 0) == 0) {
+            name = "block#" + std::to_string(std::stoi(name.substr(6)) + blockShift);
+        }
+        graftScope(*child, to->createChild(name), lineDelta, blockShift);
+    }
 }
 
 /**
@@ -299,10 +379,18 @@ SymbolTable::SymbolTable(const std::string& scopeName, std::shared_ptr<SymbolTab
 /** @brief Create child scope and register in current scope children list. */
 std::shared_ptr<SymbolTable> SymbolTable::createChild(const std::string& scopeName) {
     std::shared_ptr<SymbolTable> child = std::make_shared<SymbolTable>(scopeName, shared_from_this());
+    // Keep the first child for a name; later duplicates are still listed in _children.
+    _childIndex.emplace(scopeName, _children.size());
     _children.push_back(child);
     return child;
 }
 
+/** @brief Find the first child scope created with a given name. */
+std::shared_ptr<SymbolTable> SymbolTable::findChild(const std::string& scopeName) const {
+    auto it = _childIndex.find(scopeName);
+    return it != _childIndex.end() ? _children[it->second] : nullptr;
+}
+
 /** @brief Define symbol in current scope if name is not already present. */
 bool SymbolTable::define(const SymbolEntry& entry) {
     if (_entryIndex.find(entry.name) != _entryIndex.end()) {
@@ -332,18 +420,20 @@ SymbolEntry* SymbolTable::lookupMutableInCurrent(const std::string& name) {
     return &_entries[it->second];
 }
 
-/** @brief Resolve symbol recursively through parent scopes. */
+/** @brief Resolve symbol through this scope and its ancestors. */
 const SymbolEntry* SymbolTable::resolve(const std::string& name) const {
     const SymbolEntry* inCurrent = lookupInCurrent(name);
     if (inCurrent != nullptr) {
         return inCurrent;
     }
 
-    std::shared_ptr<SymbolTable> parent = _parent.lock();
-    if (parent == nullptr) {
-        return nullptr;
+    for (std::shared_ptr<SymbolTable> scope = _parent.lock(); scope != nullptr; scope = scope->getParent()) {
+        const SymbolEntry* found = scope->lookupInCurrent(name);
+        if (found != nullptr) {
+            return found;
+        }
     }
-    return parent->resolve(name);
+    return nullptr;
 }
 
 /** @brief Get scope name. */
@@ -366,6 +456,203 @@ const std::vector<SymbolEntry>& SymbolTable::getEntries() const {
     return _entries;
 }
 
+/** @brief Empty the scope, as pass 1 left a function scope before its body was checked. */
+void SymbolTable::clear() {
+    _children.clear();
+    _childIndex.clear();
+    _entries.clear();
+    _entryIndex.clear();
+    _overloads.clear();
+    _overloadIndex.clear();
+}
+
+/** @brief Find or add the overload of name with these parameter types. */
+FunctionOverload* SymbolTable::addOverload(const std::string& name, const std::vector<TypeId>& params, TypeId signature) {
+    auto entryIt = _entryIndex.find(name);
+    if (entryIt == _entryIndex.end()) {
+        return nullptr;
+    }
+
+    std::vector<size_t>& positions = _overloadIndex[overloadKey(entryIt->second, params.size())];
+    for (size_t position : positions) {
+        if (_overloads[position].params == params) {
+            return &_overloads[position];
+        }
+    }
+
+    FunctionOverload overload;
+    overload.entry = entryIt->second;
+    overload.params = params;
+    overload.signature = signature;
+    positions.push_back(_overloads.size());
+    _overloads.push_back(std::move(overload));
+    return &_overloads.back();
+}
+
+/** @brief Overload of name with exactly these parameter types. */
+const FunctionOverload* SymbolTable::findOverload(const std::string& name, const std::vector<TypeId>& params) const {
+    auto entryIt = _entryIndex.find(name);
+    if (entryIt == _entryIndex.end()) {
+        return nullptr;
+    }
+    const std::vector<size_t>* positions = overloadsOf(entryIt->second, params.size());
+    if (positions == nullptr) {
+        return nullptr;
+    }
+    for (size_t position : *positions) {
+        if (_overloads[position].params == params) {
+            return &_overloads[position];
+        }
+    }
+    return nullptr;
+}
+
+/** @brief Candidates of one (entry, arity) key. */
+const std::vector<size_t>* SymbolTable::overloadsOf(size_t entry, size_t arity) const {
+    auto it = _overloadIndex.find(overloadKey(entry, arity));
+    return it != _overloadIndex.end() ? &it->second : nullptr;
+}
+
+/** @brief Close every scope and forget all bindings. */
+void ScopeBindings::clear() {
+    _bindings.clear();
+    _frames.clear();
+}
+
+/** @brief Reshape the open-scope stack into the parent chain of scope. */
+void ScopeBindings::moveTo(const SymbolTable* scope) {
+    if (!_frames.empty() && _frames.back().table == scope) {
+        return;
+    }
+
+    // Fast paths: entering a direct child, or returning to the enclosing scope.
+    std::shared_ptr<SymbolTable> parent = scope != nullptr ? scope->getParent() : nullptr;
+    if (scope != nullptr && !_frames.empty() && _frames.back().table == parent.get()) {
+        open(scope);
+        return;
+    }
+    if (_frames.size() >= 2 && _frames[_frames.size() - 2].table == scope) {
+        close();
+        return;
+    }
+
+    std::vector<const SymbolTable*> chain;
+    for (const SymbolTable* current = scope; current != nullptr; ) {
+        chain.push_back(current);
+        std::shared_ptr<SymbolTable> next = current->getParent();
+        current = next.get();
+    }
+    std::reverse(chain.begin(), chain.end());
+
+    size_t common = 0;
+    while (common < _frames.size() && common < chain.size() && _frames[common].table == chain[common]) {
+        ++common;
+    }
+    while (_frames.size() > common) {
+        close();
+    }
+    for (size_t i = common; i < chain.size(); ++i) {
+        open(chain[i]);
+    }
+}
+
+/** @brief Bind the newest entry of the innermost open scope. */
+void ScopeBindings::bindLast(const SymbolTable& scope) {
+    if (_frames.empty() || _frames.back().table != &scope || scope.getEntries().empty()) {
+        return;
+    }
+    bind(_frames.back(), scope, scope.getEntries().size() - 1);
+}
+
+/** @brief Top binding for name, if any scope declaring it is open. */
+const SymbolEntry* ScopeBindings::lookup(const std::string& name) const {
+    auto it = _bindings.find(name);
+    if (it == _bindings.end() || it->second.empty()) {
+        return nullptr;
+    }
+    const Binding& top = it->second.back();
+    return &top.table->getEntries()[top.index];
+}
+
+/** @brief Top binding for name with the scope and slot holding it. */
+const SymbolEntry* ScopeBindings::lookup(const std::string& name, const SymbolTable*& table, size_t& index) const {
+    auto it = _bindings.find(name);
+    if (it == _bindings.end() || it->second.empty()) {
+        return nullptr;
+    }
+    const Binding& top = it->second.back();
+    table = top.table;
+    index = top.index;
+    return &top.table->getEntries()[top.index];
+}
+
+void ScopeBindings::open(const SymbolTable* table) {
+    _frames.push_back(Frame{table, {}});
+    const auto& entries = table->getEntries();
+    for (size_t i = 0; i < entries.size(); ++i) {
+        bind(_frames.back(), *table, i);
+    }
+}
+
+void ScopeBindings::close() {
+    // Binding vectors live in map nodes, so the stored pointers stay valid.
+    for (std::vector<Binding>* stack : _frames.back().pushed) {
+        stack->pop_back();
+    }
+    _frames.pop_back();
+}
+
+void ScopeBindings::bind(Frame& frame, const SymbolTable& table, size_t index) {
+    std::vector<Binding>& stack = _bindings[table.getEntries()[index].name];
+    stack.push_back(Binding{&table, index});
+    frame.pushed.push_back(&stack);
+}
+
+/**
+ * @class SemanticAnalyzer::DeclarationCollector
+ * @brief Pass 1 as ASTTraversal callbacks: classes, fields, and function signatures.
+ *
+ * @details
+ * Entering a class declares it, registers its fields, and enters its scope;
+ * leaving it restores the enclosing scope (kept on this listener's own stack).
+ * Fields are skipped when the walk reaches them because they were registered
+ * before any method. A function definition is declared by the analyzer's
+ * pass-1 FuncDefNode visit, which does not descend, and its parameters and
+ * body are not walked.
+ */
+class SemanticAnalyzer::DeclarationCollector : public ASTTraversalListener {
+    public:
+        explicit DeclarationCollector(SemanticAnalyzer& analyzer) : _analyzer(analyzer) {}
+
+        bool enterNode(ASTNode& node, const ASTNode* parent, const ASTChildSlot*) override {
+            if (dynamic_cast<ProgNode*>(&node) != nullptr) {
+                return parent == nullptr;
+            }
+            if (auto* cls = dynamic_cast<ClassDeclNode*>(&node)) {
+                _enclosingScopes.push_back(_analyzer.beginClassDeclaration(*cls));
+                return true;
+            }
+            if (auto* function = dynamic_cast<FuncDefNode*>(&node)) {
+                if (auto* owner = dynamic_cast<const ClassDeclNode*>(parent)) {
+                    _analyzer.checkOverriddenMemberFunction(*owner, *function);
+                }
+                function->accept(_analyzer);
+            }
+            return false;
+        }
+
+        void exitNode(ASTNode& node) override {
+            if (dynamic_cast<ClassDeclNode*>(&node) != nullptr) {
+                _analyzer.setCurrentScope(_enclosingScopes.back());
+                _enclosingScopes.pop_back();
+            }
+        }
+
+    private:
+        SemanticAnalyzer& _analyzer;
+        std::vector<std::shared_ptr<SymbolTable>> _enclosingScopes;
+};
+
 /**
  * @brief Run semantic analyzer passes over program root.
  * @param root Program AST root.
@@ -378,26 +665,67 @@ const std::vector<SymbolEntry>& SymbolTable::getEntries() const {
  * 3) pass 2 usage/type checks.
  */
 bool SemanticAnalyzer::analyze(const std::shared_ptr<ProgNode>& root) {
-    _errors.clear();
-    _warnings.clear();
+    return runAnalysis(root, TypeTable(), nullptr);
+}
+
+/**
+ * @brief Re-run analysis, reusing pass-2 results of unchanged function definitions.
+ * @param root Program AST root.
+ * @param previous Snapshot recorded by an earlier analysis.
+ * @param changedDefinitions Definition keys to re-check unconditionally.
+ * @return True if no semantic errors were emitted.
+ *
+ * @details
+ * The type table is seeded with the previous one so copied symbol entries keep
+ * valid type ids.
+ */
+bool SemanticAnalyzer::analyzeIncremental(const std::shared_ptr<ProgNode>& root, const SemanticSnapshot& previous,
+                                          const std::unordered_set<std::string>& changedDefinitions) {
+    TypeTable types = previous._types;
+    types.thaw();
+    _changedDefinitions = changedDefinitions;
+    const bool success = runAnalysis(root, std::move(types), &previous);
+    _changedDefinitions.clear();
+    return success;
+}
+
+/**
+ * @brief Passes shared by full and incremental analysis.
+ * @param root Program AST root.
+ * @param types Initial type table (fresh, or the previous snapshot's).
+ * @param previous Snapshot to reuse, or null for a full analysis.
+ * @return True if no semantic errors were emitted.
+ */
+bool SemanticAnalyzer::runAnalysis(const std::shared_ptr<ProgNode>& root, TypeTable types, const SemanticSnapshot* previous) {
+    _diagnostics.clear();
     _blockCounter = 0;
     _classScopes.clear();
     _declaredClassNames.clear();
-    _declaredMemberFunctionKeys.clear();
     _functionReturnTypeStack.clear();
+    _exprTypes.clear();
+    _annotations.clear();
+    _nodeScopes.clear();
+    _classMembers.clear();
+    _importedClassScopes.clear();
+    _types = std::move(types);
     _globalScope = std::make_shared<SymbolTable>("global");
+    _previous = previous;
+    _snapshot = _recordSnapshot ? std::make_shared<SemanticSnapshot>() : nullptr;
+    _fingerprints.clear();
+    _dirtyKeys.clear();
+    _reusedBodies = 0;
+    _checkedBodies = 0;
 
     if (root != nullptr) {
-        for (const auto& cls : root->getClasses()) {
-            if (cls != nullptr) {
-                _declaredClassNames.insert(cls->getName());
-            }
-        }
+        ClassNameCollector classNameCollector(_declaredClassNames);
+        ASTTraversal::walk(root, classNameCollector);
 
         setPassOne(true);
         _blockCounter = 0;
-        _currentScope = _globalScope;
-        root->accept(*this);
+        setCurrentScope(_globalScope);
+        declareImportedClasses();
+        DeclarationCollector declarationPass(*this);
+        ASTTraversal::walk(root, declarationPass);
 
         setPassOne(false);
         _blockCounter = 0;
@@ -406,7 +734,7 @@ bool SemanticAnalyzer::analyze(const std::shared_ptr<ProgNode>& root) {
         // 6.2: member function declared but never implemented.
         for (const auto& classPair : _classScopes) {
             const auto& classScope = classPair.second;
-            if (classScope == nullptr) {
+            if (classScope == nullptr || _importedClassScopes.count(classScope.get()) != 0) {
                 continue;
             }
 
@@ -415,76 +743,203 @@ bool SemanticAnalyzer::analyze(const std::shared_ptr<ProgNode>& root) {
                     continue;
                 }
 
-                const bool hasDecl = entry.details.find("declaration") != std::string::npos;
-                const bool hasImpl = entry.details.find("implementation") != std::string::npos;
-                if (hasDecl && !hasImpl) {
-                    reportError(entry.line, "6.2 undefined member function declaration: '" + classPair.first + "::" + entry.name + "'");
+                if ((entry.flags & (SymbolDeclared | SymbolImplemented)) == SymbolDeclared) {
+                    report(DiagnosticCode::UndefinedMemberFunctionDeclaration, entry.line, {classPair.first, entry.name});
                 }
             }
         }
 
-        // 14.1: circular class dependency in inheritance graph.
-        std::unordered_map<std::string, std::vector<std::string>> graph;
-        std::unordered_map<std::string, int> classLine;
+        // 14.1: circular class dependency in inheritance graph, once per cycle.
+        _classHierarchy = ClassHierarchy();
         for (const auto& entry : _globalScope->getEntries()) {
-            if (entry.kind != SymbolKind::Class) {
-                continue;
+            if (entry.kind == SymbolKind::Class) {
+                _classHierarchy.addClass(entry.name, classParents(entry), entry.line);
+            }
+        }
+        _classHierarchy.analyze();
+        for (const auto& cycle : _classHierarchy.cycles()) {
+            std::string members;
+            for (std::size_t index : cycle) {
+                members += (members.empty() ? "'" : ", '") + _classHierarchy.name(index) + "'";
             }
-            graph[entry.name] = parseParentsFromClassType(entry.type);
-            classLine[entry.name] = entry.line;
+            report(DiagnosticCode::CircularClassDependency, _classHierarchy.line(cycle.front()), {members});
+        }
+
+        buildClassMemberTables();
+
+        // With the error cap already hit, the pass-2 checks could only add
+        // dropped diagnostics.
+        if (_diagnostics.limitReached()) {
+            _snapshot.reset();
+            _previous = nullptr;
+            return false;
         }
 
-        enum class Color { White, Gray, Black };
-        std::unordered_map<std::string, Color> color;
-        for (const auto& kv : graph) {
-            color[kv.first] = Color::White;
+        if (_snapshot != nullptr || _previous != nullptr) {
+            _fingerprints = declarationFingerprints();
+            markDirtyKeys();
         }
 
-        std::function<void(const std::string&)> dfs = [&](const std::string& nodeName) {
-            color[nodeName] = Color::Gray;
-            for (const auto& parent : graph[nodeName]) {
-                if (graph.find(parent) == graph.end()) {
-                    continue;
-                }
-                if (color[parent] == Color::Gray) {
-                    reportError(classLine[nodeName], "14.1 circular class dependency involving '" + nodeName + "' and '" + parent + "'");
-                    continue;
+        _bindings.clear();
+        setCurrentScope(_globalScope);
+        root->accept(*this);
+        _bindings.clear();
+
+        if (_snapshot != nullptr) {
+            std::unordered_set<std::string> seen;
+            for (const auto& cls : root->getClasses()) {
+                if (cls != nullptr && seen.insert("class " + cls->getName()).second) {
+                    _snapshot->_definitionKeys.push_back("class " + cls->getName());
                 }
-                if (color[parent] == Color::White) {
-                    dfs(parent);
+            }
+            for (const auto& body : _snapshot->_bodies) {
+                if (seen.insert(body.key).second) {
+                    _snapshot->_definitionKeys.push_back(body.key);
                 }
             }
-            color[nodeName] = Color::Black;
-        };
+        }
+    }
 
-        for (const auto& kv : graph) {
-            if (color[kv.first] == Color::White) {
-                dfs(kv.first);
-            }
+    // A capped run is missing diagnostics, so it cannot seed a later one.
+    if (_snapshot != nullptr && _diagnostics.limitReached()) {
+        _snapshot.reset();
+    }
+    if (_snapshot != nullptr) {
+        _snapshot->_types = _types;
+        _snapshot->_globalScope = _globalScope;
+        _snapshot->_fingerprints = _fingerprints;
+    }
+    _previous = nullptr;
+    return _diagnostics.errorCount() == 0;
+}
+
+/** @brief Keep a copy of an interface for every following analysis. */
+void SemanticAnalyzer::importClassInterface(const ClassInterface& classInterface) {
+    _imports.push_back(std::make_shared<const ClassInterface>(classInterface));
+}
+
+/**
+ * @brief Collect the program's own classes after an analysis.
+ * @return Class symbols, own scope entries, and declared member functions, with
+ * types copied into the interface's table.
+ *
+ * @details
+ * A redeclared class is exported once, from the scope pass 2 analyzed.
+ */
+ClassInterface SemanticAnalyzer::exportClassInterface() const {
+    ClassInterface classInterface;
+    std::unordered_set<std::string> exported;
+    if (_globalScope == nullptr) {
+        return classInterface;
+    }
+
+    for (const auto& entry : _globalScope->getEntries()) {
+        if (entry.kind != SymbolKind::Class || !exported.insert(entry.name).second) {
+            continue;
+        }
+        auto scopeIt = _classScopes.find(entry.name);
+        if (scopeIt == _classScopes.end() || scopeIt->second == nullptr ||
+            _importedClassScopes.count(scopeIt->second.get()) != 0) {
+            continue;
         }
 
-        _currentScope = _globalScope;
-        root->accept(*this);
+        ClassInterface::Class cls;
+        cls.symbol = copySymbolEntry(entry, _types, classInterface.types);
+        for (const auto& member : scopeIt->second->getEntries()) {
+            cls.members.push_back(copySymbolEntry(member, _types, classInterface.types));
+        }
+        const auto& members = scopeIt->second->getEntries();
+        for (const auto& overload : scopeIt->second->getOverloads()) {
+            if ((overload.flags & SymbolDeclared) != 0) {
+                cls.declaredMethods.emplace_back(members[overload.entry].name, classInterface.types.copyFrom(_types, overload.signature));
+            }
+        }
+        classInterface.classes.push_back(std::move(cls));
     }
+    return classInterface;
+}
+
+/**
+ * @brief Define every imported class before the program's own declarations.
+ *
+ * @details
+ * Class symbols go through defineSymbol(), so a class imported twice (or also
+ * declared by the program) is reported as 8.1 like any redeclaration.
+ */
+void SemanticAnalyzer::declareImportedClasses() {
+    for (const auto& classInterface : _imports) {
+        for (const auto& cls : classInterface->classes) {
+            const SymbolEntry symbol = copySymbolEntry(cls.symbol, classInterface->types, _types);
+            _declaredClassNames.insert(symbol.name);
+            if (!defineSymbol(symbol)) {
+                continue;
+            }
 
-    return _errors.empty();
+            std::shared_ptr<SymbolTable> classScope = _globalScope->createChild("class " + symbol.name);
+            _classScopes[symbol.name] = classScope;
+            _importedClassScopes.insert(classScope.get());
+            for (const auto& member : cls.members) {
+                classScope->define(copySymbolEntry(member, classInterface->types, _types));
+            }
+            for (const auto& method : cls.declaredMethods) {
+                const TypeId signature = _types.copyFrom(classInterface->types, method.second);
+                FunctionOverload* overload = classScope->addOverload(method.first, _types.get(signature).operands, signature);
+                if (overload != nullptr) {
+                    overload->flags |= SymbolDeclared;
+                }
+            }
+        }
+    }
 }
 
-/** @brief Return semantic error list. */
-const std::vector<std::string>& SemanticAnalyzer::getErrors() const {
-    return _errors;
+/** @brief Return formatted semantic errors. */
+std::vector<std::string> SemanticAnalyzer::getErrors() const {
+    return _diagnostics.formatted(DiagnosticSeverity::Error);
 }
 
-/** @brief Return semantic warning list. */
-const std::vector<std::string>& SemanticAnalyzer::getWarnings() const {
-    return _warnings;
+/** @brief Return formatted semantic warnings. */
+std::vector<std::string> SemanticAnalyzer::getWarnings() const {
+    return _diagnostics.formatted(DiagnosticSeverity::Warning);
 }
 
+/** @brief Output stream, format, and scope numbering of one symbol-table dump. */
+struct SemanticAnalyzer::SymbolDumpState {
+    std::ostream& out;
+    SymbolTableFormat format;
+    /** @brief Id given to the next dumped scope (dump order, global = 0). */
+    long nextScopeId = 0;
+};
+
 /** @brief Produce formatted symbol-table dump for all scopes. */
 std::string SemanticAnalyzer::dumpSymbolTables() const {
-    std::string out;
-    dumpScope(_globalScope, 0, out);
-    return out;
+    std::ostringstream out;
+    writeSymbolTables(out, SymbolTableFormat::Text);
+    return out.str();
+}
+
+/**
+ * @brief Stream the symbol-table hierarchy scope by scope.
+ * @param out Destination stream.
+ * @param format Text tables or JSON lines.
+ */
+void SemanticAnalyzer::writeSymbolTables(std::ostream& out, SymbolTableFormat format) const {
+    SymbolDumpState state{out, format};
+    dumpScope(_globalScope, 0, -1, state);
+}
+
+/**
+ * @brief Stream the symbol-table hierarchy into a buffered file.
+ * @param filePath Destination path.
+ * @param format Text tables or JSON lines.
+ * @return True when the file was opened and every write succeeded.
+ */
+bool SemanticAnalyzer::writeSymbolTablesToFile(const std::string& filePath, SymbolTableFormat format) const {
+    BufferedFileSink sink(filePath);
+    if (!sink.isOpen()) {
+        return false;
+    }
+    writeSymbolTables(sink.stream(), format);
+    return sink.close();
 }
 
 /** @brief Validate identifier use in pass 2 by lexical resolution. */
@@ -493,8 +948,8 @@ void SemanticAnalyzer::visit(IdNode& node) {
         return;
     }
 
-    if (_currentScope->resolve(node.getName()) == nullptr) {
-        reportError(node.getLineNumber(), "11.1 undeclared local variable: '" + node.getName() + "'");
+    if (resolveName(node.getName()) == nullptr) {
+        report(DiagnosticCode::UndeclaredLocalVariable, node.getLineNumber(), {node.getName()});
     }
 }
 
@@ -518,58 +973,52 @@ void SemanticAnalyzer::visit(BinaryOpNode& node) {
     visitNode(node.getLeft());
     visitNode(node.getRight());
     
-    std::string leftType = inferExprType(node.getLeft());
-    std::string rightType = inferExprType(node.getRight());
+    const TypeId leftType = inferExprType(node.getLeft());
+    const TypeId rightType = inferExprType(node.getRight());
     
     // Make sure we are adding numbers!
-    if (leftType != "integer" && leftType != "float") {
-        reportError(node.getLineNumber(), "10.1 type error in expression: left operand must be numeric");
+    if (leftType != TypeTable::Integer && leftType != TypeTable::Float) {
+        report(DiagnosticCode::LeftOperandNotNumeric, node.getLineNumber());
     }
-    if (rightType != "integer" && rightType != "float") {
-        reportError(node.getLineNumber(), "10.1 type error in expression: right operand must be numeric");
+    if (rightType != TypeTable::Integer && rightType != TypeTable::Float) {
+        report(DiagnosticCode::RightOperandNotNumeric, node.getLineNumber());
     }
 }
 
-/** @brief Traverse unary operand. */
+/** @brief Traverse unary operand (inferred so that it is annotated for code generation). */
 void SemanticAnalyzer::visit(UnaryOpNode& node) {
     visitNode(node.getLeft());
+    if (!isPassOne()) {
+        inferExprType(node.getLeft());
+    }
 }
 
 /**
  * @brief Validate function/method call declaration and parameter compatibility.
  * @details
  * Handles free-function and owner-qualified method-call forms, then enforces
- * argument count/type compatibility and selected array-size semantic checks.
+ * argument count/type compatibility and selected array-size semantic checks
+ * against the overload resolveCall() selects. When no overload has the call's
+ * arity, the count is reported against the function's first declaration.
  */
 void SemanticAnalyzer::visit(FuncCallNode& node) {
     if (isPassOne()) {
         return;
     }
 
-    const SymbolEntry* symbol = nullptr;
-
     auto calleeMember = std::dynamic_pointer_cast<DataMemberNode>(node.getLeft());
     const bool isOwnerQualifiedMethodCall = calleeMember != nullptr && calleeMember->getLeft() != nullptr;
 
-    if (isOwnerQualifiedMethodCall) {
-        // For calls like p.print(), the callee node is the member (print),
-        // so receiver type comes from the owner expression (p).
-        std::string ownerType = inferExprType(calleeMember->getLeft());
-        std::string methodName = calleeMember->getName();
-
-        if (ownerType.empty()) {
-            reportError(node.getLineNumber(), "cannot resolve receiver type for method call '" + node.getFunctionName() + "'");
+    const CallTarget target = resolveCall(node);
+    const SymbolEntry* symbol = target.symbol;
+    if (symbol == nullptr || symbol->kind != SymbolKind::Function) {
+        if (isOwnerQualifiedMethodCall) {
+            // For calls like p.print(), the callee node is the member (print),
+            // so receiver type comes from the owner expression (p).
+            const TypeId ownerType = inferExprType(calleeMember->getLeft());
+            report(DiagnosticCode::UndeclaredMemberFunction, node.getLineNumber(), {_types.toString(_types.baseOf(ownerType)), calleeMember->getName()});
         } else {
-            symbol = resolveClassMember(ownerType, methodName);
-            if (symbol == nullptr || symbol->kind != SymbolKind::Function) {
-                reportError(node.getLineNumber(), "11.3 undeclared member function: '" + baseTypeName(ownerType) + "::" + methodName + "'");
-            }
-        }
-    } else {
-        // Free function call. Some AST shapes keep the callee identifier in node.getLeft().
-        symbol = _currentScope->resolve(node.getFunctionName());
-        if (symbol == nullptr || symbol->kind != SymbolKind::Function) {
-            reportError(node.getLineNumber(), "11.4 undeclared/undefined free function: '" + node.getFunctionName() + "'");
+            report(DiagnosticCode::UndeclaredFreeFunction, node.getLineNumber(), {node.getFunctionName()});
         }
     }
 
@@ -582,36 +1031,31 @@ void SemanticAnalyzer::visit(FuncCallNode& node) {
     }
 
     if (symbol != nullptr && symbol->kind == SymbolKind::Function) {
-        auto isAssignableTo = [](const std::string& expectedType, const std::string& actualType) {
-            if (expectedType == "null" || actualType == "null") {
+        auto isAssignableTo = [](TypeId expectedType, TypeId actualType) {
+            if (expectedType == TypeTable::Null || actualType == TypeTable::Null) {
                 return true;
             }
             if (expectedType == actualType) {
                 return true;
             }
-            return expectedType == "float" && actualType == "integer";
+            return expectedType == TypeTable::Float && actualType == TypeTable::Integer;
         };
 
-        const std::vector<std::string>& expectedParamTypes = symbol->paramTypes;
+        const std::vector<TypeId> expectedParamTypes = target.overload != nullptr ? target.overload->params : paramTypesOf(*symbol);
         const auto& args = node.getArgs();
         if (expectedParamTypes.size() != args.size()) {
-            reportError(
-                node.getLineNumber(),
-                "12.1 function call with wrong number of parameters: '" + node.getFunctionName() +
-                "': expected " + std::to_string(expectedParamTypes.size()) +
-                ", got " + std::to_string(args.size())
-            );
+            report(DiagnosticCode::WrongArgumentCount, node.getLineNumber(), {node.getFunctionName(), expectedParamTypes.size(), args.size()});
             return;
         }
 
         for (size_t i = 0; i < args.size(); ++i) {
-            const std::string actualType = inferExprType(args[i]);
-            const std::string& expectedType = expectedParamTypes[i];
+            const TypeId actualType = inferExprType(args[i]);
+            const TypeId expectedType = _types.baseOf(expectedParamTypes[i]);
             if (!isAssignableTo(expectedType, actualType)) {
-                reportError(
+                report(
+                    DiagnosticCode::WrongArgumentType,
                     node.getLineNumber(),
-                    "12.2 function call with wrong type of parameters in call to '" + node.getFunctionName() +
-                    "': expected '" + expectedType + "', got '" + actualType + "'"
+                    {node.getFunctionName(), _types.toString(expectedType), _types.toString(actualType)}
                 );
             }
         }
@@ -621,9 +1065,9 @@ void SemanticAnalyzer::visit(FuncCallNode& node) {
             displayName.clear();
 
             if (auto idNode = std::dynamic_pointer_cast<IdNode>(arg)) {
-                const SymbolEntry* argSymbol = _currentScope->resolve(idNode->getName());
-                if (argSymbol != nullptr && !argSymbol->dimensions.empty() && argSymbol->dimensions[0] > 0) {
-                    firstDimension = argSymbol->dimensions[0];
+                const SymbolEntry* argSymbol = resolveName(idNode->getName());
+                if (argSymbol != nullptr && !dimensionsOf(*argSymbol).empty() && dimensionsOf(*argSymbol)[0] > 0) {
+                    firstDimension = dimensionsOf(*argSymbol)[0];
                     displayName = idNode->getName();
                     return true;
                 }
@@ -636,19 +1080,19 @@ void SemanticAnalyzer::visit(FuncCallNode& node) {
             }
 
             if (memberNode->getLeft() == nullptr) {
-                const SymbolEntry* argSymbol = _currentScope->resolve(memberNode->getName());
-                if (argSymbol != nullptr && !argSymbol->dimensions.empty() && argSymbol->dimensions[0] > 0) {
-                    firstDimension = argSymbol->dimensions[0];
+                const SymbolEntry* argSymbol = resolveName(memberNode->getName());
+                if (argSymbol != nullptr && !dimensionsOf(*argSymbol).empty() && dimensionsOf(*argSymbol)[0] > 0) {
+                    firstDimension = dimensionsOf(*argSymbol)[0];
                     displayName = memberNode->getName();
                     return true;
                 }
                 return false;
             }
 
-            const std::string ownerType = inferExprType(memberNode->getLeft());
+            const TypeId ownerType = inferExprType(memberNode->getLeft());
             const SymbolEntry* memberSymbol = resolveClassMember(ownerType, memberNode->getName());
-            if (memberSymbol != nullptr && !memberSymbol->dimensions.empty() && memberSymbol->dimensions[0] > 0) {
-                firstDimension = memberSymbol->dimensions[0];
+            if (memberSymbol != nullptr && !dimensionsOf(*memberSymbol).empty() && dimensionsOf(*memberSymbol)[0] > 0) {
+                firstDimension = dimensionsOf(*memberSymbol)[0];
                 displayName = memberNode->getName();
                 return true;
             }
@@ -656,45 +1100,35 @@ void SemanticAnalyzer::visit(FuncCallNode& node) {
             return false;
         };
 
-        const std::vector<std::vector<int>>& expectedParamDimensions = symbol->paramDimensions;
-        if (expectedParamDimensions.size() == args.size()) {
-            for (size_t i = 0; i + 1 < args.size(); ++i) {
-                const std::vector<int>& dims = expectedParamDimensions[i];
-                if (dims.empty() || dims[0] >= 0) {
-                    continue;
-                }
+        for (size_t i = 0; i + 1 < args.size(); ++i) {
+            const TypeDescriptor& paramType = _types.get(expectedParamTypes[i]);
+            if (paramType.kind != TypeKind::Array || paramType.dimensions[0] >= 0) {
+                continue;
+            }
 
-                if (expectedParamTypes[i + 1] != "integer") {
-                    continue;
-                }
+            if (_types.baseOf(expectedParamTypes[i + 1]) != TypeTable::Integer) {
+                continue;
+            }
 
-                int requestedExtent = 0;
-                if (!tryEvalIntConst(args[i + 1], requestedExtent)) {
-                    continue;
-                }
+            int requestedExtent = 0;
+            if (!tryEvalIntConst(args[i + 1], requestedExtent)) {
+                continue;
+            }
 
-                int actualExtent = -1;
-                std::string arrayName;
-                if (!resolveArrayFirstDimension(args[i], actualExtent, arrayName)) {
-                    continue;
-                }
+            int actualExtent = -1;
+            std::string arrayName;
+            if (!resolveArrayFirstDimension(args[i], actualExtent, arrayName)) {
+                continue;
+            }
 
-                if (requestedExtent < 0) {
-                    reportError(
-                        node.getLineNumber(),
-                        "13.3 potential out-of-bounds access in call to '" + node.getFunctionName() +
-                        "': size argument " + std::to_string(requestedExtent) +
-                        " is negative for array '" + arrayName + "'"
-                    );
-                } else if (requestedExtent > actualExtent) {
-                    reportError(
-                        node.getLineNumber(),
-                        "13.3 potential out-of-bounds access in call to '" + node.getFunctionName() +
-                        "': size argument " + std::to_string(requestedExtent) +
-                        " exceeds declared size " + std::to_string(actualExtent) +
-                        " for array '" + arrayName + "'"
-                    );
-                }
+            if (requestedExtent < 0) {
+                report(DiagnosticCode::NegativeCallExtent, node.getLineNumber(), {node.getFunctionName(), requestedExtent, arrayName});
+            } else if (requestedExtent > actualExtent) {
+                report(
+                    DiagnosticCode::CallExtentExceedsArray,
+                    node.getLineNumber(),
+                    {node.getFunctionName(), requestedExtent, actualExtent, arrayName}
+                );
             }
         }
     }
@@ -714,62 +1148,49 @@ void SemanticAnalyzer::visit(DataMemberNode& node) {
     std::vector<int> declaredDimensions;
 
     if (node.getLeft() == nullptr) {
-        const SymbolEntry* symbol = _currentScope->resolve(node.getName());
+        const SymbolEntry* symbol = resolveName(node.getName());
         if (symbol == nullptr) {
-            reportError(node.getLineNumber(), "11.2 undeclared member variable or unresolved identifier: '" + node.getName() + "'");
+            report(DiagnosticCode::UnresolvedIdentifier, node.getLineNumber(), {node.getName()});
         } else {
-            declaredDimensions = symbol->dimensions;
+            declaredDimensions = dimensionsOf(*symbol);
             // Check array dimensions match
-            const size_t declaredDimensions = symbol->dimensions.size();
+            const size_t declaredDimensions = dimensionsOf(*symbol).size();
             const size_t accessedDimensions = node.getIndices().size();
             if (declaredDimensions != accessedDimensions) {
-                reportError(
-                    node.getLineNumber(),
-                    "13.1 array '" + node.getName() + "' has " + std::to_string(declaredDimensions) +
-                    " dimension(s) but is accessed with " + std::to_string(accessedDimensions) + " index/indices"
-                );
+                report(DiagnosticCode::ArrayDimensionMismatch, node.getLineNumber(), {node.getName(), declaredDimensions, accessedDimensions});
             }
         }
     } else {
-        const std::string ownerType = inferExprType(node.getLeft());
-        if (ownerType.empty()) {
-            reportError(node.getLineNumber(), "cannot resolve owner type for member access '" + node.getName() + "'");
+        const TypeId ownerType = inferExprType(node.getLeft());
+        const SymbolEntry* member = resolveClassMember(ownerType, node.getName());
+        const TypeId ownerBase = _types.baseOf(ownerType);
+        if (_types.kind(ownerBase) == TypeKind::Builtin) {
+            report(DiagnosticCode::DotOnNonClassType, node.getLineNumber(), {_types.toString(ownerBase)});
+        } else if (member == nullptr) {
+            report(DiagnosticCode::UndeclaredMemberVariable, node.getLineNumber(), {_types.toString(ownerBase), node.getName()});
         } else {
-            const SymbolEntry* member = resolveClassMember(ownerType, node.getName());
-            const std::string ownerBase = baseTypeName(ownerType);
-            if (ownerBase == "integer" || ownerBase == "float" || ownerBase == "void" || ownerBase == "bool") {
-                reportError(node.getLineNumber(), "15.1 '.' operator used on non-class type '" + ownerBase + "'");
-            } else if (member == nullptr) {
-                reportError(node.getLineNumber(), "11.2 undeclared member variable: type '" + ownerBase + "' has no member named '" + node.getName() + "'");
-            } else {
-                declaredDimensions = member->dimensions;
-            }
+            declaredDimensions = dimensionsOf(*member);
         }
     }
 
     size_t dimIdx = 0;
     visitNode(node.getLeft());
     for (const auto& idx : node.getIndices()) {
-        const std::string indexType = inferExprType(idx);
-        if (indexType != "null" && indexType != "integer") {
-            reportError(node.getLineNumber(), "13.2 array index is not an integer");
+        const TypeId indexType = inferExprType(idx);
+        if (indexType != TypeTable::Null && indexType != TypeTable::Integer) {
+            report(DiagnosticCode::ArrayIndexNotInteger, node.getLineNumber());
         }
 
         int constantIndex = 0;
         if (tryEvalIntConst(idx, constantIndex)) {
             if (constantIndex < 0) {
-                reportError(
-                    node.getLineNumber(),
-                    "13.3 array index out of bounds: index " + std::to_string(constantIndex) +
-                    " for array '" + node.getName() + "'"
-                );
+                report(DiagnosticCode::NegativeArrayIndex, node.getLineNumber(), {constantIndex, node.getName()});
             } else if (dimIdx < declaredDimensions.size() && declaredDimensions[dimIdx] > 0 &&
                        constantIndex >= declaredDimensions[dimIdx]) {
-                reportError(
+                report(
+                    DiagnosticCode::ArrayIndexOutOfBounds,
                     node.getLineNumber(),
-                    "13.3 array index out of bounds: index " + std::to_string(constantIndex) +
-                    " exceeds upper bound " + std::to_string(declaredDimensions[dimIdx] - 1) +
-                    " for array '" + node.getName() + "'"
+                    {constantIndex, declaredDimensions[dimIdx] - 1, node.getName()}
                 );
             }
         }
@@ -788,13 +1209,13 @@ void SemanticAnalyzer::visit(AssignStmtNode& node) {
     visitNode(node.getLeft());
     visitNode(node.getRight());
     
-    std::string leftType = inferExprType(node.getLeft());
-    std::string rightType = inferExprType(node.getRight());
+    const TypeId leftType = inferExprType(node.getLeft());
+    const TypeId rightType = inferExprType(node.getRight());
     
-    if (leftType != "null" && rightType != "null" && leftType != rightType) {
+    if (leftType != TypeTable::Null && rightType != TypeTable::Null && leftType != rightType) {
         // Allow int to float promotion, but block float to int, or int to Class.
-        if (!(leftType == "float" && rightType == "integer")) {
-             reportError(node.getLineNumber(), "10.2 type error in assignment statement: cannot assign '" + rightType + "' to '" + leftType + "'");
+        if (!(leftType == TypeTable::Float && rightType == TypeTable::Integer)) {
+            report(DiagnosticCode::AssignmentTypeMismatch, node.getLineNumber(), {_types.toString(rightType), _types.toString(leftType)});
         }
     }
 }
@@ -809,14 +1230,11 @@ void SemanticAnalyzer::visit(IfStmtNode& node) {
 
     visitNode(node.getLeft());
 
-    const std::string condType = inferExprType(node.getLeft());
+    const TypeId condType = inferExprType(node.getLeft());
     const bool isConditionCompatible =
-        condType == "bool";
-    if (condType != "null" && !isConditionCompatible) {
-        reportError(
-            node.getLineNumber(),
-            "condition in 'if' must evaluate to numeric/boolean-compatible type, found '" + condType + "'"
-        );
+        condType == TypeTable::Bool;
+    if (condType != TypeTable::Null && !isConditionCompatible) {
+        report(DiagnosticCode::IfConditionType, node.getLineNumber(), {_types.toString(condType)});
     }
 
     visitNode(node.getRight());
@@ -832,14 +1250,11 @@ void SemanticAnalyzer::visit(WhileStmtNode& node) {
 
     visitNode(node.getLeft());
 
-    const std::string condType = inferExprType(node.getLeft());
+    const TypeId condType = inferExprType(node.getLeft());
     const bool isConditionCompatible =
-        condType == "bool";
-    if (condType != "null" && !isConditionCompatible) {
-        reportError(
-            node.getLineNumber(),
-            "condition in 'while' must evaluate to numeric/boolean-compatible type, found '" + condType + "'"
-        );
+        condType == TypeTable::Bool;
+    if (condType != TypeTable::Null && !isConditionCompatible) {
+        report(DiagnosticCode::WhileConditionType, node.getLineNumber(), {_types.toString(condType)});
     }
 
     visitNode(node.getRight());
@@ -855,33 +1270,30 @@ void SemanticAnalyzer::visit(IOStmtNode& node) {
     visitNode(node.getLeft());
 
     const std::string ioType = node.getValue();
-    const std::string exprType = inferExprType(node.getLeft());
-    const std::string baseType = baseTypeName(exprType);
+    const TypeId exprType = inferExprType(node.getLeft());
+    const TypeId baseType = _types.baseOf(exprType);
 
-    if (exprType == "null") {
+    if (exprType == TypeTable::Null) {
         return;
     }
 
     if (ioType == "read") {
         if (std::dynamic_pointer_cast<IdNode>(node.getLeft()) == nullptr &&
             std::dynamic_pointer_cast<DataMemberNode>(node.getLeft()) == nullptr) {
-            reportError(node.getLineNumber(), "read statement requires an assignable variable/member target");
+            report(DiagnosticCode::ReadTargetNotAssignable, node.getLineNumber());
             return;
         }
 
-        if (baseType != "integer" && baseType != "float" && baseType != "bool") {
-            reportError(
-                node.getLineNumber(),
-                "read statement target must be scalar integer/float/bool, found '" + baseType + "'"
-            );
+        if (baseType != TypeTable::Integer && baseType != TypeTable::Float && baseType != TypeTable::Bool) {
+            report(DiagnosticCode::ReadTargetNotScalar, node.getLineNumber(), {_types.toString(baseType)});
         }
 
         return;
     }
 
     if (ioType == "write") {
-        if (baseType == "void") {
-            reportError(node.getLineNumber(), "write statement cannot output expression of type 'void'");
+        if (baseType == TypeTable::Void) {
+            report(DiagnosticCode::WriteVoidExpression, node.getLineNumber());
         }
     }
 }
@@ -895,59 +1307,56 @@ void SemanticAnalyzer::visit(ReturnStmtNode& node) {
     visitNode(node.getLeft());
 
     if (_functionReturnTypeStack.empty()) {
-        reportError(node.getLineNumber(), "return statement used outside of function body");
+        report(DiagnosticCode::ReturnOutsideFunction, node.getLineNumber());
         return;
     }
 
-    const std::string expectedType = _functionReturnTypeStack.back();
-    const std::string actualType = inferExprType(node.getLeft());
+    const TypeId expectedType = _functionReturnTypeStack.back();
+    const TypeId actualType = inferExprType(node.getLeft());
 
-    auto isAssignableTo = [](const std::string& expected, const std::string& actual) {
+    auto isAssignableTo = [](TypeId expected, TypeId actual) {
         if (expected == actual) {
             return true;
         }
-        else if(expected == "null" && actual != "null") {
+        else if(expected == TypeTable::Null && actual != TypeTable::Null) {
             return false;
         }
-        return expected == "float" && actual == "integer";
+        return expected == TypeTable::Float && actual == TypeTable::Integer;
     };
 
-    if (expectedType == "void") {
+    if (expectedType == TypeTable::Void) {
         if (node.getLeft() != nullptr) {
-            reportError(
-                node.getLineNumber(),
-                "10.3 type error in return statement: function expects 'void' but return has expression of type '" + actualType + "'"
-            );
+            report(DiagnosticCode::ReturnValueFromVoidFunction, node.getLineNumber(), {_types.toString(actualType)});
         }
         return;
     }
 
     if (node.getLeft() == nullptr) {
-        reportError(
-            node.getLineNumber(),
-            "10.3 type error in return statement: function expects '" + expectedType + "' but return has no expression"
-        );
+        report(DiagnosticCode::ReturnWithoutValue, node.getLineNumber(), {_types.toString(expectedType)});
         return;
     }
 
-    if (actualType != "null" && !isAssignableTo(expectedType, actualType)) {
-        reportError(
-            node.getLineNumber(),
-            "10.3 type error in return statement: expected '" + expectedType + "', got '" + actualType + "'"
-        );
+    if (actualType != TypeTable::Null && !isAssignableTo(expectedType, actualType)) {
+        report(DiagnosticCode::ReturnTypeMismatch, node.getLineNumber(), {_types.toString(expectedType), _types.toString(actualType)});
     }
 }
 
 /** @brief Enter block scope, visit statements, then restore previous scope. */
 void SemanticAnalyzer::visit(BlockNode& node) {
     std::shared_ptr<SymbolTable> prev = _currentScope;
-    _currentScope = getOrCreateChildScope(_currentScope, "block#" + std::to_string(++_blockCounter));
+    // Blocks are only entered in pass 2 (pass 1 stops at function bodies), so each
+    // visit creates its scope directly.
+    setCurrentScope(_currentScope->createChild("block#" + std::to_string(++_blockCounter)));
 
     for (const auto& stmt : node.getStatements()) {
         visitNode(stmt);
+        // A call statement has no parent expression to infer (and annotate) it.
+        if (std::dynamic_pointer_cast<FuncCallNode>(stmt) != nullptr) {
+            inferExprType(stmt);
+        }
     }
 
-    _currentScope = prev;
+    setCurrentScope(prev);
 }
 
 /**
@@ -956,19 +1365,21 @@ void SemanticAnalyzer::visit(BlockNode& node) {
  * Enforces class-type existence and selected shadowing diagnostics.
  */
 void SemanticAnalyzer::visit(VarDeclNode& node) {
-    const std::string declaredTypeBase = baseTypeName(node.getTypeName());
-    if (!isBuiltinType(declaredTypeBase) && _declaredClassNames.find(declaredTypeBase) == _declaredClassNames.end()) {
-        reportError(node.getLineNumber(), "11.5 undeclared class: '" + declaredTypeBase + "'");
+    const TypeId declaredType = _types.named(node.getTypeName());
+    recordDependency("c:", node.getTypeName());
+    if (_types.kind(declaredType) != TypeKind::Builtin && _declaredClassNames.find(node.getTypeName()) == _declaredClassNames.end()) {
+        report(DiagnosticCode::UndeclaredClass, node.getLineNumber(), {node.getTypeName()});
     }
 
     if (node.getVisibility() == "local") {
         const std::string enclosingClass = enclosingClassFromFunctionScope(_currentScope);
         if (!enclosingClass.empty()) {
+            recordDependency("c:", enclosingClass);
             auto classIt = _classScopes.find(enclosingClass);
             if (classIt != _classScopes.end() && classIt->second != nullptr) {
                 const SymbolEntry* classMember = classIt->second->lookupInCurrent(node.getName());
                 if (classMember != nullptr && classMember->kind == SymbolKind::Field) {
-                    reportWarning(node.getLineNumber(), "8.7 local variable in member function shadows data member: '" + node.getName() + "'");
+                    report(DiagnosticCode::LocalShadowsDataMember, node.getLineNumber(), {node.getName()});
                 }
             }
         }
@@ -980,12 +1391,12 @@ void SemanticAnalyzer::visit(VarDeclNode& node) {
         if (!currentClass.empty()) {
             const SymbolEntry* classEntry = _globalScope->lookupInCurrent(currentClass);
             if (classEntry != nullptr) {
-                for (const auto& parentName : parseParentsFromClassType(classEntry->type)) {
+                for (const auto& parentName : classParents(*classEntry)) {
                     auto parentIt = _classScopes.find(parentName);
                     if (parentIt != _classScopes.end() && parentIt->second != nullptr) {
                         const SymbolEntry* inherited = parentIt->second->lookupInCurrent(node.getName());
                         if (inherited != nullptr && inherited->kind == SymbolKind::Field) {
-                            reportWarning(node.getLineNumber(), "8.6 shadowed inherited data member: '" + node.getName() + "'");
+                            report(DiagnosticCode::ShadowedInheritedDataMember, node.getLineNumber(), {node.getName()});
                         }
                     }
                 }
@@ -995,13 +1406,10 @@ void SemanticAnalyzer::visit(VarDeclNode& node) {
 
     SymbolEntry entry;
     entry.name = node.getName();
-    entry.type = node.getTypeName();
-    entry.dimensions = node.getDimensions();
-    entry.returnType = "null";
-    entry.paramTypes.clear();
+    entry.type = declaredType;
+    entry.fullType = _types.array(declaredType, node.getDimensions());
     entry.kind = node.getVisibility() == "local" ? SymbolKind::Variable : SymbolKind::Field;
-    entry.visibility = node.getVisibility();
-    entry.details = "null";
+    entry.visibility = visibilityFromString(node.getVisibility());
     entry.line = node.getLineNumber();
     defineSymbol(entry);
 }
@@ -1018,9 +1426,10 @@ void SemanticAnalyzer::visit(FuncDefNode& node) {
 
     if (!node.getClassName().empty()) {
         ownerClass = node.getClassName();
+        recordDependency("c:", ownerClass);
         auto it = _classScopes.find(ownerClass);
         if (it == _classScopes.end()) {
-            reportError(node.getLineNumber(), "definition for method '" + ownerClass + "::" + node.getName() + "' has unknown class");
+            report(DiagnosticCode::MethodOfUnknownClass, node.getLineNumber(), {ownerClass, node.getName()});
             ownerScope = _globalScope;
         } else {
             ownerScope = it->second;
@@ -1037,34 +1446,21 @@ void SemanticAnalyzer::visit(FuncDefNode& node) {
     }
 
     std::shared_ptr<SymbolTable> prevScope = _currentScope;
-    _currentScope = ownerScope;
+    setCurrentScope(ownerScope);
 
     const bool isImplementation = node.getRight() != nullptr;
-    const std::string paramProfile = functionParamProfile(node);
-    const std::string memberFunctionKey = ownerClass.empty()
-        ? std::string()
-        : (ownerClass + "::" + node.getName() + paramProfile);
-
-    if (isPassOne() && !ownerClass.empty() && !isImplementation) {
-        _declaredMemberFunctionKeys.insert(memberFunctionKey);
+    std::vector<TypeId> paramTypes;
+    for (const auto& param : node.getParams()) {
+        paramTypes.push_back(_types.array(_types.named(param->getTypeName()), param->getDimensions()));
     }
 
     if (isPassOne()) {
         SymbolEntry entry;
         entry.name = node.getName();
         entry.type = functionSignature(node);
-        entry.returnType = node.getReturnType();
-        entry.paramTypes.clear();
-        entry.paramDimensions.clear();
-        for (const auto& param : node.getParams()) {
-            entry.paramTypes.push_back(param->getTypeName());
-            entry.paramDimensions.push_back(param->getDimensions());
-        }
+        entry.fullType = _types.function(_types.named(node.getReturnType()), paramTypes);
         entry.kind = SymbolKind::Function;
-        entry.visibility = "n/a";
-        const std::string ownerDescriptor = ownerClass.empty() ? "free function" : ("method of " + ownerClass);
-        const std::string role = isImplementation ? "implementation" : "declaration";
-        entry.details = ownerDescriptor + " (" + role + ")";
+        entry.flags = (isImplementation ? SymbolImplemented : SymbolDeclared) | (ownerClass.empty() ? 0 : SymbolMethod);
         entry.line = node.getLineNumber();
 
         SymbolEntry* existing = _currentScope->lookupMutableInCurrent(entry.name);
@@ -1076,172 +1472,627 @@ void SemanticAnalyzer::visit(FuncDefNode& node) {
                 defineSymbol(entry);
             }
         } else if (existing->kind != SymbolKind::Function) {
-            reportError(entry.line, "symbol '" + entry.name + "' already exists with non-function kind in scope '" + _currentScope->getScopeName() + "'");
+            report(DiagnosticCode::NonFunctionSymbolExists, entry.line, {entry.name, _currentScope->getScopeName()});
         } else {
-            const bool sameParameterProfile = (existing->paramTypes == entry.paramTypes) &&
-                                              (existing->paramDimensions == entry.paramDimensions);
+            const bool sameParameterProfile = paramTypesOf(*existing) == paramTypes;
 
             if (!sameParameterProfile) {
                 if (ownerClass.empty()) {
-                    reportWarning(entry.line, "9.1 overloaded free function: '" + entry.name + "'");
+                    report(DiagnosticCode::OverloadedFreeFunction, entry.line, {entry.name});
                 } else {
-                    reportWarning(entry.line, "9.2 overloaded member function: '" + ownerClass + "::" + entry.name + "'");
+                    report(DiagnosticCode::OverloadedMemberFunction, entry.line, {ownerClass, entry.name});
                 }
             } else if (!isImplementation && ownerClass.empty()) {
-                reportError(entry.line, "8.2 multiply declared free function: '" + entry.name + "'");
+                report(DiagnosticCode::MultiplyDeclaredFreeFunction, entry.line, {entry.name});
             }
 
-            const bool existingHasDecl = existing->details.find("declaration") != std::string::npos;
-            const bool existingHasImpl = existing->details.find("implementation") != std::string::npos;
+            const bool existingHasDecl = (existing->flags & SymbolDeclared) != 0;
+            const bool existingHasImpl = (existing->flags & SymbolImplemented) != 0;
             if (isImplementation && sameParameterProfile && existingHasDecl && !existingHasImpl) {
-                existing->details = ownerDescriptor + " (declaration + implementation)";
+                existing->flags |= SymbolImplemented;
             } else if (isImplementation && sameParameterProfile && existingHasImpl) {
                 if (ownerClass.empty()) {
-                    reportError(entry.line, "8.2 multiply declared free function: '" + entry.name + "'");
+                    report(DiagnosticCode::MultiplyDeclaredFreeFunction, entry.line, {entry.name});
                 } else {
-                    reportError(entry.line, "multiple implementations for function '" + entry.name + "' in scope '" + _currentScope->getScopeName() + "'");
+                    report(DiagnosticCode::MultipleImplementations, entry.line, {entry.name, _currentScope->getScopeName()});
+                }
+            }
+        }
+
+        // Index the parameter list for call resolution. A member implementation
+        // only marks a declared overload; an undeclared one is reported as 6.1.
+        const SymbolEntry* named = _currentScope->lookupInCurrent(entry.name);
+        if (named != nullptr && named->kind == SymbolKind::Function) {
+            const std::uint8_t role = isImplementation ? SymbolImplemented : SymbolDeclared;
+            if (ownerClass.empty() || !isImplementation) {
+                _currentScope->addOverload(entry.name, paramTypes, entry.fullType)->flags |= role;
+            } else {
+                const FunctionOverload* declared = _currentScope->findOverload(entry.name, paramTypes);
+                if (declared != nullptr && (declared->flags & SymbolDeclared) != 0) {
+                    _currentScope->addOverload(entry.name, paramTypes, entry.fullType)->flags |= role;
                 }
             }
         }
     }
 
     if (!isImplementation) {
-        _currentScope = prevScope;
+        setCurrentScope(prevScope);
         return;
     }
 
     if (!isPassOne() && !ownerClass.empty()) {
-        const bool hasDeclaration = _declaredMemberFunctionKeys.find(memberFunctionKey) != _declaredMemberFunctionKeys.end();
+        auto classIt = _classScopes.find(ownerClass);
+        const FunctionOverload* declared = classIt != _classScopes.end() && classIt->second != nullptr
+            ? classIt->second->findOverload(node.getName(), paramTypes)
+            : nullptr;
+        const bool hasDeclaration = declared != nullptr && (declared->flags & SymbolDeclared) != 0;
         if (!hasDeclaration) {
-            reportError(
-                node.getLineNumber(),
-                "6.1 undeclared member function definition: '" + ownerClass + "::" + node.getName() + "'"
-            );
+            report(DiagnosticCode::UndeclaredMemberFunctionDefinition, node.getLineNumber(), {ownerClass, node.getName()});
         }
     }
 
     if (isPassOne()) {
-        // Pass 1 only declares signatures; body analysis is deferred to pass 2.
-        _currentScope = prevScope;
+        // Pass 1 declares signatures and the body scope; body analysis is deferred to pass 2.
+        // Implementations sharing a scope name (duplicates) share one scope.
+        const std::string funcScopeName = ownerClass.empty()
+            ? ("function " + node.getName() + functionParamProfile(node))
+            : ("function " + ownerClass + "::" + node.getName() + functionParamProfile(node));
+        std::shared_ptr<SymbolTable> funcScope = _currentScope->findChild(funcScopeName);
+        _nodeScopes[&node] = funcScope != nullptr ? funcScope : _currentScope->createChild(funcScopeName);
+        setCurrentScope(prevScope);
         return;
     }
 
-    std::string funcScopeName = ownerClass.empty()
-        ? ("function " + node.getName() + paramProfile)
-        : ("function " + ownerClass + "::" + node.getName() + paramProfile);
     std::shared_ptr<SymbolTable> prev = _currentScope;
-    _currentScope = getOrCreateChildScope(_currentScope, funcScopeName);
+    setCurrentScope(recordedScope(node));
 
     for (const auto& param : node.getParams()) {
         SymbolEntry paramEntry;
         paramEntry.name = param->getName();
-        paramEntry.type = param->getTypeName();
-        paramEntry.dimensions = param->getDimensions();
+        paramEntry.type = _types.named(param->getTypeName());
+        paramEntry.fullType = _types.array(paramEntry.type, param->getDimensions());
         paramEntry.kind = SymbolKind::Parameter;
-        paramEntry.visibility = "param";
-        paramEntry.details = "null";
+        paramEntry.visibility = SymbolVisibility::Param;
         paramEntry.line = param->getLineNumber();
         defineSymbol(paramEntry);
     }
 
-    _functionReturnTypeStack.push_back(node.getReturnType());
+    _functionReturnTypeStack.push_back(_types.named(node.getReturnType()));
+    _receiverClass = ownerClass;
     visitNode(node.getRight());
+    _receiverClass.clear();
     _functionReturnTypeStack.pop_back();
 
     if (node.getReturnType() != "void" && !containsReturnStatement(node.getRight())) {
-        reportError(
-            node.getLineNumber(),
-            "non-void function '" + node.getName() + "' must contain a return statement"
-        );
+        report(DiagnosticCode::MissingReturnStatement, node.getLineNumber(), {node.getName()});
     }
 
-    _currentScope = prev;
-    _currentScope = prevScope;
+    setCurrentScope(prev);
+    setCurrentScope(prevScope);
 }
 
 /**
- * @brief Process class declaration and class-member semantic rules.
- * @details
- * Pass 1 registers class scope and fields before methods.
- * Pass 2 validates member bodies/usages.
+ * @brief Pass 1 on a class: define its symbol and scope, register its fields, and enter the scope.
+ * @return The enclosing scope, to restore when the class has been declared.
  */
-void SemanticAnalyzer::visit(ClassDeclNode& node) {
-    if (isPassOne()) {
-        SymbolEntry entry;
-        entry.name = node.getName();
-        entry.type = classTypeName(node);
-        entry.returnType = "null";
-        entry.paramTypes.clear();
-        entry.kind = SymbolKind::Class;
-        entry.visibility = "n/a";
-        entry.details = node.getParents().empty() ? "no inheritance" : "inherits " + std::to_string(node.getParents().size()) + " class(es)";
-        entry.line = node.getLineNumber();
-        defineSymbol(entry);
-    }
+std::shared_ptr<SymbolTable> SemanticAnalyzer::beginClassDeclaration(ClassDeclNode& node) {
+    SymbolEntry entry;
+    entry.name = node.getName();
+    entry.type = classDescriptor(node);
+    entry.fullType = entry.type;
+    entry.kind = SymbolKind::Class;
+    entry.line = node.getLineNumber();
+    defineSymbol(entry);
 
     std::shared_ptr<SymbolTable> prev = _currentScope;
-    _currentScope = getOrCreateChildScope(_currentScope, "class " + node.getName());
-    if (isPassOne()) {
-        _classScopes[node.getName()] = _currentScope;
-    }
+    const std::string scopeName = "class " + node.getName();
+    setCurrentScope(prev->createChild(scopeName));
+    _classScopes[node.getName()] = _currentScope;
+    // Pass 2 analyzes a redeclared class in the first scope of that name.
+    _nodeScopes[&node] = prev->findChild(scopeName);
+
+    declareClassFields(node);
+    return prev;
+}
 
-    // Pass 1: register all fields first, so methods can reference them regardless of source order.
+/** @brief Register all fields first, so methods can reference them regardless of source order. */
+void SemanticAnalyzer::declareClassFields(ClassDeclNode& node) {
     for (const auto& member : node.getMembers()) {
         auto field = std::dynamic_pointer_cast<VarDeclNode>(member);
         if (field != nullptr) {
             field->accept(*this);
         }
     }
+}
+
+/** @brief Report a member function that overrides a parent's function with the same signature. */
+void SemanticAnalyzer::checkOverriddenMemberFunction(const ClassDeclNode& owner, const FuncDefNode& method) {
+    const SymbolEntry* classEntry = _globalScope->lookupInCurrent(owner.getName());
+    if (classEntry == nullptr) {
+        return;
+    }
+
+    for (const auto& parentName : classParents(*classEntry)) {
+        auto parentIt = _classScopes.find(parentName);
+        if (parentIt != _classScopes.end() && parentIt->second != nullptr) {
+            const SymbolEntry* inheritedFn = parentIt->second->lookupInCurrent(method.getName());
+            if (inheritedFn != nullptr && inheritedFn->kind == SymbolKind::Function && inheritedFn->type == functionSignature(method)) {
+                report(DiagnosticCode::OverriddenMemberFunction, method.getLineNumber(), {owner.getName(), method.getName()});
+            }
+        }
+    }
+}
+
+/**
+ * @brief Process class declaration and class-member semantic rules.
+ * @details
+ * Pass 1 registers class scope and fields before methods (runAnalysis() drives
+ * it through DeclarationCollector, which shares these helpers).
+ * Pass 2 validates member bodies/usages.
+ */
+void SemanticAnalyzer::visit(ClassDeclNode& node) {
+    std::shared_ptr<SymbolTable> prev = _currentScope;
+    if (isPassOne()) {
+        prev = beginClassDeclaration(node);
+    } else {
+        setCurrentScope(recordedScope(node));
+        declareClassFields(node);
+    }
 
-    // Pass 2: analyze all members.
     for (const auto& member : node.getMembers()) {
         if (std::dynamic_pointer_cast<VarDeclNode>(member) != nullptr) {
             continue;
         }
 
         if (isPassOne()) {
-            auto method = std::dynamic_pointer_cast<FuncDefNode>(member);
-            if (method != nullptr) {
-                const SymbolEntry* classEntry = _globalScope->lookupInCurrent(node.getName());
-                if (classEntry != nullptr) {
-                    for (const auto& parentName : parseParentsFromClassType(classEntry->type)) {
-                        auto parentIt = _classScopes.find(parentName);
-                        if (parentIt != _classScopes.end() && parentIt->second != nullptr) {
-                            const SymbolEntry* inheritedFn = parentIt->second->lookupInCurrent(method->getName());
-                            if (inheritedFn != nullptr && inheritedFn->kind == SymbolKind::Function && inheritedFn->type == functionSignature(*method)) {
-                                reportWarning(method->getLineNumber(), "9.3 overridden member function: '" + node.getName() + "::" + method->getName() + "'");
-                            }
-                        }
-                    }
-                }
+            if (auto method = std::dynamic_pointer_cast<FuncDefNode>(member)) {
+                checkOverriddenMemberFunction(node, *method);
             }
         }
 
         visitNode(member);
     }
 
-    _currentScope = prev;
+    setCurrentScope(prev);
 }
 
-/** @brief Program-level traversal entry: classes then functions. */
+/** @brief Program-level traversal entry: classes then functions (bodies in parallel in pass 2). */
 void SemanticAnalyzer::visit(ProgNode& node) {
     for (const auto& cls : node.getClasses()) {
         visitNode(cls);
     }
 
+    if (!isPassOne()) {
+        checkFunctionBodies(node.getFunctions());
+        return;
+    }
+
     for (const auto& function : node.getFunctions()) {
         visitNode(function);
     }
 }
 
-/** @brief Append semantic error diagnostic with standardized prefix. */
-void SemanticAnalyzer::reportError(int line, const std::string& message) {
-    _errors.push_back("[ERROR][SEMANTIC] line " + std::to_string(line) + ": " + message);
+/**
+ * @brief Run pass 2 over function definitions, one task per definition.
+ * @param functions Free and class-qualified function definitions in source order.
+ *
+ * @details
+ * After pass 1 a body only reads the global and class scopes and writes into
+ * its own function scope, so definitions are checked on worker copies of this
+ * analyzer. The result matches a sequential run because:
+ * - each task starts block numbering at the prefix sum of earlier tasks' block counts;
+ * - local types are interned before the TypeTable is frozen, so worker copies agree on ids;
+ *   a group that still needs a new type is abandoned by its worker and re-checked
+ *   on this thread, from an emptied function scope, after the table is thawed;
+ * - definitions sharing one function scope (duplicates) form a group checked by
+ *   one worker in source order;
+ * - task diagnostics are appended in source order.
+ * With a single job (or definition) the definitions are simply visited in order.
+ * When a snapshot is recorded or reused, every definition is planned first;
+ * reusable ones are copied from the previous snapshot instead of checked.
+ */
+void SemanticAnalyzer::checkFunctionBodies(const std::vector<std::shared_ptr<FuncDefNode>>& functions) {
+    const size_t requested = _passTwoJobs != 0 ? _passTwoJobs : std::thread::hardware_concurrency();
+    const bool sequential = requested <= 1 || functions.size() <= 1;
+    const bool tracked = _snapshot != nullptr || _previous != nullptr;
+    if (sequential && !tracked) {
+        for (const auto& function : functions) {
+            if (_diagnostics.limitReached()) {
+                break;
+            }
+            visitNode(function);
+            ++_checkedBodies;
+        }
+        return;
+    }
+
+    const std::vector<BodyPlan> plans = tracked ? planFunctionBodies(functions) : std::vector<BodyPlan>(functions.size());
+    if (sequential) {
+        for (size_t i = 0; i < functions.size(); ++i) {
+            if (_diagnostics.limitReached()) {
+                break;
+            }
+            if (functions[i] == nullptr) {
+                continue;
+            }
+            FunctionBodyTask task;
+            task.node = functions[i].get();
+            task.blockBase = _blockCounter;
+            if (plans[i].reuse != nullptr) {
+                reuseFunctionBody(plans[i], task);
+            } else {
+                checkFunctionBody(task);
+                task.blockCount = _blockCounter - task.blockBase;
+                ++_checkedBodies;
+            }
+            _blockCounter = task.blockBase + task.blockCount;
+            _diagnostics.append(task.diagnostics);
+            recordFunctionBody(plans[i], task);
+        }
+        return;
+    }
+
+    std::vector<FunctionBodyTask> tasks;
+    std::vector<size_t> taskPlan;
+    std::vector<std::vector<size_t>> groups;
+    std::unordered_map<const void*, size_t> groupOf;
+    int blockBase = _blockCounter;
+    for (size_t i = 0; i < functions.size(); ++i) {
+        const auto& function = functions[i];
+        if (function == nullptr) {
+            continue;
+        }
+
+        FunctionBodyPrepass prepass;
+        ASTTraversal::walk(function, prepass);
+        for (const auto* decl : prepass.declaredTypes()) {
+            _types.array(_types.named(decl->getTypeName()), decl->getDimensions());
+        }
+
+        FunctionBodyTask task;
+        task.node = function.get();
+        task.blockBase = blockBase;
+        task.blockCount = prepass.blockCount();
+        blockBase += prepass.blockCount();
+
+        if (plans[i].reuse == nullptr) {
+            auto scopeIt = _nodeScopes.find(function.get());
+            const void* groupKey = scopeIt != _nodeScopes.end() ? static_cast<const void*>(scopeIt->second.get()) : function.get();
+            auto groupIt = groupOf.emplace(groupKey, groups.size()).first;
+            if (groupIt->second == groups.size()) {
+                groups.emplace_back();
+            }
+            groups[groupIt->second].push_back(tasks.size());
+        }
+        taskPlan.push_back(i);
+        tasks.push_back(std::move(task));
+    }
+    _types.freeze();
+
+    const size_t workers = std::min(requested, groups.size());
+    std::atomic<size_t> nextGroup{0};
+    std::vector<std::exception_ptr> failures(workers);
+    // Written only by the worker that took the group.
+    std::vector<char> retryGroup(groups.size(), 0);
+    auto runWorker = [&](size_t workerIndex) {
+        try {
+            auto worker = std::make_unique<SemanticAnalyzer>(*this);
+            for (size_t group = nextGroup++; group < groups.size(); group = nextGroup++) {
+                try {
+                    for (size_t taskIndex : groups[group]) {
+                        worker->checkFunctionBody(tasks[taskIndex]);
+                    }
+                } catch (const TypeTableFrozenError&) {
+                    // The worker stopped mid-body; start the next group from a clean copy.
+                    retryGroup[group] = 1;
+                    worker = std::make_unique<SemanticAnalyzer>(*this);
+                }
+            }
+        } catch (...) {
+            failures[workerIndex] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < workers; ++i) {
+        threads.emplace_back(runWorker, i);
+    }
+    if (workers > 0) {
+        runWorker(0);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto& failure : failures) {
+        if (failure != nullptr) {
+            std::rethrow_exception(failure);
+        }
+    }
+
+    if (std::find(retryGroup.begin(), retryGroup.end(), 1) != retryGroup.end()) {
+        _types.thaw();
+        for (size_t group = 0; group < groups.size(); ++group) {
+            if (retryGroup[group] == 0) {
+                continue;
+            }
+            recordedScope(*tasks[groups[group].front()].node)->clear();
+            for (size_t taskIndex : groups[group]) {
+                tasks[taskIndex].dependencies.clear();
+                checkFunctionBody(tasks[taskIndex]);
+            }
+        }
+        _types.freeze();
+    }
+
+    for (size_t t = 0; t < tasks.size(); ++t) {
+        const BodyPlan& plan = plans[taskPlan[t]];
+        if (plan.reuse != nullptr) {
+            reuseFunctionBody(plan, tasks[t]);
+        } else {
+            ++_checkedBodies;
+        }
+        _diagnostics.append(tasks[t].diagnostics);
+        recordFunctionBody(plan, tasks[t]);
+    }
+    _blockCounter = blockBase;
+}
+
+/**
+ * @brief Check one function definition as the sequential pass 2 would.
+ * @param task Definition and block-number base; receives the diagnostics.
+ */
+void SemanticAnalyzer::checkFunctionBody(FunctionBodyTask& task) {
+    // Bindings stay open on the global scope between tasks (each definition
+    // returns there), so only the definition's own scopes are bound per task.
+    DiagnosticEngine outer = _diagnostics.extract();
+    _functionReturnTypeStack.clear();
+    _blockCounter = task.blockBase;
+    if (_snapshot != nullptr || _previous != nullptr) {
+        _dependencySink = &task.dependencies;
+    }
+    setCurrentScope(_globalScope);
+
+    task.node->accept(*this);
+
+    _dependencySink = nullptr;
+    task.diagnostics = _diagnostics.extract();
+    _diagnostics = std::move(outer);
 }
 
-/** @brief Append semantic warning diagnostic with standardized prefix. */
-void SemanticAnalyzer::reportWarning(int line, const std::string& message) {
-    _warnings.push_back("[WARNING][SEMANTIC] line " + std::to_string(line) + ": " + message);
+/**
+ * @brief Identify each definition and match it against the previous snapshot.
+ * @param functions Function definitions in source order.
+ * @return One plan per entry of functions (empty for null entries).
+ *
+ * @details
+ * A definition is reused only when its key is unique in both runs (definitions
+ * sharing a scope are checked together), it is not listed as changed, its
+ * structural and relative-line hashes are unchanged, and none of its recorded
+ * dependencies is dirty.
+ */
+std::vector<SemanticAnalyzer::BodyPlan> SemanticAnalyzer::planFunctionBodies(const std::vector<std::shared_ptr<FuncDefNode>>& functions) const {
+    std::vector<BodyPlan> plans(functions.size());
+    std::unordered_map<std::string, size_t> keyCount;
+    for (size_t i = 0; i < functions.size(); ++i) {
+        if (functions[i] == nullptr) {
+            continue;
+        }
+        BodyPlan& plan = plans[i];
+        plan.scope = recordedScope(*functions[i]);
+        plan.key = plan.scope->getScopeName();
+        plan.hash = ASTHasher::hashSubtree(functions[i]);
+        plan.line = functions[i]->getLineNumber();
+        LineShapeHasher shape(plan.line);
+        ASTTraversal::walk(functions[i], shape);
+        plan.lineShape = shape.hash();
+        ++keyCount[plan.key];
+    }
+
+    if (_previous == nullptr) {
+        return plans;
+    }
+
+    for (auto& plan : plans) {
+        if (plan.scope == nullptr || keyCount[plan.key] != 1 || _changedDefinitions.count(plan.key) != 0) {
+            continue;
+        }
+        auto recordIt = _previous->_bodiesByKey.find(plan.key);
+        if (recordIt == _previous->_bodiesByKey.end() || recordIt->second.size() != 1) {
+            continue;
+        }
+        const SemanticSnapshot::BodyRecord& record = _previous->_bodies[recordIt->second.front()];
+        if (record.hash != plan.hash || record.lineShape != plan.lineShape) {
+            continue;
+        }
+        const bool clean = std::none_of(record.dependencies.begin(), record.dependencies.end(), [this](const std::string& key) {
+            return _dirtyKeys.count(key) != 0;
+        });
+        if (clean) {
+            plan.reuse = &record;
+        }
+    }
+    return plans;
+}
+
+/**
+ * @brief Reproduce a previous definition's pass-2 effects at its new position.
+ * @param plan Plan with the record to reuse.
+ * @param task Receives the shifted diagnostics, dependencies, and block count.
+ *
+ * @details
+ * The definition's function scope was recreated empty by pass 1; parameters,
+ * locals, and block scopes are copied into it with lines moved by the
+ * definition's line delta and blocks renumbered from the task's block base.
+ */
+void SemanticAnalyzer::reuseFunctionBody(const BodyPlan& plan, FunctionBodyTask& task) {
+    const SemanticSnapshot::BodyRecord& record = *plan.reuse;
+    const int lineDelta = plan.line - record.line;
+    graftScope(*record.scope, plan.scope, lineDelta, task.blockBase - record.blockBase);
+
+    task.diagnostics = DiagnosticEngine(DiagnosticPhase::Semantic);
+    task.diagnostics.configure(record.diagnostics.options());
+    task.diagnostics.append(record.diagnostics, lineDelta);
+    task.dependencies.insert(record.dependencies.begin(), record.dependencies.end());
+    task.blockCount = record.blockCount;
+    ++_reusedBodies;
+}
+
+/**
+ * @brief Append a finished definition to the snapshot being recorded.
+ * @param plan Definition identity.
+ * @param task Finished task (diagnostics are copied, dependencies moved out).
+ */
+void SemanticAnalyzer::recordFunctionBody(const BodyPlan& plan, FunctionBodyTask& task) {
+    if (_snapshot == nullptr) {
+        return;
+    }
+    SemanticSnapshot::BodyRecord record;
+    record.key = plan.key;
+    record.hash = plan.hash;
+    record.lineShape = plan.lineShape;
+    record.line = plan.line;
+    record.blockBase = task.blockBase;
+    record.blockCount = task.blockCount;
+    record.scope = plan.scope;
+    record.diagnostics = task.diagnostics;
+    record.dependencies.assign(task.dependencies.begin(), task.dependencies.end());
+    std::sort(record.dependencies.begin(), record.dependencies.end());
+    _snapshot->_bodiesByKey[record.key].push_back(_snapshot->_bodies.size());
+    _snapshot->_bodies.push_back(std::move(record));
+}
+
+/**
+ * @brief Fingerprint the declarations pass-2 bodies can read.
+ * @return Map from "n:<name>" and "c:<class>" keys to fingerprints.
+ *
+ * @details
+ * - "n:x" covers every global and class-scope entry named x (with its scope);
+ * - "c:C" covers whether C is declared, C's own entries, every member visible
+ *   through C (inherited ones with their owner), and C's member function
+ *   overloads;
+ * - overloads of a function name are folded into its "n:" key as well.
+ */
+std::unordered_map<std::string, std::size_t> SemanticAnalyzer::declarationFingerprints() const {
+    std::unordered_map<std::string, std::size_t> prints;
+    auto fold = [&prints](const std::string& key, std::size_t value) {
+        hashCombine(prints[key], value);
+    };
+
+    for (const auto& entry : _globalScope->getEntries()) {
+        fold("n:" + entry.name, entryHash(entry, _types));
+    }
+    for (const auto& child : _globalScope->getChildren()) {
+        const std::string className = classNameFromScope(child->getScopeName());
+        if (className.empty()) {
+            continue;
+        }
+        for (const auto& entry : child->getEntries()) {
+            std::size_t value = std::hash<std::string>()(child->getScopeName());
+            hashCombine(value, entryHash(entry, _types));
+            fold("n:" + entry.name, value);
+            fold("c:" + className, value);
+        }
+    }
+    for (const auto& className : _declaredClassNames) {
+        fold("c:" + className, 1);
+    }
+
+    for (const auto& classPair : _classMembers) {
+        std::vector<std::string> names;
+        for (const auto& member : classPair.second) {
+            names.push_back(member.first);
+        }
+        std::sort(names.begin(), names.end());
+        const std::string key = "c:" + _types.toString(classPair.first);
+        for (const auto& name : names) {
+            const ClassMember& member = classPair.second.at(name);
+            std::size_t value = entryHash(member.table->getEntries()[member.index], _types);
+            hashCombine(value, std::hash<std::string>()(_types.toString(member.owner)));
+            fold(key, value);
+        }
+    }
+
+    // Overloads decide call resolution: fold each into its name, and member
+    // function overloads into their class as well.
+    auto foldOverloads = [&](const SymbolTable& scope, const std::string& className) {
+        const auto& entries = scope.getEntries();
+        for (const auto& overload : scope.getOverloads()) {
+            std::size_t value = std::hash<std::string>()(_types.toString(overload.signature));
+            hashCombine(value, overload.flags);
+            fold("n:" + entries[overload.entry].name, value);
+            if (!className.empty()) {
+                fold("c:" + className, value);
+            }
+        }
+    };
+    foldOverloads(*_globalScope, "");
+    for (const auto& child : _globalScope->getChildren()) {
+        const std::string className = classNameFromScope(child->getScopeName());
+        if (!className.empty()) {
+            foldOverloads(*child, className);
+        }
+    }
+    return prints;
+}
+
+/**
+ * @brief Derive dirty declaration keys for an incremental analysis.
+ *
+ * @details
+ * A key is dirty when its fingerprint differs from the previous snapshot's or
+ * exists on one side only. A changed "class C" definition also dirties "c:C"
+ * and the names of C's members before and after the edit.
+ */
+void SemanticAnalyzer::markDirtyKeys() {
+    _dirtyKeys.clear();
+    if (_previous == nullptr) {
+        return;
+    }
+
+    for (const auto& print : _fingerprints) {
+        auto it = _previous->_fingerprints.find(print.first);
+        if (it == _previous->_fingerprints.end() || it->second != print.second) {
+            _dirtyKeys.insert(print.first);
+        }
+    }
+    for (const auto& print : _previous->_fingerprints) {
+        if (_fingerprints.find(print.first) == _fingerprints.end()) {
+            _dirtyKeys.insert(print.first);
+        }
+    }
+
+    for (const auto& definition : _changedDefinitions) {
+        const std::string className = classNameFromScope(definition);
+        if (className.empty()) {
+            continue;
+        }
+        _dirtyKeys.insert("c:" + className);
+        for (const auto& global : {_globalScope, _previous->_globalScope}) {
+            if (global == nullptr) {
+                continue;
+            }
+            for (const auto& child : global->getChildren()) {
+                if (child->getScopeName() != definition) {
+                    continue;
+                }
+                for (const auto& entry : child->getEntries()) {
+                    _dirtyKeys.insert("n:" + entry.name);
+                }
+            }
+        }
+    }
+}
+
+/** @brief Add a declaration key to the running body's dependencies (no-op when not tracking). */
+void SemanticAnalyzer::recordDependency(const char* prefix, const std::string& name) const {
+    if (_dependencySink != nullptr) {
+        _dependencySink->insert(prefix + name);
+    }
+}
+
+/** @brief Record a semantic diagnostic; the message is formatted only when written out. */
+void SemanticAnalyzer::report(DiagnosticCode code, int line, std::initializer_list<DiagnosticArg> args) {
+    _diagnostics.report(code, line, args);
 }
 
 /**
@@ -1255,6 +2106,9 @@ bool SemanticAnalyzer::defineSymbol(const SymbolEntry& entry) {
     }
 
     if (_currentScope->define(entry)) {
+        if (!isPassOne()) {
+            _bindings.bindLast(*_currentScope);
+        }
         return true;
     }
 
@@ -1269,18 +2123,17 @@ bool SemanticAnalyzer::defineSymbol(const SymbolEntry& entry) {
         }
     }
 
-    const std::string scopeName = _currentScope->getScopeName();
-    const std::string userFriendlyScope = getUserFriendlyScopeName(_currentScope);
+    const std::string& scopeName = _currentScope->getScopeName();
     if (entry.kind == SymbolKind::Class) {
-        reportError(entry.line, "8.1 multiply declared class: '" + entry.name + "'");
+        report(DiagnosticCode::MultiplyDeclaredClass, entry.line, {entry.name});
     } else if (entry.kind == SymbolKind::Function && scopeName == "global") {
-        reportError(entry.line, "8.2 multiply declared free function: '" + entry.name + "'");
+        report(DiagnosticCode::MultiplyDeclaredFreeFunction, entry.line, {entry.name});
     } else if (entry.kind == SymbolKind::Field && scopeName.rfind("class ", 0) == 0) {
-        reportError(entry.line, "8.3 multiply declared data member in class: '" + entry.name + "'");
+        report(DiagnosticCode::MultiplyDeclaredDataMember, entry.line, {entry.name});
     } else if (entry.kind == SymbolKind::Variable || entry.kind == SymbolKind::Parameter) {
-        reportError(entry.line, "8.4 multiply declared variable '" + entry.name + "' in scope '" + userFriendlyScope + "'");
+        report(DiagnosticCode::MultiplyDeclaredVariable, entry.line, {entry.name, getUserFriendlyScope(_currentScope)->getScopeName()});
     } else {
-        reportError(entry.line, "redefinition of symbol '" + entry.name + "' in scope '" + userFriendlyScope + "'");
+        report(DiagnosticCode::RedefinedSymbol, entry.line, {entry.name, getUserFriendlyScope(_currentScope)->getScopeName()});
     }
     return false;
 }
@@ -1293,25 +2146,44 @@ void SemanticAnalyzer::visitNode(const std::shared_ptr<ASTNode>& node) {
 }
 
 /**
- * @brief Reuse matching child scope (pass 2) or create fresh child scope (pass 1).
- * @param parent Parent scope.
- * @param scopeName Target child scope label.
- * @return Matching or newly created child scope.
+ * @brief Switch the current scope.
+ * @param scope New current scope.
+ *
+ * @details
+ * In pass 2 the flat binding index is moved along with it, so resolveName()
+ * sees exactly the declarations visible from scope.
  */
-std::shared_ptr<SymbolTable> SemanticAnalyzer::getOrCreateChildScope(const std::shared_ptr<SymbolTable>& parent, const std::string& scopeName) {
-    if (parent == nullptr) {
-        return nullptr;
+void SemanticAnalyzer::setCurrentScope(const std::shared_ptr<SymbolTable>& scope) {
+    _currentScope = scope;
+    if (!isPassOne()) {
+        _bindings.moveTo(scope.get());
     }
+}
 
-    if (!isPassOne()) {
-        for (const auto& child : parent->getChildren()) {
-            if (child != nullptr && child->getScopeName() == scopeName) {
-                return child;
-            }
-        }
+/**
+ * @brief Resolve a name from the current scope outward.
+ * @param name Identifier.
+ * @return Innermost visible entry, or null.
+ */
+const SymbolEntry* SemanticAnalyzer::resolveName(const std::string& name) const {
+    if (isPassOne()) {
+        return _currentScope != nullptr ? _currentScope->resolve(name) : nullptr;
     }
+    recordDependency("n:", name);
+    return _bindings.lookup(name);
+}
 
-    return parent->createChild(scopeName);
+/**
+ * @brief Scope recorded for a class/function node during pass 1.
+ * @param node Class or function-implementation node.
+ * @return Recorded scope (pass 1 records every node pass 2 re-enters).
+ */
+std::shared_ptr<SymbolTable> SemanticAnalyzer::recordedScope(const ASTNode& node) const {
+    auto it = _nodeScopes.find(&node);
+    if (it == _nodeScopes.end()) {
+        throw std::logic_error("semantic pass 2 reached a node without a pass-1 scope (line " + std::to_string(node.getLineNumber()) + ")");
+    }
+    return it->second;
 }
 
 /** @brief Convert SymbolKind to printable lowercase text label. */
@@ -1332,139 +2204,420 @@ std::string SemanticAnalyzer::kindToString(SymbolKind kind) {
     return "unknown";
 }
 
-/** @brief Build normalized signature text for function declaration comparison. */
-std::string SemanticAnalyzer::functionSignature(const FuncDefNode& node) {
-    std::ostringstream sig;
-    sig << node.getReturnType() << "(";
-    const auto params = node.getParams();
-    for (size_t i = 0; i < params.size(); ++i) {
-        if (i > 0) {
-            sig << ", ";
-        }
-        sig << params[i]->getTypeName();
-    }
-    sig << ")";
-    return sig.str();
+/** @brief Convert SymbolVisibility to the tag used in declarations and dumps. */
+const char* SemanticAnalyzer::visibilityToString(SymbolVisibility visibility) {
+    switch (visibility) {
+        case SymbolVisibility::None:
+            return "n/a";
+        case SymbolVisibility::Local:
+            return "local";
+        case SymbolVisibility::Param:
+            return "param";
+        case SymbolVisibility::Public:
+            return "public";
+        case SymbolVisibility::Private:
+            return "private";
+    }
+
+    return "n/a";
 }
 
-/** @brief Build class descriptor including optional inheritance list. */
-std::string SemanticAnalyzer::classTypeName(const ClassDeclNode& node) {
-    std::ostringstream oss;
-    oss << "class";
-    const auto parents = node.getParents();
-    if (!parents.empty()) {
-        oss << " : ";
-        for (size_t i = 0; i < parents.size(); ++i) {
-            if (i > 0) {
-                oss << ", ";
-            }
-            oss << parents[i];
-        }
+/** @brief Map a VarDeclNode visibility tag to SymbolVisibility. */
+SymbolVisibility SemanticAnalyzer::visibilityFromString(const std::string& visibility) {
+    if (visibility == "local") {
+        return SymbolVisibility::Local;
+    }
+    if (visibility == "public") {
+        return SymbolVisibility::Public;
     }
-    return oss.str();
+    if (visibility == "private") {
+        return SymbolVisibility::Private;
+    }
+    return SymbolVisibility::None;
 }
 
 /**
- * @brief Extract base type token from signature/array decorated type string.
- * @param typeName Raw type string.
- * @return Base type.
+ * @brief Render the "Details" column of a symbol.
+ * @param entry Symbol entry.
+ * @param scope Scope defining the entry (names the owner of member functions).
+ * @return "free function (declaration)", "method of A (declaration + implementation)",
+ *         "inherits 2 class(es)", "no inheritance", or "null".
  */
-std::string SemanticAnalyzer::baseTypeName(const std::string& typeName) {
-    std::string base = typeName;
-    size_t parenPos = base.find('(');
-    if (parenPos != std::string::npos) {
-        base = base.substr(0, parenPos);
+std::string SemanticAnalyzer::symbolDetails(const SymbolEntry& entry, const SymbolTable& scope) const {
+    if (entry.kind == SymbolKind::Class) {
+        const size_t parents = _types.get(entry.type).operands.size();
+        return parents == 0 ? "no inheritance" : "inherits " + std::to_string(parents) + " class(es)";
+    }
+    if (entry.kind != SymbolKind::Function) {
+        return "null";
     }
 
-    size_t arrayPos = base.find('[');
-    if (arrayPos != std::string::npos) {
-        base = base.substr(0, arrayPos);
+    std::string details = (entry.flags & SymbolMethod) != 0 ? "method of " + classNameFromScope(scope.getScopeName()) : "free function";
+    const bool declared = (entry.flags & SymbolDeclared) != 0;
+    const bool implemented = (entry.flags & SymbolImplemented) != 0;
+    if (declared && implemented) {
+        return details + " (declaration + implementation)";
     }
+    return details + (implemented ? " (implementation)" : " (declaration)");
+}
 
-    auto trim = [](std::string& s) {
-        while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) {
-            s.erase(s.begin());
+/** @brief Intern signature type (return type and parameter base types) for declaration comparison. */
+TypeId SemanticAnalyzer::functionSignature(const FuncDefNode& node) {
+    std::vector<TypeId> params;
+    for (const auto& param : node.getParams()) {
+        params.push_back(_types.named(param->getTypeName()));
+    }
+    return _types.function(_types.named(node.getReturnType()), params);
+}
+
+/** @brief Intern class descriptor including optional inheritance list. */
+TypeId SemanticAnalyzer::classDescriptor(const ClassDeclNode& node) {
+    std::vector<TypeId> parents;
+    for (const auto& parent : node.getParents()) {
+        parents.push_back(_types.named(parent));
+    }
+    return _types.classDescriptor(parents);
+}
+
+/**
+ * @brief Read inherited class names from a class symbol's descriptor type.
+ * @param classEntry Class symbol.
+ * @return Parent class names in declaration order.
+ */
+std::vector<std::string> SemanticAnalyzer::classParents(const SymbolEntry& classEntry) const {
+    std::vector<std::string> parents;
+    const TypeDescriptor& descriptor = _types.get(classEntry.type);
+    if (descriptor.kind != TypeKind::ClassDescriptor) {
+        return parents;
+    }
+    for (TypeId parent : descriptor.operands) {
+        parents.push_back(_types.toString(parent));
+    }
+    return parents;
+}
+
+/**
+ * @brief Flatten every class's visible members into _classMembers.
+ *
+ * @details
+ * Classes are processed in _classHierarchy's parents-first order, so each table
+ * is its own members followed by the already-flattened tables of its parents in
+ * declaration order. Own members shadow inherited ones and an earlier parent
+ * wins over a later one, matching the field layout built by code generation.
+ * Classes on an inheritance cycle (reported as 14.1) are flattened in
+ * declaration order over whichever parents are ready.
+ */
+void SemanticAnalyzer::buildClassMemberTables() {
+    for (std::size_t index : _classHierarchy.topologicalOrder()) {
+        const std::string& name = _classHierarchy.name(index);
+        const TypeId classType = _types.named(name);
+        auto& members = _classMembers[classType];
+
+        auto scopeIt = _classScopes.find(name);
+        if (scopeIt != _classScopes.end() && scopeIt->second != nullptr) {
+            const auto& entries = scopeIt->second->getEntries();
+            for (size_t i = 0; i < entries.size(); ++i) {
+                members.emplace(entries[i].name, ClassMember{scopeIt->second.get(), i, classType});
+            }
         }
-        while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) {
-            s.pop_back();
+
+        for (std::size_t parent : _classHierarchy.parentsOf(index)) {
+            auto parentIt = _classMembers.find(_types.lookupNamed(_classHierarchy.name(parent)));
+            if (parentIt == _classMembers.end() || parentIt->first == classType) {
+                continue;
+            }
+            for (const auto& inherited : parentIt->second) {
+                members.emplace(inherited.first, inherited.second);
+            }
         }
-    };
-    trim(base);
-    return base;
+    }
 }
 
 /**
- * @brief Resolve member symbol in class scope by class type name.
- * @param classTypeName Class type string.
+ * @brief Resolve member symbol of a class type, inherited members included.
+ * @param classType Class type (signature/array decoration is stripped).
  * @param memberName Member identifier.
  * @return Matching member symbol or null.
  */
-const SymbolEntry* SemanticAnalyzer::resolveClassMember(const std::string& classTypeName, const std::string& memberName) const {
-    const std::string base = baseTypeName(classTypeName);
-    auto it = _classScopes.find(base);
-    if (it == _classScopes.end() || it->second == nullptr) {
+const SymbolEntry* SemanticAnalyzer::resolveClassMember(TypeId classType, const std::string& memberName) const {
+    const ClassMember* member = findClassMember(classType, memberName);
+    return member != nullptr ? &member->table->getEntries()[member->index] : nullptr;
+}
+
+/** @brief Flattened member-table slot of a class member (see resolveClassMember()). */
+const SemanticAnalyzer::ClassMember* SemanticAnalyzer::findClassMember(TypeId classType, const std::string& memberName) const {
+    recordDependency("c:", _types.toString(_types.baseOf(classType)));
+    auto classIt = _classMembers.find(_types.baseOf(classType));
+    if (classIt == _classMembers.end()) {
         return nullptr;
     }
-    return it->second->lookupInCurrent(memberName);
+    auto memberIt = classIt->second.find(memberName);
+    return memberIt != classIt->second.end() ? &memberIt->second : nullptr;
+}
+
+/**
+ * @brief Resolve the callee of a call and pick the overload its arguments select.
+ * @param node Call node.
+ * @return Callee symbol (any kind, or null) and the selected overload.
+ *
+ * @details
+ * The candidates are the overloads indexed under the callee's entry and the
+ * call's arity in the scope defining it. A candidate fits only if each array
+ * argument meets a parameter of its rank. The first candidate whose parameter
+ * base types equal the argument types wins; otherwise the first one every
+ * argument is assignable to (integer to float); otherwise the first candidate,
+ * so its mismatches are reported. Argument types are memoized, so the
+ * selection costs one probe and one type-id compare per argument and
+ * candidate.
+ */
+SemanticAnalyzer::CallTarget SemanticAnalyzer::resolveCall(const FuncCallNode& node) const {
+    CallTarget target;
+    const SymbolTable* table = nullptr;
+    size_t index = 0;
+
+    auto calleeMember = std::dynamic_pointer_cast<DataMemberNode>(node.getLeft());
+    if (calleeMember != nullptr && calleeMember->getLeft() != nullptr) {
+        const ClassMember* member = findClassMember(inferExprType(calleeMember->getLeft()), calleeMember->getName());
+        if (member != nullptr) {
+            table = member->table;
+            index = member->index;
+            target.symbol = &table->getEntries()[index];
+        }
+    } else {
+        recordDependency("n:", node.getFunctionName());
+        target.symbol = _bindings.lookup(node.getFunctionName(), table, index);
+    }
+    if (target.symbol == nullptr || target.symbol->kind != SymbolKind::Function) {
+        return target;
+    }
+
+    const auto& args = node.getArgs();
+    const std::vector<size_t>* candidates = table->overloadsOf(index, args.size());
+    if (candidates == nullptr) {
+        return target;
+    }
+
+    const auto& overloads = table->getOverloads();
+    const FunctionOverload* assignable = nullptr;
+    for (size_t position : *candidates) {
+        const FunctionOverload& candidate = overloads[position];
+        bool exact = true;
+        bool compatible = true;
+        for (size_t i = 0; i < args.size() && compatible; ++i) {
+            const TypeId expected = _types.baseOf(candidate.params[i]);
+            const TypeId actual = inferExprType(args[i]);
+            // An array argument only fits a parameter of its rank (unannotated arguments fit any).
+            const ASTAnnotation* argument = args[i]->getAnnotation();
+            const size_t rank = _types.kind(candidate.params[i]) == TypeKind::Array ? _types.get(candidate.params[i]).dimensions.size() : 0;
+            if (argument != nullptr && argument->dimensions.size() != rank) {
+                exact = false;
+                compatible = false;
+            } else if (expected != actual) {
+                exact = false;
+                compatible = expected == TypeTable::Null || actual == TypeTable::Null ||
+                             (expected == TypeTable::Float && actual == TypeTable::Integer);
+            }
+        }
+        if (exact) {
+            target.overload = &candidate;
+            return target;
+        }
+        if (compatible && assignable == nullptr) {
+            assignable = &candidate;
+        }
+    }
+    target.overload = assignable != nullptr ? assignable : &overloads[candidates->front()];
+    return target;
 }
 
 /**
  * @brief Infer expression result type for semantic compatibility checks.
  * @param node Expression node.
- * @return Inferred type string, or "null" when unresolved.
+ * @return Inferred type id, or TypeTable::Null when unresolved.
+ *
+ * @details
+ * Each node's type is computed once and kept in _exprTypes. Checkers call this
+ * on a node's children before the visitor descends into them, so the children's
+ * own checks and their parents' synthesis all read the cached value; inference
+ * over a whole expression is linear in its size instead of size times depth.
+ * The table is only valid for pass 2, where every expression is visited in its
+ * final scope.
+ *
+ * The first inference of a resolved node also attaches its ASTAnnotation, so
+ * code generation reads the type and binding found here. Equal annotations
+ * (every use of one variable, say) share one interned object. A pass-2 worker
+ * only infers nodes of the definitions it checks, so no node is written by two
+ * threads.
  */
-std::string SemanticAnalyzer::inferExprType(const std::shared_ptr<ASTNode>& node) const {
+TypeId SemanticAnalyzer::inferExprType(const std::shared_ptr<ASTNode>& node) const {
     if (node == nullptr) {
-        return "null";
+        return TypeTable::Null;
     }
 
-    if (auto intNode = std::dynamic_pointer_cast<IntLitNode>(node)) {
-        (void)intNode;
-        return "integer";
+    auto cached = _exprTypes.find(node.get());
+    if (cached != _exprTypes.end()) {
+        return cached->second;
     }
-    if (auto floatNode = std::dynamic_pointer_cast<FloatLitNode>(node)) {
-        (void)floatNode;
-        return "float";
+    // Compute before inserting: computeExprType recurses into children, which
+    // insert entries of their own.
+    ASTAnnotation annotation;
+    const TypeId type = computeExprType(node, annotation);
+    _exprTypes.emplace(node.get(), type);
+    if (type == TypeTable::Null || annotation.typeName.empty()) {
+        node->setAnnotation(nullptr);
+        return type;
     }
-    if (auto idNode = std::dynamic_pointer_cast<IdNode>(node)) {
-        const SymbolEntry* symbol = _currentScope->resolve(idNode->getName());
-        return symbol != nullptr ? symbol->type : "null";
+    auto shared = _annotations.find(annotation);
+    if (shared == _annotations.end()) {
+        auto value = std::make_shared<const ASTAnnotation>(annotation);
+        shared = _annotations.emplace(std::move(annotation), std::move(value)).first;
     }
-    if (auto memberNode = std::dynamic_pointer_cast<DataMemberNode>(node)) {
-        if (memberNode->getLeft() == nullptr) {
-            const SymbolEntry* symbol = _currentScope->resolve(memberNode->getName());
-            return symbol != nullptr ? symbol->type : "null";
-        }
+    node->setAnnotation(shared->second);
+    return type;
+}
+
+std::size_t SemanticAnalyzer::AnnotationHash::operator()(const ASTAnnotation& annotation) const {
+    std::size_t seed = std::hash<std::string>{}(annotation.typeName);
+    hashCombine(seed, std::hash<std::string>{}(annotation.receiverClass));
+    hashCombine(seed, std::hash<std::string>{}(annotation.overload));
+    hashCombine(seed, static_cast<std::size_t>(annotation.binding));
+    for (int dim : annotation.dimensions) {
+        hashCombine(seed, static_cast<std::size_t>(dim));
+    }
+    return seed;
+}
 
-        const std::string ownerType = inferExprType(memberNode->getLeft());
-        const SymbolEntry* member = resolveClassMember(ownerType, memberNode->getName());
-        return member != nullptr ? member->type : "null";
+bool SemanticAnalyzer::AnnotationEqual::operator()(const ASTAnnotation& a, const ASTAnnotation& b) const {
+    return a.binding == b.binding && a.typeName == b.typeName && a.receiverClass == b.receiverClass &&
+           a.overload == b.overload && a.dimensions == b.dimensions;
+}
+
+/**
+ * @brief Describe how a resolved name is bound.
+ * @param symbol Entry the name resolved to.
+ * @param annotation Receives binding, receiver class, and declared dimensions.
+ *
+ * @details
+ * Names reach class-scope entries only from member function bodies, where the
+ * implicit receiver is an object of the body's class.
+ */
+void SemanticAnalyzer::annotateBinding(const SymbolEntry& symbol, ASTAnnotation& annotation) const {
+    switch (symbol.kind) {
+        case SymbolKind::Variable:
+            annotation.binding = ASTBinding::Local;
+            break;
+        case SymbolKind::Parameter:
+            annotation.binding = ASTBinding::Param;
+            break;
+        case SymbolKind::Field:
+            annotation.binding = ASTBinding::Field;
+            annotation.receiverClass = _receiverClass;
+            break;
+        case SymbolKind::Function:
+            annotation.binding = (symbol.flags & SymbolMethod) != 0 ? ASTBinding::Method : ASTBinding::Function;
+            if (annotation.binding == ASTBinding::Method) {
+                annotation.receiverClass = _receiverClass;
+            }
+            break;
+        case SymbolKind::Class:
+            break;
+    }
+    if (symbol.kind != SymbolKind::Function) {
+        annotation.dimensions = dimensionsOf(symbol);
     }
-    if (auto callNode = std::dynamic_pointer_cast<FuncCallNode>(node)) {
+}
+
+/**
+ * @brief Synthesize one node's type from its payload and its children's types.
+ * @param node Non-null expression node.
+ * @param annotation Receives the node's annotation; left without a type name
+ *        when the node should not be annotated.
+ * @return Inferred type id, or TypeTable::Null when unresolved.
+ *
+ * @details
+ * Accesses indexed more often than declared, and member accesses or method
+ * calls on array-valued owners, keep a type for checking but get no
+ * annotation, so code generation still diagnoses them itself.
+ */
+TypeId SemanticAnalyzer::computeExprType(const std::shared_ptr<ASTNode>& node, ASTAnnotation& annotation) const {
+    TypeId type = TypeTable::Null;
+    bool annotate = true;
+
+    // Class of a scalar object expression, or "" when it is not one.
+    auto receiverOf = [this](const std::shared_ptr<ASTNode>& owner, TypeId ownerType) {
+        const ASTAnnotation* ownerAnnotation = owner->getAnnotation();
+        if (ownerAnnotation == nullptr || !ownerAnnotation->dimensions.empty() || _types.kind(ownerType) != TypeKind::Class) {
+            return std::string();
+        }
+        return ownerAnnotation->typeName;
+    };
+
+    if (std::dynamic_pointer_cast<IntLitNode>(node) != nullptr) {
+        type = TypeTable::Integer;
+    } else if (std::dynamic_pointer_cast<FloatLitNode>(node) != nullptr) {
+        type = TypeTable::Float;
+    } else if (auto idNode = std::dynamic_pointer_cast<IdNode>(node)) {
+        const SymbolEntry* symbol = resolveName(idNode->getName());
+        if (symbol != nullptr) {
+            type = symbol->type;
+            annotateBinding(*symbol, annotation);
+        }
+        annotate = annotation.binding != ASTBinding::None && annotation.binding != ASTBinding::Function &&
+                   annotation.binding != ASTBinding::Method;
+    } else if (auto memberNode = std::dynamic_pointer_cast<DataMemberNode>(node)) {
         const SymbolEntry* symbol = nullptr;
-        auto calleeMember = std::dynamic_pointer_cast<DataMemberNode>(callNode->getLeft());
-        const bool isOwnerQualifiedMethodCall = calleeMember != nullptr && calleeMember->getLeft() != nullptr;
-        if (isOwnerQualifiedMethodCall) {
-            const std::string ownerType = inferExprType(calleeMember->getLeft());
-            symbol = resolveClassMember(ownerType, calleeMember->getName());
+        if (memberNode->getLeft() == nullptr) {
+            symbol = resolveName(memberNode->getName());
+            if (symbol != nullptr) {
+                annotateBinding(*symbol, annotation);
+            }
         } else {
-            symbol = _currentScope->resolve(callNode->getFunctionName());
+            const TypeId ownerType = inferExprType(memberNode->getLeft());
+            symbol = resolveClassMember(ownerType, memberNode->getName());
+            if (symbol != nullptr) {
+                annotateBinding(*symbol, annotation);
+                annotation.receiverClass = receiverOf(memberNode->getLeft(), ownerType);
+                annotate = !annotation.receiverClass.empty();
+            }
         }
-        if (symbol == nullptr) {
-            return "null";
+        if (symbol != nullptr) {
+            type = symbol->type;
+            annotate = annotate && annotation.binding != ASTBinding::None && annotation.binding != ASTBinding::Function &&
+                       annotation.binding != ASTBinding::Method;
+            const size_t indexed = memberNode->getIndices().size();
+            if (indexed > annotation.dimensions.size()) {
+                annotate = false;
+            } else {
+                annotation.dimensions.erase(annotation.dimensions.begin(), annotation.dimensions.begin() + static_cast<std::ptrdiff_t>(indexed));
+            }
         }
-
-        const std::string signature = symbol->type;
-        size_t paren = signature.find('(');
-        if (paren == std::string::npos) {
-            return signature;
+    } else if (auto callNode = std::dynamic_pointer_cast<FuncCallNode>(node)) {
+        const CallTarget target = resolveCall(*callNode);
+        if (target.symbol != nullptr) {
+            // Calling a function yields the selected overload's return type; any other symbol keeps its own type.
+            const TypeId callee = target.overload != nullptr ? target.overload->signature : target.symbol->type;
+            type = _types.kind(callee) == TypeKind::Function ? _types.get(callee).element : callee;
+
+            annotate = target.symbol->kind == SymbolKind::Function;
+            if (annotate) {
+                annotateBinding(*target.symbol, annotation);
+                if (target.overload != nullptr) {
+                    annotation.overload = "(";
+                    for (size_t i = 0; i < target.overload->params.size(); ++i) {
+                        annotation.overload += (i > 0 ? "," : "") + _types.toString(target.overload->params[i]);
+                    }
+                    annotation.overload += ")";
+                }
+                auto calleeMember = std::dynamic_pointer_cast<DataMemberNode>(callNode->getLeft());
+                if (calleeMember != nullptr && calleeMember->getLeft() != nullptr) {
+                    annotation.receiverClass = receiverOf(calleeMember->getLeft(), inferExprType(calleeMember->getLeft()));
+                    annotate = !annotation.receiverClass.empty();
+                }
+            }
         }
-        return signature.substr(0, paren);
-    }
-
-    if (auto binaryNode = std::dynamic_pointer_cast<BinaryOpNode>(node)) {
-        const std::string leftType = inferExprType(binaryNode->getLeft());
-        const std::string rightType = inferExprType(binaryNode->getRight());
+    } else if (auto binaryNode = std::dynamic_pointer_cast<BinaryOpNode>(node)) {
+        const TypeId leftType = inferExprType(binaryNode->getLeft());
+        const TypeId rightType = inferExprType(binaryNode->getRight());
         const std::string op = binaryNode->getOperator();
 
         const bool isRelational =
@@ -1474,33 +2627,37 @@ std::string SemanticAnalyzer::inferExprType(const std::shared_ptr<ASTNode>& node
             op == "and" || op == "or" || op == "&&" || op == "||";
 
         if (isRelational || isLogical) {
-            return "bool";
-        }
-
-        if (leftType == "float" || rightType == "float") {
-            return "float";
-        }
-        if (leftType == "integer" && rightType == "integer") {
-            return "integer";
+            type = TypeTable::Bool;
+        } else if (leftType == TypeTable::Float || rightType == TypeTable::Float) {
+            type = TypeTable::Float;
+        } else if (leftType == TypeTable::Integer && rightType == TypeTable::Integer) {
+            type = TypeTable::Integer;
         }
     }
+    // Other nodes (unary operators included) stay unresolved for now; richer synthesis will be added incrementally.
 
-    // Keep this conservative for now; richer synthesis will be added incrementally.
-    return "null";
+    if (annotate && type != TypeTable::Null) {
+        annotation.typeName = _types.toString(_types.baseOf(type));
+    }
+    return type;
 }
 
 /**
- * @brief Recursively emit formatted symbol-table scopes as aligned text tables.
+ * @brief Recursively dump scopes in the order of the text layout.
  * @param scope Scope root for current dump recursion.
  * @param depth Nesting depth used for indentation.
- * @param out Accumulated output buffer.
+ * @param parentId Dump id of the enclosing scope (-1 for the root).
+ * @param state Output stream, format, and scope numbering.
+ *
+ * @details
+ * Each scope is written as soon as its entries are known, so the dump never
+ * holds more than one scope's table in memory.
  */
-void SemanticAnalyzer::dumpScope(const std::shared_ptr<SymbolTable>& scope, int depth, std::string& out) const {
+void SemanticAnalyzer::dumpScope(const std::shared_ptr<SymbolTable>& scope, int depth, long parentId, SymbolDumpState& state) const {
     if (scope == nullptr) {
         return;
     }
 
-    std::string indent(depth * 2, ' ');
     const auto& allEntries = scope->getEntries();
     const auto& children = scope->getChildren();
 
@@ -1510,12 +2667,78 @@ void SemanticAnalyzer::dumpScope(const std::shared_ptr<SymbolTable>& scope, int
     std::vector<const SymbolEntry*> entries;
     entries.reserve(allEntries.size());
     for (const auto& entry : allEntries) {
-        if (isGlobal && entry.kind == SymbolKind::Function && entry.details.find("method of ") != std::string::npos) {
+        if (isGlobal && entry.kind == SymbolKind::Function && (entry.flags & SymbolMethod) != 0) {
             continue;
         }
         entries.push_back(&entry);
     }
 
+    const long id = state.nextScopeId++;
+    if (state.format == SymbolTableFormat::JsonLines) {
+        writeScopeJsonLines(state.out, id, parentId, depth, *scope, entries);
+    } else {
+        writeScopeTable(state.out, depth, *scope, entries);
+    }
+
+    std::unordered_set<const SymbolTable*> visited;
+
+    // Organized Child Scope Traversal
+    if (isGlobal) {
+        for (const auto* entry : entries) {
+            if (entry->kind == SymbolKind::Class) {
+                std::shared_ptr<SymbolTable> classChild = scope->findChild("class " + entry->name);
+                if (classChild != nullptr) {
+                    visited.insert(classChild.get());
+                    dumpScope(classChild, depth + 1, id, state);
+                }
+            }
+        }
+
+        for (const auto* entry : entries) {
+            if (entry->kind == SymbolKind::Function && (entry->flags & SymbolMethod) == 0) {
+                std::shared_ptr<SymbolTable> fnChild = scope->findChild("function " + entry->name);
+                if (fnChild != nullptr && !visited.count(fnChild.get())) {
+                    visited.insert(fnChild.get());
+                    dumpScope(fnChild, depth + 1, id, state);
+                }
+            }
+        }
+    } else if (isClassScope) {
+        const std::string className = scope->getScopeName().substr(6);
+        for (const auto* entry : entries) {
+            if (entry->kind != SymbolKind::Function) {
+                continue;
+            }
+            std::shared_ptr<SymbolTable> fnChild = scope->findChild("function " + className + "::" + entry->name);
+            if (fnChild == nullptr) {
+                fnChild = scope->findChild("function " + entry->name);
+            }
+            if (fnChild != nullptr && !visited.count(fnChild.get())) {
+                visited.insert(fnChild.get());
+                dumpScope(fnChild, depth + 1, id, state);
+            }
+        }
+    }
+
+    // Traverse any remaining unvisited children (e.g., nested blocks)
+    for (const auto& child : children) {
+        if (child != nullptr && !visited.count(child.get())) {
+            dumpScope(child, depth + 1, id, state);
+        }
+    }
+}
+
+/**
+ * @brief Write one scope as an aligned text table.
+ * @param out Destination stream.
+ * @param depth Nesting depth used for indentation.
+ * @param scope Scope being written.
+ * @param entries Entries to list, in table order.
+ */
+void SemanticAnalyzer::writeScopeTable(std::ostream& out, int depth, const SymbolTable& scope,
+                                       const std::vector<const SymbolEntry*>& entries) const {
+    const std::string indent(depth * 2, ' ');
+
     // Minimum column widths (ensures headers always fit)
     size_t kindWidth = 8;       // "Function"
     size_t nameWidth = 12;
@@ -1524,41 +2747,46 @@ void SemanticAnalyzer::dumpScope(const std::shared_ptr<SymbolTable>& scope, int
     size_t lineWidth = 4;       // "Line"
     size_t detailsWidth = 20;
 
+    std::vector<std::string> details;
+    details.reserve(entries.size());
     for (const auto* entry : entries) {
+        details.push_back(symbolDetails(*entry, scope));
         kindWidth = std::max(kindWidth, kindToString(entry->kind).size());
         nameWidth = std::max(nameWidth, entry->name.size());
-        typeWidth = std::max(typeWidth, entry->type.size());
-        visibilityWidth = std::max(visibilityWidth, entry->visibility.size());
+        typeWidth = std::max(typeWidth, _types.toString(entry->type).size());
+        visibilityWidth = std::max(visibilityWidth, std::char_traits<char>::length(visibilityToString(entry->visibility)));
         lineWidth = std::max(lineWidth, std::to_string(entry->line).size());
-        detailsWidth = std::max(detailsWidth, entry->details.size());
+        detailsWidth = std::max(detailsWidth, details.back().size());
     }
 
-    // Use a single string stream for the entire table to prevent memory thrashing
-    std::ostringstream tableStream;
-    tableStream << indent << "Scope: " << scope->getScopeName() << "\n";
+    // Column manipulators below change the stream's fill/adjust state; restore it afterwards.
+    const std::ios::fmtflags savedFlags = out.flags();
+    const char savedFill = out.fill();
+
+    out << indent << "Scope: " << scope.getScopeName() << "\n";
 
     // Lambda: Draws a separator line using zero-allocation setfill
     auto makeSeparator = [&](char ch) {
-        tableStream << indent << '+' << std::setfill(ch)
-                    << std::setw(static_cast<int>(kindWidth + 2)) << "" << '+'
-                    << std::setw(static_cast<int>(nameWidth + 2)) << "" << '+'
-                    << std::setw(static_cast<int>(typeWidth + 2)) << "" << '+'
-                    << std::setw(static_cast<int>(visibilityWidth + 2)) << "" << '+'
-                    << std::setw(static_cast<int>(lineWidth + 2)) << "" << '+'
-                    << std::setw(static_cast<int>(detailsWidth + 2)) << "" << "+\n"
-                    << std::setfill(' '); // reset fill character to space
+        out << indent << '+' << std::setfill(ch)
+            << std::setw(static_cast<int>(kindWidth + 2)) << "" << '+'
+            << std::setw(static_cast<int>(nameWidth + 2)) << "" << '+'
+            << std::setw(static_cast<int>(typeWidth + 2)) << "" << '+'
+            << std::setw(static_cast<int>(visibilityWidth + 2)) << "" << '+'
+            << std::setw(static_cast<int>(lineWidth + 2)) << "" << '+'
+            << std::setw(static_cast<int>(detailsWidth + 2)) << "" << "+\n"
+            << std::setfill(' '); // reset fill character to space
     };
 
     // Lambda: Formats and streams a row directly
-    auto formatRow = [&](const std::string& kind, const std::string& name, const std::string& type, 
+    auto formatRow = [&](const std::string& kind, const std::string& name, const std::string& type,
                          const std::string& visibility, const std::string& line, const std::string& details) {
-        tableStream << indent << "| " 
-                    << std::left << std::setw(static_cast<int>(kindWidth)) << kind << " | "
-                    << std::left << std::setw(static_cast<int>(nameWidth)) << name << " | "
-                    << std::left << std::setw(static_cast<int>(typeWidth)) << type << " | "
-                    << std::left << std::setw(static_cast<int>(visibilityWidth)) << visibility << " | "
-                    << std::right << std::setw(static_cast<int>(lineWidth)) << line << " | "
-                    << std::left << std::setw(static_cast<int>(detailsWidth)) << details << " |\n";
+        out << indent << "| "
+            << std::left << std::setw(static_cast<int>(kindWidth)) << kind << " | "
+            << std::left << std::setw(static_cast<int>(nameWidth)) << name << " | "
+            << std::left << std::setw(static_cast<int>(typeWidth)) << type << " | "
+            << std::left << std::setw(static_cast<int>(visibilityWidth)) << visibility << " | "
+            << std::right << std::setw(static_cast<int>(lineWidth)) << line << " | "
+            << std::left << std::setw(static_cast<int>(detailsWidth)) << details << " |\n";
     };
 
     makeSeparator('-');
@@ -1568,76 +2796,58 @@ void SemanticAnalyzer::dumpScope(const std::shared_ptr<SymbolTable>& scope, int
     if (entries.empty()) {
         formatRow("<none>", "-", "-", "-", "-", "-");
     } else {
-        for (const auto* entry : entries) {
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const SymbolEntry* entry = entries[i];
             formatRow(
                 kindToString(entry->kind),
                 entry->name,
-                entry->type,
-                entry->visibility,
+                _types.toString(entry->type),
+                visibilityToString(entry->visibility),
                 std::to_string(entry->line),
-                entry->details
+                details[i]
             );
         }
     }
 
     makeSeparator('-');
-    tableStream << "\n";
-    
-    // Append the fully constructed table to the output string once
-    out += tableStream.str();
-
-    std::unordered_set<const SymbolTable*> visited;
-
-    // Cleaner standard library lookup
-    auto findChildByName = [&](const std::string& expectedName) -> std::shared_ptr<SymbolTable> {
-        auto it = std::find_if(children.begin(), children.end(), [&](const auto& child) {
-            return child != nullptr && child->getScopeName() == expectedName;
-        });
-        return it != children.end() ? *it : nullptr;
-    };
+    out << "\n";
 
-    // Organized Child Scope Traversal
-    if (isGlobal) {
-        for (const auto* entry : entries) {
-            if (entry->kind == SymbolKind::Class) {
-                std::shared_ptr<SymbolTable> classChild = findChildByName("class " + entry->name);
-                if (classChild != nullptr) {
-                    visited.insert(classChild.get());
-                    dumpScope(classChild, depth + 1, out);
-                }
-            }
-        }
+    out.flags(savedFlags);
+    out.fill(savedFill);
+}
 
-        for (const auto* entry : entries) {
-            if (entry->kind == SymbolKind::Function && entry->details.find("free function") != std::string::npos) {
-                std::shared_ptr<SymbolTable> fnChild = findChildByName("function " + entry->name);
-                if (fnChild != nullptr && !visited.count(fnChild.get())) {
-                    visited.insert(fnChild.get());
-                    dumpScope(fnChild, depth + 1, out);
-                }
-            }
-        }
-    } else if (isClassScope) {
-        const std::string className = scope->getScopeName().substr(6);
-        for (const auto* entry : entries) {
-            if (entry->kind != SymbolKind::Function) {
-                continue;
-            }
-            std::shared_ptr<SymbolTable> fnChild = findChildByName("function " + className + "::" + entry->name);
-            if (fnChild == nullptr) {
-                fnChild = findChildByName("function " + entry->name);
-            }
-            if (fnChild != nullptr && !visited.count(fnChild.get())) {
-                visited.insert(fnChild.get());
-                dumpScope(fnChild, depth + 1, out);
-            }
-        }
+/**
+ * @brief Write one scope record and its symbol records as JSON lines.
+ * @param out Destination stream.
+ * @param id Dump id of the scope.
+ * @param parentId Dump id of the enclosing scope (-1 for the root, written as null).
+ * @param depth Nesting depth.
+ * @param scope Scope being written.
+ * @param entries Entries to list, in table order.
+ */
+void SemanticAnalyzer::writeScopeJsonLines(std::ostream& out, long id, long parentId, int depth, const SymbolTable& scope,
+                                           const std::vector<const SymbolEntry*>& entries) const {
+    out << "{\"record\":\"scope\",\"id\":" << id << ",\"parent\":";
+    if (parentId < 0) {
+        out << "null";
+    } else {
+        out << parentId;
     }
+    out << ",\"depth\":" << depth << ",\"name\":";
+    writeJsonString(out, scope.getScopeName());
+    out << "}\n";
 
-    // Traverse any remaining unvisited children (e.g., nested blocks)
-    for (const auto& child : children) {
-        if (child != nullptr && !visited.count(child.get())) {
-            dumpScope(child, depth + 1, out);
-        }
+    for (const auto* entry : entries) {
+        out << "{\"record\":\"symbol\",\"scope\":" << id << ",\"kind\":";
+        writeJsonString(out, kindToString(entry->kind));
+        out << ",\"name\":";
+        writeJsonString(out, entry->name);
+        out << ",\"type\":";
+        writeJsonString(out, _types.toString(entry->type));
+        out << ",\"visibility\":";
+        writeJsonString(out, visibilityToString(entry->visibility));
+        out << ",\"line\":" << entry->line << ",\"details\":";
+        writeJsonString(out, symbolDetails(*entry, scope));
+        out << "}\n";
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,246 @@
+#include "../include/types.h"
+
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * @file types.cpp
+ * @brief TypeTable interning, lookup, and rendering.
+ *
+ * @details
+ * Descriptors are hashed and compared structurally; rendered text is computed
+ * once when a descriptor is first interned and reused for every diagnostic.
+ */
+
+namespace {
+/** @brief Fold a value into a running hash (boost-style combine). */
+void hashCombine(std::size_t& seed, std::size_t value) {
+    seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+}
+
+/** @brief Check if a type name is a language builtin scalar/void type. */
+bool isBuiltinName(const std::string& name) {
+    return name == "integer" || name == "float" || name == "void" || name == "bool";
+}
+}
+
+std::size_t TypeTable::DescriptorHash::operator()(const TypeDescriptor& descriptor) const {
+    std::size_t seed = static_cast<std::size_t>(descriptor.kind);
+    hashCombine(seed, std::hash<std::string>()(descriptor.name));
+    hashCombine(seed, descriptor.element);
+    for (int dim : descriptor.dimensions) {
+        hashCombine(seed, static_cast<std::size_t>(dim));
+    }
+    for (TypeId operand : descriptor.operands) {
+        hashCombine(seed, operand);
+    }
+    return seed;
+}
+
+bool TypeTable::DescriptorEqual::operator()(const TypeDescriptor& a, const TypeDescriptor& b) const {
+    return a.kind == b.kind && a.name == b.name && a.element == b.element &&
+           a.dimensions == b.dimensions && a.operands == b.operands;
+}
+
+/**
+ * @brief Pre-intern null and builtin scalar types at their fixed ids.
+ */
+TypeTable::TypeTable() {
+    TypeDescriptor null;
+    null.kind = TypeKind::Null;
+    intern(null);
+    for (const char* builtin : {"integer", "float", "void", "bool"}) {
+        named(builtin);
+    }
+}
+
+/**
+ * @brief Intern a builtin or class type by name.
+ * @param name Type name as written in source.
+ * @return Interned id; "null" maps to TypeTable::Null.
+ */
+TypeId TypeTable::named(const std::string& name) {
+    if (name == "null") {
+        return Null;
+    }
+    TypeDescriptor descriptor;
+    descriptor.kind = isBuiltinName(name) ? TypeKind::Builtin : TypeKind::Class;
+    descriptor.name = name;
+    return intern(std::move(descriptor));
+}
+
+/**
+ * @brief Find a named type without interning it.
+ * @param name Type name.
+ * @return Interned id, or TypeTable::Null when the name was never interned.
+ */
+TypeId TypeTable::lookupNamed(const std::string& name) const {
+    TypeDescriptor probe;
+    probe.kind = isBuiltinName(name) ? TypeKind::Builtin : TypeKind::Class;
+    probe.name = name;
+    auto it = _index.find(probe);
+    return it != _index.end() ? it->second : Null;
+}
+
+/**
+ * @brief Intern an array type.
+ * @param element Element type.
+ * @param dimensions Dimension sizes (-1 for an open "[]" dimension).
+ * @return Array id, or element itself when dimensions are empty.
+ */
+TypeId TypeTable::array(TypeId element, const std::vector<int>& dimensions) {
+    if (dimensions.empty()) {
+        return element;
+    }
+    TypeDescriptor descriptor;
+    descriptor.kind = TypeKind::Array;
+    descriptor.element = element;
+    descriptor.dimensions = dimensions;
+    return intern(std::move(descriptor));
+}
+
+/**
+ * @brief Intern a function signature type.
+ * @param returnType Declared return type.
+ * @param params Parameter types in declaration order.
+ * @return Function type id.
+ */
+TypeId TypeTable::function(TypeId returnType, const std::vector<TypeId>& params) {
+    TypeDescriptor descriptor;
+    descriptor.kind = TypeKind::Function;
+    descriptor.element = returnType;
+    descriptor.operands = params;
+    return intern(std::move(descriptor));
+}
+
+/**
+ * @brief Intern a class descriptor type.
+ * @param parents Inherited class types in declaration order.
+ * @return Class descriptor id.
+ */
+TypeId TypeTable::classDescriptor(const std::vector<TypeId>& parents) {
+    TypeDescriptor descriptor;
+    descriptor.kind = TypeKind::ClassDescriptor;
+    descriptor.operands = parents;
+    return intern(std::move(descriptor));
+}
+
+/** @brief Access descriptor for an id (throws on unknown id). */
+const TypeDescriptor& TypeTable::get(TypeId id) const {
+    if (id >= _types.size()) {
+        throw std::out_of_range("unknown type id " + std::to_string(id));
+    }
+    return _types[id];
+}
+
+/** @brief Category of an id. */
+TypeKind TypeTable::kind(TypeId id) const {
+    return get(id).kind;
+}
+
+/** @brief Rendered form of an id. */
+const std::string& TypeTable::toString(TypeId id) const {
+    return get(id).text;
+}
+
+/** @brief Return type for functions, element type for arrays, otherwise the id itself. */
+TypeId TypeTable::baseOf(TypeId id) const {
+    const TypeDescriptor& descriptor = get(id);
+    if (descriptor.kind == TypeKind::Function || descriptor.kind == TypeKind::Array) {
+        return descriptor.element;
+    }
+    return id;
+}
+
+/** @brief Number of interned descriptors. */
+std::size_t TypeTable::size() const {
+    return _types.size();
+}
+
+/**
+ * @brief Rebuild a type of another table in this one.
+ * @param other Source table.
+ * @param id Type id in other.
+ * @return Id here (parts are copied first, so ids of equal structure coincide).
+ */
+TypeId TypeTable::copyFrom(const TypeTable& other, TypeId id) {
+    const TypeDescriptor& descriptor = other.get(id);
+    std::vector<TypeId> operands;
+    for (TypeId operand : descriptor.operands) {
+        operands.push_back(copyFrom(other, operand));
+    }
+    switch (descriptor.kind) {
+        case TypeKind::Null:
+            return Null;
+        case TypeKind::Builtin:
+        case TypeKind::Class:
+            return named(descriptor.name);
+        case TypeKind::Array:
+            return array(copyFrom(other, descriptor.element), descriptor.dimensions);
+        case TypeKind::Function:
+            return function(copyFrom(other, descriptor.element), operands);
+        case TypeKind::ClassDescriptor:
+            return classDescriptor(operands);
+    }
+    return Null;
+}
+
+TypeId TypeTable::intern(TypeDescriptor descriptor) {
+    auto it = _index.find(descriptor);
+    if (it != _index.end()) {
+        return it->second;
+    }
+
+    if (_frozen) {
+        throw TypeTableFrozenError("type table is frozen; cannot intern '" + render(descriptor) + "'");
+    }
+
+    const TypeId id = static_cast<TypeId>(_types.size());
+    descriptor.text = render(descriptor);
+    _index.emplace(descriptor, id);
+    _types.push_back(std::move(descriptor));
+    return id;
+}
+
+/**
+ * @brief Render a descriptor in the notation used by diagnostics and dumps.
+ * @param descriptor Descriptor whose parts are already interned.
+ * @return Text such as "integer", "float[3][]", "integer(float, A)", "class : A, B".
+ */
+std::string TypeTable::render(const TypeDescriptor& descriptor) const {
+    std::ostringstream out;
+    switch (descriptor.kind) {
+        case TypeKind::Null:
+            return "null";
+        case TypeKind::Builtin:
+        case TypeKind::Class:
+            return descriptor.name;
+        case TypeKind::Array:
+            out << toString(descriptor.element);
+            for (int dim : descriptor.dimensions) {
+                if (dim < 0) {
+                    out << "[]";
+                } else {
+                    out << "[" << dim << "]";
+                }
+            }
+            return out.str();
+        case TypeKind::Function:
+            out << toString(descriptor.element) << "(";
+            for (std::size_t i = 0; i < descriptor.operands.size(); ++i) {
+                if (i > 0) {
+                    out << ", ";
+                }
+                out << toString(descriptor.operands[i]);
+            }
+            out << ")";
+            return out.str();
+        case TypeKind::ClassDescriptor:
+            out << "class";
+            for (std::size_t i = 0; i < descriptor.operands.size(); ++i) {
+                out << (i == 0 ? " : " : ", ") << toString(descriptor.operands[i]);
+            }
+            return out.str();
+    }
+    return "null";
+}
@@ -1,6 +1,9 @@
 #include "../include/ui.h"
 
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <string>
@@ -35,7 +38,7 @@ void printRule(char c = '=', int width = 90) {
     std::cout << colorize(std::string(width, c), ANSI::Gray) << "\n";
 }
 
-bool isGraphvizDotAvailable() {
+bool probeGraphvizDot() {
 #ifdef _WIN32
     return std::system("dot -V >NUL 2>&1") == 0;
 #else
@@ -43,10 +46,68 @@ bool isGraphvizDotAvailable() {
 #endif
 }
 
+bool isGraphvizDotAvailable() {
+    // The probe spawns a shell; its answer cannot change within one run.
+    static const bool available = probeGraphvizDot();
+    return available;
+}
+
 bool renderDotImage(const std::string& inputDot, const std::string& outputPng) {
     std::string cmd = "dot -Tpng \"" + inputDot + "\" -o \"" + outputPng + "\"";
     return std::system(cmd.c_str()) == 0;
 }
+
+/**
+ * @brief Hash file contents (FNV-1a, 64-bit) as lowercase hex.
+ * @param path File to hash.
+ * @return Hex digest, or empty string when the file cannot be read.
+ */
+std::string hashFileContents(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return "";
+    }
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    char buffer[1 << 14];
+    while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+        std::streamsize count = in.gcount();
+        for (std::streamsize i = 0; i < count; ++i) {
+            hash ^= static_cast<unsigned char>(buffer[i]);
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    static const char kDigits[] = "0123456789abcdef";
+    std::string hex(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        hex[static_cast<size_t>(i)] = kDigits[hash & 0xF];
+        hash >>= 4;
+    }
+    return hex;
+}
+
+/**
+ * @brief Path of the stamp file recording which DOT content produced a PNG.
+ * @param outputPng PNG path.
+ * @return Stamp path next to the PNG.
+ */
+std::string renderStampPath(const std::string& outputPng) {
+    return outputPng + ".dothash";
+}
+
+/**
+ * @brief Check whether an existing PNG was rendered from identical DOT content.
+ * @param dotHash Hash of the current DOT file.
+ * @param outputPng PNG path.
+ * @return True when the PNG exists and its stamp matches dotHash.
+ */
+bool isRenderUpToDate(const std::string& dotHash, const std::string& outputPng) {
+    if (dotHash.empty() || !std::ifstream(outputPng, std::ios::binary).is_open()) {
+        return false;
+    }
+    std::ifstream stamp(renderStampPath(outputPng));
+    std::string recorded;
+    return stamp >> recorded && recorded == dotHash;
+}
 }  // namespace
 
 namespace UI {
@@ -112,16 +173,34 @@ PngRenderResult renderAstPngFromDot(const std::string& inputDot, const std::stri
     PngRenderResult result{};
     result.dotAvailable = isGraphvizDotAvailable();
     result.pngGenerated = false;
+    result.reusedPreviousRender = false;
 
     if (result.dotAvailable) {
+        const std::string dotHash = hashFileContents(inputDot);
+        if (isRenderUpToDate(dotHash, outputPng)) {
+            result.pngGenerated = true;
+            result.reusedPreviousRender = true;
+            return result;
+        }
+
+        std::remove(renderStampPath(outputPng).c_str());
         result.pngGenerated = renderDotImage(inputDot, outputPng);
+        if (result.pngGenerated && !dotHash.empty()) {
+            std::ofstream(renderStampPath(outputPng), std::ios::trunc) << dotHash << "\n";
+        }
     }
 
     return result;
 }
 
+std::future<PngRenderResult> renderAstPngFromDotAsync(const std::string& inputDot, const std::string& outputPng) {
+    return std::async(std::launch::async, renderAstPngFromDot, inputDot, outputPng);
+}
+
 void printPngGenerationNotes(const PngRenderResult& result) {
-    if (!result.dotAvailable) {
+    if (result.reusedPreviousRender) {
+        printStatusLine(true, "AST image unchanged since last render (DOT content identical)");
+    } else if (!result.dotAvailable) {
         printWarning("Graphviz 'dot' not found. Skipped PNG generation.");
     } else if (!result.pngGenerated) {
         printWarning("Failed to generate AST image from DOT.");